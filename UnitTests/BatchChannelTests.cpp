@@ -0,0 +1,154 @@
+﻿#include "pch.h"
+#include "CppUnitTest.h"
+#include "../WinMgmt/Core/BatchChannel.h"
+
+#include <chrono>
+#include <vector>
+#include <thread>
+#include <atomic>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTests
+{
+    // Synthetic object producer standing in for the COM sink: pushes `count` ints
+    // into the channel and completes it, the same way Indicate/SetStatus do.
+    static void ProduceSynthetic(Wmi::BatchChannel<int>& channel, int count, std::chrono::microseconds perItem = {})
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            if (perItem.count() > 0)
+                std::this_thread::sleep_for(perItem);
+
+            if (!channel.Push(i))
+                return;
+        }
+        channel.Complete();
+    }
+
+    TEST_CLASS(BatchChannelTests)
+    {
+    public:
+
+        // ---------------------------------------------------------------------
+        // Batches_Have_Fixed_Size_And_Preserve_Order
+        // - Every batch except the last one is exactly batchSize long
+        // - Items come out in the order they were pushed
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Batches_Have_Fixed_Size_And_Preserve_Order)
+        {
+            Wmi::BatchChannel<int> channel{ 16, 4 };
+            std::thread producer(ProduceSynthetic, std::ref(channel), 1000, std::chrono::microseconds{});
+
+            int expected = 0;
+            std::vector<std::size_t> sizes;
+            while (auto batch = channel.Pop())
+            {
+                sizes.push_back(batch->size());
+                for (int v : *batch)
+                    Assert::AreEqual(expected++, v);
+            }
+            producer.join();
+
+            Assert::AreEqual(1000, expected);
+            for (std::size_t i = 0; i + 1 < sizes.size(); ++i)
+                Assert::AreEqual<std::size_t>(16, sizes[i]);
+            Assert::AreEqual<std::size_t>(1000 % 16, sizes.back());
+            Assert::IsTrue(channel.IsCompleted());
+        }
+
+        // ---------------------------------------------------------------------
+        // SlowConsumer_Applies_Backpressure
+        // - A slow consumer must never see more than maxPendingBatches queued
+        // - The producer must have been blocked at least once
+        // ---------------------------------------------------------------------
+        TEST_METHOD(SlowConsumer_Applies_Backpressure)
+        {
+            Wmi::BatchChannel<int> channel{ 8, 2 };
+            std::thread producer(ProduceSynthetic, std::ref(channel), 400, std::chrono::microseconds{});
+
+            int received = 0;
+            while (auto batch = channel.Pop())
+            {
+                received += static_cast<int>(batch->size());
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            producer.join();
+
+            auto stats = channel.Stats();
+            Assert::AreEqual(400, received);
+            Assert::IsTrue(stats.peakPendingBatches <= 2, L"Pending batches exceeded the configured bound.");
+            Assert::IsTrue(stats.producerWaits > 0, L"Producer was never throttled.");
+        }
+
+        // ---------------------------------------------------------------------
+        // Cancel_Unblocks_Producer
+        // - A producer blocked on a full channel returns once the consumer cancels
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Cancel_Unblocks_Producer)
+        {
+            Wmi::BatchChannel<int> channel{ 4, 1 };
+            std::atomic<bool> done{ false };
+
+            std::thread producer([&]() {
+                ProduceSynthetic(channel, 1'000'000);
+                done = true;
+            });
+
+            auto first = channel.Pop();
+            Assert::IsTrue(first.has_value());
+
+            channel.Cancel(-1);
+            producer.join();
+
+            Assert::IsTrue(done.load());
+            Assert::AreEqual(-1, channel.Status());
+            Assert::IsFalse(channel.Pop().has_value());
+        }
+
+        // ---------------------------------------------------------------------
+        // Complete_Propagates_Status
+        // - The status handed to Complete is visible to the consumer after draining
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Complete_Propagates_Status)
+        {
+            Wmi::BatchChannel<int> channel{ 4, 4 };
+            constexpr auto status = static_cast<std::int32_t>(0x80041010);
+            channel.Push(1);
+            channel.Complete(status);
+
+            auto batch = channel.Pop();
+            Assert::IsTrue(batch.has_value());
+            Assert::AreEqual<std::size_t>(1, batch->size());
+            Assert::IsFalse(channel.Pop().has_value());
+            Assert::AreEqual(status, channel.Status());
+        }
+
+        // ---------------------------------------------------------------------
+        // Streaming_TimeToFirstBatch_Performance_Test
+        // - A producer that takes ~100us per object should hand out its first batch long
+        //   before the whole result would have been materialized.
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Streaming_TimeToFirstBatch_Performance_Test)
+        {
+            constexpr int objects = 2000;
+            constexpr auto perItem = std::chrono::microseconds(100);
+
+            Wmi::BatchChannel<int> channel{ 64, 4 };
+
+            auto start = std::chrono::steady_clock::now();
+            std::thread producer(ProduceSynthetic, std::ref(channel), objects, perItem);
+
+            auto first = channel.Pop();
+            auto firstBatch = std::chrono::steady_clock::now() - start;
+
+            while (channel.Pop()) {}
+            auto total = std::chrono::steady_clock::now() - start;
+            producer.join();
+
+            Assert::IsTrue(first.has_value());
+            Assert::IsTrue(firstBatch * 10 < total, L"First batch arrived too late to be useful.");
+            Assert::IsTrue(channel.Stats().peakPendingBatches <= 4);
+        }
+    };
+}
@@ -0,0 +1,133 @@
+﻿#include "pch.h"
+#include "CppUnitTest.h"
+#include "../WinMgmt/Core/CimDateTime.h"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTests
+{
+    TEST_CLASS(CimDateTimeTests)
+    {
+    public:
+
+        // ---------------------------------------------------------------------
+        // Parse_Utc_DateTime
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Parse_Utc_DateTime)
+        {
+            auto value = Wmi::ParseCimDateTime(L"20240102030405.123456+000");
+            Assert::IsTrue(value.has_value());
+            Assert::AreEqual<std::int64_t>(1704164645'123456, value->microseconds);
+            Assert::AreEqual<std::int32_t>(0, value->utcOffsetMinutes);
+        }
+
+        // ---------------------------------------------------------------------
+        // Parse_Applies_Utc_Offset
+        // - the same instant written in two offsets parses to the same timestamp
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Parse_Applies_Utc_Offset)
+        {
+            auto east = Wmi::ParseCimDateTime(L"20240102050405.000000+120");
+            auto west = Wmi::ParseCimDateTime(L"20240101220405.000000-300");
+            Assert::IsTrue(east.has_value() && west.has_value());
+            Assert::AreEqual(east->microseconds, west->microseconds);
+            Assert::AreEqual<std::int32_t>(120, east->utcOffsetMinutes);
+            Assert::AreEqual<std::int32_t>(-300, west->utcOffsetMinutes);
+        }
+
+        // ---------------------------------------------------------------------
+        // Parse_Rejects_Malformed_Input
+        // - wildcards, intervals, bad lengths and out-of-range fields
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Parse_Rejects_Malformed_Input)
+        {
+            Assert::IsFalse(Wmi::ParseCimDateTime(L"2024**02030405.000000+000").has_value());
+            Assert::IsFalse(Wmi::ParseCimDateTime(L"00000001020304.000000:000").has_value());
+            Assert::IsFalse(Wmi::ParseCimDateTime(L"20240102030405.000000").has_value());
+            Assert::IsFalse(Wmi::ParseCimDateTime(L"20241302030405.000000+000").has_value());
+            Assert::IsFalse(Wmi::ParseCimDateTime(L"20240102250405.000000+000").has_value());
+            Assert::IsFalse(Wmi::ParseCimDateTime(L"").has_value());
+        }
+
+        // ---------------------------------------------------------------------
+        // Parse_Interval
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Parse_Interval)
+        {
+            Assert::IsTrue(Wmi::IsCimInterval(L"00000001020304.000005:000"));
+
+            auto interval = Wmi::ParseCimInterval(L"00000001020304.000005:000");
+            Assert::IsTrue(interval.has_value());
+            Assert::AreEqual<std::int64_t>(((24 + 2) * 3600 + 3 * 60 + 4) * 1'000'000LL + 5, *interval);
+
+            Assert::IsFalse(Wmi::ParseCimInterval(L"20240102030405.000000+000").has_value());
+        }
+
+        // ---------------------------------------------------------------------
+        // Format_Round_Trips
+        // - including dates before the epoch and negative offsets
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Format_Round_Trips)
+        {
+            for (const wchar_t* text : { L"20240229235959.999999+000", L"19690720201718.000000-300", L"16010101000000.000000+060" })
+            {
+                auto value = Wmi::ParseCimDateTime(text);
+                Assert::IsTrue(value.has_value());
+
+                wchar_t formatted[Wmi::CimDateTimeLength + 1];
+                Wmi::FormatCimDateTime(*value, formatted);
+                Assert::AreEqual(std::wstring{ text }, std::wstring{ formatted });
+            }
+        }
+
+        // ---------------------------------------------------------------------
+        // Parse_Is_Constexpr
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Parse_Is_Constexpr)
+        {
+            constexpr auto epoch = Wmi::ParseCimDateTime(L"19700101000000.000000+000");
+            static_assert(epoch.has_value() && epoch->microseconds == 0);
+            Assert::IsTrue(epoch.has_value());
+        }
+
+        // ---------------------------------------------------------------------
+        // DateTime_Parse_Performance_Test
+        // - one million distinct timestamps in well under a second
+        // ---------------------------------------------------------------------
+        TEST_METHOD(DateTime_Parse_Performance_Test)
+        {
+            constexpr int count = 1'000'000;
+
+            std::vector<std::wstring> inputs;
+            inputs.reserve(count);
+            for (int i = 0; i < count; ++i)
+            {
+                wchar_t text[Wmi::CimDateTimeLength + 1];
+                Wmi::FormatCimDateTime({ 1'600'000'000'000'000LL + std::int64_t{ i } * 7'919'000'003LL, (i % 25 - 12) * 60 }, text);
+                inputs.emplace_back(text);
+            }
+
+            auto start = std::chrono::high_resolution_clock::now();
+            std::int64_t checksum = 0;
+            int parsed = 0;
+            for (auto const& input : inputs)
+            {
+                if (auto value = Wmi::ParseCimDateTime(input))
+                {
+                    checksum ^= value->microseconds;
+                    ++parsed;
+                }
+            }
+            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start);
+
+            Assert::AreEqual(count, parsed);
+            Assert::AreNotEqual<std::int64_t>(0, checksum);
+            Assert::IsTrue(elapsed.count() < 250, L"DATETIME parsing is too slow.");
+        }
+    };
+}
@@ -0,0 +1,220 @@
+﻿#include "pch.h"
+#include "CppUnitTest.h"
+#include "../WinMgmt/Core/ConnectionPool.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTests
+{
+    struct StubConnection
+    {
+        int id = 0;
+        std::wstring ns;
+    };
+
+    using StubConnectionPtr = std::shared_ptr<StubConnection>;
+
+    // Counts connects and probes; health and failures are switched by the test.
+    struct StubConnector : Wmi::IConnector<StubConnectionPtr>
+    {
+        std::atomic<int> connects{ 0 };
+        std::atomic<int> probes{ 0 };
+        std::atomic<bool> healthy{ true };
+        std::atomic<bool> failing{ false };
+        std::chrono::microseconds latency{ 0 };
+
+        StubConnectionPtr Connect(Wmi::ConnectionKey const& key) override
+        {
+            if (failing.load())
+                throw std::runtime_error("connect failed");
+
+            std::this_thread::sleep_for(latency);
+            return std::make_shared<StubConnection>(StubConnection{ connects.fetch_add(1) + 1, key.ns });
+        }
+
+        bool IsHealthy(StubConnectionPtr const&) override
+        {
+            probes.fetch_add(1);
+            return healthy.load();
+        }
+    };
+
+    TEST_CLASS(ConnectionPoolTests)
+    {
+    public:
+
+        // ---------------------------------------------------------------------
+        // Connects_Lazily_And_Reuses_Per_Key
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Connects_Lazily_And_Reuses_Per_Key)
+        {
+            auto connector = std::make_shared<StubConnector>();
+            Wmi::ConnectionPool<StubConnectionPtr> pool{ connector };
+            Assert::AreEqual(0, connector->connects.load());
+
+            auto a = pool.Acquire({ L"", L"ROOT\\CIMV2", L"" });
+            auto b = pool.Acquire({ L"", L"root\\cimv2", L"" });
+            Assert::IsTrue(a == b, L"Namespace must compare case-insensitively.");
+            Assert::AreEqual(1, connector->connects.load());
+
+            auto other = pool.Acquire({ L"", L"ROOT\\StandardCimv2", L"" });
+            auto remote = pool.Acquire({ L"server01", L"ROOT\\CIMV2", L"" });
+            auto user = pool.Acquire({ L"", L"ROOT\\CIMV2", L"DOMAIN\\admin" });
+            Assert::IsTrue(other != a && remote != a && user != a);
+            Assert::AreEqual(4, connector->connects.load());
+            Assert::AreEqual<size_t>(4, pool.Stats().connections);
+        }
+
+        // ---------------------------------------------------------------------
+        // Stale_Connection_Is_Probed_And_Replaced
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Stale_Connection_Is_Probed_And_Replaced)
+        {
+            auto connector = std::make_shared<StubConnector>();
+            auto now = std::make_shared<std::chrono::steady_clock::time_point>();
+            Wmi::ConnectionPool<StubConnectionPtr> pool{ connector, std::chrono::seconds{ 30 }, [now] { return *now; } };
+            const Wmi::ConnectionKey key{ L"", L"ROOT\\CIMV2", L"" };
+
+            auto first = pool.Acquire(key);
+            *now += std::chrono::seconds{ 10 };
+            Assert::IsTrue(pool.Acquire(key) == first);
+            Assert::AreEqual(0, connector->probes.load());
+
+            *now += std::chrono::seconds{ 31 };
+            Assert::IsTrue(pool.Acquire(key) == first);
+            Assert::AreEqual(1, connector->probes.load());
+
+            connector->healthy = false;
+            *now += std::chrono::seconds{ 31 };
+            auto replaced = pool.Acquire(key);
+            Assert::IsTrue(replaced != first);
+            Assert::AreEqual(2, connector->connects.load());
+            Assert::AreEqual<uint64_t>(1, pool.Stats().reconnects);
+        }
+
+        // ---------------------------------------------------------------------
+        // Successful_Use_Postpones_Health_Check
+        // - Confirm counts as a check, so a connection in steady use is not probed
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Successful_Use_Postpones_Health_Check)
+        {
+            auto connector = std::make_shared<StubConnector>();
+            auto now = std::make_shared<std::chrono::steady_clock::time_point>();
+            Wmi::ConnectionPool<StubConnectionPtr> pool{ connector, std::chrono::seconds{ 30 }, [now] { return *now; } };
+            const Wmi::ConnectionKey key{ L"", L"ROOT\\CIMV2", L"" };
+
+            auto first = pool.Acquire(key);
+            for (int i = 0; i < 10; ++i)
+            {
+                *now += std::chrono::seconds{ 20 };
+                Assert::IsTrue(pool.Acquire(key) == first);
+                pool.Confirm(key);
+            }
+            Assert::AreEqual(0, connector->probes.load());
+
+            *now += std::chrono::seconds{ 31 };
+            Assert::IsTrue(pool.Acquire(key) == first);
+            Assert::AreEqual(1, connector->probes.load());
+
+            pool.Confirm({ L"", L"ROOT\\Unknown", L"" });
+            Assert::AreEqual<size_t>(1, pool.Stats().connections);
+        }
+
+        // ---------------------------------------------------------------------
+        // Scopes_Do_Not_Share_Connections
+        // - Callers in different scopes (COM apartments) get their own
+        //   connection for the same key; Invalidate drops them all
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Scopes_Do_Not_Share_Connections)
+        {
+            auto connector = std::make_shared<StubConnector>();
+            auto scope = std::make_shared<std::uint64_t>(0);
+            Wmi::ConnectionPool<StubConnectionPtr> pool{ connector, std::chrono::seconds{ 30 }, &std::chrono::steady_clock::now, [scope] { return *scope; } };
+            const Wmi::ConnectionKey key{ L"", L"ROOT\\CIMV2", L"" };
+
+            auto mta = pool.Acquire(key);
+            *scope = 1234;
+            auto sta = pool.Acquire(key);
+            Assert::IsTrue(sta != mta);
+            Assert::IsTrue(pool.Acquire(key) == sta);
+            *scope = 0;
+            Assert::IsTrue(pool.Acquire(key) == mta);
+            Assert::AreEqual(2, connector->connects.load());
+
+            (void)pool.Acquire({ L"", L"ROOT\\CIMV2", L"user" });
+            pool.Invalidate(key);
+            Assert::AreEqual<size_t>(1, pool.Stats().connections);
+            Assert::IsTrue(pool.Acquire(key) != mta);
+        }
+
+        // ---------------------------------------------------------------------
+        // Failed_Connect_Propagates_And_Retries
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Failed_Connect_Propagates_And_Retries)
+        {
+            auto connector = std::make_shared<StubConnector>();
+            Wmi::ConnectionPool<StubConnectionPtr> pool{ connector };
+            const Wmi::ConnectionKey key{ L"", L"ROOT\\Missing", L"" };
+
+            connector->failing = true;
+            Assert::ExpectException<std::runtime_error>([&] { (void)pool.Acquire(key); });
+            Assert::AreEqual<uint64_t>(1, pool.Stats().failures);
+
+            connector->failing = false;
+            Assert::IsNotNull(pool.Acquire(key).get());
+
+            pool.Invalidate(key);
+            Assert::AreEqual<size_t>(0, pool.Stats().connections);
+            (void)pool.Acquire(key);
+            Assert::AreEqual(2, connector->connects.load());
+        }
+
+        // ---------------------------------------------------------------------
+        // Concurrent_Acquire_Performance_Test
+        // - 8 threads, 4 namespaces: one connect per namespace, cheap warm acquires
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Concurrent_Acquire_Performance_Test)
+        {
+            constexpr int threadCount = 8;
+            constexpr int acquiresPerThread = 100'000;
+            const std::wstring namespaces[] = { L"ROOT\\CIMV2", L"ROOT\\StandardCimv2", L"ROOT\\WMI", L"ROOT\\Microsoft\\Windows\\Storage" };
+
+            auto connector = std::make_shared<StubConnector>();
+            connector->latency = std::chrono::milliseconds{ 20 };
+            Wmi::ConnectionPool<StubConnectionPtr> pool{ connector };
+
+            std::atomic<int> mismatches{ 0 };
+            auto start = std::chrono::high_resolution_clock::now();
+            std::vector<std::thread> threads;
+            for (int t = 0; t < threadCount; ++t)
+            {
+                threads.emplace_back([&, t]
+                {
+                    for (int i = 0; i < acquiresPerThread; ++i)
+                    {
+                        auto const& ns = namespaces[(i + t) % 4];
+                        if (pool.Acquire({ L"", ns, L"" })->ns != ns)
+                            mismatches.fetch_add(1);
+                    }
+                });
+            }
+            for (auto& thread : threads)
+                thread.join();
+            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start);
+
+            Assert::AreEqual(0, mismatches.load());
+            Assert::AreEqual(4, connector->connects.load());
+            Assert::AreEqual<uint64_t>(threadCount * acquiresPerThread, pool.Stats().acquires);
+            Assert::IsTrue(elapsed.count() < 3000, L"Warm connection acquisition is too slow.");
+        }
+    };
+}
@@ -0,0 +1,250 @@
+﻿#include "pch.h"
+#include "CppUnitTest.h"
+#include "../WinMgmt/Core/EventCoalescer.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTests
+{
+    struct SyntheticEvent
+    {
+        std::uint32_t source = 0;
+        std::uint32_t sequence = 0;
+        std::chrono::steady_clock::time_point posted{};
+    };
+
+    using SyntheticCoalescer = Wmi::EventCoalescer<SyntheticEvent>;
+
+    // Synthetic event source standing in for the notification sink: delivers `rate`
+    // events per second for `duration`, in Indicate-sized chunks every millisecond.
+    static void RaiseSynthetic(SyntheticCoalescer& coalescer, std::uint32_t source, std::uint32_t rate, std::chrono::milliseconds duration)
+    {
+        const std::uint32_t perTick = rate / 1000;
+        const auto ticks = duration.count();
+        auto next = std::chrono::steady_clock::now();
+
+        std::uint32_t sequence = 0;
+        for (long long tick = 0; tick < ticks; ++tick)
+        {
+            std::vector<SyntheticEvent> chunk;
+            chunk.reserve(perTick);
+            const auto now = std::chrono::steady_clock::now();
+            for (std::uint32_t i = 0; i < perTick; ++i)
+                chunk.push_back({ source, sequence++, now });
+            coalescer.PostAll(std::move(chunk));
+
+            next += std::chrono::milliseconds(1);
+            std::this_thread::sleep_until(next);
+        }
+    }
+
+    TEST_CLASS(EventCoalescerTests)
+    {
+    public:
+
+        // ---------------------------------------------------------------------
+        // Full_Batches_Are_Delivered_Immediately
+        // - maxBatch events make a batch without waiting for maxDelay
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Full_Batches_Are_Delivered_Immediately)
+        {
+            SyntheticCoalescer coalescer{ { 8, std::chrono::milliseconds(60'000), 1024 } };
+            for (std::uint32_t i = 0; i < 20; ++i)
+                coalescer.Post({ 0, i, {} });
+
+            auto first = coalescer.TryPop();
+            auto second = coalescer.TryPop();
+            Assert::IsTrue(first.has_value() && second.has_value());
+            Assert::AreEqual<std::size_t>(8, first->size());
+            Assert::AreEqual<std::uint32_t>(8, second->front().sequence);
+
+            // The remaining four are neither a full batch nor old enough yet.
+            Assert::IsFalse(coalescer.TryPop().has_value());
+            Assert::AreEqual<std::uint64_t>(2, coalescer.Stats().fullBatches);
+        }
+
+        // ---------------------------------------------------------------------
+        // Partial_Batch_Is_Delivered_After_MaxDelay
+        // - A trickle of events is handed out once the first one is maxDelay old
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Partial_Batch_Is_Delivered_After_MaxDelay)
+        {
+            constexpr auto maxDelay = std::chrono::milliseconds(30);
+            SyntheticCoalescer coalescer{ { 256, maxDelay, 1024 } };
+
+            const auto start = std::chrono::steady_clock::now();
+            coalescer.Post({ 0, 0, start });
+            coalescer.Post({ 0, 1, start });
+
+            auto batch = coalescer.Pop();
+            const auto waited = std::chrono::steady_clock::now() - start;
+
+            Assert::IsTrue(batch.has_value());
+            Assert::AreEqual<std::size_t>(2, batch->size());
+            Assert::IsTrue(waited >= maxDelay, L"Partial batch was delivered before maxDelay.");
+            Assert::IsTrue(waited < maxDelay * 10, L"Partial batch was held far beyond maxDelay.");
+            Assert::AreEqual<std::uint64_t>(1, coalescer.Stats().timedBatches);
+        }
+
+        // ---------------------------------------------------------------------
+        // Overflow_Drops_And_Counts_Events
+        // - The producer never blocks; events past maxPending are dropped and counted
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Overflow_Drops_And_Counts_Events)
+        {
+            SyntheticCoalescer coalescer{ { 10, std::chrono::milliseconds(60'000), 50 } };
+
+            std::vector<SyntheticEvent> burst(80);
+            Assert::AreEqual<std::size_t>(50, coalescer.PostAll(std::move(burst)));
+            Assert::IsFalse(coalescer.Post(SyntheticEvent{}));
+
+            auto stats = coalescer.Stats();
+            Assert::AreEqual<std::uint64_t>(50, stats.events);
+            Assert::AreEqual<std::uint64_t>(31, stats.dropped);
+            Assert::AreEqual<std::size_t>(50, stats.peakPending);
+
+            // Draining makes room again.
+            (void)coalescer.TryPop();
+            Assert::IsTrue(coalescer.Post(SyntheticEvent{}));
+        }
+
+        // ---------------------------------------------------------------------
+        // Complete_Flushes_Remainder_And_Cancel_Discards
+        // - Complete hands out the open batch at once and then ends the stream
+        // - Cancel drops buffered events and releases a blocked consumer
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Complete_Flushes_Remainder_And_Cancel_Discards)
+        {
+            constexpr auto status = static_cast<std::int32_t>(0x80041032); // WBEM_E_CALL_CANCELLED
+            {
+                SyntheticCoalescer coalescer{ { 64, std::chrono::milliseconds(60'000), 1024 } };
+                coalescer.Post({ 0, 0, {} });
+                coalescer.Complete(status);
+
+                auto batch = coalescer.Pop();
+                Assert::IsTrue(batch.has_value());
+                Assert::AreEqual<std::size_t>(1, batch->size());
+                Assert::IsFalse(coalescer.Pop().has_value());
+                Assert::IsTrue(coalescer.IsCompleted());
+                Assert::AreEqual(status, coalescer.Status());
+            }
+            {
+                SyntheticCoalescer coalescer{ { 64, std::chrono::milliseconds(60'000), 1024 } };
+                std::atomic<bool> released{ false };
+                std::thread consumer([&]() {
+                    while (coalescer.Pop())
+                    {
+                    }
+                    released = true;
+                });
+
+                coalescer.Post({ 0, 0, {} });
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                coalescer.Cancel(status);
+                consumer.join();
+
+                Assert::IsTrue(released.load());
+                Assert::IsFalse(coalescer.Post(SyntheticEvent{}));
+                Assert::AreEqual(status, coalescer.Status());
+
+                // Events refused after Close are not dropped ones: nobody is listening.
+                Assert::AreEqual<std::uint64_t>(0, coalescer.Stats().dropped);
+            }
+        }
+
+        // ---------------------------------------------------------------------
+        // Wake_Hook_And_DueAt_Drive_A_Non_Blocking_Consumer
+        // - onWake runs when a batch starts, fills up, or the stream ends
+        // - DueAt tells a consumer using TryPop how long it may sleep
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Wake_Hook_And_DueAt_Drive_A_Non_Blocking_Consumer)
+        {
+            constexpr auto maxDelay = std::chrono::milliseconds(60'000);
+            int wakes = 0;
+            SyntheticCoalescer coalescer{ { 4, maxDelay, 1024 }, [&wakes] { ++wakes; } };
+            Assert::IsFalse(coalescer.DueAt().has_value());
+
+            const auto before = std::chrono::steady_clock::now();
+            coalescer.Post({ 0, 0, {} });
+            coalescer.Post({ 0, 1, {} });
+            Assert::AreEqual(1, wakes);
+            auto due = coalescer.DueAt();
+            Assert::IsTrue(due.has_value() && *due >= before + maxDelay);
+
+            coalescer.Post({ 0, 2, {} });
+            coalescer.Post({ 0, 3, {} });
+            Assert::AreEqual(2, wakes);
+            due = coalescer.DueAt();
+            Assert::IsTrue(due.has_value() && *due <= std::chrono::steady_clock::now());
+            Assert::IsTrue(coalescer.TryPop().has_value());
+
+            coalescer.Complete();
+            Assert::AreEqual(3, wakes);
+            Assert::IsTrue(coalescer.IsCompleted());
+        }
+
+        // ---------------------------------------------------------------------
+        // Synthetic_100k_Events_Per_Second_Stress_Test
+        // - Four sources raise 100k events/s in total for one second
+        // - Nothing is dropped, each source's events stay in order, no batch exceeds
+        //   maxBatch and no event waits much longer than maxDelay
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Synthetic_100k_Events_Per_Second_Stress_Test)
+        {
+            constexpr std::uint32_t sources = 4;
+            constexpr std::uint32_t ratePerSource = 25'000;
+            constexpr auto duration = std::chrono::milliseconds(1000);
+            constexpr auto maxDelay = std::chrono::milliseconds(20);
+            constexpr std::size_t maxBatch = 512;
+
+            SyntheticCoalescer coalescer{ { maxBatch, maxDelay, 256 * 1024 } };
+
+            std::vector<std::uint32_t> nextSequence(sources, 0);
+            std::uint64_t received = 0;
+            std::size_t largest = 0;
+            std::chrono::steady_clock::duration worstLatency{};
+            bool ordered = true;
+
+            std::thread consumer([&]() {
+                while (auto batch = coalescer.Pop())
+                {
+                    const auto now = std::chrono::steady_clock::now();
+                    largest = (std::max)(largest, batch->size());
+                    received += batch->size();
+                    worstLatency = (std::max)(worstLatency, now - batch->front().posted);
+                    for (auto const& event : *batch)
+                        ordered = ordered && event.sequence == nextSequence[event.source]++;
+                }
+            });
+
+            const auto start = std::chrono::steady_clock::now();
+            std::vector<std::thread> producers;
+            for (std::uint32_t source = 0; source < sources; ++source)
+                producers.emplace_back(RaiseSynthetic, std::ref(coalescer), source, ratePerSource, duration);
+            for (auto& producer : producers)
+                producer.join();
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+
+            coalescer.Complete();
+            consumer.join();
+
+            auto stats = coalescer.Stats();
+            const auto expected = static_cast<std::uint64_t>(sources) * ratePerSource;
+            const auto rate = expected / std::chrono::duration<double>(elapsed).count();
+
+            Assert::IsTrue(rate > 80'000, L"The synthetic source did not sustain its rate.");
+            Assert::AreEqual<std::uint64_t>(0, stats.dropped);
+            Assert::AreEqual(expected, received);
+            Assert::IsTrue(ordered, L"Events of one source were reordered.");
+            Assert::IsTrue(largest <= maxBatch, L"A batch exceeded maxBatch.");
+            Assert::IsTrue(stats.batches < received / 16, L"Events were not coalesced into batches.");
+            Assert::IsTrue(worstLatency < maxDelay * 10, L"An event waited far beyond maxDelay.");
+        }
+    };
+}
@@ -0,0 +1,263 @@
+﻿#include "pch.h"
+#include "CppUnitTest.h"
+#include "../WinMgmt/Core/FanOut.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTests
+{
+    using namespace std::chrono_literals;
+
+    // Stands in for winmgmt: every query sleeps `latency`, as a provider round trip
+    // would, and answers one row naming the namespace and query it ran. Queries in
+    // `failing` namespace throw instead.
+    struct LatencyBackend : Wmi::IQueryBackend
+    {
+        std::chrono::milliseconds latency{ 10 };
+        std::wstring failing;
+
+        std::atomic<std::size_t> executions{ 0 };
+        std::atomic<std::size_t> running{ 0 };
+        std::atomic<std::size_t> peak{ 0 };
+
+        Wmi::ResultTablePtr Execute(std::wstring_view ns, std::wstring_view query) override
+        {
+            executions.fetch_add(1);
+            const auto now = running.fetch_add(1) + 1;
+            auto seen = peak.load();
+            while (seen < now && !peak.compare_exchange_weak(seen, now))
+            {
+            }
+
+            std::this_thread::sleep_for(latency);
+            running.fetch_sub(1);
+
+            if (ns == failing)
+                throw std::runtime_error("provider failure");
+
+            auto table = std::make_shared<Wmi::ResultTable>();
+            auto nsColumn = table->AddColumn(L"Namespace", Wmi::PropertyType::String);
+            auto queryColumn = table->AddColumn(L"Query", Wmi::PropertyType::String);
+            table->BeginRow();
+            table->AppendString(nsColumn, ns);
+            table->AppendString(queryColumn, query);
+            table->EndRow();
+            return table;
+        }
+    };
+
+    static std::vector<Wmi::FanOutQuery> InventoryQueries(std::size_t count)
+    {
+        static const wchar_t* namespaces[] = { L"ROOT\\CIMV2", L"ROOT\\StandardCimv2", L"ROOT\\WMI", L"ROOT\\Microsoft\\Windows\\Storage" };
+
+        std::vector<Wmi::FanOutQuery> queries;
+        for (std::size_t i = 0; i < count; ++i)
+            queries.push_back({ namespaces[i % std::size(namespaces)], L"SELECT * FROM Class" + std::to_wstring(i) });
+        return queries;
+    }
+
+    static std::vector<Wmi::FanOutResult> Drain(Wmi::FanOut& run)
+    {
+        std::vector<Wmi::FanOutResult> results;
+        while (auto result = run.Next())
+            results.push_back(std::move(*result));
+        return results;
+    }
+
+    TEST_CLASS(FanOutTests)
+    {
+    public:
+
+        // ---------------------------------------------------------------------
+        // Executor_Runs_Every_Task_And_Steals_Idle_Work
+        // - Tasks submitted from one worker land on its deque
+        // - The other workers steal them and every task runs exactly once
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Executor_Runs_Every_Task_And_Steals_Idle_Work)
+        {
+            constexpr std::size_t taskCount = 400;
+
+            std::atomic<std::size_t> done{ 0 };
+            std::mutex mutex;
+            std::condition_variable finished;
+            Wmi::WorkStealingStats stats;
+            {
+                Wmi::WorkStealingExecutor executor{ 4 };
+                executor.Submit([&] {
+                    for (std::size_t i = 0; i < taskCount; ++i)
+                        executor.Submit([&] {
+                            std::this_thread::sleep_for(100us);
+                            if (done.fetch_add(1) + 1 == taskCount)
+                            {
+                                std::lock_guard lk(mutex);
+                                finished.notify_all();
+                            }
+                        });
+                });
+
+                std::unique_lock lk(mutex);
+                Assert::IsTrue(finished.wait_for(lk, 10s, [&] { return done.load() == taskCount; }));
+                lk.unlock();
+
+                stats = executor.Stats();
+                Assert::AreEqual<std::size_t>(4, executor.WorkerCount());
+            }
+
+            Assert::AreEqual(taskCount, done.load());
+            Assert::IsTrue(stats.stolen > 0);
+        }
+
+        // ---------------------------------------------------------------------
+        // Results_Are_Tagged_By_Source_With_Timing
+        // - Every query is reported once, tagged with its index
+        // - Each table is the one its (namespace, query) pair produced
+        // - Elapsed covers the backend latency; queued grows for later queries
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Results_Are_Tagged_By_Source_With_Timing)
+        {
+            auto backend = std::make_shared<LatencyBackend>();
+            Wmi::WorkStealingExecutor executor{ 4 };
+
+            auto run = Wmi::FanOut::Start(executor, backend, InventoryQueries(8), 2);
+            auto results = Drain(*run);
+
+            Assert::AreEqual<std::size_t>(8, results.size());
+            Assert::IsTrue(run->IsCompleted());
+
+            std::set<std::size_t> sources;
+            for (auto const& result : results)
+            {
+                sources.insert(result.source);
+                auto const& query = run->Queries()[result.source];
+
+                Assert::IsFalse(static_cast<bool>(result.error));
+                Assert::AreEqual<std::size_t>(1, result.table->RowCount());
+                Assert::IsTrue(result.table->Row(0).GetString(0) == query.ns);
+                Assert::IsTrue(result.table->Row(0).GetString(1) == query.query);
+                Assert::IsTrue(result.elapsed >= 10ms);
+            }
+            Assert::AreEqual<std::size_t>(8, sources.size());
+
+            // Two at a time: the last pair cannot start before three rounds have finished.
+            auto latest = std::max_element(results.begin(), results.end(), [](auto const& left, auto const& right) { return left.queued < right.queued; });
+            Assert::IsTrue(latest->queued >= 30ms);
+
+            auto stats = run->Stats();
+            Assert::AreEqual<std::size_t>(8, stats.completed);
+            Assert::AreEqual<std::size_t>(0, stats.failed);
+        }
+
+        // ---------------------------------------------------------------------
+        // Failures_Are_Reported_Per_Query
+        // - A failing namespace yields results carrying the backend's exception
+        // - The other queries still complete
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Failures_Are_Reported_Per_Query)
+        {
+            auto backend = std::make_shared<LatencyBackend>();
+            backend->latency = 1ms;
+            backend->failing = L"ROOT\\WMI";
+            Wmi::WorkStealingExecutor executor{ 4 };
+
+            auto run = Wmi::FanOut::Start(executor, backend, InventoryQueries(8));
+            auto results = Drain(*run);
+
+            Assert::AreEqual<std::size_t>(8, results.size());
+            for (auto const& result : results)
+            {
+                const bool shouldFail = run->Queries()[result.source].ns == L"ROOT\\WMI";
+                Assert::AreEqual(shouldFail, static_cast<bool>(result.error));
+                Assert::AreEqual(shouldFail, result.table == nullptr);
+            }
+
+            auto stats = run->Stats();
+            Assert::AreEqual<std::size_t>(6, stats.completed);
+            Assert::AreEqual<std::size_t>(2, stats.failed);
+        }
+
+        // ---------------------------------------------------------------------
+        // Concurrency_Limit_Is_Respected
+        // - With more workers than the limit, no more than the limit run at once
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Concurrency_Limit_Is_Respected)
+        {
+            auto backend = std::make_shared<LatencyBackend>();
+            backend->latency = 5ms;
+            Wmi::WorkStealingExecutor executor{ 8 };
+
+            auto run = Wmi::FanOut::Start(executor, backend, InventoryQueries(24), 3);
+            auto results = Drain(*run);
+
+            Assert::AreEqual<std::size_t>(24, results.size());
+            Assert::IsTrue(backend->peak.load() <= 3);
+            Assert::IsTrue(run->Stats().peakConcurrency <= 3);
+            Assert::IsTrue(backend->peak.load() >= 2);
+        }
+
+        // ---------------------------------------------------------------------
+        // Cancel_Skips_Pending_Queries
+        // - After Cancel, Next ends the stream and queries not started never run
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Cancel_Skips_Pending_Queries)
+        {
+            auto backend = std::make_shared<LatencyBackend>();
+            backend->latency = 5ms;
+            Wmi::WorkStealingExecutor executor{ 2 };
+
+            auto run = Wmi::FanOut::Start(executor, backend, InventoryQueries(40), 1);
+            Assert::IsTrue(run->Next().has_value());
+
+            run->Cancel();
+            Assert::IsFalse(run->Next().has_value());
+            Assert::IsTrue(run->IsCompleted());
+
+            std::this_thread::sleep_for(50ms);
+            Assert::IsTrue(backend->executions.load() <= 3);
+        }
+
+        // ---------------------------------------------------------------------
+        // Performance_Fan_Out_Scales_With_Concurrency
+        // - 64 queries with 10 ms of injected latency each
+        // - Run one at a time vs. 16 at a time on 16 workers
+        // - Latency-bound queries overlap whatever the core count, so the speedup
+        //   tracks the concurrency limit
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Performance_Fan_Out_Scales_With_Concurrency)
+        {
+            constexpr std::size_t queryCount = 64;
+            constexpr long long maxMs = 200;
+
+            auto measure = [&](std::size_t maxConcurrency) {
+                auto backend = std::make_shared<LatencyBackend>();
+                Wmi::WorkStealingExecutor executor{ 16 };
+
+                auto start = std::chrono::high_resolution_clock::now();
+                auto run = Wmi::FanOut::Start(executor, backend, InventoryQueries(queryCount), maxConcurrency);
+                auto results = Drain(*run);
+                auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start).count();
+
+                Assert::AreEqual(queryCount, results.size());
+                return elapsed;
+            };
+
+            auto serialMs = measure(1);
+            auto parallelMs = measure(16);
+
+            Assert::IsTrue(serialMs >= 640);
+            Assert::IsTrue(parallelMs < maxMs);
+            Assert::IsTrue(parallelMs * 4 < serialMs);
+        }
+    };
+}
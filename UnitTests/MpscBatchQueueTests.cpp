@@ -0,0 +1,219 @@
+﻿#include "pch.h"
+#include "CppUnitTest.h"
+#include "../WinMgmt/Core/MpscBatchQueue.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTests
+{
+    // Item written by a stress producer: which producer, and its position in that
+    // producer's sequence.
+    static std::uint64_t StressItem(std::uint64_t producer, std::uint64_t sequence)
+    {
+        return producer << 32 | sequence;
+    }
+
+    // Runs producerCount threads that each push batchesPerProducer batches of 1 to 8
+    // items through push, while the calling thread drains through drain until every
+    // producer has finished. Returns everything drained.
+    template<typename Push, typename Drain>
+    static std::vector<std::uint64_t> RunStress(std::size_t producerCount, std::size_t batchesPerProducer, Push push, Drain drain)
+    {
+        std::atomic<std::size_t> running{ producerCount };
+        std::vector<std::thread> producers;
+        for (std::size_t p = 0; p < producerCount; ++p)
+        {
+            producers.emplace_back([&, p] {
+                std::uint64_t sequence = 0;
+                for (std::size_t b = 0; b < batchesPerProducer; ++b)
+                {
+                    std::vector<std::uint64_t> batch;
+                    for (std::size_t i = 0; i <= b % 8; ++i)
+                        batch.push_back(StressItem(p, sequence++));
+                    push(std::move(batch));
+                }
+                running.fetch_sub(1);
+            });
+        }
+
+        std::vector<std::uint64_t> drained;
+        while (running.load() > 0)
+        {
+            if (drain(drained) == 0)
+                std::this_thread::yield();
+        }
+        for (auto& producer : producers)
+            producer.join();
+        drain(drained);
+
+        return drained;
+    }
+
+    // Every item of every producer arrived exactly once, each producer's in order.
+    static bool IsCompleteAndOrdered(std::vector<std::uint64_t> const& drained, std::size_t producerCount, std::size_t batchesPerProducer)
+    {
+        std::size_t perProducer = 0;
+        for (std::size_t b = 0; b < batchesPerProducer; ++b)
+            perProducer += b % 8 + 1;
+
+        if (drained.size() != producerCount * perProducer)
+            return false;
+
+        std::vector<std::uint64_t> next(producerCount, 0);
+        for (auto item : drained)
+        {
+            auto producer = item >> 32;
+            if (producer >= producerCount || (item & 0xFFFFFFFF) != next[producer]++)
+                return false;
+        }
+        return true;
+    }
+
+    TEST_CLASS(MpscBatchQueueTests)
+    {
+    public:
+
+        // ---------------------------------------------------------------------
+        // Batches_Drain_In_Push_Order
+        // - Several pushes come out as one run of items in push order
+        // - An empty queue drains nothing
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Batches_Drain_In_Push_Order)
+        {
+            Wmi::MpscBatchQueue<int> queue;
+            Assert::IsTrue(queue.Push({ 1, 2 }));
+            Assert::IsTrue(queue.Push({ 3 }));
+            Assert::IsTrue(queue.Push({}));
+            Assert::IsTrue(queue.Push({ 4, 5, 6 }));
+
+            std::vector<int> out{ 0 };
+            Assert::AreEqual<std::size_t>(3, queue.Drain(out));
+            Assert::IsTrue(out == std::vector<int>{ 0, 1, 2, 3, 4, 5, 6 });
+            Assert::AreEqual<std::size_t>(0, queue.Drain(out));
+
+            auto stats = queue.Stats();
+            Assert::AreEqual<std::uint64_t>(3, stats.batches);
+            Assert::AreEqual<std::uint64_t>(6, stats.items);
+            Assert::AreEqual<std::uint64_t>(1, stats.drains);
+            Assert::AreEqual<std::uint64_t>(0, stats.contention);
+        }
+
+        // ---------------------------------------------------------------------
+        // Close_Returns_Leftovers_And_Refuses_Pushes
+        // - Close hands back what was queued; the queue keeps no reference to it
+        // - Later pushes fail and release their items; Drain finds nothing
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Close_Returns_Leftovers_And_Refuses_Pushes)
+        {
+            Wmi::MpscBatchQueue<std::shared_ptr<int>> queue;
+            auto kept = std::make_shared<int>(1);
+            Assert::IsTrue(queue.Push({ kept, std::make_shared<int>(2) }));
+
+            auto rest = queue.Close();
+            Assert::AreEqual<std::size_t>(2, rest.size());
+            Assert::AreEqual(2L, kept.use_count());
+            Assert::IsTrue(queue.IsClosed());
+
+            auto late = std::make_shared<int>(3);
+            std::weak_ptr<int> lateRef = late;
+            Assert::IsFalse(queue.Push({ std::move(late) }));
+            Assert::IsTrue(lateRef.expired());
+
+            std::vector<std::shared_ptr<int>> out;
+            Assert::AreEqual<std::size_t>(0, queue.Drain(out));
+            Assert::IsTrue(queue.Close().empty());
+            Assert::AreEqual<std::uint64_t>(1, queue.Stats().refused);
+        }
+
+        // ---------------------------------------------------------------------
+        // Stress_Many_Producers_With_Concurrent_Drain
+        // - 16 producers push 20,000 batches each while the consumer drains
+        // - Nothing is lost or duplicated and each producer's order holds
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Stress_Many_Producers_With_Concurrent_Drain)
+        {
+            constexpr std::size_t producerCount = 16;
+            constexpr std::size_t batchesPerProducer = 20'000;
+
+            Wmi::MpscBatchQueue<std::uint64_t> queue;
+            auto drained = RunStress(producerCount, batchesPerProducer,
+                [&](std::vector<std::uint64_t> batch) { queue.Push(std::move(batch)); },
+                [&](std::vector<std::uint64_t>& out) { return queue.Drain(out); });
+
+            Assert::IsTrue(IsCompleteAndOrdered(drained, producerCount, batchesPerProducer));
+
+            auto stats = queue.Stats();
+            Assert::AreEqual<std::uint64_t>(producerCount * batchesPerProducer, stats.batches);
+            Assert::AreEqual<std::uint64_t>(drained.size(), stats.items);
+            Assert::IsTrue(stats.drains > 0);
+        }
+
+        // ---------------------------------------------------------------------
+        // Close_Racing_Producers_Loses_Nothing_Accepted
+        // - Producers keep pushing while the consumer closes the queue
+        // - Every accepted item is drained or returned by Close, exactly once
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Close_Racing_Producers_Loses_Nothing_Accepted)
+        {
+            constexpr std::size_t producerCount = 8;
+
+            Wmi::MpscBatchQueue<std::uint64_t> queue;
+            std::atomic<std::uint64_t> accepted{ 0 };
+            std::atomic<std::uint64_t> refused{ 0 };
+
+            std::vector<std::thread> producers;
+            for (std::size_t p = 0; p < producerCount; ++p)
+            {
+                producers.emplace_back([&] {
+                    while (queue.Push({ 1, 1, 1 }))
+                        accepted.fetch_add(3);
+                    refused.fetch_add(1);
+                });
+            }
+
+            std::vector<std::uint64_t> out;
+            while (out.size() < 100'000)
+                queue.Drain(out);
+
+            auto rest = queue.Close();
+            for (auto& producer : producers)
+                producer.join();
+
+            Assert::AreEqual<std::uint64_t>(accepted.load(), out.size() + rest.size());
+            Assert::AreEqual<std::uint64_t>(producerCount, refused.load());
+            Assert::AreEqual<std::uint64_t>(producerCount, queue.Stats().refused);
+        }
+
+        // ---------------------------------------------------------------------
+        // Performance_Lock_Free_Ingestion_Throughput
+        // - 8 producers push 100,000 batches of 1 to 8 items each (3.6M items)
+        // - The consumer drains concurrently and must keep up at > 5M items/s
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Performance_Lock_Free_Ingestion_Throughput)
+        {
+            constexpr std::size_t producerCount = 8;
+            constexpr std::size_t batchesPerProducer = 100'000;
+            constexpr long long maxMs = 720;
+
+            Wmi::MpscBatchQueue<std::uint64_t> queue;
+            auto start = std::chrono::high_resolution_clock::now();
+            auto drained = RunStress(producerCount, batchesPerProducer,
+                [&](std::vector<std::uint64_t> batch) { queue.Push(std::move(batch)); },
+                [&](std::vector<std::uint64_t>& out) { return queue.Drain(out); });
+            auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start).count();
+
+            Assert::IsTrue(IsCompleteAndOrdered(drained, producerCount, batchesPerProducer));
+
+            auto stats = queue.Stats();
+            Assert::AreEqual<std::uint64_t>(producerCount * batchesPerProducer, stats.batches);
+            Assert::IsTrue(elapsedMs < maxMs);
+        }
+    };
+}
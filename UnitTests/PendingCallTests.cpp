@@ -0,0 +1,269 @@
+﻿#include "pch.h"
+#include "CppUnitTest.h"
+#include "../WinMgmt/Core/FanOut.h"
+#include "../WinMgmt/Core/PendingCall.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTests
+{
+    using namespace std::chrono_literals;
+
+    using ProviderObjects = std::vector<std::shared_ptr<int>>;
+
+    constexpr std::int32_t AccessDenied = static_cast<std::int32_t>(0x80041003);   // WBEM_E_ACCESS_DENIED
+
+    // Stands in for an ExecQueryAsync call: a provider thread indicates `objects`
+    // results into the pending call, then either completes with `status` or hangs
+    // until the caller cancels it, as winmgmt does on CancelAsyncCall.
+    struct FakeProviderCall
+    {
+        Wmi::PendingCall<ProviderObjects> call;
+        std::vector<std::weak_ptr<int>> indicated;
+        std::atomic<int> cancels{ 0 };
+        std::atomic<bool> lateIndicateRefused{ false };
+
+        FakeProviderCall(std::size_t objects, bool hangs, std::int32_t status = Wmi::CallStatus::Ok)
+        {
+            ProviderObjects batch;
+            for (std::size_t i = 0; i < objects; ++i)
+                batch.push_back(std::make_shared<int>(static_cast<int>(i)));
+            for (auto const& object : batch)
+                indicated.push_back(object);
+
+            call.OnCancel([this] {
+                ++cancels;
+                std::lock_guard lk(m_mutex);
+                m_stopped = true;
+                m_stop.notify_all();
+            });
+
+            m_provider = std::thread([this, batch = std::move(batch), hangs, status]() mutable {
+                call.Produce([&](ProviderObjects& buffer) { buffer = std::move(batch); });
+
+                if (!hangs)
+                {
+                    call.Complete(status);
+                    return;
+                }
+
+                {
+                    std::unique_lock lk(m_mutex);
+                    m_stop.wait(lk, [this] { return m_stopped; });
+                }
+
+                // After a cancellation winmgmt may still deliver, and reports the end of the call.
+                lateIndicateRefused = !call.Produce([](ProviderObjects& buffer) { buffer.push_back(std::make_shared<int>(-1)); });
+                call.Complete(Wmi::CallStatus::Cancelled);
+            });
+        }
+
+        ~FakeProviderCall()
+        {
+            call.Cancel();
+            JoinProvider();
+        }
+
+        void JoinProvider()
+        {
+            if (m_provider.joinable())
+                m_provider.join();
+        }
+
+        bool Released() const
+        {
+            for (auto const& object : indicated)
+            {
+                if (!object.expired())
+                    return false;
+            }
+            return true;
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::condition_variable m_stop;
+        bool m_stopped = false;
+        std::thread m_provider;
+    };
+
+    // A backend whose queries against `hungNamespace` never answer; every query is
+    // bounded by `deadline`, as WmiWbemBackend bounds its provider calls.
+    struct HangingBackend : Wmi::IQueryBackend
+    {
+        std::wstring hungNamespace;
+        std::chrono::milliseconds latency{ 5 };
+        std::chrono::milliseconds deadline{ 50 };
+
+        Wmi::ResultTablePtr Execute(std::wstring_view ns, std::wstring_view) override
+        {
+            const bool hangs = ns == hungNamespace;
+            if (!hangs)
+                std::this_thread::sleep_for(latency);
+
+            FakeProviderCall provider{ 4, hangs };
+            const auto status = provider.call.WaitFor(deadline);
+            if (status < 0)
+                throw std::runtime_error(status == Wmi::CallStatus::TimedOut ? "timed out" : "failed");
+
+            auto table = std::make_shared<Wmi::ResultTable>();
+            auto column = table->AddColumn(L"Value", Wmi::PropertyType::Int32);
+            for (auto const& object : provider.call.Take())
+            {
+                table->BeginRow();
+                table->AppendInteger(column, *object);
+                table->EndRow();
+            }
+            return table;
+        }
+    };
+
+    TEST_CLASS(PendingCallTests)
+    {
+    public:
+
+        // ---------------------------------------------------------------------
+        // Final_Status_Reaches_The_Caller
+        // - A successful call hands over everything the provider indicated
+        // - A failed call reports the provider's HRESULT instead of empty results
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Final_Status_Reaches_The_Caller)
+        {
+            FakeProviderCall succeeded{ 3, false };
+            Assert::AreEqual(Wmi::CallStatus::Ok, succeeded.call.Wait());
+            Assert::AreEqual<std::size_t>(3, succeeded.call.Take().size());
+            Assert::AreEqual(0, succeeded.cancels.load());
+
+            FakeProviderCall failed{ 3, false, AccessDenied };
+            Assert::AreEqual(AccessDenied, failed.call.Wait());
+            Assert::IsFalse(failed.call.IsCancelled());
+        }
+
+        // ---------------------------------------------------------------------
+        // Deadline_Cancels_A_Hung_Call
+        // - The waiter returns TimedOut shortly after the deadline
+        // - The provider call is cancelled once and buffered objects are freed
+        // - Later deliveries are refused and the late completion is ignored
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Deadline_Cancels_A_Hung_Call)
+        {
+            FakeProviderCall provider{ 100, true };
+
+            auto start = std::chrono::steady_clock::now();
+            auto status = provider.call.WaitFor(30ms);
+            auto elapsed = std::chrono::steady_clock::now() - start;
+
+            Assert::AreEqual(Wmi::CallStatus::TimedOut, status);
+            Assert::IsTrue(elapsed >= 30ms && elapsed < 500ms);
+            Assert::AreEqual(1, provider.cancels.load());
+            Assert::IsTrue(provider.Released());
+
+            provider.JoinProvider();
+            Assert::IsTrue(provider.lateIndicateRefused.load());
+            Assert::IsFalse(provider.call.Complete(Wmi::CallStatus::Ok));
+            Assert::AreEqual(Wmi::CallStatus::TimedOut, provider.call.Status());
+            Assert::IsTrue(provider.call.Take().empty());
+        }
+
+        // ---------------------------------------------------------------------
+        // Cancel_Releases_A_Blocked_Waiter
+        // - Cancel from another thread ends Wait with Cancelled
+        // - Cancelling twice runs the canceller once
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Cancel_Releases_A_Blocked_Waiter)
+        {
+            FakeProviderCall provider{ 10, true };
+
+            std::atomic<std::int32_t> seen{ Wmi::CallStatus::Ok };
+            std::thread waiter([&] { seen = provider.call.Wait(); });
+
+            std::this_thread::sleep_for(10ms);
+            Assert::IsTrue(provider.call.Cancel());
+            Assert::IsFalse(provider.call.Cancel(Wmi::CallStatus::TimedOut));
+            waiter.join();
+
+            Assert::AreEqual(Wmi::CallStatus::Cancelled, seen.load());
+            Assert::AreEqual(1, provider.cancels.load());
+            Assert::IsTrue(provider.Released());
+        }
+
+        // ---------------------------------------------------------------------
+        // Canceller_Follows_The_Call_State
+        // - A canceller attached after Cancel runs at once
+        // - A canceller attached to a completed call never runs
+        // - onFinished fires once, however the call ended
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Canceller_Follows_The_Call_State)
+        {
+            int finished = 0;
+            int cancelled = 0;
+
+            Wmi::PendingCall<ProviderObjects> early{ [&] { ++finished; } };
+            early.Cancel();
+            early.OnCancel([&] { ++cancelled; });
+            Assert::AreEqual(1, cancelled);
+
+            Wmi::PendingCall<ProviderObjects> done{ [&] { ++finished; } };
+            Assert::IsTrue(done.Produce([](ProviderObjects& buffer) { buffer.push_back(std::make_shared<int>(1)); }));
+            Assert::IsTrue(done.Complete(Wmi::CallStatus::Ok));
+            done.OnCancel([&] { ++cancelled; });
+            Assert::IsFalse(done.Cancel());
+
+            Assert::AreEqual(1, cancelled);
+            Assert::AreEqual(2, finished);
+            Assert::AreEqual<std::size_t>(1, done.Take().size());
+        }
+
+        // ---------------------------------------------------------------------
+        // Hung_Provider_Does_Not_Hold_Up_A_Fan_Out
+        // - 16 queries, 4 against a namespace whose provider never answers
+        // - The run ends just after the deadline; the hung queries fail with it
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Hung_Provider_Does_Not_Hold_Up_A_Fan_Out)
+        {
+            auto backend = std::make_shared<HangingBackend>();
+            backend->hungNamespace = L"ROOT\\WMI";
+
+            std::vector<Wmi::FanOutQuery> queries;
+            const wchar_t* namespaces[] = { L"ROOT\\CIMV2", L"ROOT\\StandardCimv2", L"ROOT\\WMI", L"ROOT\\Microsoft\\Windows\\Storage" };
+            for (int i = 0; i < 16; ++i)
+                queries.push_back({ namespaces[i % 4], L"SELECT * FROM Class" + std::to_wstring(i) });
+
+            Wmi::WorkStealingExecutor executor{ 16 };
+
+            auto start = std::chrono::steady_clock::now();
+            auto run = Wmi::FanOut::Start(executor, backend, std::move(queries), 16);
+
+            std::size_t succeeded = 0;
+            std::size_t failed = 0;
+            while (auto result = run->Next())
+            {
+                if (result->error)
+                {
+                    ++failed;
+                    Assert::IsTrue(run->Queries()[result->source].ns == L"ROOT\\WMI");
+                }
+                else
+                {
+                    ++succeeded;
+                    Assert::AreEqual<std::size_t>(4, result->table->RowCount());
+                }
+            }
+            auto elapsed = std::chrono::steady_clock::now() - start;
+
+            Assert::AreEqual<std::size_t>(12, succeeded);
+            Assert::AreEqual<std::size_t>(4, failed);
+            Assert::IsTrue(elapsed < 500ms);
+        }
+    };
+}
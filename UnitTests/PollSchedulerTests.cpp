@@ -0,0 +1,268 @@
+﻿#include "pch.h"
+#include "CppUnitTest.h"
+#include "../WinMgmt/Core/PollScheduler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTests
+{
+    using namespace std::chrono_literals;
+
+    // Manually advanced clock shared by the scheduler and the fake backend.
+    struct PollClock
+    {
+        std::shared_ptr<std::chrono::steady_clock::time_point> now = std::make_shared<std::chrono::steady_clock::time_point>();
+
+        Wmi::PollScheduler::time_source Source() const
+        {
+            return [now = now] { return *now; };
+        }
+    };
+
+    // Stands in for winmgmt: every dispatched run takes `latency` of virtual time.
+    // Tracks what ran when and how many runs overlapped per (case-insensitive) namespace.
+    struct FakePollBackend
+    {
+        PollClock clock;
+        std::chrono::milliseconds latency{ 0 };
+
+        std::vector<std::pair<std::chrono::steady_clock::time_point, std::uint64_t>> running;
+        std::vector<std::pair<std::uint64_t, std::chrono::steady_clock::time_point>> started;
+        std::map<std::wstring, std::size_t> inFlight;
+        std::map<std::wstring, std::size_t> peak;
+        std::map<std::uint64_t, std::wstring> namespaces;
+        std::set<std::uint64_t> active;
+        bool overlapped = false;
+
+        void Start(Wmi::PollRun const& run)
+        {
+            std::wstring ns;
+            for (auto c : run.ns)
+                ns.push_back(Wmi::Wql::ToUpperAscii(c));
+
+            overlapped = overlapped || !active.insert(run.id).second;
+            started.emplace_back(run.id, *clock.now);
+            running.emplace_back(*clock.now + latency, run.id);
+            namespaces[run.id] = ns;
+            peak[ns] = (std::max)(peak[ns], ++inFlight[ns]);
+        }
+
+        std::size_t Runs(std::uint64_t id) const
+        {
+            return static_cast<std::size_t>(std::count_if(started.begin(), started.end(), [&](auto const& start) { return start.first == id; }));
+        }
+
+        // Steps the clock to `duration` from now, completing finished runs and polling
+        // the scheduler once per step, as the timer-driven loop would.
+        void RunFor(Wmi::PollScheduler& scheduler, std::chrono::milliseconds duration, std::chrono::milliseconds step = 1ms)
+        {
+            const auto until = *clock.now + duration;
+            while (*clock.now < until)
+            {
+                *clock.now += step;
+
+                std::vector<std::uint64_t> done;
+                std::erase_if(running, [&](auto const& run) {
+                    if (run.first > *clock.now)
+                        return false;
+                    done.push_back(run.second);
+                    return true;
+                });
+                for (auto id : done)
+                {
+                    active.erase(id);
+                    --inFlight[namespaces[id]];
+                    scheduler.Complete(id);
+                }
+
+                scheduler.Poll();
+            }
+        }
+    };
+
+    static Wmi::PollScheduler MakeScheduler(FakePollBackend& backend, std::size_t maxConcurrentPerNamespace = 2)
+    {
+        Wmi::PollSchedulerOptions options;
+        options.resolution = 1ms;
+        options.wheelSlots = 64;
+        options.maxConcurrentPerNamespace = maxConcurrentPerNamespace;
+        options.seed = 7;
+        return Wmi::PollScheduler{ options, [&backend](Wmi::PollRun const& run) { backend.Start(run); }, backend.clock.Source() };
+    }
+
+    TEST_CLASS(PollSchedulerTests)
+    {
+    public:
+
+        // ---------------------------------------------------------------------
+        // Runs_Recur_At_Their_Interval
+        // - Queries with different intervals share one wheel and keep their cadence
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Runs_Recur_At_Their_Interval)
+        {
+            FakePollBackend backend;
+            auto scheduler = MakeScheduler(backend);
+
+            auto fast = scheduler.Register({ L"ROOT\\CIMV2", L"SELECT * FROM Win32_Process", 100ms });
+            auto slow = scheduler.Register({ L"ROOT\\CIMV2", L"SELECT * FROM Win32_Service", 250ms });
+            backend.RunFor(scheduler, 1000ms);
+
+            Assert::AreEqual<std::size_t>(11, backend.Runs(fast));
+            Assert::AreEqual<std::size_t>(5, backend.Runs(slow));
+
+            // Interval 100ms on a 1ms wheel: every run within one tick of its nominal time.
+            std::vector<std::chrono::steady_clock::time_point> times;
+            for (auto const& [id, at] : backend.started)
+                if (id == fast)
+                    times.push_back(at);
+            for (std::size_t i = 1; i < times.size(); ++i)
+                Assert::IsTrue(times[i] - times[i - 1] >= 99ms && times[i] - times[i - 1] <= 101ms);
+
+            Assert::ExpectException<std::invalid_argument>([&] { scheduler.Register({ L"ROOT\\CIMV2", L"SELECT * FROM Win32_Process", 0ms }); });
+        }
+
+        // ---------------------------------------------------------------------
+        // Jitter_Spreads_Queries_Sharing_An_Interval
+        // - Forty queries registered together do not all start on the same tick
+        // - No run starts earlier than its nominal time or later than nominal + jitter
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Jitter_Spreads_Queries_Sharing_An_Interval)
+        {
+            FakePollBackend backend;
+            auto scheduler = MakeScheduler(backend, 64);
+
+            const auto origin = *backend.clock.now;
+            for (int i = 0; i < 40; ++i)
+                scheduler.Register({ L"ROOT\\CIMV2", L"SELECT * FROM Win32_Process", 1000ms, 200ms });
+            backend.RunFor(scheduler, 3000ms);
+
+            std::set<std::chrono::steady_clock::time_point> firstTicks;
+            for (auto const& [id, at] : backend.started)
+            {
+                const auto offset = (at - origin) % 1000ms;
+                Assert::IsTrue(offset <= 201ms, L"A run started outside its jitter window.");
+                if (at - origin < 1000ms)
+                    firstTicks.insert(at);
+            }
+
+            Assert::IsTrue(firstTicks.size() > 20, L"Jitter did not spread the first runs.");
+            Assert::AreEqual<std::size_t>(40 * 3, backend.started.size());
+        }
+
+        // ---------------------------------------------------------------------
+        // Concurrency_Is_Capped_Per_Namespace
+        // - Ten slow queries in one namespace never run more than two at a time
+        // - Another namespace is not held back by the first one's queue
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Concurrency_Is_Capped_Per_Namespace)
+        {
+            FakePollBackend backend;
+            backend.latency = 50ms;
+            auto scheduler = MakeScheduler(backend, 2);
+
+            for (int i = 0; i < 10; ++i)
+                scheduler.Register({ L"ROOT\\CIMV2", L"SELECT * FROM Win32_Process", 1000ms });
+            auto wmi = scheduler.Register({ L"ROOT\\WMI", L"SELECT * FROM MSStorageDriver_FailurePredictStatus", 1000ms });
+            backend.RunFor(scheduler, 400ms);
+
+            Assert::AreEqual<std::size_t>(2, backend.peak[L"ROOT\\CIMV2"]);
+            Assert::AreEqual<std::size_t>(1, backend.Runs(wmi));
+            Assert::IsTrue(backend.started.front().second == backend.started.back().second - 200ms, L"Queued runs did not start as slots freed up.");
+            Assert::AreEqual<std::uint64_t>(11, scheduler.Stats().runs);
+            Assert::AreEqual<std::uint64_t>(8, scheduler.Stats().deferred);
+
+            // The cap is per namespace, whatever the spelling.
+            scheduler.Register({ L"root\\cimv2", L"SELECT * FROM Win32_Service", 1000ms });
+            backend.RunFor(scheduler, 1700ms);
+            Assert::AreEqual<std::size_t>(2, backend.peak[L"ROOT\\CIMV2"]);
+        }
+
+        // ---------------------------------------------------------------------
+        // Overlapping_Ticks_Are_Skipped_Or_Merged
+        // - A run slower than its interval never overlaps itself
+        // - Skip waits for the next tick; Merge reruns as soon as the run completes
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Overlapping_Ticks_Are_Skipped_Or_Merged)
+        {
+            FakePollBackend backend;
+            backend.latency = 150ms;
+            auto scheduler = MakeScheduler(backend, 8);
+
+            auto skip = scheduler.Register({ L"ROOT\\CIMV2", L"SELECT * FROM Win32_Process", 100ms, 0ms, Wmi::OverlapPolicy::Skip });
+            auto merge = scheduler.Register({ L"ROOT\\StandardCimv2", L"SELECT * FROM MSFT_NetAdapter", 100ms, 0ms, Wmi::OverlapPolicy::Merge });
+            backend.RunFor(scheduler, 1000ms);
+
+            Assert::IsFalse(backend.overlapped, L"A query overlapped its own previous run.");
+
+            // Skip: every other tick, at 0, 200, ... 1000. Merge: back to back every 150ms.
+            Assert::AreEqual<std::size_t>(6, backend.Runs(skip));
+            Assert::AreEqual<std::size_t>(7, backend.Runs(merge));
+
+            auto stats = scheduler.Stats();
+            Assert::AreEqual<std::uint64_t>(5, stats.skipped);
+            Assert::IsTrue(stats.merged >= 6);
+        }
+
+        // ---------------------------------------------------------------------
+        // Unregister_And_Clock_Jumps
+        // - An unregistered query stops; its in-flight run still frees the slot
+        // - A clock jump of an hour fires a query once, not once per missed tick
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Unregister_And_Clock_Jumps)
+        {
+            FakePollBackend backend;
+            backend.latency = 30ms;
+            auto scheduler = MakeScheduler(backend, 1);
+
+            auto first = scheduler.Register({ L"ROOT\\CIMV2", L"SELECT * FROM Win32_Process", 100ms });
+            backend.RunFor(scheduler, 10ms);
+            Assert::IsTrue(scheduler.Unregister(first));
+            Assert::IsFalse(scheduler.Unregister(first));
+
+            auto second = scheduler.Register({ L"ROOT\\CIMV2", L"SELECT * FROM Win32_Service", 100ms });
+            backend.RunFor(scheduler, 300ms);
+            Assert::AreEqual<std::size_t>(1, backend.Runs(first));
+            Assert::AreEqual<std::size_t>(4, backend.Runs(second));
+            Assert::IsTrue(backend.started[1].second - backend.started[0].second == 30ms, L"The unregistered run did not free its slot on completion.");
+            Assert::AreEqual<std::size_t>(1, scheduler.Stats().registrations);
+
+            const auto before = backend.Runs(second);
+            backend.RunFor(scheduler, 3600s, 3600s);
+            Assert::AreEqual(before + 1, backend.Runs(second));
+        }
+
+        // ---------------------------------------------------------------------
+        // PollScheduler_Ten_Thousand_Queries_Performance_Test
+        // - 10k registrations over a simulated minute cost little per poll
+        // ---------------------------------------------------------------------
+        TEST_METHOD(PollScheduler_Ten_Thousand_Queries_Performance_Test)
+        {
+            constexpr int queries = 10'000;
+            constexpr long long maxMs = 1000;
+
+            FakePollBackend backend;
+            backend.latency = 5ms;
+            auto scheduler = MakeScheduler(backend, 64);
+
+            for (int i = 0; i < queries; ++i)
+                scheduler.Register({ L"ROOT\\NS" + std::to_wstring(i % 16), L"SELECT * FROM Win32_Process", std::chrono::milliseconds(1000 + (i % 10) * 1000), 500ms });
+
+            auto start = std::chrono::high_resolution_clock::now();
+            backend.RunFor(scheduler, 60s, 10ms);
+            auto elapsed = std::chrono::high_resolution_clock::now() - start;
+
+            auto stats = scheduler.Stats();
+            Assert::IsTrue(stats.runs > 150'000, L"Queries did not run at their intervals.");
+            Assert::IsTrue(stats.peakInFlight <= 16 * 64);
+            Assert::IsTrue(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() < maxMs, L"Polling the wheel is too slow.");
+        }
+    };
+}
@@ -0,0 +1,226 @@
+﻿#include "pch.h"
+#include "CppUnitTest.h"
+#include "../WinMgmt/Core/Predicate.h"
+
+#include <chrono>
+#include <string>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTests
+{
+    // Win32_Process-like rows; every seventh WorkingSetSize is null and names cycle
+    // through a few service host spellings.
+    static Wmi::ResultTable MakeFilterTable(std::size_t rows)
+    {
+        static const wchar_t* names[] = { L"svchost.exe", L"SvcHost.exe", L"explorer.exe", L"services.exe", L"System" };
+
+        Wmi::ResultTable table;
+        auto name = table.AddColumn(L"Name", Wmi::PropertyType::String);
+        auto pid = table.AddColumn(L"ProcessId", Wmi::PropertyType::UInt32);
+        auto ws = table.AddColumn(L"WorkingSetSize", Wmi::PropertyType::UInt64);
+        auto cpu = table.AddColumn(L"PercentProcessorTime", Wmi::PropertyType::Double);
+        auto crit = table.AddColumn(L"Critical", Wmi::PropertyType::Boolean);
+        table.Reserve(rows);
+
+        for (std::size_t i = 0; i < rows; ++i)
+        {
+            table.BeginRow();
+            table.AppendString(name, names[i % 5]);
+            table.AppendInteger(pid, static_cast<std::int64_t>(i));
+            if (i % 7 != 0)
+                table.AppendInteger(ws, static_cast<std::int64_t>(i * 4096));
+            table.AppendReal(cpu, static_cast<double>(i % 100));
+            table.AppendBoolean(crit, i % 2 == 0);
+            table.EndRow();
+        }
+        return table;
+    }
+
+    static std::size_t CountWhere(Wmi::ResultTable const& table, std::wstring_view condition)
+    {
+        return Wmi::Predicate::Compile(condition).Evaluate(table).Count();
+    }
+
+    TEST_CLASS(PredicateTests)
+    {
+    public:
+
+        // ---------------------------------------------------------------------
+        // Numeric_Comparisons_Skip_Nulls
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Numeric_Comparisons_Skip_Nulls)
+        {
+            auto table = MakeFilterTable(100);
+
+            Assert::AreEqual<std::size_t>(10, CountWhere(table, L"ProcessId < 10"));
+            Assert::AreEqual<std::size_t>(1, CountWhere(table, L"ProcessId = 42"));
+            Assert::AreEqual<std::size_t>(99, CountWhere(table, L"42 <> ProcessId"));
+
+            // Rows 0, 7, ..., 98 have no WorkingSetSize: 15 nulls.
+            Assert::AreEqual<std::size_t>(85, CountWhere(table, L"WorkingSetSize >= 0"));
+            Assert::AreEqual<std::size_t>(15, CountWhere(table, L"WorkingSetSize IS NULL"));
+            Assert::AreEqual<std::size_t>(15, CountWhere(table, L"WorkingSetSize = NULL"));
+            Assert::AreEqual<std::size_t>(85, CountWhere(table, L"WorkingSetSize IS NOT NULL"));
+
+            Assert::AreEqual<std::size_t>(50, CountWhere(table, L"PercentProcessorTime >= 50"));
+            Assert::AreEqual<std::size_t>(49, CountWhere(table, L"PercentProcessorTime > 50.5"));
+            Assert::AreEqual<std::size_t>(3, CountWhere(table, L"ProcessId > 96.5"));
+            Assert::AreEqual<std::size_t>(50, CountWhere(table, L"Critical = TRUE"));
+        }
+
+        // ---------------------------------------------------------------------
+        // UInt64_Compares_Unsigned
+        // - Values above INT64_MAX and quoted uint64 literals (as WMI writes them)
+        // ---------------------------------------------------------------------
+        TEST_METHOD(UInt64_Compares_Unsigned)
+        {
+            Wmi::ResultTable table;
+            auto size = table.AddColumn(L"Size", Wmi::PropertyType::UInt64);
+            for (auto value : { 1ull, 9'223'372'036'854'775'808ull, 18'446'744'073'709'551'615ull })
+            {
+                table.BeginRow();
+                table.AppendInteger(size, static_cast<std::int64_t>(value));
+                table.EndRow();
+            }
+
+            Assert::AreEqual<std::size_t>(2, CountWhere(table, L"Size > 100"));
+            Assert::AreEqual<std::size_t>(1, CountWhere(table, L"Size = '18446744073709551615'"));
+            Assert::AreEqual<std::size_t>(3, CountWhere(table, L"Size > -1"));
+            Assert::AreEqual<std::size_t>(0, CountWhere(table, L"Size < -1"));
+        }
+
+        // ---------------------------------------------------------------------
+        // Strings_Compare_Case_Insensitively
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Strings_Compare_Case_Insensitively)
+        {
+            auto table = MakeFilterTable(100);
+
+            Assert::AreEqual<std::size_t>(40, CountWhere(table, L"Name = 'SVCHOST.EXE'"));
+            Assert::AreEqual<std::size_t>(60, CountWhere(table, L"Name <> 'svchost.exe'"));
+            Assert::AreEqual<std::size_t>(40, CountWhere(table, L"Name LIKE 'svc%'"));
+            Assert::AreEqual<std::size_t>(60, CountWhere(table, L"Name LIKE '%.exe' AND Name LIKE '[s]%'"));
+            Assert::AreEqual<std::size_t>(20, CountWhere(table, L"Name LIKE 'S_stem'"));
+            Assert::AreEqual<std::size_t>(20, CountWhere(table, L"Name LIKE '[^s]%'"));
+            Assert::AreEqual<std::size_t>(40, CountWhere(table, L"Name LIKE '[a-f]%' OR Name LIKE '%tem'"));
+            Assert::AreEqual<std::size_t>(20, CountWhere(table, L"Name < 'f'"));
+        }
+
+        // ---------------------------------------------------------------------
+        // Logical_Operators_Combine_Bitmaps
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Logical_Operators_Combine_Bitmaps)
+        {
+            auto table = MakeFilterTable(130);
+
+            Assert::AreEqual<std::size_t>(5, CountWhere(table, L"ProcessId < 10 AND Critical = TRUE"));
+            Assert::AreEqual<std::size_t>(70, CountWhere(table, L"ProcessId < 10 OR Critical = TRUE"));
+            Assert::AreEqual<std::size_t>(120, CountWhere(table, L"NOT ProcessId < 10"));
+            Assert::AreEqual<std::size_t>(130, CountWhere(table, L"NOT (ProcessId < 10 AND ProcessId >= 10)"));
+
+            auto selected = Wmi::Predicate::Compile(L"SELECT Name FROM Win32_Process WHERE ProcessId >= 128").Evaluate(table);
+            Assert::AreEqual<std::size_t>(130, selected.Size());
+            Assert::IsTrue(selected.Indices() == std::vector<std::size_t>{ 128, 129 });
+        }
+
+        // ---------------------------------------------------------------------
+        // Missing_Property_Behaves_As_Null
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Missing_Property_Behaves_As_Null)
+        {
+            auto table = MakeFilterTable(10);
+
+            Assert::AreEqual<std::size_t>(0, CountWhere(table, L"Missing = 1"));
+            Assert::AreEqual<std::size_t>(10, CountWhere(table, L"Missing IS NULL"));
+            Assert::AreEqual<std::size_t>(10, CountWhere(table, L"processid >= 0"));
+        }
+
+        // ---------------------------------------------------------------------
+        // DateTime_Compares_Against_Cim_Literal
+        // ---------------------------------------------------------------------
+        TEST_METHOD(DateTime_Compares_Against_Cim_Literal)
+        {
+            Wmi::ResultTable table;
+            auto installed = table.AddColumn(L"InstallDate", Wmi::PropertyType::DateTime);
+            for (auto text : { L"20200101000000.000000+000", L"20240615120000.000000+060" })
+            {
+                table.BeginRow();
+                table.AppendInteger(installed, Wmi::ParseCimDateTime(text)->microseconds);
+                table.EndRow();
+            }
+
+            Assert::AreEqual<std::size_t>(1, CountWhere(table, L"InstallDate > '20230101000000.000000+000'"));
+            Assert::AreEqual<std::size_t>(1, CountWhere(table, L"InstallDate = '20240615110000.000000+000'"));
+        }
+
+        // ---------------------------------------------------------------------
+        // Property_To_Property_Comparisons
+        // - Two columns compare row by row, numbers across storage kinds,
+        //   strings against strings; nulls and mismatched kinds never match
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Property_To_Property_Comparisons)
+        {
+            auto table = MakeFilterTable(200);
+
+            Assert::AreEqual<std::size_t>(100, CountWhere(table, L"ProcessId = PercentProcessorTime"));
+            Assert::AreEqual<std::size_t>(100, CountWhere(table, L"ProcessId > PercentProcessorTime"));
+            Assert::AreEqual<std::size_t>(171, CountWhere(table, L"WorkingSetSize > ProcessId"));
+            Assert::AreEqual<std::size_t>(200, CountWhere(table, L"Name = Name"));
+            Assert::AreEqual<std::size_t>(0, CountWhere(table, L"Name <> ProcessId"));
+            Assert::AreEqual<std::size_t>(0, CountWhere(table, L"Name = Missing"));
+        }
+
+        // ---------------------------------------------------------------------
+        // Unsupported_Conditions_Throw
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Unsupported_Conditions_Throw)
+        {
+            Assert::ExpectException<std::invalid_argument>([] { (void)Wmi::Predicate::Compile(L"TargetInstance ISA 'Win32_Process'"); });
+            Assert::ExpectException<std::invalid_argument>([] { (void)Wmi::Predicate::Compile(L"Name = "); });
+            Assert::IsTrue(Wmi::Predicate::Compile(L"SELECT * FROM Win32_Process").SelectsAll());
+        }
+
+        // ---------------------------------------------------------------------
+        // Predicate_Million_Row_Performance_Test
+        // - A numeric compare over 1M rows must beat boxed per-row evaluation
+        //   and stay within a few milliseconds
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Predicate_Million_Row_Performance_Test)
+        {
+            constexpr std::size_t rows = 1'000'000;
+            constexpr int passes = 10;
+            constexpr long long maxMs = 100;
+
+            auto table = MakeFilterTable(rows);
+            auto predicate = Wmi::Predicate::Compile(L"WorkingSetSize > 2000000000 AND PercentProcessorTime >= 50");
+
+            auto start = std::chrono::high_resolution_clock::now();
+            std::size_t vectorized = 0;
+            for (int pass = 0; pass < passes; ++pass)
+                vectorized += predicate.Evaluate(table).Count();
+            auto end = std::chrono::high_resolution_clock::now();
+            auto vectorizedTime = end - start;
+
+            auto const& ws = table.GetColumn(*table.Find(L"WorkingSetSize"));
+            auto const& cpu = table.GetColumn(*table.Find(L"PercentProcessorTime"));
+            start = std::chrono::high_resolution_clock::now();
+            std::size_t boxed = 0;
+            for (int pass = 0; pass < passes; ++pass)
+            {
+                for (std::size_t row = 0; row < rows; ++row)
+                {
+                    auto size = ws.GetValue(row);
+                    auto load = cpu.GetValue(row);
+                    if (!size.IsNull() && size.AsUInt64() > 2'000'000'000 && !load.IsNull() && load.AsDouble() >= 50)
+                        ++boxed;
+                }
+            }
+            auto boxedTime = std::chrono::high_resolution_clock::now() - start;
+
+            Assert::AreEqual(boxed, vectorized);
+            Assert::IsTrue(vectorizedTime < boxedTime, L"Column passes are slower than boxed evaluation.");
+            Assert::IsTrue(std::chrono::duration_cast<std::chrono::milliseconds>(vectorizedTime).count() < maxMs, L"Predicate evaluation is too slow.");
+        }
+    };
+}
@@ -0,0 +1,190 @@
+﻿#include "pch.h"
+#include "CppUnitTest.h"
+#include "../WinMgmt/Core/Projection.h"
+#include "../WinMgmt/Core/QueryBackend.h"
+#include "../WinMgmt/Core/WqlParser.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTests
+{
+    // Stands in for a provider: holds one wide class and honours the select list,
+    // counting every cell it hands back (and that a sink would have to convert).
+    struct ProjectingBackend : Wmi::IQueryBackend
+    {
+        static constexpr std::size_t columns = 40;
+        static constexpr std::size_t rows = 500;
+
+        std::size_t cellsTransferred = 0;
+        std::vector<std::wstring> executed;
+
+        Wmi::ResultTablePtr Execute(std::wstring_view, std::wstring_view query) override
+        {
+            executed.emplace_back(query);
+            auto parsed = Wmi::Wql::Parse(query);
+            if (!parsed)
+                throw std::invalid_argument("invalid query");
+
+            std::vector<std::wstring> selected;
+            for (std::size_t c = 0; c < columns; ++c)
+            {
+                auto name = ColumnName(c);
+                if (parsed.query.selectAll || std::any_of(parsed.query.properties.begin(), parsed.query.properties.end(), [&](auto p) { return Wmi::Wql::EqualsIgnoreCase(p, name); }))
+                    selected.push_back(name);
+            }
+
+            auto table = std::make_shared<Wmi::ResultTable>();
+            for (auto const& name : selected)
+                table->AddColumn(name, Wmi::PropertyType::UInt32);
+
+            for (std::size_t row = 0; row < rows; ++row)
+            {
+                table->BeginRow();
+                for (std::size_t c = 0; c < selected.size(); ++c)
+                    table->AppendInteger(c, static_cast<std::int64_t>(row));
+                table->EndRow();
+            }
+
+            cellsTransferred += rows * selected.size();
+            return table;
+        }
+
+        static std::wstring ColumnName(std::size_t index)
+        {
+            return index == 0 ? L"Name" : index == 1 ? L"ProcessId" : L"Property" + std::to_wstring(index);
+        }
+    };
+
+    // Mirrors what WmiDataContext does around one execution; the consumer reads
+    // the given properties of every row, the way a view binding would.
+    static std::size_t RunAndRead(Wmi::ProjectionAdvisor& advisor, ProjectingBackend& backend, std::wstring const& query, std::vector<std::wstring> const& reads)
+    {
+        auto parsed = Wmi::Wql::Parse(query);
+        auto prepared = advisor.Prepare(L"ROOT\\CIMV2\n" + query, query, parsed.query);
+        auto table = backend.Execute(L"ROOT\\CIMV2", prepared.text);
+
+        std::size_t found = 0;
+        for (std::size_t row = 0; row < table->RowCount(); ++row)
+        {
+            for (auto const& name : reads)
+            {
+                auto column = table->Find(name);
+                if (prepared.recorder)
+                    prepared.recorder->Read(name, column.has_value());
+                found += column.has_value();
+            }
+        }
+        return found;
+    }
+
+    TEST_CLASS(ProjectionTests)
+    {
+    public:
+
+        // ---------------------------------------------------------------------
+        // SelectAll_Is_Rewritten_In_Place
+        // ---------------------------------------------------------------------
+        TEST_METHOD(SelectAll_Is_Rewritten_In_Place)
+        {
+            std::vector<std::wstring> properties{ L"Name", L"ProcessId" };
+
+            auto rewritten = Wmi::ProjectSelectAll(L"select *  FROM Win32_Process WHERE Name LIKE 'a*%'", properties);
+            Assert::IsTrue(rewritten.has_value());
+            Assert::AreEqual(std::wstring{ L"select Name, ProcessId  FROM Win32_Process WHERE Name LIKE 'a*%'" }, *rewritten);
+
+            Assert::IsFalse(Wmi::ProjectSelectAll(L"SELECT Name FROM Win32_Process", properties).has_value());
+            Assert::IsFalse(Wmi::ProjectSelectAll(L"SELECT * FROM Win32_Process", {}).has_value());
+            Assert::IsFalse(Wmi::ProjectSelectAll(L"ASSOCIATORS OF {Win32_Service.Name='x'}", properties).has_value());
+        }
+
+        // ---------------------------------------------------------------------
+        // Warm_Up_Then_Only_Read_Columns_Are_Transferred
+        // - The first run is SELECT *; later runs move 2 of 40 columns
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Warm_Up_Then_Only_Read_Columns_Are_Transferred)
+        {
+            const std::wstring query = L"SELECT * FROM Win32_Process";
+            Wmi::ProjectionAdvisor advisor;
+            ProjectingBackend backend;
+
+            RunAndRead(advisor, backend, query, { L"Name", L"ProcessId" });
+            const auto fullCells = backend.cellsTransferred;
+            Assert::AreEqual(ProjectingBackend::rows * ProjectingBackend::columns, fullCells);
+
+            auto found = RunAndRead(advisor, backend, query, { L"Name", L"ProcessId" });
+            const auto projectedCells = backend.cellsTransferred - fullCells;
+
+            Assert::AreEqual(ProjectingBackend::rows * 2, found);
+            Assert::AreEqual(ProjectingBackend::rows * 2, projectedCells);
+            Assert::AreEqual(std::wstring{ L"SELECT Name, ProcessId FROM Win32_Process" }, backend.executed.back());
+            Assert::AreEqual<std::uint64_t>(1, advisor.Stats().projected);
+        }
+
+        // ---------------------------------------------------------------------
+        // Late_Read_Widens_Next_Projection
+        // - A property missing from a projected result is added on the next run
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Late_Read_Widens_Next_Projection)
+        {
+            const std::wstring query = L"SELECT * FROM Win32_Process";
+            Wmi::ProjectionAdvisor advisor;
+            ProjectingBackend backend;
+
+            RunAndRead(advisor, backend, query, { L"Name" });
+            RunAndRead(advisor, backend, query, { L"Name", L"Property7" });
+            Assert::AreEqual(std::wstring{ L"SELECT Name FROM Win32_Process" }, backend.executed.back());
+
+            auto found = RunAndRead(advisor, backend, query, { L"Name", L"Property7" });
+            Assert::AreEqual(ProjectingBackend::rows * 2, found);
+            Assert::AreEqual(std::wstring{ L"SELECT Name, Property7 FROM Win32_Process" }, backend.executed.back());
+        }
+
+        // ---------------------------------------------------------------------
+        // Unknown_Property_On_Full_Result_Is_Not_Selected
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Unknown_Property_On_Full_Result_Is_Not_Selected)
+        {
+            const std::wstring query = L"SELECT * FROM Win32_Process";
+            Wmi::ProjectionAdvisor advisor;
+            ProjectingBackend backend;
+
+            RunAndRead(advisor, backend, query, { L"Name", L"NoSuchProperty" });
+            RunAndRead(advisor, backend, query, { L"Name" });
+            Assert::AreEqual(std::wstring{ L"SELECT Name FROM Win32_Process" }, backend.executed.back());
+        }
+
+        // ---------------------------------------------------------------------
+        // Overrides_Win_Over_Recorded_Reads
+        // - Enumerating every property, Disable and Pin each keep or force the shape
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Overrides_Win_Over_Recorded_Reads)
+        {
+            const std::wstring query = L"SELECT * FROM Win32_Process";
+            const std::wstring key = L"ROOT\\CIMV2\n" + query;
+            auto parsed = Wmi::Wql::Parse(query);
+
+            Wmi::ProjectionAdvisor advisor;
+            auto first = advisor.Prepare(key, query, parsed.query);
+            first.recorder->Read(L"Name", true);
+            first.recorder->ReadAll();
+            Assert::AreEqual(query, advisor.Prepare(key, query, parsed.query).text);
+
+            advisor.Reset(key);
+            advisor.Prepare(key, query, parsed.query).recorder->Read(L"Name", true);
+            advisor.Disable(key);
+            Assert::AreEqual(query, advisor.Prepare(key, query, parsed.query).text);
+
+            advisor.Pin(key, { L"Handle", L"Name" });
+            auto pinned = advisor.Prepare(key, query, parsed.query);
+            Assert::AreEqual(std::wstring{ L"SELECT Handle, Name FROM Win32_Process" }, pinned.text);
+            Assert::IsTrue(pinned.recorder == nullptr);
+
+            advisor.Reset(key);
+            Assert::AreEqual(query, advisor.Prepare(key, query, parsed.query).text);
+        }
+    };
+}
@@ -0,0 +1,208 @@
+﻿#include "pch.h"
+#include "CppUnitTest.h"
+#include "../WinMgmt/Core/PropertyCache.h"
+#include "../WinMgmt/Core/WmiValue.h"
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTests
+{
+    // A converted property: the value, plus whatever keeps its string storage alive
+    // (for a live object, the VARIANT holding the BSTR).
+    struct FakeProperty
+    {
+        Wmi::Value value;
+        std::shared_ptr<const std::wstring> owner;
+    };
+
+    // Object whose properties are fetched one by one, like IWbemClassObject::Get. Each
+    // Fetch hands out freshly allocated string storage and is counted.
+    class FakeObjectSource
+    {
+    public:
+        FakeObjectSource()
+        {
+            m_strings[L"Name"] = L"explorer.exe";
+            m_strings[L"CommandLine"] = L"C:\\Windows\\explorer.exe /factory";
+            m_numbers[L"ProcessId"] = 4242;
+            m_numbers[L"ThreadCount"] = 87;
+        }
+
+        FakeProperty Fetch(std::wstring const& name) const
+        {
+            m_fetches.fetch_add(1, std::memory_order_relaxed);
+
+            if (auto it = m_strings.find(name); it != m_strings.end())
+            {
+                auto owner = std::make_shared<const std::wstring>(it->second);
+                return { Wmi::Value::FromString(*owner), owner };
+            }
+            if (auto it = m_numbers.find(name); it != m_numbers.end())
+                return { Wmi::Value::FromInt64(it->second, Wmi::PropertyType::UInt32), nullptr };
+
+            throw std::out_of_range("property not found");
+        }
+
+        // Reads through cache the way WmiClassObject::GetProperty does.
+        FakeProperty Read(Wmi::PropertyCache<FakeProperty>& cache, std::wstring const& name) const
+        {
+            return cache.Get(name, [&] { return Fetch(name); });
+        }
+
+        std::size_t Fetches() const noexcept { return m_fetches.load(); }
+
+    private:
+        std::map<std::wstring, std::wstring> m_strings;
+        std::map<std::wstring, std::int64_t> m_numbers;
+        mutable std::atomic<std::size_t> m_fetches{ 0 };
+    };
+
+    TEST_CLASS(PropertyCacheTests)
+    {
+    public:
+        // ---------------------------------------------------------------
+        // PropertyCache_Converts_Each_Property_Once_Test
+        // - Reads two properties 100 times each, as re-rendering bindings would
+        // - Expects two fetches and conversions, every other read a cache hit
+        // ---------------------------------------------------------------
+        TEST_METHOD(PropertyCache_Converts_Each_Property_Once_Test)
+        {
+            FakeObjectSource source;
+            Wmi::PropertyCache<FakeProperty> cache;
+
+            for (int i = 0; i < 100; ++i)
+            {
+                Assert::AreEqual(L"explorer.exe", std::wstring{ source.Read(cache, L"Name").value.AsString() }.c_str());
+                Assert::AreEqual<std::int64_t>(4242, source.Read(cache, L"ProcessId").value.AsInt64());
+            }
+
+            Assert::AreEqual<std::size_t>(2, source.Fetches());
+            Assert::AreEqual<std::size_t>(2, cache.Size());
+            Assert::AreEqual<std::uint64_t>(2, cache.Stats().conversions);
+            Assert::AreEqual<std::uint64_t>(198, cache.Stats().hits);
+        }
+
+        // ---------------------------------------------------------------
+        // PropertyCache_Strings_Stay_Views_Over_Fetched_Storage_Test
+        // - Reads a string property repeatedly
+        // - Expects every read to view the same characters the first fetch
+        //   produced, with no copy made per read
+        // ---------------------------------------------------------------
+        TEST_METHOD(PropertyCache_Strings_Stay_Views_Over_Fetched_Storage_Test)
+        {
+            FakeObjectSource source;
+            Wmi::PropertyCache<FakeProperty> cache;
+
+            auto first = source.Read(cache, L"CommandLine");
+            Assert::IsTrue(first.value.AsString().data() == first.owner->data());
+
+            for (int i = 0; i < 10; ++i)
+            {
+                auto again = source.Read(cache, L"CommandLine");
+                Assert::IsTrue(again.value.AsString().data() == first.owner->data());
+                Assert::IsTrue(again.owner == first.owner);
+            }
+            Assert::AreEqual<std::uint64_t>(1, cache.Stats().conversions);
+        }
+
+        // ---------------------------------------------------------------
+        // PropertyCache_Names_Ignore_Case_Test
+        // - Reads one property as "Name", "name" and "NAME"
+        // - Expects one fetch, as IWbemClassObject::Get resolves all three
+        //   to the same property
+        // ---------------------------------------------------------------
+        TEST_METHOD(PropertyCache_Names_Ignore_Case_Test)
+        {
+            FakeObjectSource source;
+            Wmi::PropertyCache<FakeProperty> cache;
+
+            auto first = source.Read(cache, L"Name");
+            Assert::IsTrue(cache.Get(L"name", [] { return FakeProperty{}; }).owner == first.owner);
+            Assert::IsTrue(cache.Get(L"NAME", [] { return FakeProperty{}; }).owner == first.owner);
+
+            Assert::AreEqual<std::size_t>(1, source.Fetches());
+            Assert::AreEqual<std::size_t>(1, cache.Size());
+        }
+
+        // ---------------------------------------------------------------
+        // PropertyCache_Does_Not_Cache_Failures_Test
+        // - Reads a property the object does not have, twice
+        // - Expects both reads to throw and fetch, and nothing cached
+        // ---------------------------------------------------------------
+        TEST_METHOD(PropertyCache_Does_Not_Cache_Failures_Test)
+        {
+            FakeObjectSource source;
+            Wmi::PropertyCache<FakeProperty> cache;
+
+            Assert::ExpectException<std::out_of_range>([&] { (void)source.Read(cache, L"Missing"); });
+            Assert::ExpectException<std::out_of_range>([&] { (void)source.Read(cache, L"Missing"); });
+
+            Assert::AreEqual<std::size_t>(2, source.Fetches());
+            Assert::AreEqual<std::size_t>(0, cache.Size());
+            Assert::AreEqual<std::uint64_t>(0, cache.Stats().conversions);
+        }
+
+        // ---------------------------------------------------------------
+        // PropertyCache_Concurrent_Readers_Convert_Once_Test
+        // - 8 threads read the same four properties 1000 times each
+        // - Expects exactly one conversion per property
+        // ---------------------------------------------------------------
+        TEST_METHOD(PropertyCache_Concurrent_Readers_Convert_Once_Test)
+        {
+            FakeObjectSource source;
+            Wmi::PropertyCache<FakeProperty> cache;
+            const std::vector<std::wstring> names{ L"Name", L"CommandLine", L"ProcessId", L"ThreadCount" };
+
+            std::vector<std::thread> readers;
+            for (int t = 0; t < 8; ++t)
+                readers.emplace_back([&] {
+                    for (int i = 0; i < 1000; ++i)
+                        (void)source.Read(cache, names[i % names.size()]);
+                });
+            for (auto& reader : readers)
+                reader.join();
+
+            Assert::AreEqual<std::size_t>(4, source.Fetches());
+            Assert::AreEqual<std::uint64_t>(4, cache.Stats().conversions);
+            Assert::AreEqual<std::uint64_t>(8 * 1000 - 4, cache.Stats().hits);
+        }
+
+        // ---------------------------------------------------------------
+        // PropertyCache_Repeated_Reads_Match_Fetching_Every_Time_Test
+        // - 100k reads spread over four properties, with and without the cache
+        // - Expects the same values either way, with one fetch per property
+        //   through the cache
+        // ---------------------------------------------------------------
+        TEST_METHOD(PropertyCache_Repeated_Reads_Match_Fetching_Every_Time_Test)
+        {
+            constexpr int reads = 100000;
+
+            FakeObjectSource uncached;
+            const std::vector<std::wstring> names{ L"Name", L"CommandLine", L"ProcessId", L"ThreadCount" };
+
+            std::size_t uncachedLength = 0;
+            for (int i = 0; i < reads; ++i)
+                uncachedLength += uncached.Fetch(names[i % names.size()]).value.AsString().size();
+
+            FakeObjectSource source;
+            Wmi::PropertyCache<FakeProperty> cache;
+            std::size_t cachedLength = 0;
+            for (int i = 0; i < reads; ++i)
+                cachedLength += source.Read(cache, names[i % names.size()]).value.AsString().size();
+
+            Assert::AreEqual(uncachedLength, cachedLength);
+            Assert::AreEqual<std::size_t>(reads, uncached.Fetches());
+            Assert::AreEqual<std::size_t>(names.size(), source.Fetches());
+            Assert::AreEqual<std::uint64_t>(names.size(), cache.Stats().conversions);
+            Assert::AreEqual<std::uint64_t>(reads - names.size(), cache.Stats().hits);
+        }
+    };
+}
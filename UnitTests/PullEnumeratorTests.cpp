@@ -0,0 +1,189 @@
+﻿#include "pch.h"
+#include "CppUnitTest.h"
+#include "../WinMgmt/Core/PullEnumerator.h"
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTests
+{
+    // Stands in for IEnumWbemClassObject: hands out `total` objects, charging a fixed
+    // round-trip cost per Next call plus a small cost per object.
+    struct FakeEnumSource
+    {
+        std::uint32_t total = 0;
+        std::uint32_t produced = 0;
+        std::chrono::nanoseconds callCost{ 0 };
+        std::chrono::nanoseconds objectCost{ 0 };
+        std::int32_t failAfter = -1;
+        std::shared_ptr<int> live = std::make_shared<int>(0);
+
+        std::int32_t Next(std::uint32_t count, std::shared_ptr<int>* out, std::uint32_t& returned)
+        {
+            spin(callCost + objectCost * count);
+
+            if (failAfter >= 0 && produced >= static_cast<std::uint32_t>(failAfter))
+            {
+                returned = 0;
+                return static_cast<std::int32_t>(0x80041001); // WBEM_E_FAILED
+            }
+
+            returned = (std::min)(count, total - produced);
+            for (std::uint32_t i = 0; i < returned; ++i)
+                out[i] = live;
+            produced += returned;
+            return returned == count ? Wmi::PullStatus::Ok : Wmi::PullStatus::False;
+        }
+
+        static void spin(std::chrono::nanoseconds duration)
+        {
+            const auto until = std::chrono::steady_clock::now() + duration;
+            while (std::chrono::steady_clock::now() < until)
+            {
+            }
+        }
+    };
+
+    using FakePullEnumerator = Wmi::PullEnumerator<std::shared_ptr<int>, FakeEnumSource>;
+
+    TEST_CLASS(PullEnumeratorTests)
+    {
+    public:
+
+        // ---------------------------------------------------------------------
+        // Fixed_Batches_Cover_Every_Object
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Fixed_Batches_Cover_Every_Object)
+        {
+            FakePullEnumerator enumerator{ FakeEnumSource{ .total = 1000 }, Wmi::BatchPolicy{ 64 } };
+
+            std::size_t items = 0;
+            std::size_t batches = 0;
+            for (auto batch = enumerator.NextBatch(); !batch.empty(); batch = enumerator.NextBatch())
+            {
+                Assert::IsTrue(batch.size() <= 64);
+                items += batch.size();
+                ++batches;
+            }
+
+            Assert::AreEqual<std::size_t>(1000, items);
+            Assert::AreEqual<std::size_t>(16, batches);
+            Assert::IsTrue(enumerator.IsCompleted());
+            Assert::AreEqual(Wmi::PullStatus::Ok, enumerator.Status());
+        }
+
+        // ---------------------------------------------------------------------
+        // Previous_Batch_Is_Released
+        // - Only the current batch holds references, whatever the result size
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Previous_Batch_Is_Released)
+        {
+            FakePullEnumerator enumerator{ FakeEnumSource{ .total = 10'000 }, Wmi::BatchPolicy{ 100 } };
+            auto const& live = enumerator.GetSource().live;
+
+            long peak = 0;
+            for (auto batch = enumerator.NextBatch(); !batch.empty(); batch = enumerator.NextBatch())
+                peak = (std::max)(peak, live.use_count() - 1);
+
+            Assert::AreEqual(100L, peak);
+            Assert::AreEqual(1L, live.use_count());
+        }
+
+        // ---------------------------------------------------------------------
+        // Range_For_Pulls_On_Demand
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Range_For_Pulls_On_Demand)
+        {
+            FakePullEnumerator enumerator{ FakeEnumSource{ .total = 300 }, Wmi::BatchPolicy{ 128 } };
+
+            std::size_t items = 0;
+            for (auto& item : enumerator)
+            {
+                Assert::IsTrue(item != nullptr);
+                if (++items == 10)
+                    break;
+            }
+
+            Assert::AreEqual<std::size_t>(10, items);
+            Assert::AreEqual<std::uint64_t>(1, enumerator.Stats().pulls);
+
+            // Breaking does not advance, so the item the loop stopped on comes again.
+            for ([[maybe_unused]] auto& item : enumerator)
+                ++items;
+            Assert::AreEqual<std::size_t>(301, items);
+        }
+
+        // ---------------------------------------------------------------------
+        // Source_Failure_Ends_With_Status
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Source_Failure_Ends_With_Status)
+        {
+            FakePullEnumerator enumerator{ FakeEnumSource{ .total = 1000, .failAfter = 200 }, Wmi::BatchPolicy{ 100 } };
+
+            std::size_t items = 0;
+            for ([[maybe_unused]] auto& item : enumerator)
+                ++items;
+
+            Assert::AreEqual<std::size_t>(200, items);
+            Assert::IsTrue(enumerator.IsCompleted());
+            Assert::AreEqual(static_cast<std::int32_t>(0x80041001), enumerator.Status());
+        }
+
+        // ---------------------------------------------------------------------
+        // Adaptive_Policy_Tracks_Target_Latency
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Adaptive_Policy_Tracks_Target_Latency)
+        {
+            Wmi::BatchPolicy policy{ Wmi::BatchPolicyOptions{ .initial = 16, .minimum = 4, .maximum = 4096, .target = std::chrono::microseconds{ 10'000 } } };
+
+            // Cheap objects (10us each): converges on ~1000 per pull.
+            for (int i = 0; i < 20; ++i)
+                policy.Observe(policy.Size(), std::chrono::microseconds{ 10 } * policy.Size());
+            Assert::IsTrue(policy.Size() > 900 && policy.Size() <= 1000);
+
+            // Provider slows down to 1ms per object: shrinks towards 10.
+            for (int i = 0; i < 20; ++i)
+                policy.Observe(policy.Size(), std::chrono::microseconds{ 1'000 } * policy.Size());
+            Assert::IsTrue(policy.Size() >= 10 && policy.Size() < 12);
+
+            // Never leaves [minimum, maximum].
+            for (int i = 0; i < 10; ++i)
+                policy.Observe(1, std::chrono::seconds{ 10 });
+            Assert::AreEqual<std::uint32_t>(4, policy.Size());
+            Assert::IsTrue(Wmi::BatchPolicy{ 50 }.IsFixed());
+        }
+
+        // ---------------------------------------------------------------------
+        // Pull_Batching_Performance_Test
+        // - 200k objects behind a 20us per-call round trip: batches of 256 must
+        //   be far cheaper than object-at-a-time pulls
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Pull_Batching_Performance_Test)
+        {
+            constexpr std::uint32_t total = 200'000;
+            constexpr std::uint32_t singleTotal = 10'000;
+            const auto callCost = std::chrono::microseconds{ 20 };
+
+            auto run = [&](std::uint32_t count, Wmi::BatchPolicy policy) {
+                FakePullEnumerator enumerator{ FakeEnumSource{ .total = count, .callCost = callCost }, policy };
+                auto start = std::chrono::high_resolution_clock::now();
+                std::size_t items = 0;
+                for ([[maybe_unused]] auto& item : enumerator)
+                    ++items;
+                auto elapsed = std::chrono::high_resolution_clock::now() - start;
+                Assert::AreEqual<std::size_t>(count, items);
+                return std::chrono::duration<double, std::micro>(elapsed).count() / count;
+            };
+
+            const double singleCost = run(singleTotal, Wmi::BatchPolicy{ 1 });
+            const double batchedCost = run(total, Wmi::BatchPolicy{ 256 });
+            const double adaptiveCost = run(total, Wmi::BatchPolicy{});
+
+            Assert::IsTrue(batchedCost * 10 < singleCost, L"Batched pulls do not amortize the round trip.");
+            Assert::IsTrue(adaptiveCost * 10 < singleCost, L"Adaptive pulls do not amortize the round trip.");
+        }
+    };
+}
@@ -0,0 +1,174 @@
+﻿#include "pch.h"
+#include "CppUnitTest.h"
+#include "../WinMgmt/Core/ReplayBackend.h"
+#include "../WinMgmt/Core/ResultCache.h"
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTests
+{
+    // Two Win32_Service-like objects covering every storage kind, nulls and awkward strings.
+    static Wmi::ResultTablePtr MakeServiceTable()
+    {
+        auto table = std::make_shared<Wmi::ResultTable>();
+        auto name = table->AddColumn(L"Name", Wmi::PropertyType::String);
+        auto pid = table->AddColumn(L"ProcessId", Wmi::PropertyType::UInt32);
+        auto started = table->AddColumn(L"Started", Wmi::PropertyType::Boolean);
+        auto load = table->AddColumn(L"Load", Wmi::PropertyType::Double);
+        auto size = table->AddColumn(L"Size", Wmi::PropertyType::UInt64);
+        auto path = table->AddColumn(L"__PATH", Wmi::PropertyType::Reference);
+
+        table->BeginRow();
+        table->AppendString(name, L"Tab\there\nand\\slash");
+        table->AppendInteger(pid, 4);
+        table->AppendBoolean(started, true);
+        table->AppendReal(load, 0.1);
+        table->AppendInteger(size, static_cast<std::int64_t>(18'446'744'073'709'551'615ull));
+        table->AppendString(path, L"\\\\PC\\root\\cimv2:Win32_Service.Name=\"A\"");
+        table->EndRow();
+
+        table->BeginRow();
+        table->AppendString(name, L"");
+        table->AppendBoolean(started, false);
+        table->EndRow();
+
+        return table;
+    }
+
+    TEST_CLASS(ReplayBackendTests)
+    {
+    public:
+
+        // ---------------------------------------------------------------------
+        // Save_Load_RoundTrips_Every_Column
+        // - Values, nulls, escapes and the empty string survive the text format
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Save_Load_RoundTrips_Every_Column)
+        {
+            Wmi::ReplayBackend recorder;
+            recorder.Add(L"ROOT\\CIMV2", L"SELECT * FROM Win32_Service", MakeServiceTable());
+
+            Wmi::ReplayBackend replay;
+            replay.Load(recorder.Save());
+
+            auto original = MakeServiceTable();
+            auto loaded = replay.Execute(L"root\\cimv2", L"SELECT * FROM Win32_Service");
+
+            Assert::AreEqual(original->RowCount(), loaded->RowCount());
+            Assert::AreEqual(original->ColumnCount(), loaded->ColumnCount());
+            for (std::size_t c = 0; c < original->ColumnCount(); ++c)
+            {
+                Assert::IsTrue(original->GetColumn(c).Name() == loaded->GetColumn(c).Name());
+                Assert::IsTrue(original->GetColumn(c).Type() == loaded->GetColumn(c).Type());
+                for (std::size_t row = 0; row < original->RowCount(); ++row)
+                    Assert::IsTrue(original->GetColumn(c).GetValue(row) == loaded->GetColumn(c).GetValue(row));
+            }
+        }
+
+        // ---------------------------------------------------------------------
+        // Unknown_Query_Throws
+        // - A query that was never recorded is a miss, not an empty result
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Unknown_Query_Throws)
+        {
+            Wmi::ReplayBackend replay;
+            replay.Add(L"ROOT\\CIMV2", L"SELECT * FROM Win32_Service", MakeServiceTable());
+
+            Assert::ExpectException<std::out_of_range>([&] { (void)replay.Execute(L"ROOT\\CIMV2", L"SELECT * FROM Win32_Process"); });
+            Assert::ExpectException<std::out_of_range>([&] { (void)replay.Execute(L"ROOT\\WMI", L"SELECT * FROM Win32_Service"); });
+            Assert::AreEqual<std::uint64_t>(2, replay.Stats().misses);
+        }
+
+        // ---------------------------------------------------------------------
+        // Malformed_Snapshot_Throws
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Malformed_Snapshot_Throws)
+        {
+            Wmi::ReplayBackend replay;
+            Assert::ExpectException<std::invalid_argument>([&] { replay.Load(L"not a snapshot\n"); });
+            Assert::ExpectException<std::invalid_argument>([&] { replay.Load(L"WMISNAPSHOT 1\nQUERY ROOT\tq\nCOLUMNS A:String\n"); });
+            Assert::ExpectException<std::invalid_argument>([&] { replay.Load(L"WMISNAPSHOT 1\nQUERY ROOT\tq\nCOLUMNS A:String\nROW x\ty\nEND\n"); });
+        }
+
+        // ---------------------------------------------------------------------
+        // ObjectCount_Resizes_Results
+        // - Recorded rows are repeated up to (or truncated at) objectCount
+        // ---------------------------------------------------------------------
+        TEST_METHOD(ObjectCount_Resizes_Results)
+        {
+            Wmi::ReplayOptions options;
+            options.objectCount = 5;
+
+            Wmi::ReplayBackend replay{ options };
+            replay.Add(L"ROOT\\CIMV2", L"SELECT * FROM Win32_Service", MakeServiceTable());
+
+            auto table = replay.Execute(L"ROOT\\CIMV2", L"SELECT * FROM Win32_Service");
+            Assert::AreEqual<std::size_t>(5, table->RowCount());
+            Assert::IsTrue(table->GetColumn(0).GetString(4) == table->GetColumn(0).GetString(0));
+            Assert::IsTrue(table->GetColumn(1).IsNull(3));
+
+            // The resized table is built once and shared by later executions.
+            Assert::IsTrue(table == replay.Execute(L"ROOT\\CIMV2", L"SELECT * FROM Win32_Service"));
+        }
+
+        // ---------------------------------------------------------------------
+        // Latency_Is_Applied_Per_Execution
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Latency_Is_Applied_Per_Execution)
+        {
+            Wmi::ReplayOptions options;
+            options.latency = std::chrono::milliseconds{ 20 };
+
+            Wmi::ReplayBackend replay{ options };
+            replay.Add(L"ROOT\\CIMV2", L"SELECT * FROM Win32_Service", MakeServiceTable());
+
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < 3; ++i)
+                (void)replay.Execute(L"ROOT\\CIMV2", L"SELECT * FROM Win32_Service");
+            auto elapsed = std::chrono::steady_clock::now() - start;
+
+            Assert::IsTrue(elapsed >= std::chrono::milliseconds{ 60 });
+            Assert::AreEqual<std::uint64_t>(3, replay.Stats().executions);
+        }
+
+        // ---------------------------------------------------------------------
+        // Replay_Backend_Cached_Query_Performance_Test
+        // - 100k-object results replayed behind the result cache: one execution,
+        //   and repeated reads must not pay the simulated provider cost
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Replay_Backend_Cached_Query_Performance_Test)
+        {
+            constexpr int reads = 1'000;
+            constexpr long long maxMs = 200;
+            const std::wstring ns = L"ROOT\\CIMV2";
+            const std::wstring query = L"SELECT * FROM Win32_Service";
+
+            Wmi::ReplayOptions options;
+            options.latency = std::chrono::milliseconds{ 50 };
+            options.objectCount = 100'000;
+
+            auto replay = std::make_shared<Wmi::ReplayBackend>(options);
+            replay->Add(ns, query, MakeServiceTable());
+
+            Wmi::ResultCache<Wmi::ResultTablePtr> cache;
+
+            auto start = std::chrono::high_resolution_clock::now();
+            std::size_t rows = 0;
+            for (int i = 0; i < reads; ++i)
+            {
+                auto table = cache.GetOrExecute(ns + L"\n" + query, std::chrono::minutes{ 1 }, [&] { return replay->Execute(ns, query); });
+                rows += table->RowCount();
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+
+            Assert::AreEqual<std::size_t>(std::size_t{ reads } * options.objectCount, rows);
+            Assert::AreEqual<std::uint64_t>(1, replay->Stats().executions);
+            Assert::IsTrue(std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() < maxMs, L"Replayed queries are too slow.");
+        }
+    };
+}
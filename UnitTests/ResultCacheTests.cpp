@@ -0,0 +1,177 @@
+﻿#include "pch.h"
+#include "CppUnitTest.h"
+#include "../WinMgmt/Core/ResultCache.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTests
+{
+    using FakeResult = std::shared_ptr<const std::vector<int>>;
+
+    // Stands in for IWbemServices: counts executions and takes a while to answer.
+    struct FakeQueryBackend
+    {
+        std::atomic<int> executions{ 0 };
+        std::chrono::milliseconds latency{ 50 };
+
+        FakeResult Execute(std::wstring const& query)
+        {
+            executions.fetch_add(1);
+            std::this_thread::sleep_for(latency);
+            return std::make_shared<const std::vector<int>>(std::vector<int>(query.size(), 1));
+        }
+    };
+
+    // Manually advanced clock for TTL tests.
+    struct VirtualClock
+    {
+        std::shared_ptr<std::chrono::steady_clock::time_point> now = std::make_shared<std::chrono::steady_clock::time_point>();
+
+        Wmi::ResultCache<FakeResult>::time_source Source() const
+        {
+            return [now = now] { return *now; };
+        }
+    };
+
+    TEST_CLASS(ResultCacheTests)
+    {
+    public:
+
+        // ---------------------------------------------------------------------
+        // Concurrent_Identical_Queries_Execute_Once
+        // - N callers released at the same moment share one backend execution
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Concurrent_Identical_Queries_Execute_Once)
+        {
+            constexpr int callerCount = 16;
+            const std::wstring query = L"SELECT * FROM Win32_NetworkAdapterConfiguration";
+
+            FakeQueryBackend backend;
+            backend.latency = std::chrono::milliseconds{ 200 };
+            Wmi::ResultCache<FakeResult> cache;
+
+            std::atomic<int> ready{ 0 };
+            std::atomic<bool> go{ false };
+            std::vector<FakeResult> results(callerCount);
+            std::vector<std::thread> callers;
+            for (int i = 0; i < callerCount; ++i)
+            {
+                callers.emplace_back([&, i]
+                {
+                    ready.fetch_add(1);
+                    while (!go.load())
+                        std::this_thread::yield();
+
+                    results[i] = cache.GetOrExecute(query, std::chrono::seconds{ 0 }, [&] { return backend.Execute(query); });
+                });
+            }
+
+            while (ready.load() < callerCount)
+                std::this_thread::yield();
+
+            go.store(true);
+            for (auto& caller : callers)
+                caller.join();
+
+            Assert::AreEqual(1, backend.executions.load());
+            for (auto const& result : results)
+                Assert::IsTrue(result == results[0], L"Callers did not share the same immutable result.");
+
+            auto stats = cache.Stats();
+            Assert::AreEqual<uint64_t>(1, stats.executions);
+            Assert::AreEqual<uint64_t>(callerCount - 1, stats.coalesced);
+            Assert::AreEqual<size_t>(0, stats.entries, L"Zero TTL must not retain the result.");
+        }
+
+        // ---------------------------------------------------------------------
+        // Result_Is_Reused_Until_Ttl_Expires
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Result_Is_Reused_Until_Ttl_Expires)
+        {
+            FakeQueryBackend backend;
+            backend.latency = std::chrono::milliseconds{ 0 };
+
+            VirtualClock clock;
+            Wmi::ResultCache<FakeResult> cache{ 16, clock.Source() };
+            auto run = [&] { return cache.GetOrExecute(L"q", std::chrono::seconds{ 5 }, [&] { return backend.Execute(L"q"); }); };
+
+            auto first = run();
+            *clock.now += std::chrono::seconds{ 4 };
+            auto second = run();
+            Assert::IsTrue(first == second);
+            Assert::AreEqual(1, backend.executions.load());
+
+            *clock.now += std::chrono::seconds{ 2 };
+            auto third = run();
+            Assert::IsTrue(first != third);
+            Assert::AreEqual(2, backend.executions.load());
+            Assert::AreEqual<uint64_t>(1, cache.Stats().hits);
+
+            cache.Invalidate(L"q");
+            (void)run();
+            Assert::AreEqual(3, backend.executions.load());
+        }
+
+        // ---------------------------------------------------------------------
+        // Failure_Reaches_Waiters_And_Is_Not_Cached
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Failure_Reaches_Waiters_And_Is_Not_Cached)
+        {
+            Wmi::ResultCache<FakeResult> cache;
+
+            auto leader = cache.Acquire(L"q");
+            auto follower = cache.Acquire(L"q");
+            Assert::IsTrue(leader.IsLeader());
+            Assert::IsFalse(follower.IsLeader());
+
+            cache.Fail(leader, std::make_exception_ptr(std::runtime_error("provider failure")));
+            Assert::ExpectException<std::runtime_error>([&] { (void)follower.Get(); });
+
+            auto retry = cache.Acquire(L"q");
+            Assert::IsTrue(retry.IsLeader());
+            cache.Publish(retry, std::make_shared<const std::vector<int>>(), std::chrono::seconds{ 1 });
+            Assert::AreEqual<uint64_t>(1, cache.Stats().failures);
+        }
+
+        // ---------------------------------------------------------------------
+        // Abandoned_Flight_Is_Restarted
+        // - a leader that never publishes must not wedge the key
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Abandoned_Flight_Is_Restarted)
+        {
+            Wmi::ResultCache<FakeResult> cache;
+            {
+                auto leader = cache.Acquire(L"q");
+                Assert::IsTrue(leader.IsLeader());
+            }
+
+            auto next = cache.Acquire(L"q");
+            Assert::IsTrue(next.IsLeader());
+        }
+
+        // ---------------------------------------------------------------------
+        // Entries_Are_Bounded
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Entries_Are_Bounded)
+        {
+            VirtualClock clock;
+            Wmi::ResultCache<FakeResult> cache{ 4, clock.Source() };
+
+            for (int i = 0; i < 10; ++i)
+            {
+                *clock.now += std::chrono::milliseconds{ 1 };
+                (void)cache.GetOrExecute(std::to_wstring(i), std::chrono::seconds{ 60 }, [] { return std::make_shared<const std::vector<int>>(); });
+            }
+
+            Assert::AreEqual<size_t>(4, cache.Stats().entries);
+        }
+    };
+}
@@ -0,0 +1,309 @@
+﻿#include "pch.h"
+#include "CppUnitTest.h"
+#include "../WinMgmt/Core/ResultExporter.h"
+#include "../WinMgmt/Core/ResultTable.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTests
+{
+    // A Win32_Service-like table with every storage kind, nulls and strings that need escaping.
+    static void FillExportTable(Wmi::ResultTable& table, std::size_t rows)
+    {
+        auto name = table.AddColumn(L"Name", Wmi::PropertyType::String);
+        auto pid = table.AddColumn(L"ProcessId", Wmi::PropertyType::UInt32);
+        auto size = table.AddColumn(L"Size", Wmi::PropertyType::UInt64);
+        auto load = table.AddColumn(L"Load", Wmi::PropertyType::Double);
+        auto started = table.AddColumn(L"Started", Wmi::PropertyType::Boolean);
+        auto installed = table.AddColumn(L"InstallDate", Wmi::PropertyType::DateTime);
+        auto path = table.AddColumn(L"PathName", Wmi::PropertyType::String);
+
+        table.Reserve(rows);
+        for (std::size_t row = 0; row < rows; ++row)
+        {
+            table.BeginRow();
+            table.AppendString(name, L"Service" + std::to_wstring(row % 300));
+            table.AppendInteger(pid, static_cast<std::int64_t>(row * 4));
+            table.AppendInteger(size, static_cast<std::int64_t>(row * 1'048'576));
+            if (row % 5 != 0)
+                table.AppendReal(load, static_cast<double>(row) / 8);
+            table.AppendBoolean(started, row % 2 == 0);
+            table.AppendInteger(installed, 1'700'000'000'000'000 + static_cast<std::int64_t>(row) * 1'000'000);
+            table.AppendString(path, L"\"C:\\Windows\\System32\\svchost.exe\" -k netsvcs -p -s Service" + std::to_wstring(row));
+            table.EndRow();
+        }
+    }
+
+    // Straightforward JSON string escaping, to check the exporter's fast path against.
+    static std::string ReferenceJsonString(std::wstring_view text)
+    {
+        std::string out = "\"";
+        for (std::size_t i = 0; i < text.size(); ++i)
+        {
+            auto code = static_cast<std::uint32_t>(text[i]);
+            if (sizeof(wchar_t) == 2 && code >= 0xD800 && code < 0xDC00 && i + 1 < text.size())
+                code = 0x10000 + ((code - 0xD800) << 10) + (static_cast<std::uint32_t>(text[++i]) - 0xDC00);
+
+            if (code == '"' || code == '\\')
+            {
+                out += '\\';
+                out += static_cast<char>(code);
+            }
+            else if (code == '\n')
+                out += "\\n";
+            else if (code == '\t')
+                out += "\\t";
+            else if (code < 0x20)
+            {
+                char escape[8];
+                std::snprintf(escape, sizeof(escape), "\\u%04x", static_cast<unsigned>(code));
+                out += escape;
+            }
+            else if (code < 0x80)
+                out += static_cast<char>(code);
+            else if (code < 0x800)
+            {
+                out += static_cast<char>(0xC0 | (code >> 6));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            }
+            else if (code < 0x10000)
+            {
+                out += static_cast<char>(0xE0 | (code >> 12));
+                out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            }
+            else
+            {
+                out += static_cast<char>(0xF0 | (code >> 18));
+                out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+                out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            }
+        }
+        return out + "\"";
+    }
+
+    TEST_CLASS(ResultExporterTests)
+    {
+    public:
+        // ---------------------------------------------------------------
+        // ResultExporter_Writes_Typed_Json_Lines_Test
+        // - Numbers, booleans, nulls, DateTime and escaped strings are
+        //   written from their typed storage, one object per line
+        // ---------------------------------------------------------------
+        TEST_METHOD(ResultExporter_Writes_Typed_Json_Lines_Test)
+        {
+            Wmi::ResultTable table;
+            auto name = table.AddColumn(L"Na\"me", Wmi::PropertyType::String);
+            auto count = table.AddColumn(L"Count", Wmi::PropertyType::Int32);
+            auto size = table.AddColumn(L"Size", Wmi::PropertyType::UInt64);
+            auto ratio = table.AddColumn(L"Ratio", Wmi::PropertyType::Float);
+            auto load = table.AddColumn(L"Load", Wmi::PropertyType::Double);
+            auto on = table.AddColumn(L"On", Wmi::PropertyType::Boolean);
+            auto when = table.AddColumn(L"When", Wmi::PropertyType::DateTime);
+
+            table.BeginRow();
+            table.AppendString(name, L"a\"b\\c\td\ne\x01 caf\u00e9 \U0001F600");
+            table.AppendInteger(count, -42);
+            table.AppendInteger(size, static_cast<std::int64_t>(18'446'744'073'709'551'615ull));
+            table.AppendReal(ratio, 0.1f);
+            table.AppendReal(load, 0.1);
+            table.AppendBoolean(on, true);
+            table.AppendInteger(when, 1'700'000'000'123'456);
+            table.EndRow();
+
+            table.BeginRow();
+            table.AppendReal(load, std::numeric_limits<double>::infinity());
+            table.AppendBoolean(on, false);
+            table.EndRow();
+
+            std::string out;
+            Wmi::ResultExporter exporter{ Wmi::ExportFormat::JsonLines, [&](std::string_view chunk) { out.append(chunk); } };
+            exporter.Write(table);
+            exporter.Finish();
+
+            Assert::AreEqual(std::string{
+                "{\"Na\\\"me\":\"a\\\"b\\\\c\\td\\ne\\u0001 caf\xC3\xA9 \xF0\x9F\x98\x80\",\"Count\":-42,\"Size\":18446744073709551615,"
+                "\"Ratio\":0.1,\"Load\":0.1,\"On\":true,\"When\":\"2023-11-14T22:13:20.123456Z\"}\n"
+                "{\"Na\\\"me\":null,\"Count\":null,\"Size\":null,\"Ratio\":null,\"Load\":null,\"On\":false,\"When\":null}\n" }, out);
+
+            auto stats = exporter.Stats();
+            Assert::AreEqual<std::uint64_t>(2, stats.rows);
+            Assert::AreEqual<std::uint64_t>(out.size(), stats.bytes);
+        }
+
+        // ---------------------------------------------------------------
+        // ResultExporter_Writes_Rfc4180_Csv_Test
+        // - A header line, CRLF line ends, empty fields for nulls
+        // - Only fields with a comma, quote or line break are quoted,
+        //   with quotes doubled
+        // - Row values are written by their own types
+        // ---------------------------------------------------------------
+        TEST_METHOD(ResultExporter_Writes_Rfc4180_Csv_Test)
+        {
+            const std::wstring_view columns[] = { L"Name", L"Path, full", L"Id", L"Enabled" };
+
+            std::ostringstream out;
+            Wmi::ResultExporter exporter{ Wmi::ExportFormat::Csv, out };
+            exporter.Begin(columns);
+
+            const Wmi::Value first[] = {
+                Wmi::Value::FromString(L"plain"),
+                Wmi::Value::FromString(L"\\\\PC\\root\\cimv2:Win32_Service.Name=\"A,B\"", Wmi::PropertyType::Reference),
+                Wmi::Value::FromInt64(7, Wmi::PropertyType::UInt32),
+                Wmi::Value::FromBoolean(true) };
+            const Wmi::Value second[] = {
+                Wmi::Value::FromString(L"two\r\nlines"),
+                Wmi::Value::Null(),
+                Wmi::Value::FromString(L"4"),
+                Wmi::Value::FromBoolean(false) };
+            exporter.WriteRow(first);
+            exporter.WriteRow(second);
+            exporter.Finish();
+
+            Assert::AreEqual(std::string{
+                "Name,\"Path, full\",Id,Enabled\r\n"
+                "plain,\"\\\\PC\\root\\cimv2:Win32_Service.Name=\"\"A,B\"\"\",7,true\r\n"
+                "\"two\r\nlines\",,4,false\r\n" }, out.str());
+
+            Assert::ExpectException<std::invalid_argument>([&] { exporter.WriteRow(std::span<const Wmi::Value>{ first, 2 }); });
+        }
+
+        // ---------------------------------------------------------------
+        // ResultExporter_Escaping_Matches_Reference_Test
+        // - Random strings mixing plain ASCII, escapes, BMP and
+        //   supplementary characters, at every length around the vector
+        //   width, come out as a byte-by-byte escaper writes them
+        // - Holds for a buffer small enough to split strings across flushes
+        // ---------------------------------------------------------------
+        TEST_METHOD(ResultExporter_Escaping_Matches_Reference_Test)
+        {
+            const std::wstring alphabet = L"abcXYZ019 _-:.\"\\\t\n\x01\x1f\u00e9\u4e2d\U0001F600";
+            std::mt19937 random{ 2024 };
+
+            Wmi::ResultTable table;
+            auto column = table.AddColumn(L"Text", Wmi::PropertyType::String);
+            std::string expected;
+            for (std::size_t length = 0; length < 300; ++length)
+            {
+                std::wstring text;
+                for (std::size_t i = 0; i < length; ++i)
+                {
+                    // Mostly plain text, so runs long enough for the vector path are common.
+                    const auto pick = random() % 8 == 0 ? random() % alphabet.size() : random() % 14;
+                    text += alphabet[pick];
+                    if (sizeof(wchar_t) == 2 && (alphabet[pick] & 0xFC00) == 0xD800)
+                        text += alphabet[pick + 1];
+                }
+
+                table.BeginRow();
+                table.AppendString(column, text);
+                table.EndRow();
+                expected += "{\"Text\":" + ReferenceJsonString(text) + "}\n";
+            }
+
+            for (std::size_t bufferBytes : { std::size_t{ 256 }, std::size_t{ 333 }, Wmi::ResultExporter::DefaultBufferBytes })
+            {
+                std::string out;
+                std::size_t largest = 0;
+                Wmi::ResultExporter exporter{ Wmi::ExportFormat::JsonLines, [&](std::string_view chunk) {
+                    largest = (std::max)(largest, chunk.size());
+                    out.append(chunk);
+                }, bufferBytes };
+                exporter.Write(table);
+                exporter.Finish();
+
+                Assert::IsTrue(expected == out);
+                Assert::IsTrue(largest <= bufferBytes);
+            }
+        }
+
+        // ---------------------------------------------------------------
+        // ResultExporter_Streams_Tables_Through_A_Fixed_Buffer_Test
+        // - Several tables with the same columns continue one export;
+        //   CSV writes its header once
+        // - The sink only ever sees chunks up to the buffer size
+        // - A table with other columns is refused
+        // ---------------------------------------------------------------
+        TEST_METHOD(ResultExporter_Streams_Tables_Through_A_Fixed_Buffer_Test)
+        {
+            Wmi::ResultTable first;
+            FillExportTable(first, 1000);
+            Wmi::ResultTable second;
+            FillExportTable(second, 500);
+
+            std::size_t chunks = 0;
+            std::size_t bytes = 0;
+            std::size_t largest = 0;
+            std::size_t lines = 0;
+            std::size_t headers = 0;
+            Wmi::ResultExporter exporter{ Wmi::ExportFormat::Csv, [&](std::string_view chunk) {
+                ++chunks;
+                bytes += chunk.size();
+                largest = (std::max)(largest, chunk.size());
+                for (std::size_t at = chunk.find("\r\n"); at != std::string_view::npos; at = chunk.find("\r\n", at + 2))
+                    ++lines;
+                for (std::size_t at = chunk.find("Name,ProcessId"); at != std::string_view::npos; at = chunk.find("Name,ProcessId", at + 1))
+                    ++headers;
+            }, 4096 };
+
+            exporter.Write(first);
+            exporter.Write(second);
+
+            Wmi::ResultTable other;
+            other.AddColumn(L"Name", Wmi::PropertyType::String);
+            Assert::ExpectException<std::invalid_argument>([&] { exporter.Write(other); });
+            exporter.Finish();
+
+            Assert::AreEqual<std::size_t>(1 + 1500, lines);
+            Assert::AreEqual<std::size_t>(1, headers);
+            Assert::IsTrue(chunks > 10 && largest <= 4096);
+
+            auto stats = exporter.Stats();
+            Assert::AreEqual<std::uint64_t>(1500, stats.rows);
+            Assert::AreEqual<std::uint64_t>(bytes, stats.bytes);
+            Assert::IsTrue(stats.BytesPerSecond() > 0);
+        }
+
+        // ---------------------------------------------------------------
+        // Performance_Export_Json_Lines_Throughput
+        // - Exports a 1M-row synthetic service table as JSON Lines and CSV
+        //   into a sink that only counts bytes
+        // - Expects each export to report the bytes the sink received and a
+        //   throughput of at least minMBps
+        // ---------------------------------------------------------------
+        TEST_METHOD(Performance_Export_Json_Lines_Throughput)
+        {
+            constexpr std::size_t rows = 1'000'000;
+            constexpr double minMBps = 50;
+
+            Wmi::ResultTable table;
+            FillExportTable(table, rows);
+
+            for (auto format : { Wmi::ExportFormat::JsonLines, Wmi::ExportFormat::Csv })
+            {
+                std::uint64_t received = 0;
+                Wmi::ResultExporter exporter{ format, [&](std::string_view chunk) { received += chunk.size(); } };
+                exporter.Write(table);
+                exporter.Finish();
+
+                auto stats = exporter.Stats();
+                Assert::AreEqual<std::uint64_t>(rows, stats.rows);
+                Assert::AreEqual(received, stats.bytes);
+                Assert::IsTrue(stats.bytes > rows * 100);
+                Assert::IsTrue(stats.BytesPerSecond() / 1e6 > minMBps);
+            }
+        }
+    };
+}
@@ -0,0 +1,172 @@
+﻿#include "pch.h"
+#include "CppUnitTest.h"
+#include "../WinMgmt/Core/ResultTable.h"
+
+#include <chrono>
+#include <string>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTests
+{
+    // Builds a Win32_Process-like table with `rows` synthetic objects.
+    static Wmi::ResultTable MakeProcessTable(std::size_t rows)
+    {
+        Wmi::ResultTable table;
+        auto name = table.AddColumn(L"Name", Wmi::PropertyType::String);
+        auto pid = table.AddColumn(L"ProcessId", Wmi::PropertyType::UInt32);
+        auto ws = table.AddColumn(L"WorkingSetSize", Wmi::PropertyType::UInt64);
+        auto cpu = table.AddColumn(L"PercentProcessorTime", Wmi::PropertyType::Double);
+        auto crit = table.AddColumn(L"Critical", Wmi::PropertyType::Boolean);
+        table.Reserve(rows);
+
+        for (std::size_t i = 0; i < rows; ++i)
+        {
+            table.BeginRow();
+            table.AppendString(name, L"svchost_" + std::to_wstring(i % 97) + L".exe");
+            table.AppendInteger(pid, static_cast<std::int64_t>(i));
+            table.AppendInteger(ws, static_cast<std::int64_t>(i * 4096));
+            table.AppendReal(cpu, static_cast<double>(i % 100) / 10.0);
+            if (i % 3 == 0)
+                table.AppendBoolean(crit, (i & 1) != 0);
+            table.EndRow();
+        }
+        return table;
+    }
+
+    TEST_CLASS(ResultTableTests)
+    {
+    public:
+
+        // ---------------------------------------------------------------------
+        // Typed_Columns_RoundTrip_Through_RowView
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Typed_Columns_RoundTrip_Through_RowView)
+        {
+            auto table = MakeProcessTable(10);
+            Assert::AreEqual<std::size_t>(10, table.RowCount());
+            Assert::AreEqual<std::size_t>(5, table.ColumnCount());
+
+            auto row = table.Row(7);
+            Assert::IsTrue(row.GetString(*table.Find(L"Name")) == L"svchost_7.exe");
+            Assert::AreEqual<std::uint64_t>(7, row.GetUInt64(*table.Find(L"ProcessId")));
+            Assert::AreEqual<std::uint64_t>(7 * 4096, row.GetUInt64(*table.Find(L"WorkingSetSize")));
+            Assert::AreEqual(0.7, row.GetDouble(*table.Find(L"PercentProcessorTime")), 1e-9);
+        }
+
+        // ---------------------------------------------------------------------
+        // Unwritten_Cells_Are_Null
+        // - Cells skipped during a row are padded with nulls
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Unwritten_Cells_Are_Null)
+        {
+            auto table = MakeProcessTable(6);
+            auto crit = *table.Find(L"Critical");
+
+            Assert::IsFalse(table.Row(0).IsNull(crit));
+            Assert::IsTrue(table.Row(1).IsNull(crit));
+            Assert::IsTrue(table.Row(2).IsNull(crit));
+            Assert::IsTrue(table.Row(3).GetBoolean(crit));
+        }
+
+        // ---------------------------------------------------------------------
+        // Late_Column_Is_BackFilled
+        // - A property first seen on a later object gets null cells for earlier rows
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Late_Column_Is_BackFilled)
+        {
+            auto table = MakeProcessTable(3);
+
+            table.BeginRow();
+            auto extra = table.AddColumn(L"CommandLine", Wmi::PropertyType::String);
+            table.AppendString(extra, L"-k netsvcs");
+            table.EndRow();
+
+            Assert::AreEqual<std::size_t>(4, table.GetColumn(extra).Size());
+            for (std::size_t i = 0; i < 3; ++i)
+                Assert::IsTrue(table.Row(i).IsNull(extra));
+            Assert::IsTrue(table.Row(3).GetString(extra) == L"-k netsvcs");
+            Assert::IsTrue(table.Row(3).IsNull(*table.Find(L"Name")));
+        }
+
+        // ---------------------------------------------------------------------
+        // Column_Names_Ignore_Case
+        // - Find and AddColumn treat "processid" as ProcessId, as WMI does
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Column_Names_Ignore_Case)
+        {
+            auto table = MakeProcessTable(2);
+            auto pid = *table.Find(L"ProcessId");
+
+            Assert::AreEqual(pid, *table.Find(L"processid"));
+            Assert::AreEqual(pid, *table.Find(L"PROCESSID"));
+            Assert::AreEqual(pid, table.AddColumn(L"processId", Wmi::PropertyType::UInt32));
+            Assert::AreEqual<std::size_t>(5, table.ColumnCount());
+            Assert::IsFalse(table.Find(L"ProcessIds").has_value());
+        }
+
+        // ---------------------------------------------------------------------
+        // Select_Copies_Rows_In_Order
+        // - The selected rows keep their values, nulls and column types
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Select_Copies_Rows_In_Order)
+        {
+            auto table = MakeProcessTable(10);
+            const std::uint32_t rows[] = { 7, 1, 3 };
+
+            auto selected = table.Select(rows);
+            Assert::AreEqual<std::size_t>(3, selected.RowCount());
+            Assert::AreEqual(table.ColumnCount(), selected.ColumnCount());
+
+            auto name = *selected.Find(L"Name");
+            auto crit = *selected.Find(L"Critical");
+            Assert::IsTrue(selected.Row(0).GetString(name) == L"svchost_7.exe");
+            Assert::IsTrue(selected.Row(2).GetString(name) == L"svchost_3.exe");
+            Assert::IsTrue(selected.Row(0).IsNull(crit));
+            Assert::IsTrue(selected.Row(2).GetBoolean(crit));
+            Assert::IsTrue(selected.GetColumn(*selected.Find(L"ProcessId")).Type() == Wmi::PropertyType::UInt32);
+        }
+
+        // ---------------------------------------------------------------------
+        // Mismatched_Value_Throws
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Mismatched_Value_Throws)
+        {
+            Wmi::ResultTable table;
+            auto col = table.AddColumn(L"ProcessId", Wmi::PropertyType::UInt32);
+            table.BeginRow();
+
+            Assert::ExpectException<std::invalid_argument>([&]() {
+                table.AppendString(col, L"not a number");
+            });
+        }
+
+        // ---------------------------------------------------------------------
+        // ResultTable_Memory_And_Scan_Performance_Test
+        // - 100k rows of five properties must stay well under the per-cell cost of boxed values
+        // - A full scan of a numeric column must stay fast
+        // ---------------------------------------------------------------------
+        TEST_METHOD(ResultTable_Memory_And_Scan_Performance_Test)
+        {
+            constexpr std::size_t rows = 100'000;
+            constexpr std::size_t maxBytesPerRow = 96;
+            constexpr long long maxScanMs = 50;
+
+            auto table = MakeProcessTable(rows);
+            auto bytesPerRow = table.MemoryUsage() / rows;
+            Assert::IsTrue(bytesPerRow < maxBytesPerRow, L"Columnar storage uses too much memory per row.");
+
+            auto ws = table.GetColumn(*table.Find(L"WorkingSetSize")).Integers();
+
+            auto start = std::chrono::high_resolution_clock::now();
+            std::uint64_t total = 0;
+            for (int pass = 0; pass < 10; ++pass)
+                for (auto v : ws)
+                    total += static_cast<std::uint64_t>(v);
+            auto end = std::chrono::high_resolution_clock::now();
+
+            Assert::IsTrue(total > 0);
+            Assert::IsTrue(std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() < maxScanMs, L"Column scan is too slow.");
+        }
+    };
+}
@@ -0,0 +1,261 @@
+﻿#include "pch.h"
+#include "CppUnitTest.h"
+#include "../WinMgmt/Core/MpscBatchQueue.h"
+#include "../WinMgmt/Core/RowArena.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTests
+{
+    // Allocations and bytes requested through ArenaCountingAllocator.
+    struct ArenaAllocations
+    {
+        std::size_t count = 0;
+        std::size_t bytes = 0;
+    };
+
+    template<typename T>
+    struct ArenaCountingAllocator
+    {
+        using value_type = T;
+
+        explicit ArenaCountingAllocator(ArenaAllocations& counts) noexcept : counts(&counts) {}
+
+        template<typename U>
+        ArenaCountingAllocator(ArenaCountingAllocator<U> const& other) noexcept : counts(other.counts) {}
+
+        T* allocate(std::size_t n)
+        {
+            ++counts->count;
+            counts->bytes += n * sizeof(T);
+            return std::allocator<T>{}.allocate(n);
+        }
+
+        void deallocate(T* p, std::size_t n) noexcept
+        {
+            std::allocator<T>{}.deallocate(p, n);
+        }
+
+        template<typename U>
+        bool operator==(ArenaCountingAllocator<U> const& other) const noexcept { return counts == other.counts; }
+
+        ArenaAllocations* counts;
+    };
+
+    // Stands in for the per-row wrapper object made when a row is read.
+    struct ProjectedRow
+    {
+        const void* source = nullptr;
+        std::uint64_t state[3]{};
+    };
+
+    TEST_CLASS(RowArenaTests)
+    {
+    public:
+        // ---------------------------------------------------------------
+        // RowArena_Indexes_Rows_Across_Chunks_Test
+        // - Appends 1000 rows into chunks that start at 4 rows and double
+        // - Expects every row back at its index and ceil(log2(1000 / 4 + 1)) chunks
+        // ---------------------------------------------------------------
+        TEST_METHOD(RowArena_Indexes_Rows_Across_Chunks_Test)
+        {
+            Wmi::RowArena<std::uint32_t> arena{ 4 };
+            for (std::uint32_t i = 0; i < 1000; ++i)
+                arena.Append(i * 3);
+
+            Assert::AreEqual<std::size_t>(1000, arena.Size());
+            for (std::uint32_t i = 0; i < 1000; ++i)
+                Assert::AreEqual<std::uint32_t>(i * 3, arena[i]);
+
+            auto stats = arena.Stats();
+            Assert::AreEqual<std::size_t>(1000, stats.rows);
+            Assert::AreEqual<std::size_t>(8, stats.chunks);
+            Assert::AreEqual<std::size_t>(4 * 255 * sizeof(std::uint32_t), stats.bytesReserved);
+        }
+
+        // ---------------------------------------------------------------
+        // RowArena_Keeps_Rows_In_Place_And_Frees_Them_Together_Test
+        // - Holds shared_ptr rows; checks their addresses survive later appends
+        // - Expects every row released when the arena goes away, and only then
+        // ---------------------------------------------------------------
+        TEST_METHOD(RowArena_Keeps_Rows_In_Place_And_Frees_Them_Together_Test)
+        {
+            std::vector<std::weak_ptr<int>> watched;
+            {
+                Wmi::RowArena<std::shared_ptr<int>> arena{ 2 };
+                auto* first = &arena.Append(std::make_shared<int>(0));
+                watched.push_back(arena[0]);
+
+                for (int i = 1; i < 100; ++i)
+                    watched.push_back(arena.Append(std::make_shared<int>(i)));
+
+                Assert::IsTrue(first == &arena[0]);
+                for (int i = 0; i < 100; ++i)
+                    Assert::AreEqual(i, *arena[i]);
+
+                for (auto const& row : watched)
+                    Assert::IsFalse(row.expired());
+            }
+
+            for (auto const& row : watched)
+                Assert::IsTrue(row.expired());
+        }
+
+        // ---------------------------------------------------------------
+        // RowArena_Collects_Queued_Batches_In_Order_Test
+        // - Pushes three batches through an MpscBatchQueue
+        // - Expects CloseInto to lay them out in the arena in push order
+        // ---------------------------------------------------------------
+        TEST_METHOD(RowArena_Collects_Queued_Batches_In_Order_Test)
+        {
+            Wmi::MpscBatchQueue<int> queue;
+            queue.Push({ 0, 1, 2 });
+            queue.Push({ 3 });
+            queue.Push({ 4, 5 });
+
+            Wmi::RowArena<int> arena{ 2 };
+            queue.CloseInto(arena);
+
+            Assert::AreEqual<std::size_t>(6, arena.Size());
+            for (int i = 0; i < 6; ++i)
+                Assert::AreEqual(i, arena[i]);
+            Assert::IsFalse(queue.Push({ 6 }));
+        }
+
+        // ---------------------------------------------------------------
+        // LazyProjection_Keeps_One_Object_Per_Touched_Row_Test
+        // - 8 threads read the same 100 of 10000 rows concurrently
+        // - Expects one object kept per touched row, shared by every reader,
+        //   and nothing made for the other rows
+        // ---------------------------------------------------------------
+        TEST_METHOD(LazyProjection_Keeps_One_Object_Per_Touched_Row_Test)
+        {
+            Wmi::LazyProjection<std::shared_ptr<ProjectedRow>> rows{ 10000 };
+            std::atomic<std::size_t> made{ 0 };
+            auto make = [&](std::size_t) {
+                made.fetch_add(1, std::memory_order_relaxed);
+                return std::make_shared<ProjectedRow>();
+            };
+
+            std::vector<std::vector<std::shared_ptr<ProjectedRow>>> seen(8);
+            std::vector<std::thread> readers;
+            for (std::size_t t = 0; t < seen.size(); ++t)
+                readers.emplace_back([&, t] {
+                    for (std::size_t row = 0; row < 10000; row += 100)
+                        seen[t].push_back(rows.Get(row, make));
+                });
+            for (auto& reader : readers)
+                reader.join();
+
+            Assert::IsTrue(made.load() >= 100);
+            Assert::AreEqual<std::size_t>(100, rows.Materialized());
+            for (std::size_t t = 1; t < seen.size(); ++t)
+                Assert::IsTrue(seen[t] == seen[0]);
+
+            Assert::AreEqual<std::size_t>(300, rows.Find(seen[0][3]).value());
+            Assert::IsFalse(rows.Find(std::make_shared<ProjectedRow>()).has_value());
+        }
+
+        // ---------------------------------------------------------------
+        // LazyProjection_Makes_Rows_Outside_The_Lock_Test
+        // - One thread's make blocks until another thread has read a
+        //   different row
+        // - Expects the second read to finish meanwhile, and a later read of
+        //   the first row to reuse what the first make returned
+        // ---------------------------------------------------------------
+        TEST_METHOD(LazyProjection_Makes_Rows_Outside_The_Lock_Test)
+        {
+            Wmi::LazyProjection<std::shared_ptr<ProjectedRow>> rows{ 2 };
+            std::promise<void> otherRowRead;
+            auto released = otherRowRead.get_future();
+
+            std::thread slow([&] {
+                (void)rows.Get(0, [&](std::size_t) {
+                    released.wait();
+                    return std::make_shared<ProjectedRow>();
+                });
+            });
+
+            (void)rows.Get(1, [](std::size_t) { return std::make_shared<ProjectedRow>(); });
+            otherRowRead.set_value();
+            slow.join();
+
+            bool remade = false;
+            (void)rows.Get(0, [&](std::size_t) { remade = true; return std::make_shared<ProjectedRow>(); });
+            Assert::IsFalse(remade);
+            Assert::AreEqual<std::size_t>(2, rows.Materialized());
+        }
+
+        // ---------------------------------------------------------------
+        // RowArena_Lazy_Rows_Allocation_Benchmark_Test
+        // - Stores 1M pointer-sized rows in an arena and projects 1% of them
+        // - Baseline makes a wrapper object per row up front, as Indicate did
+        // - Expects one allocation per chunk and per projected row instead of
+        //   one per row, under half the baseline's bytes per row, and less time
+        // ---------------------------------------------------------------
+        TEST_METHOD(RowArena_Lazy_Rows_Allocation_Benchmark_Test)
+        {
+            constexpr std::size_t rowCount = 1 << 20;
+            constexpr std::size_t touchEvery = 100;
+            constexpr long long maxMs = 400;
+            static const int source = 0;
+
+            ArenaAllocations lazy;
+            auto start = std::chrono::high_resolution_clock::now();
+            {
+                Wmi::RowArena<const void*, ArenaCountingAllocator<const void*>> arena{ 256, ArenaCountingAllocator<const void*>{ lazy } };
+                for (std::size_t i = 0; i < rowCount; ++i)
+                    arena.Append(&source);
+
+                Wmi::LazyProjection<std::shared_ptr<ProjectedRow>> rows{ arena.Size() };
+                ArenaCountingAllocator<ProjectedRow> objects{ lazy };
+                for (std::size_t i = 0; i < rowCount; i += touchEvery)
+                {
+                    auto row = rows.Get(i, [&](std::size_t index) {
+                        return std::allocate_shared<ProjectedRow>(objects, ProjectedRow{ arena[index] });
+                    });
+                    Assert::IsTrue(row->source == &source);
+                }
+
+                auto stats = arena.Stats();
+                Assert::IsTrue(stats.chunks <= 16);
+                Assert::IsTrue(stats.bytesReserved <= 2 * sizeof(const void*) * rowCount);
+            }
+            auto lazyMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start).count();
+
+            ArenaAllocations eager;
+            start = std::chrono::high_resolution_clock::now();
+            {
+                ArenaCountingAllocator<ProjectedRow> objects{ eager };
+                std::vector<std::shared_ptr<ProjectedRow>, ArenaCountingAllocator<std::shared_ptr<ProjectedRow>>> rows{ ArenaCountingAllocator<std::shared_ptr<ProjectedRow>>{ eager } };
+                rows.reserve(rowCount);
+                for (std::size_t i = 0; i < rowCount; ++i)
+                    rows.push_back(std::allocate_shared<ProjectedRow>(objects, ProjectedRow{ &source }));
+            }
+            auto eagerMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start).count();
+
+            const auto projected = rowCount / touchEvery + 1;
+            Assert::IsTrue(lazy.count <= 16 + projected);
+            Assert::IsTrue(eager.count > rowCount);
+
+            // Per stored row: the arena slot, the empty projection slot, and the objects
+            // actually made spread over all rows.
+            constexpr auto slotBytes = sizeof(std::shared_ptr<ProjectedRow>);
+            const auto lazyBytesPerRow = static_cast<double>(lazy.bytes + slotBytes * rowCount) / rowCount;
+            const auto eagerBytesPerRow = static_cast<double>(eager.bytes) / rowCount;
+            Assert::IsTrue(lazyBytesPerRow < 2 * sizeof(const void*) + slotBytes + 1);
+            Assert::IsTrue(eagerBytesPerRow > 2 * lazyBytesPerRow);
+
+            Assert::IsTrue(lazyMs < maxMs);
+            Assert::IsTrue(lazyMs <= eagerMs);
+        }
+    };
+}
@@ -0,0 +1,134 @@
+﻿#include "pch.h"
+#include "CppUnitTest.h"
+#include "../WinMgmt/Core/SchemaCache.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTests
+{
+    using SchemaCache = Wmi::BasicSchemaCache<std::wstring>;
+
+    // Fake object source: reports a fixed property layout and counts how often it was enumerated.
+    struct FakeClass
+    {
+        std::vector<std::pair<std::wstring, Wmi::PropertyType>> properties;
+        mutable std::atomic<int> enumerations{ 0 };
+
+        auto Enumerator() const
+        {
+            return [this](auto&& add)
+            {
+                ++enumerations;
+                for (auto const& [name, type] : properties)
+                    add({ name, type });
+            };
+        }
+    };
+
+    static FakeClass Win32Process()
+    {
+        return { { { L"Caption", Wmi::PropertyType::String }, { L"Name", Wmi::PropertyType::String },
+                   { L"ProcessId", Wmi::PropertyType::UInt32 }, { L"WorkingSetSize", Wmi::PropertyType::UInt64 } } };
+    }
+
+    static FakeClass Win32Service()
+    {
+        return { { { L"Caption", Wmi::PropertyType::String }, { L"Name", Wmi::PropertyType::String },
+                   { L"Started", Wmi::PropertyType::Boolean } } };
+    }
+
+    TEST_CLASS(SchemaCacheTests)
+    {
+    public:
+
+        // ---------------------------------------------------------------------
+        // Schema_Is_Enumerated_Once_Per_Class
+        // - 500 objects of one class enumerate the layout once and share one schema
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Schema_Is_Enumerated_Once_Per_Class)
+        {
+            SchemaCache cache;
+            auto process = Win32Process();
+
+            auto first = cache.GetOrAdd(L"ROOT\\CIMV2", L"Win32_Process", process.Enumerator());
+            for (int i = 1; i < 500; ++i)
+            {
+                auto schema = cache.GetOrAdd(L"ROOT\\CIMV2", L"Win32_Process", process.Enumerator());
+                Assert::IsTrue(schema == first);
+                Assert::IsTrue(&schema->Name(1) == &first->Name(1), L"Property name was copied instead of shared.");
+            }
+
+            auto stats = cache.Stats();
+            Assert::AreEqual(1, process.enumerations.load());
+            Assert::AreEqual<std::uint64_t>(1, stats.misses);
+            Assert::AreEqual<std::uint64_t>(499, stats.hits);
+        }
+
+        // ---------------------------------------------------------------------
+        // Lookup_Is_Case_Insensitive_On_Key_And_Indexed_By_Name
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Lookup_Is_Case_Insensitive_On_Key_And_Indexed_By_Name)
+        {
+            SchemaCache cache;
+            auto process = Win32Process();
+            cache.GetOrAdd(L"ROOT\\CIMV2", L"Win32_Process", process.Enumerator());
+
+            auto schema = cache.Find(L"root\\cimv2", L"win32_process");
+            Assert::IsTrue(schema != nullptr);
+            Assert::AreEqual<std::size_t>(3, *schema->Find(L"WorkingSetSize"));
+            Assert::IsTrue(schema->Type(3) == Wmi::PropertyType::UInt64);
+            Assert::IsFalse(schema->Find(L"Missing").has_value());
+        }
+
+        // ---------------------------------------------------------------------
+        // Names_Are_Interned_Across_Classes
+        // - Caption/Name shared by two classes are stored once
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Names_Are_Interned_Across_Classes)
+        {
+            SchemaCache cache;
+            auto process = Win32Process();
+            auto service = Win32Service();
+
+            cache.GetOrAdd(L"ROOT\\CIMV2", L"Win32_Process", process.Enumerator());
+            cache.GetOrAdd(L"ROOT\\CIMV2", L"Win32_Service", service.Enumerator());
+            cache.GetOrAdd(L"ROOT\\StandardCimv2", L"Win32_Service", service.Enumerator());
+
+            auto stats = cache.Stats();
+            Assert::AreEqual<std::size_t>(3, stats.classes);
+            Assert::AreEqual<std::size_t>(5, stats.internedNames);
+        }
+
+        // ---------------------------------------------------------------------
+        // Concurrent_Resolve_Produces_Single_Schema
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Concurrent_Resolve_Produces_Single_Schema)
+        {
+            SchemaCache cache;
+            auto process = Win32Process();
+
+            constexpr int threadCount = 8;
+            std::vector<std::thread> threads;
+            std::vector<SchemaCache::schema_ptr> results(threadCount);
+
+            for (int t = 0; t < threadCount; ++t)
+            {
+                threads.emplace_back([&, t]()
+                    {
+                        for (int i = 0; i < 1000; ++i)
+                            results[t] = cache.GetOrAdd(L"ROOT\\CIMV2", L"Win32_Process", process.Enumerator());
+                    });
+            }
+            for (auto& t : threads) t.join();
+
+            for (auto const& r : results)
+                Assert::IsTrue(r == results[0]);
+            Assert::AreEqual<std::size_t>(1, cache.Stats().classes);
+        }
+    };
+}
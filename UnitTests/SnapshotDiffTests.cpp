@@ -0,0 +1,263 @@
+﻿#include "pch.h"
+#include "CppUnitTest.h"
+#include "../WinMgmt/Core/SnapshotDiff.h"
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTests
+{
+    struct SyntheticProcess
+    {
+        std::uint32_t id = 0;
+        std::wstring name;
+        std::uint64_t workingSet = 0;
+        double load = 0.0;
+        bool critical = false;
+    };
+
+    static std::vector<SyntheticProcess> MakeProcesses(std::size_t count)
+    {
+        std::vector<SyntheticProcess> processes;
+        processes.reserve(count);
+        for (std::size_t i = 0; i < count; ++i)
+            processes.push_back({ static_cast<std::uint32_t>(i), L"process" + std::to_wstring(i % 97) + L".exe", i * 4096, static_cast<double>(i % 100), i % 3 == 0 });
+        return processes;
+    }
+
+    // Win32_Process-like snapshot, optionally with the __PATH WMI would report.
+    static Wmi::ResultTable MakeSnapshot(std::vector<SyntheticProcess> const& processes, bool withPath = true)
+    {
+        Wmi::ResultTable table;
+        std::size_t path = 0;
+        if (withPath)
+            path = table.AddColumn(L"__PATH", Wmi::PropertyType::String);
+        auto name = table.AddColumn(L"Name", Wmi::PropertyType::String);
+        auto pid = table.AddColumn(L"ProcessId", Wmi::PropertyType::UInt32);
+        auto ws = table.AddColumn(L"WorkingSetSize", Wmi::PropertyType::UInt64);
+        auto cpu = table.AddColumn(L"PercentProcessorTime", Wmi::PropertyType::Double);
+        auto crit = table.AddColumn(L"Critical", Wmi::PropertyType::Boolean);
+        table.Reserve(processes.size());
+
+        for (auto const& process : processes)
+        {
+            table.BeginRow();
+            if (withPath)
+                table.AppendString(path, L"\\\\HOST\\root\\cimv2:Win32_Process.Handle=\"" + std::to_wstring(process.id) + L"\"");
+            table.AppendString(name, process.name);
+            table.AppendInteger(pid, process.id);
+            table.AppendInteger(ws, static_cast<std::int64_t>(process.workingSet));
+            table.AppendReal(cpu, process.load);
+            table.AppendBoolean(crit, process.critical);
+            table.EndRow();
+        }
+        return table;
+    }
+
+    static std::vector<std::wstring> ChangedNames(Wmi::SnapshotDiff const& diff, Wmi::RowChange const& change)
+    {
+        std::vector<std::wstring> names;
+        for (auto property : diff.ChangedProperties(change))
+            names.emplace_back(diff.PropertyName(property));
+        return names;
+    }
+
+    TEST_CLASS(SnapshotDiffTests)
+    {
+    public:
+
+        // ---------------------------------------------------------------------
+        // Reordered_Identical_Snapshots_Have_No_Changes
+        // - Objects are matched by identity, not by position
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Reordered_Identical_Snapshots_Have_No_Changes)
+        {
+            auto processes = MakeProcesses(500);
+            auto before = MakeSnapshot(processes);
+            std::reverse(processes.begin(), processes.end());
+            auto after = MakeSnapshot(processes);
+
+            Wmi::SnapshotDiffer differ;
+            auto diff = differ.Diff(before, after);
+
+            Assert::IsTrue(diff.Empty());
+            Assert::AreEqual<std::size_t>(500, diff.Unchanged());
+        }
+
+        // ---------------------------------------------------------------------
+        // Reports_Added_Removed_And_Changed_Properties
+        // - Each changed object lists exactly the properties that differ
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Reports_Added_Removed_And_Changed_Properties)
+        {
+            auto processes = MakeProcesses(100);
+            auto before = MakeSnapshot(processes);
+
+            processes[10].workingSet += 1;
+            processes[20].name = L"renamed.exe";
+            processes[20].critical = !processes[20].critical;
+            processes.erase(processes.begin() + 30);
+            processes.push_back({ 1000, L"new.exe", 1, 0.0, false });
+            auto after = MakeSnapshot(processes);
+
+            Wmi::SnapshotDiffer differ;
+            auto diff = differ.Diff(before, after);
+
+            Assert::AreEqual<std::size_t>(1, diff.Added().size());
+            Assert::AreEqual<std::uint32_t>(99, diff.Added()[0]);
+            Assert::AreEqual<std::size_t>(1, diff.Removed().size());
+            Assert::AreEqual<std::uint32_t>(30, diff.Removed()[0]);
+            Assert::AreEqual<std::size_t>(97, diff.Unchanged());
+
+            auto changed = diff.Changed();
+            Assert::AreEqual<std::size_t>(2, changed.size());
+            Assert::AreEqual<std::uint32_t>(10, changed[0].before);
+            Assert::IsTrue(ChangedNames(diff, changed[0]) == std::vector<std::wstring>{ L"WorkingSetSize" });
+            Assert::AreEqual<std::uint32_t>(20, changed[1].after);
+            Assert::IsTrue(ChangedNames(diff, changed[1]) == std::vector<std::wstring>{ L"Name", L"Critical" });
+        }
+
+        // ---------------------------------------------------------------------
+        // Key_Properties_Match_Objects_Without_Path
+        // - Without __PATH the caller names the keys; a missing key is rejected
+        //   unless one side is empty
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Key_Properties_Match_Objects_Without_Path)
+        {
+            auto processes = MakeProcesses(50);
+            auto before = MakeSnapshot(processes, false);
+            processes[5].load = 99.5;
+            std::swap(processes[1], processes[40]);
+            auto after = MakeSnapshot(processes, false);
+
+            Wmi::SnapshotDiffer differ;
+            Assert::ExpectException<std::invalid_argument>([&] { (void)differ.Diff(before, after); });
+
+            const std::vector<std::wstring> keys{ L"ProcessId" };
+            auto diff = differ.Diff(before, after, keys);
+            Assert::AreEqual<std::size_t>(1, diff.Changed().size());
+            Assert::IsTrue(ChangedNames(diff, diff.Changed()[0]) == std::vector<std::wstring>{ L"PercentProcessorTime" });
+            Assert::AreEqual<std::size_t>(49, diff.Unchanged());
+
+            const std::vector<std::wstring> missing{ L"Handle" };
+            Assert::ExpectException<std::invalid_argument>([&] { (void)differ.Diff(before, after, missing); });
+
+            // An empty side has nothing to match, whatever its columns.
+            Wmi::ResultTable empty;
+            Assert::AreEqual<std::size_t>(50, differ.Diff(before, empty, missing).Removed().size());
+            Assert::AreEqual<std::size_t>(50, differ.Diff(empty, after).Added().size());
+        }
+
+        // ---------------------------------------------------------------------
+        // Schema_Differences_And_Duplicate_Keys
+        // - A property only one snapshot has counts as null in the other
+        // - Rows sharing a key pair up in order instead of all matching the first
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Schema_Differences_And_Duplicate_Keys)
+        {
+            Wmi::ResultTable before;
+            auto name = before.AddColumn(L"Name", Wmi::PropertyType::String);
+            for (int i = 0; i < 3; ++i)
+            {
+                before.BeginRow();
+                before.AppendString(name, L"dup");
+                before.EndRow();
+            }
+
+            Wmi::ResultTable after;
+            name = after.AddColumn(L"Name", Wmi::PropertyType::String);
+            auto state = after.AddColumn(L"State", Wmi::PropertyType::String);
+            for (int i = 0; i < 2; ++i)
+            {
+                after.BeginRow();
+                after.AppendString(name, L"dup");
+                if (i == 1)
+                    after.AppendString(state, L"Running");
+                after.EndRow();
+            }
+
+            const std::vector<std::wstring> keys{ L"Name" };
+            Wmi::SnapshotDiffer differ;
+            auto diff = differ.Diff(before, after, keys);
+
+            Assert::AreEqual<std::size_t>(0, diff.Added().size());
+            Assert::AreEqual<std::size_t>(1, diff.Removed().size());
+            Assert::AreEqual<std::uint32_t>(2, diff.Removed()[0]);
+            Assert::AreEqual<std::size_t>(1, diff.Unchanged());
+            Assert::AreEqual<std::size_t>(1, diff.Changed().size());
+            Assert::AreEqual<std::uint32_t>(1, diff.Changed()[0].before);
+            Assert::IsTrue(ChangedNames(diff, diff.Changed()[0]) == std::vector<std::wstring>{ L"State" });
+        }
+
+        // ---------------------------------------------------------------------
+        // SnapshotDiff_Large_Synthetic_Pair_Performance_Test
+        // - 200k objects with 1% changed, 0.5% removed and 0.5% added, shuffled:
+        //   the hashed diff must find exactly those and beat a keyed map with
+        //   property-by-property comparison
+        // ---------------------------------------------------------------------
+        TEST_METHOD(SnapshotDiff_Large_Synthetic_Pair_Performance_Test)
+        {
+            constexpr std::size_t objects = 200'000;
+            constexpr long long maxMs = 250;
+
+            auto processes = MakeProcesses(objects);
+            auto before = MakeSnapshot(processes);
+
+            std::mt19937 random{ 42 };
+            for (std::size_t i = 0; i < objects; i += 100)
+                processes[i].workingSet += 4096;
+            for (std::size_t i = 1; i < objects; i += 200)
+                processes[i].id = static_cast<std::uint32_t>(objects + i);
+            std::shuffle(processes.begin(), processes.end(), random);
+            auto after = MakeSnapshot(processes);
+
+            Wmi::SnapshotDiffer differ;
+            Wmi::SnapshotDiff diff;
+            differ.Diff(before, after, {}, diff);
+
+            // Second run reuses the warm buffers, as a polling refresh would.
+            auto start = std::chrono::high_resolution_clock::now();
+            differ.Diff(before, after, {}, diff);
+            auto hashedTime = std::chrono::high_resolution_clock::now() - start;
+
+            Assert::AreEqual<std::size_t>(objects / 100, diff.Changed().size());
+            Assert::AreEqual<std::size_t>(objects / 200, diff.Added().size());
+            Assert::AreEqual<std::size_t>(objects / 200, diff.Removed().size());
+
+            start = std::chrono::high_resolution_clock::now();
+            auto const& beforePath = before.GetColumn(*before.Find(L"__PATH"));
+            auto const& afterPath = after.GetColumn(*after.Find(L"__PATH"));
+            std::map<std::wstring_view, std::size_t> index;
+            for (std::size_t row = 0; row < before.RowCount(); ++row)
+                index.emplace(beforePath.GetString(row), row);
+
+            std::size_t naiveChanged = 0;
+            for (std::size_t row = 0; row < after.RowCount(); ++row)
+            {
+                auto it = index.find(afterPath.GetString(row));
+                if (it == index.end())
+                    continue;
+
+                for (std::size_t column = 0; column < after.ColumnCount(); ++column)
+                {
+                    if (!(before.GetColumn(column).GetValue(it->second) == after.GetColumn(column).GetValue(row)))
+                    {
+                        ++naiveChanged;
+                        break;
+                    }
+                }
+            }
+            auto naiveTime = std::chrono::high_resolution_clock::now() - start;
+
+            Assert::AreEqual(naiveChanged, diff.Changed().size());
+            Assert::IsTrue(hashedTime < naiveTime, L"Hashed diff is slower than a keyed map.");
+            Assert::IsTrue(std::chrono::duration_cast<std::chrono::milliseconds>(hashedTime).count() < maxMs, L"Snapshot diff is too slow.");
+        }
+    };
+}
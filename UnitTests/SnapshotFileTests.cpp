@@ -0,0 +1,295 @@
+﻿#include "pch.h"
+#include "CppUnitTest.h"
+#include "../WinMgmt/Core/ReplayBackend.h"
+#include "../WinMgmt/Core/SnapshotFile.h"
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTests
+{
+    // Snapshot bytes copied into 8-byte aligned storage, as a mapping would be.
+    struct SnapshotBytes
+    {
+        std::vector<std::uint64_t> words;
+        std::size_t size = 0;
+
+        explicit SnapshotBytes(std::string const& bytes) : words((bytes.size() + 7) / 8), size(bytes.size())
+        {
+            std::memcpy(words.data(), bytes.data(), bytes.size());
+        }
+
+        [[nodiscard]] std::span<const std::byte> Span() const noexcept { return { reinterpret_cast<const std::byte*>(words.data()), size }; }
+        [[nodiscard]] std::byte* Data() noexcept { return reinterpret_cast<std::byte*>(words.data()); }
+    };
+
+    // One Win32_Process-like row per index, with nulls, repeated and unique strings.
+    static std::shared_ptr<Wmi::ResultTable> MakeProcessTable(std::size_t rows, std::shared_ptr<Wmi::StringPool> pool = nullptr)
+    {
+        auto table = std::make_shared<Wmi::ResultTable>(std::move(pool));
+        auto name = table->AddColumn(L"Name", Wmi::PropertyType::String);
+        auto pid = table->AddColumn(L"ProcessId", Wmi::PropertyType::UInt32);
+        auto size = table->AddColumn(L"WorkingSetSize", Wmi::PropertyType::UInt64);
+        auto cpu = table->AddColumn(L"PercentProcessorTime", Wmi::PropertyType::Double);
+        auto critical = table->AddColumn(L"Critical", Wmi::PropertyType::Boolean);
+        auto path = table->AddColumn(L"ExecutablePath", Wmi::PropertyType::String);
+
+        table->Reserve(rows);
+        for (std::size_t row = 0; row < rows; ++row)
+        {
+            table->BeginRow();
+            table->AppendString(name, L"process" + std::to_wstring(row % 50) + L".exe");
+            table->AppendInteger(pid, static_cast<std::int64_t>(4 + row * 4));
+            table->AppendInteger(size, static_cast<std::int64_t>(18'446'744'073'709'551'615ull - row));
+            if (row % 7 != 0)
+                table->AppendReal(cpu, row * 0.25);
+            table->AppendBoolean(critical, row % 3 == 0);
+            table->AppendString(path, L"C:\\Program Files\\App" + std::to_wstring(row) + L"\\app.exe");
+            table->EndRow();
+        }
+        return table;
+    }
+
+    static std::string WriteSnapshot(std::vector<std::pair<std::wstring, Wmi::ResultTablePtr>> const& results, std::wstring_view className = L"Win32_Process")
+    {
+        std::stringstream out{ std::ios::in | std::ios::out | std::ios::binary };
+        Wmi::SnapshotWriter writer{ out };
+        for (auto const& [query, table] : results)
+            writer.Add(L"ROOT\\CIMV2", query, *table, className);
+        writer.Finish();
+        return out.str();
+    }
+
+    static bool SameCells(Wmi::ResultTable const& expected, Wmi::ResultTable const& actual)
+    {
+        if (expected.RowCount() != actual.RowCount() || expected.ColumnCount() != actual.ColumnCount())
+            return false;
+
+        for (std::size_t c = 0; c < expected.ColumnCount(); ++c)
+        {
+            if (expected.GetColumn(c).Name() != actual.GetColumn(c).Name() || expected.GetColumn(c).Type() != actual.GetColumn(c).Type())
+                return false;
+            for (std::size_t row = 0; row < expected.RowCount(); ++row)
+            {
+                if (!(expected.GetColumn(c).GetValue(row) == actual.GetColumn(c).GetValue(row)))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    TEST_CLASS(SnapshotFileTests)
+    {
+    public:
+        // ---------------------------------------------------------------
+        // SnapshotFile_RoundTrips_Every_Column_Test
+        // - Values, nulls, UInt64 bit patterns and strings outside the
+        //   BMP read back in place and through ToTable
+        // - Pooled string columns are written like inline ones
+        // ---------------------------------------------------------------
+        TEST_METHOD(SnapshotFile_RoundTrips_Every_Column_Test)
+        {
+            auto table = MakeProcessTable(200, std::make_shared<Wmi::StringPool>());
+            auto note = table->AddColumn(L"Description", Wmi::PropertyType::String);
+            table->BeginRow();
+            table->AppendString(note, L"caf\u00e9 \U0001F600");
+            table->EndRow();
+
+            SnapshotBytes bytes{ WriteSnapshot({ { L"SELECT * FROM Win32_Process", table } }) };
+            Wmi::SnapshotReader reader{ bytes.Span() };
+
+            Assert::AreEqual<std::size_t>(1, reader.ResultCount());
+            auto result = reader.Result(0);
+            Assert::IsTrue(result.Namespace() == u"ROOT\\CIMV2");
+            Assert::IsTrue(result.Query() == u"SELECT * FROM Win32_Process");
+            Assert::IsTrue(result.ClassName() == u"Win32_Process");
+            Assert::AreEqual<std::size_t>(201, result.RowCount());
+            Assert::AreEqual<std::size_t>(7, result.ColumnCount());
+
+            Assert::IsTrue(result.ColumnName(1) == u"ProcessId");
+            Assert::IsTrue(result.ColumnType(2) == Wmi::PropertyType::UInt64);
+            Assert::AreEqual<std::int64_t>(44, result.GetInt64(10, 1));
+            Assert::AreEqual<std::uint64_t>(18'446'744'073'709'551'605ull, result.GetUInt64(10, 2));
+            Assert::IsTrue(result.IsNull(14, 3));
+            Assert::AreEqual(2.5, result.GetDouble(10, 3));
+            Assert::IsTrue(result.GetBoolean(9, 4));
+            Assert::IsTrue(result.GetString(10, 0) == u"process10.exe");
+            Assert::IsTrue(result.GetString(200, 6) == u"caf\u00e9 \U0001F600");
+            Assert::IsTrue(result.IsNull(200, 0) && result.IsNull(0, 6));
+            Assert::IsTrue(*result.Find(u"Critical") == 4);
+            Assert::IsFalse(result.Find(u"critical").has_value());
+
+            Assert::IsTrue(SameCells(*table, *result.ToTable()));
+        }
+
+        // ---------------------------------------------------------------
+        // SnapshotFile_Stores_Strings_And_Schemas_Once_Test
+        // - Repeated values, names and namespaces share one string id
+        // - Results of the same class and columns share a schema, and are
+        //   found by namespace (any case) and exact query
+        // ---------------------------------------------------------------
+        TEST_METHOD(SnapshotFile_Stores_Strings_And_Schemas_Once_Test)
+        {
+            SnapshotBytes bytes{ WriteSnapshot({
+                { L"SELECT * FROM Win32_Process", MakeProcessTable(1000) },
+                { L"SELECT * FROM Win32_Process WHERE ProcessId > 4", MakeProcessTable(500) } }) };
+            Wmi::SnapshotReader reader{ bytes.Span() };
+
+            // "", namespace, class, 6 column names, 2 queries, 50 names and 1000 paths.
+            Assert::AreEqual<std::size_t>(1 + 1 + 1 + 6 + 2 + 50 + 1000, reader.StringCount());
+
+            auto first = reader.Result(0);
+            auto second = reader.Result(1);
+            auto ids = first.StringIds(0);
+            Assert::AreEqual(ids[3], ids[53]);
+            Assert::AreEqual(ids[3], second.StringIds(0)[3]);
+            Assert::IsTrue(first.ColumnName(5).data() == second.ColumnName(5).data());
+
+            auto found = reader.Find(u"root\\cimv2", u"SELECT * FROM Win32_Process WHERE ProcessId > 4");
+            Assert::IsTrue(found.has_value());
+            Assert::AreEqual<std::size_t>(500, found->RowCount());
+            Assert::IsFalse(reader.Find(u"root\\cimv2", u"select * from Win32_Process").has_value());
+        }
+
+        // ---------------------------------------------------------------
+        // SnapshotFile_Rejects_Damaged_Files_Test
+        // - Foreign bytes, a newer major version and truncation throw
+        // - A newer minor version still reads
+        // - A damaged string id reads as an empty string
+        // ---------------------------------------------------------------
+        TEST_METHOD(SnapshotFile_Rejects_Damaged_Files_Test)
+        {
+            const auto good = WriteSnapshot({ { L"q", MakeProcessTable(10) } });
+
+            Assert::ExpectException<std::invalid_argument>([] { Wmi::SnapshotReader{ SnapshotBytes{ std::string(64, 'x') }.Span() }; });
+            Assert::ExpectException<std::invalid_argument>([] { Wmi::SnapshotReader{ SnapshotBytes{ std::string{} }.Span() }; });
+            Assert::ExpectException<std::invalid_argument>([&] { Wmi::SnapshotReader{ SnapshotBytes{ good.substr(0, good.size() - 8) }.Span() }; });
+
+            SnapshotBytes newer{ good };
+            newer.Data()[8] = std::byte{ 2 };
+            Assert::ExpectException<std::invalid_argument>([&] { Wmi::SnapshotReader{ newer.Span() }; });
+
+            SnapshotBytes minor{ good };
+            minor.Data()[10] = std::byte{ 7 };
+            Assert::AreEqual<std::uint16_t>(7, Wmi::SnapshotReader{ minor.Span() }.Minor());
+
+            // Row 0's name is the first id of the first column block, right after the header.
+            SnapshotBytes damaged{ good };
+            Wmi::SnapshotReader before{ damaged.Span() };
+            auto offset = reinterpret_cast<const std::byte*>(before.Result(0).StringIds(0).data()) - damaged.Span().data();
+            std::uint32_t bad = 0xFFFFFFF0;
+            std::memcpy(damaged.Data() + offset, &bad, sizeof(bad));
+
+            Wmi::SnapshotReader reader{ damaged.Span() };
+            Assert::IsTrue(reader.Result(0).GetString(0, 0).empty());
+            Assert::IsTrue(reader.Result(0).GetString(1, 0) == u"process1.exe");
+        }
+
+        // ---------------------------------------------------------------
+        // SnapshotFile_Replays_From_A_Mapped_File_Test
+        // - ReplayBackend saves to a file, which is mapped and loaded into
+        //   another backend with identical results
+        // ---------------------------------------------------------------
+        TEST_METHOD(SnapshotFile_Replays_From_A_Mapped_File_Test)
+        {
+            auto path = std::filesystem::temp_directory_path() / "SnapshotFile_Replays_From_A_Mapped_File_Test.wmisnap";
+
+            Wmi::ReplayBackend recorder;
+            recorder.Add(L"ROOT\\CIMV2", L"SELECT * FROM Win32_Process", MakeProcessTable(300));
+            recorder.Add(L"ROOT\\WMI", L"SELECT * FROM MSAcpi_ThermalZoneTemperature", MakeProcessTable(3));
+            {
+                std::ofstream out{ path, std::ios::binary | std::ios::trunc };
+                Wmi::SnapshotWriter writer{ out };
+                recorder.Save(writer);
+                writer.Finish();
+            }
+
+            Wmi::ReplayBackend replay;
+            {
+                auto reader = Wmi::SnapshotReader::Open(path);
+                Assert::AreEqual<std::size_t>(std::filesystem::file_size(path), reader.Size());
+                replay.Load(reader);
+            }
+            std::filesystem::remove(path);
+
+            Assert::IsTrue(SameCells(*MakeProcessTable(300), *replay.Execute(L"root\\cimv2", L"SELECT * FROM Win32_Process")));
+            Assert::IsTrue(SameCells(*MakeProcessTable(3), *replay.Execute(L"root\\wmi", L"SELECT * FROM MSAcpi_ThermalZoneTemperature")));
+            Assert::ExpectException<std::runtime_error>([&] { (void)Wmi::SnapshotReader::Open(path); });
+        }
+
+        // ---------------------------------------------------------------
+        // Performance_Mapped_Snapshot_Load
+        // - Writes a 1M-row snapshot file and maps it
+        // - Expects opening to take under openMs whatever the row count,
+        //   a full scan of every column within maxMs, and both together
+        //   to beat loading the same rows from the text format 10x
+        // ---------------------------------------------------------------
+        TEST_METHOD(Performance_Mapped_Snapshot_Load)
+        {
+            constexpr std::size_t rows = 1'000'000;
+            constexpr long long openMs = 5;
+            constexpr long long maxMs = 500;
+
+            auto path = std::filesystem::temp_directory_path() / "Performance_Mapped_Snapshot_Load.wmisnap";
+            Wmi::ReplayBackend recorder;
+            recorder.Add(L"ROOT\\CIMV2", L"SELECT * FROM Win32_Process", MakeProcessTable(rows));
+            {
+                std::ofstream out{ path, std::ios::binary | std::ios::trunc };
+                Wmi::SnapshotWriter writer{ out };
+                recorder.Save(writer);
+                writer.Finish();
+            }
+
+            auto start = std::chrono::high_resolution_clock::now();
+            auto reader = Wmi::SnapshotReader::Open(path);
+            auto opened = std::chrono::high_resolution_clock::now();
+
+            auto result = reader.Result(0);
+            std::int64_t pids = 0;
+            double cpu = 0;
+            std::size_t critical = 0;
+            std::size_t characters = 0;
+            for (auto pid : result.Integers(1))
+                pids += pid;
+            for (std::size_t row = 0; row < rows; ++row)
+            {
+                if (!result.IsNull(row, 3))
+                    cpu += result.GetDouble(row, 3);
+                critical += result.GetBoolean(row, 4) ? 1 : 0;
+                characters += result.GetString(row, 0).size() + result.GetString(row, 5).size();
+            }
+            auto scanned = std::chrono::high_resolution_clock::now();
+
+            const auto text = recorder.Save();
+            auto textStart = std::chrono::high_resolution_clock::now();
+            Wmi::ReplayBackend parsed;
+            parsed.Load(text);
+            auto textLoaded = std::chrono::high_resolution_clock::now();
+
+            std::filesystem::remove(path);
+
+            using std::chrono::duration_cast;
+            using std::chrono::microseconds;
+            const auto openUs = duration_cast<microseconds>(opened - start).count();
+            const auto binaryUs = duration_cast<microseconds>(scanned - start).count();
+            const auto textUs = duration_cast<microseconds>(textLoaded - textStart).count();
+
+            Assert::AreEqual<std::int64_t>(static_cast<std::int64_t>(4 * rows + 2 * rows * (rows - 1)), pids);
+            Assert::AreEqual<std::size_t>((rows + 2) / 3, critical);
+            Assert::IsTrue(cpu > 0 && characters > rows * 30);
+
+            Assert::IsTrue(openUs < openMs * 1000);
+            Assert::IsTrue(binaryUs < maxMs * 1000);
+            Assert::IsTrue(binaryUs * 10 < textUs);
+        }
+    };
+}
@@ -0,0 +1,254 @@
+﻿#include "pch.h"
+#include "CppUnitTest.h"
+#include "../WinMgmt/Core/ResultTable.h"
+#include "../WinMgmt/Core/StringPool.h"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTests
+{
+    // Columns of a synthetic Win32_PnPEntity result: one unique per device, the rest
+    // repeating with the cardinalities seen on real machines.
+    static const wchar_t* const PnPColumns[] = {
+        L"DeviceID", L"Name", L"Description", L"Manufacturer", L"Status", L"Service",
+        L"ClassGuid", L"PNPClass", L"CreationClassName", L"SystemCreationClassName", L"SystemName"
+    };
+
+    static std::wstring PnPCell(std::size_t column, std::size_t row)
+    {
+        switch (column)
+        {
+        case 0:  return L"PCI\\VEN_8086&DEV_" + std::to_wstring(1000 + row) + L"&SUBSYS_00008086&REV_00\\3&11583659&0&" + std::to_wstring(row % 97);
+        case 1:
+        case 2:  return L"Intel(R) Generic Device Function " + std::to_wstring(row % 300);
+        case 3:  return L"(Standard system devices) vendor " + std::to_wstring(row % 30);
+        case 4:  return row % 500 == 0 ? L"Error" : L"OK";
+        case 5:  return L"service" + std::to_wstring(row % 100);
+        case 6:  return L"{4d36e97d-e325-11ce-bfc1-08002be10" + std::to_wstring(100 + row % 40) + L"}";
+        case 7:  return L"Class" + std::to_wstring(row % 40);
+        case 8:  return L"Win32_PnPEntity";
+        case 9:  return L"Win32_ComputerSystem";
+        default: return L"WORKSTATION-0042";
+        }
+    }
+
+    static void FillPnPTable(Wmi::ResultTable& table, std::size_t rows)
+    {
+        std::vector<std::size_t> columns;
+        for (auto name : PnPColumns)
+            columns.push_back(table.AddColumn(name, Wmi::PropertyType::String));
+
+        for (std::size_t row = 0; row < rows; ++row)
+        {
+            table.BeginRow();
+            for (std::size_t c = 0; c < columns.size(); ++c)
+                table.AppendString(columns[c], PnPCell(c, row));
+            table.EndRow();
+        }
+    }
+
+    TEST_CLASS(StringPoolTests)
+    {
+    public:
+        // ---------------------------------------------------------------
+        // StringPool_Keeps_One_Copy_Per_Distinct_String_Test
+        // - Interns three values, two of them twice
+        // - Expects equal strings to share one handle, and the stats to
+        //   count requests, distinct strings and bytes saved
+        // ---------------------------------------------------------------
+        TEST_METHOD(StringPool_Keeps_One_Copy_Per_Distinct_String_Test)
+        {
+            Wmi::StringPool pool;
+
+            bool added = false;
+            auto ok = pool.Intern(L"OK", added);
+            Assert::IsTrue(added);
+            Assert::IsTrue(ok == pool.Intern(std::wstring{ L"OK" }, added));
+            Assert::IsFalse(added);
+
+            auto error = pool.Intern(L"Error");
+            Assert::IsFalse(ok == error);
+            Assert::IsTrue(pool.Intern(L"Error") == error);
+
+            auto empty = pool.Intern(L"");
+            Assert::IsTrue(static_cast<bool>(empty));
+            Assert::IsTrue(empty.View().empty());
+
+            Assert::AreEqual(L"OK", std::wstring{ ok.View() }.c_str());
+            Assert::AreEqual(L"Error", std::wstring{ error.View() }.c_str());
+            Assert::AreEqual(L'\0', error.View().data()[5]);
+
+            auto stats = pool.Stats();
+            Assert::AreEqual<std::uint64_t>(5, stats.total);
+            Assert::AreEqual<std::uint64_t>(3, stats.unique);
+            Assert::AreEqual<std::uint64_t>(0, stats.refused);
+            Assert::AreEqual<std::uint64_t>(14 * sizeof(wchar_t), stats.bytesRequested);
+            Assert::AreEqual<std::uint64_t>(7 * sizeof(wchar_t), stats.bytesStored);
+            Assert::AreEqual<std::uint64_t>(7 * sizeof(wchar_t), stats.BytesSaved());
+        }
+
+        // ---------------------------------------------------------------
+        // StringPool_Refuses_Long_Strings_And_Stays_Within_Budget_Test
+        // - Offers a string over the length limit, then fills a small pool
+        // - Expects empty handles for both, counted as refused, while
+        //   strings already pooled are still found and the pool reports
+        //   itself close to its budget
+        // ---------------------------------------------------------------
+        TEST_METHOD(StringPool_Refuses_Long_Strings_And_Stays_Within_Budget_Test)
+        {
+            Wmi::StringPool pool{ 1024, 16 };
+
+            Assert::IsFalse(static_cast<bool>(pool.Intern(std::wstring(17, L'x'))));
+
+            std::size_t accepted = 0;
+            for (int i = 0; i < 100; ++i)
+                accepted += pool.Intern(L"value-" + std::to_wstring(i)) ? 1 : 0;
+
+            Assert::IsTrue(accepted > 0 && accepted < 100);
+            Assert::IsTrue(static_cast<bool>(pool.Intern(L"value-0")));
+
+            auto stats = pool.Stats();
+            Assert::AreEqual<std::uint64_t>(accepted, stats.unique);
+            Assert::AreEqual<std::uint64_t>(1 + 100 - accepted, stats.refused);
+            Assert::IsTrue(pool.ReservedBytes() <= pool.MaxBytes());
+            Assert::IsTrue(pool.ReservedBytes() > pool.MaxBytes() / 4 * 3);
+        }
+
+        // ---------------------------------------------------------------
+        // StringPool_Concurrent_Interning_Agrees_On_Handles_Test
+        // - 8 threads intern the same 200 values 20 times over
+        // - Expects 200 distinct strings and every thread holding the same
+        //   handle for the same value
+        // ---------------------------------------------------------------
+        TEST_METHOD(StringPool_Concurrent_Interning_Agrees_On_Handles_Test)
+        {
+            Wmi::StringPool pool;
+            std::vector<std::wstring> values;
+            for (int i = 0; i < 200; ++i)
+                values.push_back(L"Manufacturer " + std::to_wstring(i));
+
+            std::vector<std::vector<Wmi::InternedString>> seen(8, std::vector<Wmi::InternedString>(values.size()));
+            std::vector<std::thread> threads;
+            for (std::size_t t = 0; t < seen.size(); ++t)
+                threads.emplace_back([&, t] {
+                    for (int round = 0; round < 20; ++round)
+                        for (std::size_t i = 0; i < values.size(); ++i)
+                            seen[t][(i + t * 25) % values.size()] = pool.Intern(values[(i + t * 25) % values.size()]);
+                });
+            for (auto& thread : threads)
+                thread.join();
+
+            Assert::AreEqual<std::uint64_t>(200, pool.Stats().unique);
+            Assert::AreEqual<std::uint64_t>(8 * 20 * 200, pool.Stats().total);
+            for (std::size_t t = 1; t < seen.size(); ++t)
+                Assert::IsTrue(seen[t] == seen[0]);
+            for (std::size_t i = 0; i < values.size(); ++i)
+                Assert::IsTrue(seen[0][i].View() == values[i]);
+        }
+
+        // ---------------------------------------------------------------
+        // ResultTable_Pools_Only_Repeating_String_Columns_Test
+        // - Fills a pooled table with a repeating and a unique column,
+        //   plus nulls, past the sampling window
+        // - Expects the repeating column to stay pooled, the unique one to
+        //   fall back to inline storage, and every cell to read back intact
+        // ---------------------------------------------------------------
+        TEST_METHOD(ResultTable_Pools_Only_Repeating_String_Columns_Test)
+        {
+            auto pool = std::make_shared<Wmi::StringPool>();
+            Wmi::ResultTable table{ pool };
+            auto status = table.AddColumn(L"Status", Wmi::PropertyType::String);
+            auto id = table.AddColumn(L"DeviceID", Wmi::PropertyType::String);
+            auto count = table.AddColumn(L"Count", Wmi::PropertyType::UInt32);
+
+            const std::size_t rows = Wmi::Column::PoolSampleRows * 2;
+            for (std::size_t row = 0; row < rows; ++row)
+            {
+                table.BeginRow();
+                if (row % 10 == 0)
+                    table.AppendNull(status);
+                else
+                    table.AppendString(status, row % 3 ? L"OK" : L"Degraded");
+                table.AppendString(id, L"ROOT\\DEVICE\\" + std::to_wstring(row));
+                table.AppendInteger(count, static_cast<std::int64_t>(row));
+                table.EndRow();
+            }
+
+            Assert::IsTrue(table.GetColumn(status).IsPooled());
+            Assert::IsFalse(table.GetColumn(id).IsPooled());
+            Assert::IsFalse(table.GetColumn(count).IsPooled());
+
+            for (std::size_t row = 0; row < rows; ++row)
+            {
+                auto cells = table.Row(row);
+                if (row % 10 == 0)
+                {
+                    Assert::IsTrue(cells.IsNull(status));
+                    Assert::IsTrue(cells.GetString(status).empty());
+                }
+                else
+                {
+                    Assert::IsTrue(cells.GetString(status) == (row % 3 ? L"OK" : L"Degraded"));
+                }
+                Assert::IsTrue(cells.GetString(id) == L"ROOT\\DEVICE\\" + std::to_wstring(row));
+            }
+
+            Assert::IsTrue(pool->Stats().unique <= 2 + Wmi::Column::PoolSampleRows);
+        }
+
+        // ---------------------------------------------------------------
+        // Performance_Pooled_PnP_Snapshot_Memory
+        // - Builds a synthetic 50k-row Win32_PnPEntity table with and
+        //   without a pool
+        // - Expects identical cells, the repeating columns plus the pool to
+        //   take at least 4x less memory than plain ones, the whole table at
+        //   least 2x less, and the pooled build within maxMs
+        // ---------------------------------------------------------------
+        TEST_METHOD(Performance_Pooled_PnP_Snapshot_Memory)
+        {
+            constexpr std::size_t rows = 50000;
+            constexpr long long maxMs = 1500;
+
+            Wmi::ResultTable plain;
+            FillPnPTable(plain, rows);
+
+            auto pool = std::make_shared<Wmi::StringPool>();
+            Wmi::ResultTable pooled{ pool };
+            auto start = std::chrono::high_resolution_clock::now();
+            FillPnPTable(pooled, rows);
+            auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start).count();
+
+            for (std::size_t row = 0; row < rows; row += 997)
+                for (std::size_t c = 0; c < plain.ColumnCount(); ++c)
+                    Assert::IsTrue(plain.Row(row).GetString(c) == pooled.Row(row).GetString(c));
+
+            // The unique DeviceID column costs the same either way; the repeating ones are
+            // where the pool pays off.
+            std::size_t plainRepeating = 0;
+            std::size_t pooledRepeating = pool->MemoryUsage();
+            for (std::size_t c = 1; c < plain.ColumnCount(); ++c)
+            {
+                plainRepeating += plain.GetColumn(c).MemoryUsage();
+                pooledRepeating += pooled.GetColumn(c).MemoryUsage();
+            }
+            Assert::IsTrue(plainRepeating >= pooledRepeating * 4);
+
+            const auto plainBytes = plain.MemoryUsage();
+            const auto pooledBytes = pooled.MemoryUsage() + pool->MemoryUsage();
+            Assert::IsTrue(plainBytes >= pooledBytes * 2);
+
+            auto stats = pool->Stats();
+            Assert::IsTrue(stats.unique * 50 < stats.total);
+            Assert::IsTrue(stats.BytesSaved() * 10 > stats.bytesRequested * 9);
+
+            Assert::IsTrue(elapsedMs < maxMs);
+        }
+    };
+}
@@ -0,0 +1,236 @@
+﻿#include "pch.h"
+#include "CppUnitTest.h"
+#include "../WinMgmt/Core/ResultTable.h"
+#include "../WinMgmt/Core/TimeSeriesStore.h"
+
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTests
+{
+    // One Win32_PerfRawData_PerfOS_Processor-like poll: a row per processor with a
+    // steadily rising counter, a real load and a boolean.
+    static void FillProcessorPoll(Wmi::ResultTable& table, std::size_t processors, std::int64_t poll)
+    {
+        auto name = table.AddColumn(L"Name", Wmi::PropertyType::String);
+        auto time = table.AddColumn(L"PercentProcessorTime", Wmi::PropertyType::UInt64);
+        auto load = table.AddColumn(L"Load", Wmi::PropertyType::Double);
+        auto parked = table.AddColumn(L"Parked", Wmi::PropertyType::Boolean);
+        auto caption = table.AddColumn(L"Caption", Wmi::PropertyType::String);
+
+        for (std::size_t p = 0; p < processors; ++p)
+        {
+            table.BeginRow();
+            table.AppendString(name, L"CPU" + std::to_wstring(p));
+            table.AppendInteger(time, poll * 10'000'000 + static_cast<std::int64_t>(p));
+            if (poll % 4 != 3)
+                table.AppendReal(load, static_cast<double>((poll + static_cast<std::int64_t>(p)) % 8) / 4);
+            table.AppendBoolean(parked, p % 2 == 0);
+            table.AppendString(caption, L"Processor");
+            table.EndRow();
+        }
+    }
+
+    TEST_CLASS(TimeSeriesStoreTests)
+    {
+    public:
+        // ---------------------------------------------------------------
+        // TimeSeriesStore_Round_Trips_Every_Type_Test
+        // - Integer extremes, UInt64 wrap-around, reals including NaN,
+        //   infinity and -0, booleans and uneven timestamps come back from
+        //   a range scan exactly as appended, across several chunks
+        // ---------------------------------------------------------------
+        TEST_METHOD(TimeSeriesStore_Round_Trips_Every_Type_Test)
+        {
+            Wmi::TimeSeriesStore store{ Wmi::TimeSeriesOptions{ .chunkSamples = 4 } };
+
+            const std::vector<std::int64_t> times{ -5, 0, 0, 7, 1'000'000, 1'000'001, 1'700'000'000'000'000, 1'700'000'000'000'000 };
+            const std::vector<std::int64_t> integers{ 0, -1, (std::numeric_limits<std::int64_t>::max)(), (std::numeric_limits<std::int64_t>::min)(), 3, 3, -7, 12 };
+            const std::vector<double> reals{ 0.1, 0.1, -0.0, std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::infinity(), 1e-300, 12345.678, 0.1 };
+
+            for (std::size_t i = 0; i < times.size(); ++i)
+            {
+                Assert::IsTrue(store.Append(L"A", L"Int", times[i], Wmi::Value::FromInt64(integers[i])));
+                Assert::IsTrue(store.Append(L"A", L"UInt", times[i], Wmi::Value::FromUInt64(static_cast<std::uint64_t>(integers[i]) * 3)));
+                Assert::IsTrue(store.Append(L"A", L"Real", times[i], Wmi::Value::FromDouble(reals[i])));
+                Assert::IsTrue(store.Append(L"A", L"Flag", times[i], Wmi::Value::FromBoolean(i % 3 == 0)));
+            }
+
+            auto ints = store.Range(L"A", L"Int", (std::numeric_limits<std::int64_t>::min)(), (std::numeric_limits<std::int64_t>::max)());
+            auto uints = store.Range(L"A", L"UInt", (std::numeric_limits<std::int64_t>::min)(), (std::numeric_limits<std::int64_t>::max)());
+            auto realSamples = store.Range(L"A", L"Real", (std::numeric_limits<std::int64_t>::min)(), (std::numeric_limits<std::int64_t>::max)());
+            auto flags = store.Range(L"A", L"Flag", (std::numeric_limits<std::int64_t>::min)(), (std::numeric_limits<std::int64_t>::max)());
+
+            Assert::AreEqual(times.size(), ints.size());
+            Assert::AreEqual(times.size(), uints.size());
+            Assert::AreEqual(times.size(), realSamples.size());
+            Assert::AreEqual(times.size(), flags.size());
+            for (std::size_t i = 0; i < times.size(); ++i)
+            {
+                Assert::AreEqual(times[i], ints[i].time);
+                Assert::AreEqual(integers[i], ints[i].value.AsInt64());
+                Assert::IsTrue(ints[i].value.Type() == Wmi::PropertyType::Int64);
+                Assert::AreEqual(static_cast<std::uint64_t>(integers[i]) * 3, uints[i].value.AsUInt64());
+                Assert::IsTrue(uints[i].value.Type() == Wmi::PropertyType::UInt64);
+                Assert::AreEqual(std::bit_cast<std::uint64_t>(reals[i]), std::bit_cast<std::uint64_t>(realSamples[i].value.AsDouble()));
+                Assert::AreEqual(i % 3 == 0, flags[i].value.AsBoolean());
+                Assert::IsTrue(flags[i].value.Type() == Wmi::PropertyType::Boolean);
+            }
+
+            Assert::AreEqual<std::size_t>(4, store.Stats().series);
+            Assert::AreEqual<std::uint64_t>(8, store.Stats().chunks);
+        }
+
+        // ---------------------------------------------------------------
+        // TimeSeriesStore_Range_Scan_Is_Inclusive_Test
+        // - Scans return the samples with from <= time <= to, oldest first,
+        //   whether the bounds fall inside or between chunks
+        // - Unknown series and empty ranges return nothing
+        // ---------------------------------------------------------------
+        TEST_METHOD(TimeSeriesStore_Range_Scan_Is_Inclusive_Test)
+        {
+            Wmi::TimeSeriesStore store{ Wmi::TimeSeriesOptions{ .chunkSamples = 10 } };
+            for (std::int64_t t = 0; t < 100; ++t)
+                store.Append(L"CPU0", L"Load", t * 1000, Wmi::Value::FromInt64(t));
+
+            auto range = store.Range(L"CPU0", L"Load", 9'000, 21'500);
+            Assert::AreEqual<std::size_t>(13, range.size());
+            for (std::size_t i = 0; i < range.size(); ++i)
+                Assert::AreEqual(static_cast<std::int64_t>(9 + i), range[i].value.AsInt64());
+
+            std::size_t visited = store.Scan(L"CPU0", L"Load", 98'999, 1'000'000, [](Wmi::TimeSeriesSample const& sample) {
+                Assert::AreEqual<std::int64_t>(99'000, sample.time);
+            });
+            Assert::AreEqual<std::size_t>(1, visited);
+
+            Assert::IsTrue(store.Range(L"CPU0", L"Load", 1'500, 1'900).empty());
+            Assert::IsTrue(store.Range(L"CPU0", L"Load", 5'000, 4'000).empty());
+            Assert::IsTrue(store.Range(L"CPU1", L"Load", 0, 100'000).empty());
+            Assert::IsTrue(store.Range(L"CPU0", L"Other", 0, 100'000).empty());
+        }
+
+        // ---------------------------------------------------------------
+        // TimeSeriesStore_Ingests_Numeric_Columns_Test
+        // - A table poll adds one sample per non-null numeric cell, keyed
+        //   by the identity column; strings are not kept
+        // - Non-numeric values and samples older than their series' latest
+        //   are refused and counted
+        // - A missing or non-string identity column throws
+        // ---------------------------------------------------------------
+        TEST_METHOD(TimeSeriesStore_Ingests_Numeric_Columns_Test)
+        {
+            Wmi::TimeSeriesStore store;
+            for (std::int64_t poll = 0; poll < 8; ++poll)
+            {
+                Wmi::ResultTable table;
+                FillProcessorPoll(table, 4, poll);
+                std::size_t expected = poll % 4 == 3 ? 8 : 12;
+                Assert::AreEqual(expected, store.Append(poll * 1'000'000, table, L"Name"));
+            }
+
+            Assert::AreEqual<std::size_t>(12, store.Stats().series);
+            Assert::AreEqual<std::uint64_t>(4 * 8 * 2 + 4 * 6, store.Stats().samples);
+
+            auto counter = store.Range(L"CPU2", L"PercentProcessorTime", 2'000'000, 4'000'000);
+            Assert::AreEqual<std::size_t>(3, counter.size());
+            Assert::AreEqual<std::uint64_t>(20'000'002, counter[0].value.AsUInt64());
+            Assert::AreEqual<std::uint64_t>(40'000'002, counter[2].value.AsUInt64());
+            Assert::IsTrue(store.Range(L"CPU2", L"Caption", 0, 10'000'000).empty());
+
+            Assert::IsFalse(store.Append(L"CPU2", L"PercentProcessorTime", 6'999'999, Wmi::Value::FromUInt64(1)));
+            Assert::IsFalse(store.Append(L"CPU2", L"Caption", 8'000'000, Wmi::Value::FromString(L"Processor")));
+            Assert::IsFalse(store.Append(L"CPU2", L"Load", 8'000'000, Wmi::Value::Null()));
+            Assert::AreEqual<std::uint64_t>(1, store.Stats().outOfOrder);
+
+            Wmi::ResultTable table;
+            FillProcessorPoll(table, 1, 9);
+            Assert::ExpectException<std::invalid_argument>([&] { store.Append(9'000'000, table, L"Missing"); });
+            Assert::ExpectException<std::invalid_argument>([&] { store.Append(9'000'000, table, L"Load"); });
+        }
+
+        // ---------------------------------------------------------------
+        // TimeSeriesStore_Stays_Within_Memory_Budget_Test
+        // - Beyond maxBytes the oldest sealed chunks are evicted, so usage
+        //   stays under the budget while the newest samples remain
+        //   scannable and the evicted ones are counted
+        // ---------------------------------------------------------------
+        TEST_METHOD(TimeSeriesStore_Stays_Within_Memory_Budget_Test)
+        {
+            constexpr std::size_t maxBytes = 64 * 1024;
+            Wmi::TimeSeriesStore store{ Wmi::TimeSeriesOptions{ .maxBytes = maxBytes, .chunkSamples = 64 } };
+
+            for (std::int64_t t = 0; t < 50'000; ++t)
+            {
+                for (int s = 0; s < 8; ++s)
+                    store.Append(L"Proc" + std::to_wstring(s), L"WorkingSet", t * 1'000'000, Wmi::Value::FromUInt64(static_cast<std::uint64_t>(t * 7919 % 100'003) * 4096));
+                Assert::IsTrue(store.MemoryUsage() <= maxBytes);
+            }
+
+            auto stats = store.Stats();
+            Assert::IsTrue(stats.evictedSamples > 0);
+            Assert::AreEqual<std::uint64_t>(50'000 * 8, stats.samples + stats.evictedSamples);
+
+            auto latest = store.Range(L"Proc3", L"WorkingSet", 49'000'000'000, 50'000'000'000);
+            Assert::AreEqual<std::size_t>(1000, latest.size());
+            Assert::AreEqual<std::uint64_t>(static_cast<std::uint64_t>(49'999 * 7919 % 100'003) * 4096, latest.back().value.AsUInt64());
+            Assert::IsTrue(store.Range(L"Proc3", L"WorkingSet", 0, 1'000'000'000).empty());
+        }
+
+        // ---------------------------------------------------------------
+        // Performance_Time_Series_Ingest_And_Scan
+        // - Ingests an hour of one-second polls of 64 processors with four
+        //   numeric properties each, then range-scans every series
+        // - Expects at least minIngestPerSecond and minScanPerSecond
+        //   samples per second and a compression ratio of at least
+        //   minRatio for the steadily polled counters
+        // ---------------------------------------------------------------
+        TEST_METHOD(Performance_Time_Series_Ingest_And_Scan)
+        {
+            constexpr std::size_t processors = 64;
+            constexpr std::int64_t polls = 3600;
+            constexpr double minIngestPerSecond = 2e6;
+            constexpr double minScanPerSecond = 20e6;
+            constexpr double minRatio = 4;
+
+            std::vector<Wmi::ResultTable> tables(polls);
+            for (std::int64_t poll = 0; poll < polls; ++poll)
+                FillProcessorPoll(tables[poll], processors, poll);
+
+            Wmi::TimeSeriesStore store;
+            auto start = std::chrono::steady_clock::now();
+            std::size_t ingested = 0;
+            for (std::int64_t poll = 0; poll < polls; ++poll)
+                ingested += store.Append(1'700'000'000'000'000 + poll * 1'000'000, tables[poll], L"Name");
+            std::chrono::duration<double> ingest = std::chrono::steady_clock::now() - start;
+
+            start = std::chrono::steady_clock::now();
+            std::size_t scanned = 0;
+            double sum = 0;
+            for (int pass = 0; pass < 10; ++pass)
+            {
+                for (std::size_t p = 0; p < processors; ++p)
+                {
+                    for (auto property : { L"PercentProcessorTime", L"Load", L"Parked" })
+                        scanned += store.Scan(L"CPU" + std::to_wstring(p), property, 0, (std::numeric_limits<std::int64_t>::max)(),
+                            [&](Wmi::TimeSeriesSample const& sample) { sum += sample.value.AsDouble(); });
+                }
+            }
+            std::chrono::duration<double> scan = std::chrono::steady_clock::now() - start;
+
+            auto stats = store.Stats();
+            Assert::AreEqual<std::uint64_t>(ingested, stats.samples);
+            Assert::AreEqual<std::size_t>(10 * ingested, scanned);
+            Assert::IsTrue(sum > 0);
+            Assert::IsTrue(ingested / ingest.count() > minIngestPerSecond);
+            Assert::IsTrue(scanned / scan.count() > minScanPerSecond);
+            Assert::IsTrue(stats.CompressionRatio() > minRatio);
+        }
+    };
+}
@@ -1,9 +1,13 @@
-#include "pch.h"
+﻿#include "pch.h"
 #include "CppUnitTest.h"
 
 #include <winrt/WinMgmt.h>
+#include <WbemIdl.h>
 
 #include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
 #include <vector>
 #include <thread>
 #include <atomic>
@@ -221,6 +225,513 @@ namespace IntegrationTests
             Assert::IsTrue(avg < maxAverageMs, L"Average query time is too slow.");
         }
 
+        // ---------------------------------------------------------------------
+        // Wmi_QueryStream_Delivers_All_Objects_In_Batches
+        // - Stream the same query with a small batch size and compare the total against QueryAsync.
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Wmi_QueryStream_Delivers_All_Objects_In_Batches)
+        {
+            const winrt::hstring query = L"SELECT * FROM Win32_NetworkAdapterConfiguration";
+            constexpr uint32_t batchSize = 2;
+
+            auto expected = RunQueryBlocking(query).Size();
+
+            winrt::WinMgmt::WmiDataContext context;
+            auto stream = context.QueryStream(query, batchSize);
+
+            uint32_t total = 0;
+            while (true)
+            {
+                auto batch = stream.NextBatchAsync().get();
+                if (batch.Size() == 0)
+                    break;
+
+                Assert::IsTrue(batch.Size() <= batchSize, L"Batch exceeds the requested size.");
+                total += batch.Size();
+            }
+
+            Assert::IsTrue(stream.IsCompleted());
+            Assert::AreEqual(expected, total);
+        }
+
+        // ---------------------------------------------------------------------
+        // Wmi_QueryTable_Matches_Object_Query
+        // - The columnar query must return the same objects and property names as QueryAsync.
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Wmi_QueryTable_Matches_Object_Query)
+        {
+            const winrt::hstring query = L"SELECT * FROM Win32_OperatingSystem";
+
+            winrt::WinMgmt::WmiDataContext context;
+            auto objects = context.QueryAsync(query).get();
+            auto rows = context.QueryTableAsync(query).get();
+
+            Assert::AreEqual(objects.Size(), rows.Size());
+            Assert::IsTrue(rows.Size() > 0, L"No Win32_OperatingSystem instances found.");
+
+            auto caption = rows.GetAt(0).GetProperty(L"Caption");
+            Assert::IsTrue(caption.Type() == winrt::WinMgmt::PropertyType::String);
+            Assert::IsTrue(winrt::unbox_value<winrt::hstring>(caption.Value()) == winrt::unbox_value<winrt::hstring>(objects.GetAt(0).GetProperty(L"Caption").Value()));
+            Assert::AreEqual(objects.GetAt(0).Properties().Size(), rows.GetAt(0).Properties().Size());
+        }
+
+        // ---------------------------------------------------------------------
+        // Wmi_Projections_Of_Same_Width_Keep_Their_Own_Schema
+        // - Two projections of one class selecting as many properties each
+        //   return their own properties.
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Wmi_Projections_Of_Same_Width_Keep_Their_Own_Schema)
+        {
+            winrt::WinMgmt::WmiDataContext context;
+            auto names = context.QueryTableAsync(L"SELECT Name FROM Win32_OperatingSystem").get();
+            auto captions = context.QueryTableAsync(L"SELECT Caption FROM Win32_OperatingSystem").get();
+            auto objects = context.QueryAsync(L"SELECT Version FROM Win32_OperatingSystem").get();
+
+            Assert::IsFalse(names.GetAt(0).GetProperty(L"Name").AsString().empty());
+            Assert::IsFalse(captions.GetAt(0).GetProperty(L"Caption").AsString().empty());
+            Assert::AreEqual(1u, objects.GetAt(0).Properties().Size());
+            Assert::IsTrue(objects.GetAt(0).Properties().GetAt(0).Name() == L"Version");
+        }
+
+        // ---------------------------------------------------------------------
+        // Wmi_Property_Typed_Accessors_Match_Boxed_Value
+        // - TotalVisibleMemorySize is a CIM uint64; the typed accessor must agree with the boxed value.
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Wmi_Property_Typed_Accessors_Match_Boxed_Value)
+        {
+            auto query_result = RunQueryBlocking(L"SELECT * FROM Win32_OperatingSystem");
+            Assert::IsTrue(query_result.Size() > 0, L"No Win32_OperatingSystem instances found.");
+
+            auto memory = query_result.GetAt(0).GetProperty(L"TotalVisibleMemorySize");
+            Assert::IsTrue(memory.Type() == winrt::WinMgmt::PropertyType::UInt64);
+            Assert::IsTrue(memory.AsUInt64() > 0);
+            Assert::AreEqual(memory.AsUInt64(), winrt::unbox_value<uint64_t>(memory.Value()));
+        }
+
+        // ---------------------------------------------------------------------
+        // Wmi_Namespace_Change_Reconnects
+        // - Namespace set after construction must apply to the next query.
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Wmi_Namespace_Change_Reconnects)
+        {
+            winrt::WinMgmt::WmiDataContext context;
+            Assert::IsTrue(context.QueryAsync(L"SELECT * FROM Win32_OperatingSystem").get().Size() > 0);
+
+            context.Namespace(L"ROOT\\StandardCimv2");
+            Assert::IsTrue(context.QueryAsync(L"SELECT * FROM MSFT_NetAdapter").get().Size() > 0);
+
+            context.Namespace(L"ROOT\\DoesNotExist");
+            Assert::ExpectException<winrt::hresult_error>([&] { context.QueryAsync(L"SELECT * FROM Win32_OperatingSystem").get(); });
+        }
+
+        // ---------------------------------------------------------------------
+        // Wmi_Semisynchronous_Query_Matches_Asynchronous
+        // - Forward-only pulls must return the same objects as the sink-based path.
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Wmi_Semisynchronous_Query_Matches_Asynchronous)
+        {
+            const winrt::hstring query = L"SELECT * FROM Win32_Service";
+
+            winrt::WinMgmt::WmiDataContext context;
+            auto pushed = context.QueryAsync(query).get();
+
+            context.ExecutionMode(winrt::WinMgmt::WmiExecutionMode::Semisynchronous);
+            auto pulled = context.QueryAsync(query).get();
+            Assert::AreEqual(pushed.Size(), pulled.Size());
+            Assert::AreEqual(pushed.Size(), context.QueryTableAsync(query).get().Size());
+
+            auto stream = context.QueryStream(query, 16);
+            uint32_t streamed = 0;
+            for (auto batch = stream.NextBatchAsync().get(); batch.Size() > 0; batch = stream.NextBatchAsync().get())
+            {
+                Assert::IsTrue(batch.Size() <= 16);
+                streamed += batch.Size();
+            }
+            Assert::AreEqual(pushed.Size(), streamed);
+            Assert::IsTrue(stream.IsCompleted());
+        }
+
+        // ---------------------------------------------------------------------
+        // Wmi_Event_Subscription_Delivers_Coalesced_Batches
+        // - Win32_LocalTime changes every second, so a WITHIN 1 subscription sees events
+        //   in batches no larger than maxBatch, and Close ends the subscription.
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Wmi_Event_Subscription_Delivers_Coalesced_Batches)
+        {
+            const winrt::hstring query = L"SELECT * FROM __InstanceModificationEvent WITHIN 1 WHERE TargetInstance ISA 'Win32_LocalTime'";
+
+            winrt::WinMgmt::WmiDataContext context;
+            auto subscription = context.Subscribe(query, 4, std::chrono::milliseconds(100));
+
+            auto batch = subscription.NextBatchAsync().get();
+            Assert::IsTrue(batch.Size() > 0 && batch.Size() <= 4);
+            Assert::AreEqual<uint32_t>(4, subscription.MaxBatch());
+
+            subscription.Close();
+            while (subscription.NextBatchAsync().get().Size() > 0)
+            {
+            }
+            Assert::IsTrue(subscription.IsCompleted());
+        }
+
+        // ---------------------------------------------------------------------
+        // Wmi_Snapshot_Diff_Matches_Objects_By_Key
+        // - A result compared with itself is all unchanged; dropping objects from
+        //   the newer side reports exactly those as removed.
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Wmi_Snapshot_Diff_Matches_Objects_By_Key)
+        {
+            winrt::WinMgmt::WmiDataContext context;
+            auto services = context.QueryTableAsync(L"SELECT Name, State, StartMode FROM Win32_Service").get();
+            auto keys = winrt::single_threaded_vector<winrt::hstring>({ L"Name" });
+
+            auto same = winrt::WinMgmt::WmiDataContext::Diff(services, services, keys);
+            Assert::AreEqual(services.Size(), same.UnchangedCount());
+            Assert::AreEqual<uint32_t>(0, same.Added().Size() + same.Removed().Size() + same.Changed().Size());
+
+            auto empty = winrt::single_threaded_vector<winrt::WinMgmt::WmiClassObject>().GetView();
+            auto gone = winrt::WinMgmt::WmiDataContext::Diff(services, empty, keys);
+            Assert::AreEqual(services.Size(), gone.Removed().Size());
+        }
+
+        // ---------------------------------------------------------------------
+        // Wmi_Filter_Results_Can_Be_Filtered_And_Diffed_Again
+        // - A filtered result is a table of its own: filtering it again and
+        //   diffing it against its source both work.
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Wmi_Filter_Results_Can_Be_Filtered_And_Diffed_Again)
+        {
+            winrt::WinMgmt::WmiDataContext context;
+            auto processes = context.QueryTableAsync(L"SELECT Name, ProcessId FROM Win32_Process").get();
+
+            auto running = winrt::WinMgmt::WmiDataContext::Filter(processes, L"ProcessId > 0");
+            auto user = winrt::WinMgmt::WmiDataContext::Filter(running, L"ProcessId > 4");
+            Assert::IsTrue(user.Size() > 0 && user.Size() <= running.Size());
+
+            auto keys = winrt::single_threaded_vector<winrt::hstring>({ L"ProcessId" });
+            auto diff = winrt::WinMgmt::WmiDataContext::Diff(user, processes, keys);
+            Assert::AreEqual(user.Size(), diff.UnchangedCount());
+            Assert::AreEqual(processes.Size() - user.Size(), diff.Added().Size());
+        }
+
+        // ---------------------------------------------------------------------
+        // Wmi_PollScheduler_Delivers_Recurring_Results
+        // - A registered query runs repeatedly and reports each run's results.
+        // - Runs have a deadline unless it is set to zero.
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Wmi_PollScheduler_Delivers_Recurring_Results)
+        {
+            winrt::WinMgmt::WmiPollScheduler scheduler{ L"", 2 };
+            Assert::IsTrue(scheduler.Timeout().count() > 0);
+            scheduler.Timeout(std::chrono::seconds(5));
+            std::atomic<int> runs{ 0 };
+            std::atomic<bool> failed{ false };
+
+            scheduler.ResultsReady([&](auto const&, winrt::WinMgmt::WmiPollResult const& result) {
+                failed = failed || result.Status() < 0 || result.Results().Size() != 1;
+                ++runs;
+            });
+
+            auto id = scheduler.Register(L"ROOT\\CIMV2", L"SELECT Caption FROM Win32_OperatingSystem",
+                std::chrono::milliseconds(200), std::chrono::milliseconds(50), winrt::WinMgmt::WmiOverlapPolicy::Skip);
+
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+            while (runs < 3 && std::chrono::steady_clock::now() < deadline)
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+            Assert::IsTrue(scheduler.Unregister(id));
+            scheduler.Close();
+            Assert::IsTrue(runs >= 3);
+            Assert::IsFalse(failed.load());
+        }
+
+        // ---------------------------------------------------------------------
+        // Wmi_PollScheduler_Records_Numeric_History
+        // - A recorded query keeps one sample per run of each numeric property,
+        //   keyed by the identity property, readable by time range.
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Wmi_PollScheduler_Records_Numeric_History)
+        {
+            winrt::WinMgmt::WmiPollScheduler scheduler{ L"", 2 };
+            std::atomic<int> runs{ 0 };
+
+            scheduler.ResultsReady([&](auto const&, winrt::WinMgmt::WmiPollResult const&) { ++runs; });
+
+            const auto from = winrt::clock::now();
+            auto id = scheduler.Register(L"ROOT\\CIMV2", L"SELECT Name, NumberOfProcesses FROM Win32_OperatingSystem",
+                std::chrono::milliseconds(200), std::chrono::milliseconds(50), winrt::WinMgmt::WmiOverlapPolicy::Skip);
+            scheduler.RecordHistory(id, L"Name");
+
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+            while (runs < 3 && std::chrono::steady_clock::now() < deadline)
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+            Assert::IsTrue(scheduler.Unregister(id));
+            scheduler.Close();
+
+            winrt::WinMgmt::WmiDataContext context;
+            auto os = context.QueryTableAsync(L"SELECT Name FROM Win32_OperatingSystem").get();
+            auto name = winrt::unbox_value<winrt::hstring>(os.GetAt(0).GetProperty(L"Name").Value());
+
+            auto history = scheduler.History(name, L"NumberOfProcesses", from, winrt::clock::now());
+            Assert::IsTrue(history.Size() >= 3);
+            for (std::uint32_t i = 0; i < history.Size(); ++i)
+            {
+                Assert::IsTrue(history.GetAt(i).Integer > 0);
+                if (i > 0)
+                    Assert::IsTrue(history.GetAt(i).Time > history.GetAt(i - 1).Time);
+            }
+            Assert::AreEqual(0u, scheduler.History(name, L"Name", from, winrt::clock::now()).Size());
+        }
+
+        // ---------------------------------------------------------------------
+        // Wmi_FanOut_Tags_Results_By_Source
+        // - Queries across namespaces come back once each, tagged and timed.
+        // - A query against a missing namespace reports its failure without data.
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Wmi_FanOut_Tags_Results_By_Source)
+        {
+            auto namespaces = winrt::single_threaded_vector<winrt::hstring>({ L"ROOT\\CIMV2", L"ROOT\\StandardCimv2", L"ROOT\\DoesNotExist" });
+            auto queries = winrt::single_threaded_vector<winrt::hstring>({
+                L"SELECT Caption FROM Win32_OperatingSystem",
+                L"SELECT Name FROM MSFT_NetAdapter",
+                L"SELECT Caption FROM Win32_OperatingSystem" });
+
+            winrt::WinMgmt::WmiDataContext context;
+            auto stream = context.FanOut(namespaces.GetView(), queries.GetView(), 2);
+
+            std::vector<bool> seen(3, false);
+            while (auto result = stream.NextAsync().get())
+            {
+                Assert::IsFalse(seen[result.Source()]);
+                seen[result.Source()] = true;
+                Assert::AreEqual(namespaces.GetAt(result.Source()), result.Namespace());
+
+                if (result.Source() == 2)
+                {
+                    Assert::IsTrue(result.Status() < 0);
+                    Assert::AreEqual(0u, result.Results().Size());
+                }
+                else
+                {
+                    Assert::AreEqual(0, static_cast<int>(result.Status()));
+                    Assert::IsTrue(result.Elapsed().count() > 0);
+                }
+            }
+
+            Assert::IsTrue(stream.IsCompleted());
+            Assert::IsTrue(seen[0] && seen[1] && seen[2]);
+            Assert::IsTrue(stream.NextAsync().get() == nullptr);
+        }
+
+        // ---------------------------------------------------------------------
+        // Wmi_QueryAsync_Surfaces_Failure_Deadline_And_Cancellation
+        // - A provider failure is thrown instead of returning an empty result.
+        // - A query still running at its deadline fails with WBEM_E_TIMED_OUT.
+        // - Cancelling the operation ends it promptly.
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Wmi_QueryAsync_Surfaces_Failure_Deadline_And_Cancellation)
+        {
+            winrt::WinMgmt::WmiDataContext context;
+
+            try
+            {
+                context.QueryAsync(L"SELECT * FROM Win32_DoesNotExist").get();
+                Assert::Fail(L"an invalid class must not look like an empty result");
+            }
+            catch (winrt::hresult_error const& error)
+            {
+                Assert::AreEqual(static_cast<int32_t>(WBEM_E_INVALID_CLASS), static_cast<int32_t>(error.code()));
+            }
+
+            // Enumerating every file on the machine takes far longer than a millisecond.
+            context.Timeout(std::chrono::milliseconds(1));
+            auto start = std::chrono::steady_clock::now();
+            try
+            {
+                context.QueryTableAsync(L"SELECT Name FROM CIM_DataFile").get();
+                Assert::Fail(L"the query should have timed out");
+            }
+            catch (winrt::hresult_error const& error)
+            {
+                Assert::AreEqual(static_cast<int32_t>(WBEM_E_TIMED_OUT), static_cast<int32_t>(error.code()));
+            }
+            Assert::IsTrue(std::chrono::steady_clock::now() - start < std::chrono::seconds(10));
+
+            context.Timeout({});
+            auto operation = context.QueryAsync(L"SELECT Name FROM CIM_DataFile");
+            operation.Cancel();
+            Assert::ExpectException<winrt::hresult_canceled>([&] { operation.get(); });
+        }
+
+        // ---------------------------------------------------------------------
+        // Wmi_Query_Results_Make_Row_Objects_On_First_Touch
+        // - Reading a row twice returns the same object, for live and table results.
+        // - Iteration, GetMany and IndexOf agree with GetAt.
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Wmi_Query_Results_Make_Row_Objects_On_First_Touch)
+        {
+            winrt::WinMgmt::WmiDataContext context;
+            for (auto const& results : { context.QueryAsync(L"SELECT Name FROM Win32_Process").get(), context.QueryTableAsync(L"SELECT Name FROM Win32_Process").get() })
+            {
+                Assert::IsTrue(results.Size() > 1);
+
+                auto last = results.Size() - 1;
+                Assert::IsTrue(results.GetAt(last) == results.GetAt(last));
+
+                uint32_t index = 0;
+                Assert::IsTrue(results.IndexOf(results.GetAt(last), index));
+                Assert::AreEqual(last, index);
+
+                std::vector<winrt::WinMgmt::WmiClassObject> firstTwo(2, nullptr);
+                Assert::AreEqual(2u, results.GetMany(0, firstTwo));
+                Assert::IsTrue(firstTwo[1] == results.GetAt(1));
+
+                uint32_t iterated = 0;
+                for (auto const& row : results)
+                {
+                    Assert::IsTrue(row == results.GetAt(iterated++));
+                }
+                Assert::AreEqual(results.Size(), iterated);
+
+                Assert::ExpectException<winrt::hresult_out_of_bounds>([&] { results.GetAt(results.Size()); });
+            }
+        }
+
+        // ---------------------------------------------------------------------
+        // Wmi_GetProperty_Converts_Once_Per_Object
+        // - Reading a property again returns the property converted the first time.
+        // - Properties() reuses properties already read through GetProperty.
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Wmi_GetProperty_Converts_Once_Per_Object)
+        {
+            winrt::WinMgmt::WmiDataContext context;
+            auto results = context.QueryAsync(L"SELECT Name, ProcessId FROM Win32_Process").get();
+            Assert::IsTrue(results.Size() > 0);
+
+            auto row = results.GetAt(0);
+            auto name = row.GetProperty(L"Name");
+            Assert::IsTrue(name == row.GetProperty(L"Name"));
+            Assert::AreEqual(name.AsString(), row.GetProperty(L"Name").AsString());
+
+            bool reused = false;
+            for (auto const& property : row.Properties())
+            {
+                reused = reused || property == name;
+            }
+            Assert::IsTrue(reused);
+        }
+
+        // ---------------------------------------------------------------------
+        // Wmi_Snapshot_File_Replays_Recorded_Queries
+        // - A binary snapshot file recorded from winmgmt answers the recorded
+        //   query after the file is gone, with the recorded values.
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Wmi_Snapshot_File_Replays_Recorded_Queries)
+        {
+            const winrt::hstring query = L"SELECT Name, ProcessId FROM Win32_Process";
+            auto path = std::filesystem::temp_directory_path() / L"Wmi_Snapshot_File_Replays_Recorded_Queries.wmisnap";
+
+            winrt::WinMgmt::WmiDataContext live;
+            live.RecordSnapshotFileAsync(winrt::single_threaded_vector<winrt::hstring>({ query }), winrt::hstring{ path.wstring() }).get();
+
+            auto replay = winrt::WinMgmt::WmiDataContext::FromSnapshotFile(winrt::hstring{ path.wstring() }, {}, 0);
+            std::filesystem::remove(path);
+
+            auto results = replay.QueryAsync(query).get();
+            Assert::IsTrue(results.Size() > 0);
+
+            for (auto const& row : results)
+            {
+                Assert::IsFalse(row.GetProperty(L"Name").AsString().empty());
+            }
+        }
+
+        // ---------------------------------------------------------------------
+        // Wmi_Cached_Results_Are_Not_Shared_Across_Backends
+        // - A replay context and a live context caching the same query each
+        //   get their own backend's result.
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Wmi_Cached_Results_Are_Not_Shared_Across_Backends)
+        {
+            const winrt::hstring query = L"SELECT Name, ProcessId FROM Win32_Process";
+            const winrt::Windows::Foundation::TimeSpan ttl = std::chrono::minutes(1);
+            auto path = std::filesystem::temp_directory_path() / L"Wmi_Cached_Results_Are_Not_Shared_Across_Backends.wmisnap";
+
+            winrt::WinMgmt::WmiDataContext live;
+            live.RecordSnapshotFileAsync(winrt::single_threaded_vector<winrt::hstring>({ query }), winrt::hstring{ path.wstring() }).get();
+
+            auto replay = winrt::WinMgmt::WmiDataContext::FromSnapshotFile(winrt::hstring{ path.wstring() }, {}, 3);
+            std::filesystem::remove(path);
+
+            Assert::AreEqual(3u, replay.QueryCachedAsync(query, ttl).get().Size());
+            Assert::AreNotEqual(3u, live.QueryCachedAsync(query, ttl).get().Size());
+            Assert::AreEqual(3u, replay.QueryCachedAsync(query, ttl).get().Size());
+
+            live.InvalidateCachedQuery(query);
+            replay.InvalidateCachedQuery(query);
+        }
+
+        // ---------------------------------------------------------------------
+        // Wmi_Cached_Results_Are_Not_Shared_Across_Projection_Settings
+        // - A context with pushdown pinned to one property and a plain context
+        //   caching the same SELECT * each get their own result; the plain one
+        //   still reads properties the projection left out.
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Wmi_Cached_Results_Are_Not_Shared_Across_Projection_Settings)
+        {
+            const winrt::hstring query = L"SELECT * FROM Win32_OperatingSystem";
+            const winrt::Windows::Foundation::TimeSpan ttl = std::chrono::minutes(1);
+
+            winrt::WinMgmt::WmiDataContext projected;
+            projected.ProjectionPushdown(true);
+            projected.SetProjection(query, winrt::single_threaded_vector<winrt::hstring>({ L"Name" }));
+
+            winrt::WinMgmt::WmiDataContext plain;
+
+            auto narrow = projected.QueryCachedAsync(query, ttl).get();
+            auto full = plain.QueryCachedAsync(query, ttl).get();
+
+            Assert::IsFalse(full.GetAt(0).GetProperty(L"Caption").AsString().empty());
+            Assert::IsTrue(full.GetAt(0).Properties().Size() > narrow.GetAt(0).Properties().Size());
+
+            projected.ResetProjection(query);
+            projected.InvalidateCachedQuery(query);
+            plain.InvalidateCachedQuery(query);
+        }
+
+        // ---------------------------------------------------------------------
+        // Wmi_ExportAsync_Writes_One_Line_Per_Object
+        // - Object-backed and table-backed results export the same number of
+        //   JSON lines, and CSV adds a header line.
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Wmi_ExportAsync_Writes_One_Line_Per_Object)
+        {
+            const winrt::hstring query = L"SELECT Name, ProcessorId, NumberOfCores FROM Win32_Processor";
+            auto path = std::filesystem::temp_directory_path() / L"Wmi_ExportAsync_Writes_One_Line_Per_Object.out";
+            auto countLines = [&] {
+                std::ifstream in{ path, std::ios::binary };
+                std::size_t lines = 0;
+                for (std::string line; std::getline(in, line);)
+                    ++lines;
+                return lines;
+            };
+
+            winrt::WinMgmt::WmiDataContext context;
+            auto objects = context.QueryAsync(query).get();
+            auto rows = context.QueryTableAsync(query).get();
+            Assert::IsTrue(objects.Size() > 0);
+
+            auto bytes = winrt::WinMgmt::WmiDataContext::ExportAsync(objects, winrt::hstring{ path.wstring() }, winrt::WinMgmt::WmiExportFormat::JsonLines).get();
+            Assert::AreEqual<uint64_t>(std::filesystem::file_size(path), bytes);
+            Assert::AreEqual<std::size_t>(objects.Size(), countLines());
+
+            winrt::WinMgmt::WmiDataContext::ExportAsync(rows, winrt::hstring{ path.wstring() }, winrt::WinMgmt::WmiExportFormat::Csv).get();
+            Assert::AreEqual<std::size_t>(rows.Size() + 1, countLines());
+
+            std::filesystem::remove(path);
+        }
+
         // ---------------------------------------------------------------------
         // Wmi_QueryValidator_Valid_Query_Test
         // - Verify that the WQL query validator correctly identifies a valid query.
@@ -245,6 +756,8 @@ namespace IntegrationTests
             winrt::WinMgmt::WmiQueryValidator validator;
 
             Assert::IsTrue(!validator.Validate(query));
+            Assert::AreEqual(0, validator.ErrorPosition());
+            Assert::IsFalse(validator.ErrorMessage().empty());
         }
 
     };
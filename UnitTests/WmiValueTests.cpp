@@ -0,0 +1,275 @@
+﻿#include "pch.h"
+#include "CppUnitTest.h"
+#include "../WinMgmt/Core/VariantConverter.h"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTests
+{
+    // SAFEARRAY look-alike: one dimension, data block owned by the test.
+    struct FakeSafeArray
+    {
+        unsigned short cDims = 1;
+        void* pvData = nullptr;
+        struct { unsigned long cElements; long lLbound; } rgsabound[1]{};
+    };
+
+    // VARIANT look-alike with the member names ConvertVariant reads.
+    struct FakeVariant
+    {
+        std::uint16_t vt = Wmi::VarType::Empty;
+        union
+        {
+            char cVal;
+            short iVal;
+            long lVal;
+            long long llVal;
+            unsigned char bVal;
+            unsigned short uiVal;
+            unsigned long ulVal;
+            unsigned long long ullVal;
+            float fltVal;
+            double dblVal;
+            short boolVal;
+            const wchar_t* bstrVal;
+            FakeSafeArray* parray;
+        };
+    };
+
+    static FakeVariant MakeVariant(std::uint16_t vt, long long bits)
+    {
+        FakeVariant v;
+        v.vt = vt;
+        v.llVal = bits;
+        return v;
+    }
+
+    static FakeVariant MakeString(const wchar_t* text)
+    {
+        FakeVariant v;
+        v.vt = Wmi::VarType::BStr;
+        v.bstrVal = text;
+        return v;
+    }
+
+    template<typename T>
+    static FakeVariant MakeArray(std::uint16_t elementVt, std::vector<T>& items, FakeSafeArray& array)
+    {
+        array.pvData = items.data();
+        array.rgsabound[0].cElements = static_cast<unsigned long>(items.size());
+
+        FakeVariant v;
+        v.vt = static_cast<std::uint16_t>(Wmi::VarType::Array | elementVt);
+        v.parray = &array;
+        return v;
+    }
+
+    TEST_CLASS(WmiValueTests)
+    {
+    public:
+
+        // ---------------------------------------------------------------------
+        // Integers_Use_Declared_Type
+        // - uint32 arrives as VT_I4 and must be re-read as unsigned
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Integers_Use_Declared_Type)
+        {
+            FakeVariant var;
+            var.vt = Wmi::VarType::I4;
+            var.lVal = -1;
+
+            auto value = Wmi::ConvertVariant(var, Wmi::PropertyType::UInt32);
+            Assert::IsTrue(value.Type() == Wmi::PropertyType::UInt32);
+            Assert::AreEqual<std::uint64_t>(0xFFFFFFFFull, value.AsUInt64());
+
+            auto undeclared = Wmi::ConvertVariant(var);
+            Assert::IsTrue(undeclared.Type() == Wmi::PropertyType::Int32);
+            Assert::AreEqual<std::int64_t>(-1, undeclared.AsInt64());
+        }
+
+        // ---------------------------------------------------------------------
+        // UInt64_String_Is_Parsed
+        // - CIM uint64/sint64 values are marshalled as BSTR
+        // ---------------------------------------------------------------------
+        TEST_METHOD(UInt64_String_Is_Parsed)
+        {
+            auto value = Wmi::ConvertVariant(MakeString(L"18446744073709551615"), Wmi::PropertyType::UInt64);
+            Assert::IsTrue(value.Type() == Wmi::PropertyType::UInt64);
+            Assert::AreEqual<std::uint64_t>(UINT64_MAX, value.AsUInt64());
+
+            auto negative = Wmi::ConvertVariant(MakeString(L"-42"), Wmi::PropertyType::Int64);
+            Assert::AreEqual<std::int64_t>(-42, negative.AsInt64());
+
+            Assert::IsTrue(Wmi::ConvertVariant(MakeString(L"12x"), Wmi::PropertyType::UInt64).IsNull());
+        }
+
+        // ---------------------------------------------------------------------
+        // String_Is_A_View_Over_The_Variant
+        // ---------------------------------------------------------------------
+        TEST_METHOD(String_Is_A_View_Over_The_Variant)
+        {
+            const wchar_t* text = L"Microsoft Windows 11 Pro";
+            auto value = Wmi::ConvertVariant(MakeString(text));
+
+            Assert::IsTrue(value.Type() == Wmi::PropertyType::String);
+            Assert::IsTrue(value.AsString().data() == text, L"String value was copied.");
+            Assert::AreEqual<std::size_t>(24, value.AsString().size());
+        }
+
+        // ---------------------------------------------------------------------
+        // Null_Bool_And_Real_Conversions
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Null_Bool_And_Real_Conversions)
+        {
+            Assert::IsTrue(Wmi::ConvertVariant(MakeVariant(Wmi::VarType::Null, 0)).Type() == Wmi::PropertyType::Null);
+            Assert::IsTrue(Wmi::ConvertVariant(MakeVariant(0x2000 | Wmi::VarType::BStr, 0)).Type() == Wmi::PropertyType::Unknown);
+
+            FakeVariant b;
+            b.vt = Wmi::VarType::Bool;
+            b.boolVal = -1;
+            Assert::IsTrue(Wmi::ConvertVariant(b).AsBoolean());
+
+            FakeVariant d;
+            d.vt = Wmi::VarType::R8;
+            d.dblVal = 2.5;
+            Assert::AreEqual(2.5, Wmi::ConvertVariant(d).AsDouble(), 1e-12);
+            Assert::AreEqual<std::int64_t>(2, Wmi::ConvertVariant(d).AsInt64());
+        }
+
+        // ---------------------------------------------------------------------
+        // Array_Is_A_Span_Over_The_SafeArray
+        // - no element is copied; the declared element type still applies
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Array_Is_A_Span_Over_The_SafeArray)
+        {
+            std::vector<std::int32_t> items{ 1, -1, 42 };
+            FakeSafeArray array;
+
+            auto value = Wmi::ConvertVariant(MakeArray(Wmi::VarType::I4, items, array), Wmi::PropertyType::Array, {}, Wmi::PropertyType::UInt32);
+            Assert::IsTrue(value.Type() == Wmi::PropertyType::Array);
+            Assert::IsTrue(value.ElementType() == Wmi::PropertyType::UInt32);
+
+            auto view = value.AsArray();
+            Assert::AreEqual<std::uint32_t>(3, view.Size());
+            Assert::IsTrue(view.Data() == items.data());
+            Assert::IsTrue(view.As<std::int32_t>().data() == items.data());
+
+            Assert::AreEqual<std::uint64_t>(0xFFFFFFFFull, Wmi::ArrayElement(view, 1).AsUInt64());
+            Assert::AreEqual<std::uint64_t>(42, Wmi::ArrayElement(view, 2).AsUInt64());
+            Assert::IsTrue(Wmi::ElementTypeOf(view) == Wmi::PropertyType::UInt32);
+        }
+
+        // ---------------------------------------------------------------------
+        // String_Array_Elements_Follow_Declared_Type
+        // - IPAddress-style string arrays, uint64 and DATETIME arrays arrive as BSTR[]
+        // ---------------------------------------------------------------------
+        TEST_METHOD(String_Array_Elements_Follow_Declared_Type)
+        {
+            std::vector<const wchar_t*> addresses{ L"192.168.1.10", L"fe80::1" };
+            FakeSafeArray array;
+            auto view = Wmi::ConvertVariant(MakeArray(Wmi::VarType::BStr, addresses, array)).AsArray();
+
+            Assert::IsTrue(Wmi::ElementTypeOf(view) == Wmi::PropertyType::String);
+            Assert::IsTrue(Wmi::ArrayElement(view, 1).AsString() == L"fe80::1");
+            Assert::IsTrue(Wmi::ArrayElement(view, 1).AsString().data() == addresses[1]);
+
+            std::vector<const wchar_t*> stamps{ L"20240102030405.000000+000" };
+            FakeSafeArray stampArray;
+            auto stampView = Wmi::ConvertVariant(MakeArray(Wmi::VarType::BStr, stamps, stampArray), Wmi::PropertyType::Array, {}, Wmi::PropertyType::DateTime).AsArray();
+            auto stamp = Wmi::ArrayElement(stampView, 0);
+            Assert::IsTrue(stamp.Type() == Wmi::PropertyType::DateTime);
+            Assert::AreEqual<std::int64_t>(1704164645'000000, stamp.AsInt64());
+        }
+
+        // ---------------------------------------------------------------------
+        // Multi_Dimensional_Array_Is_Unknown
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Multi_Dimensional_Array_Is_Unknown)
+        {
+            std::vector<double> items{ 1.0, 2.0 };
+            FakeSafeArray array;
+            auto var = MakeArray(Wmi::VarType::R8, items, array);
+            array.cDims = 2;
+
+            Assert::IsTrue(Wmi::ConvertVariant(var).Type() == Wmi::PropertyType::Unknown);
+        }
+
+        // ---------------------------------------------------------------------
+        // Array_Element_Access_Performance_Test
+        // - summing a large UInt32 array through ArrayElement stays close to a raw loop
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Array_Element_Access_Performance_Test)
+        {
+            constexpr std::size_t count = 4'000'000;
+
+            std::vector<std::int32_t> items(count);
+            for (std::size_t i = 0; i < count; ++i)
+                items[i] = static_cast<std::int32_t>(i);
+
+            FakeSafeArray array;
+            auto view = Wmi::ConvertVariant(MakeArray(Wmi::VarType::I4, items, array), Wmi::PropertyType::Array, {}, Wmi::PropertyType::UInt32).AsArray();
+
+            auto start = std::chrono::high_resolution_clock::now();
+            std::uint64_t total = 0;
+            for (std::size_t i = 0; i < view.Size(); ++i)
+                total += Wmi::ArrayElement(view, i).AsUInt64();
+            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start);
+
+            Assert::AreEqual<std::uint64_t>(std::uint64_t{ count } * (count - 1) / 2, total);
+            Assert::IsTrue(elapsed.count() < 200, L"Array element access is too slow.");
+        }
+
+        // ---------------------------------------------------------------------
+        // Value_Is_Trivially_Copyable_And_Compact
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Value_Is_Trivially_Copyable_And_Compact)
+        {
+            Assert::IsTrue(std::is_trivially_copyable_v<Wmi::Value>);
+            Assert::IsTrue(sizeof(Wmi::Value) <= 16);
+
+            auto a = Wmi::Value::FromUInt64(7);
+            auto b = a;
+            Assert::IsTrue(a == b);
+            Assert::IsFalse(a == Wmi::Value::FromInt64(7));
+        }
+
+        // ---------------------------------------------------------------------
+        // Value_Vs_Boxed_Conversion_Performance_Test
+        // - Converting a UInt64 counter into a Value must be much cheaper than boxing it.
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Value_Vs_Boxed_Conversion_Performance_Test)
+        {
+            constexpr int iterations = 1'000'000;
+
+            FakeVariant var;
+            var.vt = Wmi::VarType::UI8;
+
+            auto start = std::chrono::high_resolution_clock::now();
+            std::uint64_t unboxedTotal = 0;
+            for (int i = 0; i < iterations; ++i)
+            {
+                var.ullVal = static_cast<unsigned long long>(i);
+                unboxedTotal += Wmi::ConvertVariant(var).AsUInt64();
+            }
+            auto unboxed = std::chrono::high_resolution_clock::now() - start;
+
+            start = std::chrono::high_resolution_clock::now();
+            std::uint64_t boxedTotal = 0;
+            for (int i = 0; i < iterations; ++i)
+            {
+                var.ullVal = static_cast<unsigned long long>(i);
+                auto boxed = winrt::box_value(static_cast<std::uint64_t>(var.ullVal));
+                boxedTotal += winrt::unbox_value<std::uint64_t>(boxed);
+            }
+            auto boxed = std::chrono::high_resolution_clock::now() - start;
+
+            Assert::AreEqual(boxedTotal, unboxedTotal);
+            Assert::IsTrue(unboxed * 5 < boxed, L"Value conversion is not meaningfully cheaper than boxing.");
+        }
+    };
+}
@@ -0,0 +1,229 @@
+﻿#include "pch.h"
+#include "CppUnitTest.h"
+#include "../WinMgmt/Core/WqlParser.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTests
+{
+    TEST_CLASS(WqlParserTests)
+    {
+    public:
+
+        // ---------------------------------------------------------------------
+        // Select_Star_And_Property_List
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Select_Star_And_Property_List)
+        {
+            auto all = Wmi::Wql::Parse(L"SELECT * FROM Win32_Process");
+            Assert::IsTrue(all.Ok());
+            Assert::IsTrue(all.query.selectAll);
+            Assert::IsTrue(all.query.className == L"Win32_Process");
+            Assert::IsNull(all.query.Where());
+
+            auto some = Wmi::Wql::Parse(L"select Name, ProcessId ,WorkingSetSize from Win32_Process");
+            Assert::IsTrue(some.Ok());
+            Assert::IsFalse(some.query.selectAll);
+            Assert::AreEqual<size_t>(3, some.query.properties.size());
+            Assert::IsTrue(some.query.properties[1] == L"ProcessId");
+        }
+
+        // ---------------------------------------------------------------------
+        // Where_Builds_Precedence_Tree
+        // - AND binds tighter than OR; literals on the left are normalized
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Where_Builds_Precedence_Tree)
+        {
+            auto result = Wmi::Wql::Parse(L"SELECT * FROM Win32_Service WHERE State = 'Running' OR 5 < ProcessId AND NOT StartMode <> \"Auto\"");
+            Assert::IsTrue(result.Ok());
+
+            auto const& q = result.query;
+            auto const* root = q.Where();
+            Assert::IsTrue(root->kind == Wmi::Wql::ExprKind::Or);
+
+            auto const& state = q.Node(root->left);
+            Assert::IsTrue(state.kind == Wmi::Wql::ExprKind::Compare);
+            Assert::IsTrue(state.property == L"State");
+            Assert::IsTrue(state.literal.kind == Wmi::Wql::LiteralKind::String);
+            Assert::IsTrue(state.literal.text == L"Running");
+
+            auto const& conj = q.Node(root->right);
+            Assert::IsTrue(conj.kind == Wmi::Wql::ExprKind::And);
+
+            auto const& pid = q.Node(conj.left);
+            Assert::IsTrue(pid.property == L"ProcessId");
+            Assert::IsTrue(pid.op == Wmi::Wql::CompareOp::Greater);
+            Assert::AreEqual<int64_t>(5, pid.literal.integer);
+
+            auto const& negation = q.Node(conj.right);
+            Assert::IsTrue(negation.kind == Wmi::Wql::ExprKind::Not);
+            Assert::IsTrue(q.Node(negation.left).op == Wmi::Wql::CompareOp::NotEqual);
+        }
+
+        // ---------------------------------------------------------------------
+        // Predicates_And_Literals
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Predicates_And_Literals)
+        {
+            auto result = Wmi::Wql::Parse(
+                L"SELECT * FROM Win32_LogicalDisk WHERE (VolumeName IS NOT NULL AND Description IS NULL) "
+                L"AND Name LIKE 'C%' AND Caption NOT LIKE '%tmp%' AND Size >= -1.5e3 AND Compressed = FALSE");
+            Assert::IsTrue(result.Ok());
+
+            std::vector<Wmi::Wql::Expr const*> leaves;
+            for (auto const& e : result.query.expressions)
+            {
+                if (e.kind != Wmi::Wql::ExprKind::And)
+                    leaves.push_back(&e);
+            }
+
+            Assert::IsTrue(leaves[0]->kind == Wmi::Wql::ExprKind::IsNotNull);
+            Assert::IsTrue(leaves[1]->kind == Wmi::Wql::ExprKind::IsNull);
+            Assert::IsTrue(leaves[2]->op == Wmi::Wql::CompareOp::Like);
+            Assert::IsTrue(leaves[3]->op == Wmi::Wql::CompareOp::Like);
+            Assert::IsTrue(leaves[4]->kind == Wmi::Wql::ExprKind::Not);
+            Assert::AreEqual(-1500.0, leaves[5]->literal.real, 1e-9);
+            Assert::IsTrue(leaves[6]->literal.kind == Wmi::Wql::LiteralKind::Boolean);
+            Assert::IsFalse(leaves[6]->literal.boolean);
+        }
+
+        // ---------------------------------------------------------------------
+        // Event_Query_With_Within_And_Isa
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Event_Query_With_Within_And_Isa)
+        {
+            auto result = Wmi::Wql::Parse(
+                L"SELECT * FROM __InstanceCreationEvent WITHIN 2.5 WHERE TargetInstance ISA 'Win32_Process' AND TargetInstance.Name = 'notepad.exe'");
+            Assert::IsTrue(result.Ok());
+            Assert::AreEqual(2.5, *result.query.within, 1e-12);
+
+            auto const& q = result.query;
+            auto const& isa = q.Node(q.Where()->left);
+            Assert::IsTrue(isa.kind == Wmi::Wql::ExprKind::Isa);
+            Assert::IsTrue(isa.literal.text == L"Win32_Process");
+            Assert::IsTrue(q.Node(q.Where()->right).property == L"TargetInstance.Name");
+
+            auto trailing = Wmi::Wql::Parse(L"SELECT * FROM __InstanceDeletionEvent WHERE TargetInstance ISA 'Win32_Service' WITHIN 10");
+            Assert::IsTrue(trailing.Ok());
+            Assert::AreEqual(10.0, *trailing.query.within, 1e-12);
+        }
+
+        // ---------------------------------------------------------------------
+        // Event_Query_Compares_Target_And_Previous_Instance
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Event_Query_Compares_Target_And_Previous_Instance)
+        {
+            auto result = Wmi::Wql::Parse(
+                L"SELECT * FROM __InstanceModificationEvent WITHIN 5 WHERE TargetInstance ISA 'Win32_Service' "
+                L"AND TargetInstance.State <> PreviousInstance.State");
+            Assert::IsTrue(result.Ok());
+
+            auto const& q = result.query;
+            auto const& changed = q.Node(q.Where()->right);
+            Assert::IsTrue(changed.kind == Wmi::Wql::ExprKind::Compare);
+            Assert::IsTrue(changed.op == Wmi::Wql::CompareOp::NotEqual);
+            Assert::IsTrue(changed.property == L"TargetInstance.State");
+            Assert::IsTrue(changed.otherProperty == L"PreviousInstance.State");
+
+            auto literal = Wmi::Wql::Parse(L"SELECT * FROM Win32_Service WHERE State = 'Running'");
+            Assert::IsTrue(literal.Ok());
+            Assert::IsTrue(literal.query.Where()->otherProperty.empty());
+
+            Assert::IsFalse(Wmi::Wql::Parse(L"SELECT * FROM Win32_Service WHERE State = AND").Ok());
+        }
+
+        // ---------------------------------------------------------------------
+        // Event_Query_With_Group_By_Having
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Event_Query_With_Group_By_Having)
+        {
+            auto result = Wmi::Wql::Parse(
+                L"SELECT * FROM __InstanceModificationEvent WITHIN 5 WHERE TargetInstance ISA 'Win32_Service' "
+                L"GROUP WITHIN 600 BY TargetInstance.State HAVING NumberOfEvents > 3");
+            Assert::IsTrue(result.Ok());
+            Assert::AreEqual(600.0, *result.query.groupWithin, 1e-12);
+            Assert::AreEqual<size_t>(1, result.query.groupBy.size());
+            Assert::IsTrue(result.query.groupBy[0] == L"TargetInstance.State");
+            Assert::IsTrue(result.query.Node(result.query.having).property == L"NumberOfEvents");
+        }
+
+        // ---------------------------------------------------------------------
+        // Associators_And_References
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Associators_And_References)
+        {
+            auto assoc = Wmi::Wql::Parse(
+                L"ASSOCIATORS OF {Win32_NetworkAdapter.DeviceID=\"1\"} WHERE AssocClass = Win32_NetworkAdapterSetting ResultClass = Win32_NetworkAdapterConfiguration KeysOnly");
+            Assert::IsTrue(assoc.Ok());
+            Assert::IsTrue(assoc.query.kind == Wmi::Wql::QueryKind::Associators);
+            Assert::IsTrue(assoc.query.objectPath == L"Win32_NetworkAdapter.DeviceID=\"1\"");
+            Assert::IsTrue(assoc.query.association.assocClass == L"Win32_NetworkAdapterSetting");
+            Assert::IsTrue(assoc.query.association.resultClass == L"Win32_NetworkAdapterConfiguration");
+            Assert::IsTrue(assoc.query.association.keysOnly);
+
+            auto refs = Wmi::Wql::Parse(L"REFERENCES OF { Win32_Directory.Name='C:\\\\{x}' } WHERE ClassDefsOnly");
+            Assert::IsTrue(refs.Ok());
+            Assert::IsTrue(refs.query.kind == Wmi::Wql::QueryKind::References);
+            Assert::IsTrue(refs.query.objectPath == L"Win32_Directory.Name='C:\\\\{x}'");
+            Assert::IsTrue(refs.query.association.classDefsOnly);
+
+            auto invalid = Wmi::Wql::Parse(L"REFERENCES OF {Win32_Directory.Name='C:'} WHERE AssocClass = X");
+            Assert::IsFalse(invalid.Ok());
+            Assert::AreEqual<uint32_t>(48, invalid.error.offset);
+        }
+
+        // ---------------------------------------------------------------------
+        // Errors_Report_Position
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Errors_Report_Position)
+        {
+            struct Case { const wchar_t* text; Wmi::Wql::ErrorCode code; uint32_t offset; };
+            const Case cases[] = {
+                { L"INVALID QUERY", Wmi::Wql::ErrorCode::ExpectedSelect, 0 },
+                { L"SELECT * Win32_Process", Wmi::Wql::ErrorCode::ExpectedFrom, 9 },
+                { L"SELECT * FROM", Wmi::Wql::ErrorCode::UnexpectedEnd, 13 },
+                { L"SELECT * FROM A WHERE Name = 'x", Wmi::Wql::ErrorCode::UnterminatedString, 29 },
+                { L"SELECT * FROM A WHERE (Name = 1", Wmi::Wql::ErrorCode::UnexpectedEnd, 31 },
+                { L"SELECT * FROM A WHERE Name # 1", Wmi::Wql::ErrorCode::InvalidToken, 27 },
+                { L"SELECT * FROM A WHERE Name = 1 garbage", Wmi::Wql::ErrorCode::UnexpectedToken, 31 },
+                { L"SELECT Name, FROM A", Wmi::Wql::ErrorCode::ExpectedProperty, 13 },
+                { L"SELECT * FROM A WITHIN x", Wmi::Wql::ErrorCode::ExpectedNumber, 23 },
+            };
+
+            for (auto const& c : cases)
+            {
+                auto result = Wmi::Wql::Parse(c.text);
+                Assert::IsFalse(result.Ok(), c.text);
+                Assert::IsTrue(result.error.code == c.code, c.text);
+                Assert::AreEqual(c.offset, result.error.offset, c.text);
+                Assert::IsFalse(result.error.message.empty());
+            }
+        }
+
+        // ---------------------------------------------------------------------
+        // Parse_Performance_Test
+        // - Validate must run in microseconds; 100k parses of a typical query
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Parse_Performance_Test)
+        {
+            constexpr int iterations = 100'000;
+            const std::wstring query =
+                L"SELECT Name, ProcessId, WorkingSetSize FROM Win32_Process WHERE (Name LIKE 'svc%' OR ProcessId > 1000) AND WorkingSetSize IS NOT NULL";
+
+            auto start = std::chrono::high_resolution_clock::now();
+            int valid = 0;
+            for (int i = 0; i < iterations; ++i)
+                valid += Wmi::Wql::Parse(query).Ok() ? 1 : 0;
+            auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start);
+
+            Assert::AreEqual(iterations, valid);
+
+            double average = static_cast<double>(elapsed.count()) / iterations;
+            Assert::IsTrue(average < 5.0, L"Average WQL parse time exceeds 5 microseconds.");
+        }
+    };
+}
@@ -0,0 +1,182 @@
+﻿#include "pch.h"
+#include "CppUnitTest.h"
+#include "../WinMgmt/Core/WqlPlanCache.h"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTests
+{
+    TEST_CLASS(WqlPlanCacheTests)
+    {
+    public:
+
+        // ---------------------------------------------------------------------
+        // Normalize_Ignores_Case_Whitespace_And_Literal_Values
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Normalize_Ignores_Case_Whitespace_And_Literal_Values)
+        {
+            std::wstring a, b, c;
+            Assert::IsTrue(Wmi::Wql::Normalize(L"SELECT Name FROM Win32_Process WHERE ProcessId = 4 AND Name = 'System'", a));
+            Assert::IsTrue(Wmi::Wql::Normalize(L"  select  name\tfrom win32_process\nwhere processid=1234 and name=\"svchost.exe\"", b));
+            Assert::IsTrue(Wmi::Wql::Normalize(L"SELECT Name FROM Win32_Process WHERE ProcessId = 'x' AND Name = 'System'", c));
+
+            Assert::AreEqual(std::wstring{ L"SELECT NAME FROM WIN32_PROCESS WHERE PROCESSID = # AND NAME = ?" }, a);
+            Assert::AreEqual(a, b);
+            Assert::AreNotEqual(a, c);
+
+            std::wstring path;
+            Assert::IsTrue(Wmi::Wql::Normalize(L"ASSOCIATORS OF {Win32_Service.Name='a}b'} WHERE ResultClass = Win32_Process", path));
+            Assert::AreEqual(std::wstring{ L"ASSOCIATORS OF { Win32_Service.Name='a}b' } WHERE RESULTCLASS = WIN32_PROCESS" }, path);
+
+            std::wstring broken;
+            Assert::IsFalse(Wmi::Wql::Normalize(L"SELECT * FROM A WHERE Name = 'open", broken));
+        }
+
+        // ---------------------------------------------------------------------
+        // Lookup_Hits_Same_Shape_And_Returns_Current_Literals
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Lookup_Hits_Same_Shape_And_Returns_Current_Literals)
+        {
+            Wmi::Wql::PlanCache cache{ 16 };
+
+            auto first = cache.Lookup(L"SELECT * FROM Win32_Process WHERE ProcessId = 4");
+            Assert::IsTrue(static_cast<bool>(first));
+            Assert::IsFalse(first.hit);
+
+            const std::wstring second_text = L"select * from WIN32_PROCESS where ProcessId = 1234";
+            auto second = cache.Lookup(second_text);
+            Assert::IsTrue(second.hit);
+            Assert::IsTrue(first.plan == second.plan);
+
+            Assert::AreEqual<size_t>(1, second.plan->literalCount);
+            Assert::AreEqual<size_t>(1, second.literals.size());
+            Assert::IsTrue(second.literals[0].text == L"1234");
+            Assert::IsTrue(second.literals[0].kind == Wmi::Wql::TokenKind::Integer);
+
+            Assert::IsTrue(second.plan->query.className == L"Win32_Process");
+
+            auto stats = cache.Stats();
+            Assert::AreEqual<uint64_t>(1, stats.hits);
+            Assert::AreEqual<uint64_t>(1, stats.misses);
+            Assert::AreEqual<size_t>(1, stats.size);
+        }
+
+        // ---------------------------------------------------------------------
+        // Object_Paths_Are_Part_Of_The_Shape
+        // - After a valid path is cached, an empty or unterminated path still
+        //   fails and another path gets a plan of its own.
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Object_Paths_Are_Part_Of_The_Shape)
+        {
+            Wmi::Wql::PlanCache cache{ 16 };
+
+            auto warm = cache.Lookup(L"ASSOCIATORS OF {Win32_Service.Name='Spooler'}");
+            Assert::IsTrue(static_cast<bool>(warm));
+
+            auto empty = cache.Lookup(L"ASSOCIATORS OF {}");
+            Assert::IsFalse(static_cast<bool>(empty));
+            Assert::IsTrue(empty.error.code == Wmi::Wql::ErrorCode::ExpectedObjectPath);
+
+            auto unterminated = cache.Lookup(L"ASSOCIATORS OF {Win32_Service.Name='Spooler}");
+            Assert::IsFalse(static_cast<bool>(unterminated));
+
+            auto other = cache.Lookup(L"associators of {Win32_Service.Name='Dhcp'}");
+            Assert::IsTrue(static_cast<bool>(other));
+            Assert::IsFalse(other.hit);
+            Assert::IsTrue(other.plan->query.objectPath == L"Win32_Service.Name='Dhcp'");
+
+            Assert::IsTrue(cache.Lookup(L"ASSOCIATORS OF { Win32_Service.Name='Spooler' }").hit);
+        }
+
+        // ---------------------------------------------------------------------
+        // Invalid_Queries_Are_Not_Cached
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Invalid_Queries_Are_Not_Cached)
+        {
+            Wmi::Wql::PlanCache cache{ 16 };
+
+            auto result = cache.Lookup(L"SELECT * Win32_Process");
+            Assert::IsFalse(static_cast<bool>(result));
+            Assert::IsTrue(result.error.code == Wmi::Wql::ErrorCode::ExpectedFrom);
+            Assert::AreEqual<uint32_t>(9, result.error.offset);
+
+            auto unterminated = cache.Lookup(L"SELECT * FROM A WHERE Name = 'x");
+            Assert::IsTrue(unterminated.error.code == Wmi::Wql::ErrorCode::UnterminatedString);
+
+            Assert::AreEqual<size_t>(0, cache.Stats().size);
+        }
+
+        // ---------------------------------------------------------------------
+        // Least_Recently_Used_Plan_Is_Evicted
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Least_Recently_Used_Plan_Is_Evicted)
+        {
+            Wmi::Wql::PlanCache cache{ 2, 1 };
+
+            (void)cache.Lookup(L"SELECT * FROM A");
+            (void)cache.Lookup(L"SELECT * FROM B");
+            Assert::IsTrue(cache.Lookup(L"SELECT * FROM A").hit);
+
+            (void)cache.Lookup(L"SELECT * FROM C");
+
+            auto stats = cache.Stats();
+            Assert::AreEqual<uint64_t>(1, stats.evictions);
+            Assert::AreEqual<size_t>(2, stats.size);
+
+            Assert::IsTrue(cache.Lookup(L"SELECT * FROM A").hit);
+            Assert::IsFalse(cache.Lookup(L"SELECT * FROM B").hit);
+        }
+
+        // ---------------------------------------------------------------------
+        // Concurrent_Lookup_Performance_Test
+        // - 8 threads re-issue 200 query shapes with varying literals
+        // ---------------------------------------------------------------------
+        TEST_METHOD(Concurrent_Lookup_Performance_Test)
+        {
+            constexpr int threadCount = 8;
+            constexpr int lookupsPerThread = 50'000;
+            constexpr int shapes = 200;
+
+            std::vector<std::wstring> queries;
+            for (int i = 0; i < shapes * 4; ++i)
+            {
+                queries.push_back(L"SELECT Name, ProcessId FROM Win32_Process_" + std::to_wstring(i % shapes) +
+                    L" WHERE ProcessId > " + std::to_wstring(i) + L" AND Name LIKE 'svc%'");
+            }
+
+            Wmi::Wql::PlanCache cache{ 256 };
+            std::atomic<int> failures{ 0 };
+
+            auto start = std::chrono::high_resolution_clock::now();
+            std::vector<std::thread> threads;
+            for (int t = 0; t < threadCount; ++t)
+            {
+                threads.emplace_back([&, t]
+                {
+                    for (int i = 0; i < lookupsPerThread; ++i)
+                    {
+                        auto lookup = cache.Lookup(queries[(i * 7 + t) % queries.size()]);
+                        if (!lookup || lookup.literals.size() != 2)
+                            failures.fetch_add(1);
+                    }
+                });
+            }
+            for (auto& thread : threads)
+                thread.join();
+            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start);
+
+            auto stats = cache.Stats();
+            Assert::AreEqual(0, failures.load());
+            Assert::AreEqual<uint64_t>(threadCount * lookupsPerThread, stats.hits + stats.misses);
+            Assert::IsTrue(stats.misses < 2 * shapes, L"Shapes were re-parsed instead of hitting the cache.");
+            Assert::IsTrue(stats.size <= shapes);
+            Assert::IsTrue(elapsed.count() < 2000, L"Concurrent plan cache lookups are too slow.");
+        }
+    };
+}
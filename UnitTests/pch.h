@@ -1,4 +1,6 @@
 #pragma once
+// Keeps windows.h from defining min and max macros over std::min and std::max.
+#define NOMINMAX
 #include <windows.h>
 #include <unknwn.h>
 #include <restrictederrorinfo.h>
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace Wmi
+{
+    struct BatchChannelStats
+    {
+        std::uint64_t items = 0;
+        std::uint64_t batches = 0;
+        std::uint64_t producerWaits = 0;
+        std::size_t peakPendingBatches = 0;
+    };
+
+    // Bounded hand-off between a result producer (the WMI sink) and a consumer.
+    // Items are grouped into fixed-size batches; once maxPendingBatches are queued
+    // the producer blocks until the consumer catches up.
+    template<typename T>
+    class BatchChannel
+    {
+    public:
+        BatchChannel(std::size_t batchSize, std::size_t maxPendingBatches)
+            : m_batchSize(batchSize ? batchSize : 1), m_maxPending(maxPendingBatches ? maxPendingBatches : 1)
+        {
+            m_current.reserve(m_batchSize);
+        }
+
+        BatchChannel(const BatchChannel&) = delete;
+        BatchChannel& operator=(const BatchChannel&) = delete;
+
+        // Returns false once the channel is closed and the item was dropped.
+        bool Push(T value)
+        {
+            std::unique_lock lk(m_mutex);
+            if (m_closed) [[unlikely]]
+                return false;
+
+            m_current.push_back(std::move(value));
+            ++m_stats.items;
+
+            if (m_current.size() >= m_batchSize)
+                return publish(lk);
+
+            return true;
+        }
+
+        // Producer side: no more items will follow. status is an HRESULT-style code.
+        void Complete(std::int32_t status = 0)
+        {
+            std::unique_lock lk(m_mutex);
+            if (m_closed)
+                return;
+
+            if (!m_current.empty())
+            {
+                m_pending.push_back(std::move(m_current));
+                m_current = {};
+                ++m_stats.batches;
+            }
+
+            m_status = status;
+            m_closed = true;
+            m_consumerCv.notify_all();
+            m_producerCv.notify_all();
+        }
+
+        // Consumer side: drop everything buffered and unblock the producer.
+        void Cancel(std::int32_t status)
+        {
+            std::lock_guard lk(m_mutex);
+            m_pending.clear();
+            m_current.clear();
+            if (!m_closed)
+                m_status = status;
+            m_closed = true;
+            m_consumerCv.notify_all();
+            m_producerCv.notify_all();
+        }
+
+        // Blocks until a batch is available. Returns nullopt once the channel is closed and drained.
+        [[nodiscard]] std::optional<std::vector<T>> Pop()
+        {
+            std::unique_lock lk(m_mutex);
+            m_consumerCv.wait(lk, [this] { return !m_pending.empty() || m_closed; });
+            return take();
+        }
+
+        [[nodiscard]] std::optional<std::vector<T>> TryPop()
+        {
+            std::lock_guard lk(m_mutex);
+            return take();
+        }
+
+        [[nodiscard]] bool IsCompleted() const
+        {
+            std::lock_guard lk(m_mutex);
+            return m_closed && m_pending.empty();
+        }
+
+        [[nodiscard]] std::int32_t Status() const
+        {
+            std::lock_guard lk(m_mutex);
+            return m_status;
+        }
+
+        [[nodiscard]] BatchChannelStats Stats() const
+        {
+            std::lock_guard lk(m_mutex);
+            return m_stats;
+        }
+
+        [[nodiscard]] std::size_t BatchSize() const noexcept
+        {
+            return m_batchSize;
+        }
+
+    private:
+        bool publish(std::unique_lock<std::mutex>& lk)
+        {
+            auto batch = std::move(m_current);
+            m_current = {};
+            m_current.reserve(m_batchSize);
+
+            if (m_pending.size() >= m_maxPending)
+            {
+                ++m_stats.producerWaits;
+                m_producerCv.wait(lk, [this] { return m_pending.size() < m_maxPending || m_closed; });
+                if (m_closed) [[unlikely]]
+                    return false;
+            }
+
+            m_pending.push_back(std::move(batch));
+            ++m_stats.batches;
+            if (m_pending.size() > m_stats.peakPendingBatches)
+                m_stats.peakPendingBatches = m_pending.size();
+
+            m_consumerCv.notify_one();
+            return true;
+        }
+
+        std::optional<std::vector<T>> take()
+        {
+            if (m_pending.empty())
+                return std::nullopt;
+
+            auto batch = std::move(m_pending.front());
+            m_pending.pop_front();
+            m_producerCv.notify_one();
+            return batch;
+        }
+
+    private:
+        const std::size_t m_batchSize;
+        const std::size_t m_maxPending;
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_consumerCv;
+        std::condition_variable m_producerCv;
+
+        std::vector<T> m_current;
+        std::deque<std::vector<T>> m_pending;
+        BatchChannelStats m_stats;
+        std::int32_t m_status = 0;
+        bool m_closed = false;
+    };
+}
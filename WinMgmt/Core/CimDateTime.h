@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace Wmi
+{
+    // A parsed CIM DATETIME: UTC microseconds since the Unix epoch plus the original
+    // UTC offset in minutes, so the value can be written back unchanged.
+    struct CimDateTime
+    {
+        std::int64_t microseconds = 0;
+        std::int32_t utcOffsetMinutes = 0;
+
+        friend constexpr bool operator==(CimDateTime const&, CimDateTime const&) noexcept = default;
+    };
+
+    // yyyymmddHHMMSS.mmmmmmsUUU
+    constexpr std::size_t CimDateTimeLength = 25;
+
+    namespace detail
+    {
+        [[nodiscard]] constexpr bool ReadDigits(std::wstring_view text, std::size_t offset, std::size_t count, std::int64_t& value) noexcept
+        {
+            std::int64_t result = 0;
+            for (std::size_t i = offset; i < offset + count; ++i)
+            {
+                auto digit = text[i] - L'0';
+                if (digit < 0 || digit > 9)
+                    return false;
+                result = result * 10 + digit;
+            }
+            value = result;
+            return true;
+        }
+
+        // Days since 1970-01-01 for a proleptic Gregorian date (H. Hinnant's days_from_civil).
+        [[nodiscard]] constexpr std::int64_t DaysFromCivil(std::int64_t y, std::int64_t m, std::int64_t d) noexcept
+        {
+            y -= m <= 2;
+            const std::int64_t era = (y >= 0 ? y : y - 399) / 400;
+            const std::int64_t yoe = y - era * 400;
+            const std::int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+            const std::int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+            return era * 146097 + doe - 719468;
+        }
+
+        constexpr void CivilFromDays(std::int64_t z, std::int64_t& y, std::int64_t& m, std::int64_t& d) noexcept
+        {
+            z += 719468;
+            const std::int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+            const std::int64_t doe = z - era * 146097;
+            const std::int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+            const std::int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+            const std::int64_t mp = (5 * doy + 2) / 153;
+            d = doy - (153 * mp + 2) / 5 + 1;
+            m = mp + (mp < 10 ? 3 : -9);
+            y = yoe + era * 400 + (m <= 2);
+        }
+
+        constexpr void WriteDigits(wchar_t* out, std::int64_t value, std::size_t count) noexcept
+        {
+            for (std::size_t i = count; i > 0; --i)
+            {
+                out[i - 1] = static_cast<wchar_t>(L'0' + value % 10);
+                value /= 10;
+            }
+        }
+    }
+
+    // CIM intervals share the length but use ':' where a datetime has the offset sign.
+    [[nodiscard]] constexpr bool IsCimInterval(std::wstring_view text) noexcept
+    {
+        return text.size() == CimDateTimeLength && text[21] == L':';
+    }
+
+    // Parses a fully specified CIM DATETIME. Wildcard ('*') fields and intervals are rejected.
+    [[nodiscard]] constexpr std::optional<CimDateTime> ParseCimDateTime(std::wstring_view text) noexcept
+    {
+        if (text.size() != CimDateTimeLength || text[14] != L'.' || (text[21] != L'+' && text[21] != L'-'))
+            return std::nullopt;
+
+        std::int64_t year = 0, month = 0, day = 0, hour = 0, minute = 0, second = 0, micros = 0, offset = 0;
+        if (!detail::ReadDigits(text, 0, 4, year) || !detail::ReadDigits(text, 4, 2, month) || !detail::ReadDigits(text, 6, 2, day) ||
+            !detail::ReadDigits(text, 8, 2, hour) || !detail::ReadDigits(text, 10, 2, minute) || !detail::ReadDigits(text, 12, 2, second) ||
+            !detail::ReadDigits(text, 15, 6, micros) || !detail::ReadDigits(text, 22, 3, offset))
+            return std::nullopt;
+
+        if (month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60)
+            return std::nullopt;
+
+        if (text[21] == L'-')
+            offset = -offset;
+
+        const std::int64_t seconds = detail::DaysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second - offset * 60;
+        return CimDateTime{ seconds * 1'000'000 + micros, static_cast<std::int32_t>(offset) };
+    }
+
+    // ddddddddHHMMSS.mmmmmm:000, returned as a duration in microseconds.
+    [[nodiscard]] constexpr std::optional<std::int64_t> ParseCimInterval(std::wstring_view text) noexcept
+    {
+        if (!IsCimInterval(text) || text[14] != L'.')
+            return std::nullopt;
+
+        std::int64_t days = 0, hours = 0, minutes = 0, seconds = 0, micros = 0;
+        if (!detail::ReadDigits(text, 0, 8, days) || !detail::ReadDigits(text, 8, 2, hours) || !detail::ReadDigits(text, 10, 2, minutes) ||
+            !detail::ReadDigits(text, 12, 2, seconds) || !detail::ReadDigits(text, 15, 6, micros))
+            return std::nullopt;
+
+        return (((days * 24 + hours) * 60 + minutes) * 60 + seconds) * 1'000'000 + micros;
+    }
+
+    // Writes the 25-character CIM form of value (in its original offset) into out.
+    constexpr void FormatCimDateTime(CimDateTime const& value, wchar_t (&out)[CimDateTimeLength + 1]) noexcept
+    {
+        const std::int64_t local = value.microseconds + std::int64_t{ value.utcOffsetMinutes } * 60'000'000;
+        std::int64_t days = local / 86'400'000'000;
+        std::int64_t rest = local % 86'400'000'000;
+        if (rest < 0)
+        {
+            rest += 86'400'000'000;
+            --days;
+        }
+
+        std::int64_t year = 0, month = 0, day = 0;
+        detail::CivilFromDays(days, year, month, day);
+
+        detail::WriteDigits(out, year, 4);
+        detail::WriteDigits(out + 4, month, 2);
+        detail::WriteDigits(out + 6, day, 2);
+        detail::WriteDigits(out + 8, rest / 3'600'000'000, 2);
+        detail::WriteDigits(out + 10, rest / 60'000'000 % 60, 2);
+        detail::WriteDigits(out + 12, rest / 1'000'000 % 60, 2);
+        out[14] = L'.';
+        detail::WriteDigits(out + 15, rest % 1'000'000, 6);
+        out[21] = value.utcOffsetMinutes < 0 ? L'-' : L'+';
+        detail::WriteDigits(out + 22, value.utcOffsetMinutes < 0 ? -value.utcOffsetMinutes : value.utcOffsetMinutes, 3);
+        out[25] = L'\0';
+    }
+}
@@ -0,0 +1,252 @@
+#pragma once
+
+#include "SchemaCache.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Wmi
+{
+    // Identity of a connection. An empty server means the local machine; user is
+    // empty for the caller's own credentials. Server and namespace compare
+    // case-insensitively, user does not.
+    struct ConnectionKey
+    {
+        std::wstring server;
+        std::wstring ns;
+        std::wstring user;
+
+        [[nodiscard]] std::wstring ToString() const
+        {
+            std::wstring key;
+            key.reserve(server.size() + ns.size() + user.size() + 2);
+            for (auto c : server)
+                key.push_back(static_cast<wchar_t>(c >= L'a' && c <= L'z' ? c - (L'a' - L'A') : c));
+            key.push_back(L'|');
+            for (auto c : ns)
+                key.push_back(static_cast<wchar_t>(c >= L'a' && c <= L'z' ? c - (L'a' - L'A') : c));
+            key.push_back(L'|');
+            key.append(user);
+            return key;
+        }
+    };
+
+    // Opens and probes connections; the WMI implementation wraps IWbemLocator, tests
+    // use a stub. Connect reports failure by throwing.
+    template<typename Connection>
+    class IConnector
+    {
+    public:
+        virtual ~IConnector() = default;
+
+        virtual Connection Connect(ConnectionKey const& key) = 0;
+        virtual bool IsHealthy(Connection const& connection) = 0;
+    };
+
+    struct ConnectionPoolStats
+    {
+        std::uint64_t acquires = 0;
+        std::uint64_t connects = 0;
+        std::uint64_t healthChecks = 0;
+        std::uint64_t reconnects = 0;
+        std::uint64_t failures = 0;
+        std::size_t connections = 0;
+    };
+
+    // Process-wide set of warm connections, one per key, shared by every caller.
+    // Connections are opened on first use and re-validated with IsHealthy once
+    // healthCheckInterval has passed since the last successful use (see Confirm) or
+    // check.
+    //
+    // Connections that only work where they were opened, such as COM proxies in
+    // their apartment, are kept per scope: scope() names the caller's, and callers
+    // of different scopes never share a connection.
+    template<typename Connection>
+    class ConnectionPool
+    {
+    public:
+        using clock = std::chrono::steady_clock;
+        using time_source = std::function<clock::time_point()>;
+        using scope_source = std::function<std::uint64_t()>;
+
+        explicit ConnectionPool(std::shared_ptr<IConnector<Connection>> connector,
+            clock::duration healthCheckInterval = std::chrono::seconds{ 30 }, time_source now = &clock::now, scope_source scope = {})
+            : m_connector(std::move(connector)), m_healthCheckInterval(healthCheckInterval), m_now(std::move(now)), m_scope(std::move(scope))
+        {
+        }
+
+        ConnectionPool(const ConnectionPool&) = delete;
+        ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+        [[nodiscard]] Connection Acquire(ConnectionKey const& key)
+        {
+            m_acquires.fetch_add(1, std::memory_order_relaxed);
+
+            auto slot = slotFor(slotKey(key));
+
+            // Only callers of the same key serialize here, and only while a
+            // connection is being opened or probed.
+            std::lock_guard lk(slot->mutex);
+            const auto now = m_now();
+
+            if (slot->connected)
+            {
+                if (now - slot->verified < m_healthCheckInterval) [[likely]]
+                    return slot->connection;
+
+                m_healthChecks.fetch_add(1, std::memory_order_relaxed);
+                if (m_connector->IsHealthy(slot->connection))
+                {
+                    slot->verified = now;
+                    return slot->connection;
+                }
+
+                m_reconnects.fetch_add(1, std::memory_order_relaxed);
+                slot->connected = false;
+                slot->connection = Connection{};
+            }
+
+            try
+            {
+                slot->connection = m_connector->Connect(key);
+            }
+            catch (...)
+            {
+                m_failures.fetch_add(1, std::memory_order_relaxed);
+                throw;
+            }
+
+            m_connects.fetch_add(1, std::memory_order_relaxed);
+            slot->connected = true;
+            slot->verified = m_now();
+            return slot->connection;
+        }
+
+        // Records that a call on the caller's connection for key succeeded, which
+        // counts as a health check.
+        void Confirm(ConnectionKey const& key)
+        {
+            std::shared_ptr<Slot> slot;
+            {
+                std::lock_guard lk(m_mutex);
+                auto it = m_slots.find(slotKey(key));
+                if (it == m_slots.end())
+                    return;
+                slot = it->second;
+            }
+
+            const auto now = m_now();
+            std::lock_guard lk(slot->mutex);
+            if (slot->connected && slot->verified < now)
+                slot->verified = now;
+        }
+
+        // Drops the connections for key in every scope, typically after a call failed
+        // with a transport error; the next Acquire reconnects.
+        void Invalidate(ConnectionKey const& key)
+        {
+            const auto prefix = key.ToString();
+
+            std::vector<std::shared_ptr<Slot>> slots;
+            {
+                std::lock_guard lk(m_mutex);
+                for (auto const& [text, slot] : m_slots)
+                {
+                    if (!text.starts_with(prefix))
+                        continue;
+
+                    // Scoped slots are the key followed by "#<scope>".
+                    auto rest = std::wstring_view{ text }.substr(prefix.size());
+                    const bool matches = m_scope
+                        ? rest.size() > 1 && rest[0] == L'#' && rest.find_first_not_of(L"0123456789", 1) == std::wstring_view::npos
+                        : rest.empty();
+                    if (matches)
+                        slots.push_back(slot);
+                }
+            }
+
+            for (auto const& slot : slots)
+            {
+                std::lock_guard lk(slot->mutex);
+                slot->connected = false;
+                slot->connection = Connection{};
+            }
+        }
+
+        void Clear()
+        {
+            std::lock_guard lk(m_mutex);
+            m_slots.clear();
+        }
+
+        [[nodiscard]] ConnectionPoolStats Stats() const
+        {
+            ConnectionPoolStats stats{ m_acquires.load(std::memory_order_relaxed), m_connects.load(std::memory_order_relaxed),
+                m_healthChecks.load(std::memory_order_relaxed), m_reconnects.load(std::memory_order_relaxed),
+                m_failures.load(std::memory_order_relaxed), 0 };
+
+            std::lock_guard lk(m_mutex);
+            for (auto const& [key, slot] : m_slots)
+            {
+                std::lock_guard slotLock(slot->mutex);
+                stats.connections += slot->connected ? 1 : 0;
+            }
+            return stats;
+        }
+
+    private:
+        struct Slot
+        {
+            mutable std::mutex mutex;
+            Connection connection{};
+            bool connected = false;
+            clock::time_point verified{};
+        };
+
+        std::wstring slotKey(ConnectionKey const& key) const
+        {
+            auto text = key.ToString();
+            if (m_scope)
+            {
+                text.push_back(L'#');
+                text.append(std::to_wstring(m_scope()));
+            }
+            return text;
+        }
+
+        std::shared_ptr<Slot> slotFor(std::wstring key)
+        {
+            std::lock_guard lk(m_mutex);
+            auto it = m_slots.find(std::wstring_view{ key });
+            if (it != m_slots.end()) [[likely]]
+                return it->second;
+
+            return m_slots.emplace(std::move(key), std::make_shared<Slot>()).first->second;
+        }
+
+    private:
+        std::shared_ptr<IConnector<Connection>> m_connector;
+        clock::duration m_healthCheckInterval;
+        time_source m_now;
+        scope_source m_scope;
+
+        mutable std::mutex m_mutex;
+        std::unordered_map<std::wstring, std::shared_ptr<Slot>, TransparentStringHash, TransparentStringEqual> m_slots;
+
+        std::atomic<std::uint64_t> m_acquires{ 0 };
+        std::atomic<std::uint64_t> m_connects{ 0 };
+        std::atomic<std::uint64_t> m_healthChecks{ 0 };
+        std::atomic<std::uint64_t> m_reconnects{ 0 };
+        std::atomic<std::uint64_t> m_failures{ 0 };
+    };
+}
@@ -0,0 +1,260 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace Wmi
+{
+    struct EventCoalescerOptions
+    {
+        // A batch is handed out as soon as it holds maxBatch events...
+        std::size_t maxBatch = 256;
+
+        // ...or once its first event has waited maxDelay, whichever comes first.
+        std::chrono::milliseconds maxDelay{ 250 };
+
+        // Events buffered across all batches before new ones are dropped.
+        std::size_t maxPending = 64 * 1024;
+    };
+
+    struct EventCoalescerStats
+    {
+        std::uint64_t events = 0;
+        std::uint64_t dropped = 0;
+        std::uint64_t batches = 0;
+        std::uint64_t fullBatches = 0;
+        std::uint64_t timedBatches = 0;
+        std::size_t peakPending = 0;
+    };
+
+    // Groups a stream of notifications into batches bounded by count and by age.
+    // Unlike BatchChannel the producer never blocks: winmgmt delivers events on its
+    // own threads and holding them back only delays the next delivery, so once
+    // maxPending events are buffered further events are dropped and counted.
+    template<typename T>
+    class EventCoalescer
+    {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        // onWake runs, under the lock, wherever a blocked Pop would be woken, so a consumer
+        // that must not block (e.g. a coroutine waiting on an event) can use TryPop and DueAt.
+        explicit EventCoalescer(EventCoalescerOptions const& options = {}, std::function<void()> onWake = {})
+            : m_maxBatch(std::max<std::size_t>(options.maxBatch, 1)),
+              m_maxDelay((std::max)(options.maxDelay, std::chrono::milliseconds{ 0 })),
+              m_maxPending((std::max)(options.maxPending, m_maxBatch)),
+              m_onWake(std::move(onWake))
+        {
+            m_open.reserve(m_maxBatch);
+        }
+
+        EventCoalescer(const EventCoalescer&) = delete;
+        EventCoalescer& operator=(const EventCoalescer&) = delete;
+
+        // Returns false when the event was refused. Only events refused because the
+        // coalescer is full count as dropped; once closed, nothing is expected any more.
+        bool Post(T event)
+        {
+            std::lock_guard lk(m_mutex);
+            return append(std::move(event), clock::now());
+        }
+
+        // Posts a whole delivery under one lock; returns how many events were accepted.
+        std::size_t PostAll(std::vector<T> events)
+        {
+            const auto now = clock::now();
+            std::size_t accepted = 0;
+
+            std::lock_guard lk(m_mutex);
+            for (auto& event : events)
+                accepted += append(std::move(event), now) ? 1 : 0;
+            return accepted;
+        }
+
+        // Producer side: no more events will follow. Buffered events are still delivered,
+        // without waiting for maxDelay. status is an HRESULT-style code.
+        void Complete(std::int32_t status = 0)
+        {
+            std::lock_guard lk(m_mutex);
+            if (m_closed)
+                return;
+
+            m_status = status;
+            m_closed = true;
+            wakeAll();
+        }
+
+        // Consumer side: drop everything buffered and release a blocked Pop.
+        void Cancel(std::int32_t status)
+        {
+            std::lock_guard lk(m_mutex);
+            m_ready.clear();
+            m_open.clear();
+            m_pending = 0;
+            if (!m_closed)
+                m_status = status;
+            m_closed = true;
+            wakeAll();
+        }
+
+        // Blocks until a batch is due. Returns nullopt once closed and drained.
+        [[nodiscard]] std::optional<std::vector<T>> Pop()
+        {
+            std::unique_lock lk(m_mutex);
+            for (;;)
+            {
+                if (auto batch = take(clock::now()))
+                    return batch;
+
+                if (m_closed)
+                    return std::nullopt;
+
+                // Posting into an empty coalescer notifies, so an idle consumer needs no timeout.
+                if (m_open.empty())
+                    m_cv.wait(lk);
+                else
+                    m_cv.wait_until(lk, m_openedAt + m_maxDelay);
+            }
+        }
+
+        // Returns a batch only if one is already due.
+        [[nodiscard]] std::optional<std::vector<T>> TryPop()
+        {
+            std::lock_guard lk(m_mutex);
+            return take(clock::now());
+        }
+
+        // When the next batch falls due: now if one is ready or the coalescer is closed,
+        // nullopt while nothing is buffered (the next Post wakes the consumer).
+        [[nodiscard]] std::optional<clock::time_point> DueAt() const
+        {
+            std::lock_guard lk(m_mutex);
+            if (!m_ready.empty() || m_closed)
+                return clock::now();
+            if (m_open.empty())
+                return std::nullopt;
+            return m_openedAt + m_maxDelay;
+        }
+
+        [[nodiscard]] bool IsCompleted() const
+        {
+            std::lock_guard lk(m_mutex);
+            return m_closed && m_pending == 0;
+        }
+
+        [[nodiscard]] std::int32_t Status() const
+        {
+            std::lock_guard lk(m_mutex);
+            return m_status;
+        }
+
+        [[nodiscard]] EventCoalescerStats Stats() const
+        {
+            std::lock_guard lk(m_mutex);
+            return m_stats;
+        }
+
+        [[nodiscard]] std::size_t MaxBatch() const noexcept { return m_maxBatch; }
+        [[nodiscard]] std::chrono::milliseconds MaxDelay() const noexcept { return m_maxDelay; }
+
+    private:
+        bool append(T&& event, clock::time_point now)
+        {
+            if (m_closed) [[unlikely]]
+                return false;
+
+            if (m_pending >= m_maxPending) [[unlikely]]
+            {
+                ++m_stats.dropped;
+                return false;
+            }
+
+            // The consumer only needs waking when a batch starts (it then knows the
+            // deadline) or fills up, not for every event in between.
+            if (m_open.empty())
+            {
+                m_openedAt = now;
+                wakeOne();
+            }
+
+            m_open.push_back(std::move(event));
+            ++m_pending;
+            ++m_stats.events;
+            m_stats.peakPending = (std::max)(m_stats.peakPending, m_pending);
+
+            if (m_open.size() >= m_maxBatch)
+            {
+                m_ready.push_back(std::move(m_open));
+                m_open = {};
+                m_open.reserve(m_maxBatch);
+                wakeOne();
+            }
+            return true;
+        }
+
+        void wakeOne()
+        {
+            m_cv.notify_one();
+            if (m_onWake)
+                m_onWake();
+        }
+
+        void wakeAll()
+        {
+            m_cv.notify_all();
+            if (m_onWake)
+                m_onWake();
+        }
+
+        std::optional<std::vector<T>> take(clock::time_point now)
+        {
+            std::vector<T> batch;
+            if (!m_ready.empty())
+            {
+                batch = std::move(m_ready.front());
+                m_ready.pop_front();
+                ++m_stats.fullBatches;
+            }
+            else if (!m_open.empty() && (m_closed || now - m_openedAt >= m_maxDelay))
+            {
+                batch = std::move(m_open);
+                m_open = {};
+                ++m_stats.timedBatches;
+            }
+            else
+            {
+                return std::nullopt;
+            }
+
+            m_pending -= batch.size();
+            ++m_stats.batches;
+            return batch;
+        }
+
+    private:
+        const std::size_t m_maxBatch;
+        const std::chrono::milliseconds m_maxDelay;
+        const std::size_t m_maxPending;
+        const std::function<void()> m_onWake;
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_cv;
+
+        std::vector<T> m_open;
+        clock::time_point m_openedAt{};
+        std::deque<std::vector<T>> m_ready;
+        std::size_t m_pending = 0;
+        EventCoalescerStats m_stats;
+        std::int32_t m_status = 0;
+        bool m_closed = false;
+    };
+}
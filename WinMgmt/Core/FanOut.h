@@ -0,0 +1,183 @@
+#pragma once
+
+#include "QueryBackend.h"
+#include "WorkStealingExecutor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Wmi
+{
+    struct FanOutQuery
+    {
+        std::wstring ns;
+        std::wstring query;
+    };
+
+    struct FanOutResult
+    {
+        // Index of the query in the list passed to Start.
+        std::size_t source = 0;
+
+        // Null when the query failed; error then holds what the backend threw.
+        ResultTablePtr table;
+        std::exception_ptr error;
+
+        // From Start until the query began, and the time it spent in the backend.
+        std::chrono::microseconds queued{ 0 };
+        std::chrono::microseconds elapsed{ 0 };
+    };
+
+    struct FanOutStats
+    {
+        std::size_t completed = 0;
+        std::size_t failed = 0;
+        std::size_t peakConcurrency = 0;
+    };
+
+    // Runs a set of (namespace, query) pairs on a shared executor and streams the
+    // results back in completion order, each tagged with the query it came from.
+    // At most maxConcurrency queries run at once: Start seeds that many chains, and
+    // each chain submits the next pending query from the worker that just finished
+    // one, leaving idle workers to steal it. The executor must outlive the run.
+    class FanOut : public std::enable_shared_from_this<FanOut>
+    {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        // A maxConcurrency of 0 runs one query per executor worker.
+        [[nodiscard]] static std::shared_ptr<FanOut> Start(WorkStealingExecutor& executor, std::shared_ptr<IQueryBackend> backend, std::vector<FanOutQuery> queries, std::size_t maxConcurrency = 0)
+        {
+            std::shared_ptr<FanOut> run{ new FanOut(executor, std::move(backend), std::move(queries)) };
+
+            const auto limit = maxConcurrency ? maxConcurrency : executor.WorkerCount();
+            const auto chains = (std::min)(limit, run->m_queries.size());
+            for (std::size_t i = 0; i < chains; ++i)
+                executor.Submit([run] { run->step(); });
+
+            return run;
+        }
+
+        FanOut(const FanOut&) = delete;
+        FanOut& operator=(const FanOut&) = delete;
+
+        // Blocks until the next query finishes. Returns nullopt once every result has
+        // been handed out, or after Cancel.
+        [[nodiscard]] std::optional<FanOutResult> Next()
+        {
+            std::unique_lock lk(m_mutex);
+            m_cv.wait(lk, [this] { return !m_ready.empty() || m_outstanding == 0 || m_cancelled; });
+
+            if (m_ready.empty())
+                return std::nullopt;
+
+            auto result = std::move(m_ready.front());
+            m_ready.pop_front();
+            return result;
+        }
+
+        // Queries not started yet are skipped and results not yet handed out are
+        // dropped. Queries already in the backend still run to completion.
+        void Cancel()
+        {
+            std::lock_guard lk(m_mutex);
+            m_cancelled = true;
+            m_ready.clear();
+            m_cv.notify_all();
+        }
+
+        [[nodiscard]] bool IsCompleted() const
+        {
+            std::lock_guard lk(m_mutex);
+            return m_ready.empty() && (m_outstanding == 0 || m_cancelled);
+        }
+
+        [[nodiscard]] std::vector<FanOutQuery> const& Queries() const noexcept { return m_queries; }
+
+        [[nodiscard]] FanOutStats Stats() const
+        {
+            std::lock_guard lk(m_mutex);
+            return m_stats;
+        }
+
+    private:
+        FanOut(WorkStealingExecutor& executor, std::shared_ptr<IQueryBackend> backend, std::vector<FanOutQuery> queries)
+            : m_executor(executor), m_backend(std::move(backend)), m_queries(std::move(queries)), m_started(clock::now()), m_outstanding(m_queries.size())
+        {
+        }
+
+        // Runs one pending query, then hands the chain on to the next.
+        void step()
+        {
+            const auto index = m_next.fetch_add(1, std::memory_order_relaxed);
+            if (index >= m_queries.size() || isCancelled())
+                return;
+
+            auto const& query = m_queries[index];
+            FanOutResult result;
+            result.source = index;
+
+            const auto started = clock::now();
+            result.queued = std::chrono::duration_cast<std::chrono::microseconds>(started - m_started);
+
+            const auto running = m_running.fetch_add(1, std::memory_order_relaxed) + 1;
+            try
+            {
+                result.table = m_backend->Execute(query.ns, query.query);
+            }
+            catch (...)
+            {
+                result.error = std::current_exception();
+            }
+            m_running.fetch_sub(1, std::memory_order_relaxed);
+            result.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - started);
+
+            {
+                std::lock_guard lk(m_mutex);
+                --m_outstanding;
+                ++(result.error ? m_stats.failed : m_stats.completed);
+                m_stats.peakConcurrency = (std::max)(m_stats.peakConcurrency, running);
+                if (!m_cancelled)
+                    m_ready.push_back(std::move(result));
+                m_cv.notify_one();
+            }
+
+            if (m_next.load(std::memory_order_relaxed) < m_queries.size() && !isCancelled())
+                m_executor.Submit([self = shared_from_this()] { self->step(); });
+        }
+
+        bool isCancelled() const
+        {
+            std::lock_guard lk(m_mutex);
+            return m_cancelled;
+        }
+
+    private:
+        WorkStealingExecutor& m_executor;
+        std::shared_ptr<IQueryBackend> m_backend;
+        const std::vector<FanOutQuery> m_queries;
+        const clock::time_point m_started;
+
+        std::atomic<std::size_t> m_next{ 0 };
+        std::atomic<std::size_t> m_running{ 0 };
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_cv;
+        std::deque<FanOutResult> m_ready;
+        std::size_t m_outstanding;
+        FanOutStats m_stats;
+        bool m_cancelled = false;
+    };
+}
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Wmi
+{
+    struct MpscQueueStats
+    {
+        std::uint64_t batches = 0;
+        std::uint64_t items = 0;
+        std::uint64_t contention = 0;
+        std::uint64_t drains = 0;
+        std::uint64_t refused = 0;
+    };
+
+    // Lock-free hand-off from many producers (winmgmt's RPC threads calling Indicate)
+    // to one consumer. Producers push whole batches onto an atomic list with a single
+    // compare-and-swap; the consumer detaches the list in one exchange and reverses it,
+    // so batches come out in the order their pushes took effect and each producer's
+    // batches keep their order. Failed compare-and-swaps are counted as contention.
+    //
+    // Close detaches what is left and refuses later pushes, which is how the owner
+    // releases buffered items when the call is abandoned. Drain and Close are for the
+    // single consumer; Push may be called from any number of threads.
+    template<typename T>
+    class MpscBatchQueue
+    {
+    public:
+        MpscBatchQueue() = default;
+
+        MpscBatchQueue(const MpscBatchQueue&) = delete;
+        MpscBatchQueue& operator=(const MpscBatchQueue&) = delete;
+
+        ~MpscBatchQueue()
+        {
+            (void)Close();
+        }
+
+        // Returns false, dropping the batch, once the queue is closed.
+        bool Push(std::vector<T> batch)
+        {
+            if (batch.empty()) [[unlikely]]
+                return !IsClosed();
+
+            const auto count = batch.size();
+            auto node = std::make_unique<Node>(std::move(batch));
+
+            auto head = m_head.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                if (head == &m_closed) [[unlikely]]
+                {
+                    m_refused.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+
+                node->next = head;
+                if (m_head.compare_exchange_weak(head, node.get(), std::memory_order_release, std::memory_order_relaxed)) [[likely]]
+                    break;
+
+                m_contention.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            node.release();
+            m_batches.fetch_add(1, std::memory_order_relaxed);
+            m_items.fetch_add(count, std::memory_order_relaxed);
+            return true;
+        }
+
+        // Appends everything pushed so far to out, in push order. Out is any container
+        // with push_back, e.g. a RowArena. Returns the number of batches taken.
+        template<typename Out>
+        std::size_t Drain(Out& out)
+        {
+            auto head = m_head.load(std::memory_order_relaxed);
+            do
+            {
+                if (head == nullptr || head == &m_closed)
+                    return 0;
+            } while (!m_head.compare_exchange_weak(head, nullptr, std::memory_order_acquire, std::memory_order_relaxed));
+
+            m_drains.fetch_add(1, std::memory_order_relaxed);
+            return take(head, out);
+        }
+
+        // Refuses later pushes and returns what was still queued, in push order.
+        std::vector<T> Close()
+        {
+            std::vector<T> rest;
+            CloseInto(rest);
+            return rest;
+        }
+
+        // Close, appending what was still queued to out.
+        template<typename Out>
+        void CloseInto(Out& out)
+        {
+            auto head = m_head.exchange(&m_closed, std::memory_order_acq_rel);
+            if (head != &m_closed)
+                take(head, out);
+        }
+
+        [[nodiscard]] bool IsClosed() const noexcept
+        {
+            return m_head.load(std::memory_order_acquire) == &m_closed;
+        }
+
+        [[nodiscard]] MpscQueueStats Stats() const noexcept
+        {
+            return {
+                m_batches.load(std::memory_order_relaxed),
+                m_items.load(std::memory_order_relaxed),
+                m_contention.load(std::memory_order_relaxed),
+                m_drains.load(std::memory_order_relaxed),
+                m_refused.load(std::memory_order_relaxed)
+            };
+        }
+
+    private:
+        struct Node
+        {
+            Node() = default;
+            explicit Node(std::vector<T> batch) : items(std::move(batch)) {}
+
+            std::vector<T> items;
+            Node* next = nullptr;
+        };
+
+        // The detached list runs newest first; reverse it, then move the items out.
+        template<typename Out>
+        static std::size_t take(Node* head, Out& out)
+        {
+            Node* oldest = nullptr;
+            std::size_t batches = 0;
+            while (head)
+            {
+                auto next = head->next;
+                head->next = oldest;
+                oldest = head;
+                head = next;
+                ++batches;
+            }
+
+            while (oldest)
+            {
+                std::unique_ptr<Node> node{ oldest };
+                oldest = node->next;
+                if constexpr (std::is_same_v<Out, std::vector<T>>)
+                {
+                    out.insert(out.end(), std::make_move_iterator(node->items.begin()), std::make_move_iterator(node->items.end()));
+                }
+                else
+                {
+                    for (auto& item : node->items)
+                        out.push_back(std::move(item));
+                }
+            }
+            return batches;
+        }
+
+    private:
+        // Its address marks a closed queue; it never holds items.
+        Node m_closed;
+
+        std::atomic<Node*> m_head{ nullptr };
+        std::atomic<std::uint64_t> m_batches{ 0 };
+        std::atomic<std::uint64_t> m_items{ 0 };
+        std::atomic<std::uint64_t> m_contention{ 0 };
+        std::atomic<std::uint64_t> m_drains{ 0 };
+        std::atomic<std::uint64_t> m_refused{ 0 };
+    };
+}
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <utility>
+
+namespace Wmi
+{
+    // Final statuses a caller imposes on a provider call, matching winmgmt's codes.
+    namespace CallStatus
+    {
+        constexpr std::int32_t Ok = 0;                                              // WBEM_S_NO_ERROR
+        constexpr std::int32_t Cancelled = static_cast<std::int32_t>(0x80041032);   // WBEM_E_CALL_CANCELLED
+        constexpr std::int32_t TimedOut = static_cast<std::int32_t>(0x80043001);    // WBEM_E_TIMED_OUT
+    }
+
+    // One asynchronous provider call as shared by its sink and its caller. The sink
+    // adds results to the Buffer through Produce and reports the final status with
+    // Complete; the caller waits, optionally up to a deadline, or gives up with
+    // Cancel. Whichever finishes the call first decides its status. Giving up frees
+    // the buffered results at once, runs the canceller (CancelAsyncCall) exactly
+    // once, and makes later Produce calls fail so the sink can tell the provider to
+    // stop. Thread-safe.
+    template<typename Buffer>
+    class PendingCall
+    {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        // onFinished runs once when the call finishes, however it ended, e.g. to signal an event.
+        explicit PendingCall(std::function<void()> onFinished = {})
+            : m_onFinished(std::move(onFinished))
+        {
+        }
+
+        PendingCall(const PendingCall&) = delete;
+        PendingCall& operator=(const PendingCall&) = delete;
+
+        // Set once the call has started. Runs at once if the caller already gave up,
+        // and never if the call completed on its own.
+        void OnCancel(std::function<void()> canceller)
+        {
+            {
+                std::lock_guard lk(m_mutex);
+                if (!m_cancelled)
+                {
+                    if (!m_finished)
+                        m_canceller = std::move(canceller);
+                    return;
+                }
+            }
+            canceller();
+        }
+
+        // Runs fill(buffer) under the lock. Returns false, without calling it, once the
+        // call has finished.
+        template<typename Fill>
+        bool Produce(Fill&& fill)
+        {
+            std::lock_guard lk(m_mutex);
+            if (m_finished) [[unlikely]]
+                return false;
+
+            std::forward<Fill>(fill)(m_buffer);
+            return true;
+        }
+
+        // Provider side. status is the HRESULT-style code winmgmt reported. Returns false
+        // when the caller had already given up.
+        bool Complete(std::int32_t status)
+        {
+            return finish(status, false);
+        }
+
+        // Caller side. Returns false when the call had already finished.
+        bool Cancel(std::int32_t reason = CallStatus::Cancelled)
+        {
+            return finish(reason, true);
+        }
+
+        std::int32_t Wait()
+        {
+            std::unique_lock lk(m_mutex);
+            m_cv.wait(lk, [this] { return m_signalled; });
+            return m_status;
+        }
+
+        // Gives up with CallStatus::TimedOut when the call has not finished by deadline.
+        std::int32_t WaitUntil(clock::time_point deadline)
+        {
+            {
+                std::unique_lock lk(m_mutex);
+                if (m_cv.wait_until(lk, deadline, [this] { return m_signalled; }))
+                    return m_status;
+            }
+
+            Cancel(CallStatus::TimedOut);
+
+            // Whoever finished the call may still be running its callbacks.
+            return Wait();
+        }
+
+        std::int32_t WaitFor(clock::duration timeout)
+        {
+            return WaitUntil(clock::now() + timeout);
+        }
+
+        // Moves the results out; meaningful once the call completed successfully.
+        [[nodiscard]] Buffer Take()
+        {
+            std::lock_guard lk(m_mutex);
+            return std::exchange(m_buffer, Buffer{});
+        }
+
+        [[nodiscard]] bool IsFinished() const
+        {
+            std::lock_guard lk(m_mutex);
+            return m_finished;
+        }
+
+        [[nodiscard]] bool IsCancelled() const
+        {
+            std::lock_guard lk(m_mutex);
+            return m_cancelled;
+        }
+
+        [[nodiscard]] std::int32_t Status() const
+        {
+            std::lock_guard lk(m_mutex);
+            return m_status;
+        }
+
+    private:
+        bool finish(std::int32_t status, bool cancel)
+        {
+            std::function<void()> canceller;
+            Buffer released;
+            {
+                std::lock_guard lk(m_mutex);
+                if (m_finished)
+                    return false;
+
+                m_finished = true;
+                m_cancelled = cancel;
+                m_status = status;
+                if (cancel)
+                {
+                    released = std::exchange(m_buffer, Buffer{});
+                    canceller = std::move(m_canceller);
+                }
+                m_canceller = nullptr;
+            }
+
+            // The canceller calls into the provider and the released results may be many
+            // objects; neither happens under the lock.
+            if (canceller)
+                canceller();
+            released = Buffer{};
+
+            if (m_onFinished)
+                m_onFinished();
+
+            // Waiters are released last, so nothing here runs after one of them has
+            // destroyed the call.
+            std::lock_guard lk(m_mutex);
+            m_signalled = true;
+            m_cv.notify_all();
+            return true;
+        }
+
+    private:
+        const std::function<void()> m_onFinished;
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_cv;
+        Buffer m_buffer{};
+        std::function<void()> m_canceller;
+        std::int32_t m_status = CallStatus::Ok;
+        bool m_finished = false;
+        bool m_cancelled = false;
+        bool m_signalled = false;
+    };
+}
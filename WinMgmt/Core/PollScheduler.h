@@ -0,0 +1,309 @@
+#pragma once
+
+#include "SchemaCache.h"
+#include "TimerWheel.h"
+#include "WqlLexer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Wmi
+{
+    // What to do with a tick that comes due while the previous run of the same
+    // query is still executing or waiting for a namespace slot.
+    enum class OverlapPolicy : std::uint8_t
+    {
+        // Drop the tick; the next run happens at the next tick after completion.
+        Skip,
+
+        // Remember it: one more run starts as soon as the current one completes,
+        // however many ticks were missed meanwhile.
+        Merge
+    };
+
+    struct PollRegistration
+    {
+        std::wstring ns;
+        std::wstring query;
+        std::chrono::milliseconds interval{ 1000 };
+
+        // Each run starts up to this much after its nominal time, so queries that
+        // share an interval do not all hit the provider on the same tick.
+        std::chrono::milliseconds jitter{ 0 };
+
+        OverlapPolicy overlap = OverlapPolicy::Skip;
+    };
+
+    // Handed to the dispatch callback; report its end with PollScheduler::Complete(id).
+    struct PollRun
+    {
+        std::uint64_t id = 0;
+        std::wstring ns;
+        std::wstring query;
+    };
+
+    struct PollSchedulerOptions
+    {
+        std::chrono::milliseconds resolution{ 10 };
+        std::size_t wheelSlots = 512;
+        std::size_t maxConcurrentPerNamespace = 2;
+
+        // Seeds the jitter; 0 picks a random seed.
+        std::uint64_t seed = 0;
+    };
+
+    struct PollSchedulerStats
+    {
+        std::uint64_t runs = 0;
+        std::uint64_t skipped = 0;
+        std::uint64_t merged = 0;
+        std::uint64_t deferred = 0;
+        std::size_t inFlight = 0;
+        std::size_t peakInFlight = 0;
+        std::size_t registrations = 0;
+    };
+
+    // Drives recurring queries from one timer wheel. Poll advances the wheel to the
+    // current time and starts whatever came due by calling dispatch(PollRun) outside
+    // the lock; dispatch starts the query (typically asynchronously) and its owner
+    // calls Complete(id) when it ends, successfully or not. At most
+    // maxConcurrentPerNamespace runs execute per namespace; the rest wait their turn
+    // in arrival order. Thread-safe.
+    class PollScheduler
+    {
+    public:
+        using clock = std::chrono::steady_clock;
+        using time_source = std::function<clock::time_point()>;
+        using dispatcher = std::function<void(PollRun const&)>;
+
+        PollScheduler(PollSchedulerOptions const& options, dispatcher dispatch, time_source now = &clock::now)
+            : m_dispatch(std::move(dispatch)),
+              m_now(std::move(now)),
+              m_maxConcurrent(std::max<std::size_t>(options.maxConcurrentPerNamespace, 1)),
+              m_wheel(options.resolution, options.wheelSlots, m_now()),
+              m_random(options.seed ? options.seed : std::random_device{}())
+        {
+        }
+
+        PollScheduler(const PollScheduler&) = delete;
+        PollScheduler& operator=(const PollScheduler&) = delete;
+
+        // The first run comes due within jitter of now. Throws std::invalid_argument for
+        // a non-positive interval.
+        std::uint64_t Register(PollRegistration registration)
+        {
+            if (registration.interval <= std::chrono::milliseconds{ 0 }) [[unlikely]]
+                throw std::invalid_argument("poll interval must be positive");
+
+            std::lock_guard lk(m_mutex);
+            const auto id = ++m_lastId;
+            const auto now = m_now();
+
+            Entry entry;
+            entry.key = upper(registration.ns);
+            entry.registration = std::move(registration);
+            entry.nominal = now;
+
+            auto& stored = m_entries.emplace(id, std::move(entry)).first->second;
+            m_wheel.Schedule(id, now + sampleJitter(stored.registration.jitter));
+            return id;
+        }
+
+        // A run already executing still completes and must still be reported.
+        bool Unregister(std::uint64_t id)
+        {
+            std::lock_guard lk(m_mutex);
+            auto it = m_entries.find(id);
+            if (it == m_entries.end() || it->second.removed)
+                return false;
+
+            auto& entry = it->second;
+            entry.removed = true;
+            if (!entry.running)
+                m_entries.erase(it);
+            return true;
+        }
+
+        // Advances the wheel to now and dispatches the runs that came due. Returns how many started.
+        std::size_t Poll()
+        {
+            std::vector<PollRun> starts;
+            {
+                std::lock_guard lk(m_mutex);
+                const auto now = m_now();
+                m_wheel.Advance(now, [&](std::uint64_t id) { due(id, now, starts); });
+            }
+
+            for (auto const& run : starts)
+                m_dispatch(run);
+            return starts.size();
+        }
+
+        // Reports the end of a dispatched run, freeing its namespace slot.
+        void Complete(std::uint64_t id)
+        {
+            std::vector<PollRun> starts;
+            {
+                std::lock_guard lk(m_mutex);
+                auto it = m_entries.find(id);
+                if (it == m_entries.end() || !it->second.running) [[unlikely]]
+                    return;
+
+                auto& entry = it->second;
+                entry.running = false;
+                --m_stats.inFlight;
+
+                auto& ns = m_namespaces[entry.key];
+                --ns.inFlight;
+
+                if (entry.removed)
+                {
+                    m_entries.erase(it);
+                }
+                else if (entry.rerun)
+                {
+                    // A merged tick queues behind runs that were already waiting.
+                    entry.rerun = false;
+                    entry.queued = true;
+                    ns.waiting.push_back(id);
+                }
+
+                drain(ns, starts);
+            }
+
+            for (auto const& run : starts)
+                m_dispatch(run);
+        }
+
+        [[nodiscard]] PollSchedulerStats Stats() const
+        {
+            std::lock_guard lk(m_mutex);
+            auto stats = m_stats;
+            stats.registrations = m_entries.size();
+            return stats;
+        }
+
+    private:
+        struct Entry
+        {
+            PollRegistration registration;
+            std::wstring key;
+            clock::time_point nominal{};
+            bool running = false;
+            bool queued = false;
+            bool rerun = false;
+            bool removed = false;
+        };
+
+        struct Namespace
+        {
+            std::size_t inFlight = 0;
+            std::deque<std::uint64_t> waiting;
+        };
+
+        static std::wstring upper(std::wstring_view text)
+        {
+            std::wstring key;
+            key.reserve(text.size());
+            for (auto c : text)
+                key.push_back(Wql::ToUpperAscii(c));
+            return key;
+        }
+
+        clock::duration sampleJitter(std::chrono::milliseconds jitter)
+        {
+            if (jitter <= std::chrono::milliseconds{ 0 })
+                return clock::duration::zero();
+
+            const auto range = std::chrono::duration_cast<clock::duration>(jitter).count();
+            return clock::duration{ std::uniform_int_distribution<clock::rep>{ 0, range }(m_random) };
+        }
+
+        void due(std::uint64_t id, clock::time_point now, std::vector<PollRun>& starts)
+        {
+            auto it = m_entries.find(id);
+            if (it == m_entries.end() || it->second.removed)
+                return;
+
+            auto& entry = it->second;
+
+            // Keep the cadence anchored to nominal times rather than to when the wheel
+            // happened to be polled; after a stall, restart from now instead of firing
+            // every missed tick.
+            entry.nominal += entry.registration.interval;
+            if (entry.nominal <= now)
+                entry.nominal = now + entry.registration.interval;
+            m_wheel.Schedule(id, entry.nominal + sampleJitter(entry.registration.jitter));
+
+            if (entry.running || entry.queued)
+            {
+                if (entry.registration.overlap == OverlapPolicy::Merge)
+                {
+                    // A run still waiting for a slot already covers this tick.
+                    entry.rerun = entry.running;
+                    ++m_stats.merged;
+                }
+                else
+                {
+                    ++m_stats.skipped;
+                }
+                return;
+            }
+
+            auto& ns = m_namespaces[entry.key];
+            entry.queued = true;
+            ns.waiting.push_back(id);
+            if (ns.inFlight >= m_maxConcurrent)
+                ++m_stats.deferred;
+
+            drain(ns, starts);
+        }
+
+        void drain(Namespace& ns, std::vector<PollRun>& starts)
+        {
+            while (ns.inFlight < m_maxConcurrent && !ns.waiting.empty())
+            {
+                const auto id = ns.waiting.front();
+                ns.waiting.pop_front();
+
+                auto it = m_entries.find(id);
+                if (it == m_entries.end() || it->second.removed || !it->second.queued)
+                    continue;
+
+                auto& entry = it->second;
+                entry.queued = false;
+                entry.running = true;
+                ++ns.inFlight;
+
+                ++m_stats.runs;
+                ++m_stats.inFlight;
+                m_stats.peakInFlight = (std::max)(m_stats.peakInFlight, m_stats.inFlight);
+                starts.push_back({ id, entry.registration.ns, entry.registration.query });
+            }
+        }
+
+    private:
+        dispatcher m_dispatch;
+        time_source m_now;
+        const std::size_t m_maxConcurrent;
+
+        mutable std::mutex m_mutex;
+        TimerWheel m_wheel;
+        std::mt19937_64 m_random;
+        std::unordered_map<std::uint64_t, Entry> m_entries;
+        std::unordered_map<std::wstring, Namespace, TransparentStringHash, TransparentStringEqual> m_namespaces;
+        std::uint64_t m_lastId = 0;
+        PollSchedulerStats m_stats;
+    };
+}
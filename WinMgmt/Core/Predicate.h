@@ -0,0 +1,721 @@
+#pragma once
+
+#include "CimDateTime.h"
+#include "ResultTable.h"
+#include "WqlParser.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cwchar>
+#include <functional>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Wmi
+{
+    // One bit per row of a result table; bits past Size() are always zero.
+    class SelectionBitmap
+    {
+    public:
+        SelectionBitmap() = default;
+        explicit SelectionBitmap(std::size_t size, bool selected = false)
+            : m_words((size + 63) / 64, selected ? ~std::uint64_t{ 0 } : 0), m_size(size)
+        {
+            clearTail();
+        }
+
+        [[nodiscard]] std::size_t Size() const noexcept { return m_size; }
+        [[nodiscard]] std::span<const std::uint64_t> Words() const noexcept { return m_words; }
+        [[nodiscard]] std::span<std::uint64_t> Words() noexcept { return m_words; }
+
+        [[nodiscard]] bool Test(std::size_t index) const noexcept
+        {
+            return (m_words[index >> 6] >> (index & 63)) & 1;
+        }
+
+        void Set(std::size_t index, bool selected = true) noexcept
+        {
+            const auto mask = std::uint64_t{ 1 } << (index & 63);
+            if (selected)
+                m_words[index >> 6] |= mask;
+            else
+                m_words[index >> 6] &= ~mask;
+        }
+
+        [[nodiscard]] std::size_t Count() const noexcept
+        {
+            std::size_t count = 0;
+            for (auto word : m_words)
+                count += static_cast<std::size_t>(std::popcount(word));
+            return count;
+        }
+
+        [[nodiscard]] bool None() const noexcept
+        {
+            return std::all_of(m_words.begin(), m_words.end(), [](std::uint64_t word) { return word == 0; });
+        }
+
+        SelectionBitmap& operator&=(SelectionBitmap const& other) noexcept
+        {
+            for (std::size_t i = 0; i < m_words.size(); ++i)
+                m_words[i] &= other.m_words[i];
+            return *this;
+        }
+
+        SelectionBitmap& operator|=(SelectionBitmap const& other) noexcept
+        {
+            for (std::size_t i = 0; i < m_words.size(); ++i)
+                m_words[i] |= other.m_words[i];
+            return *this;
+        }
+
+        void Invert() noexcept
+        {
+            for (auto& word : m_words)
+                word = ~word;
+            clearTail();
+        }
+
+        // Clears every row that is null in nulls.
+        void ExcludeNulls(NullBitmap const& nulls) noexcept
+        {
+            auto words = nulls.Words();
+            for (std::size_t i = 0; i < m_words.size(); ++i)
+                m_words[i] &= ~words[i];
+        }
+
+        // Calls f(row) for every selected row in ascending order.
+        template<typename F>
+        void ForEach(F&& f) const
+        {
+            for (std::size_t i = 0; i < m_words.size(); ++i)
+            {
+                for (auto word = m_words[i]; word != 0; word &= word - 1)
+                    f(i * 64 + static_cast<std::size_t>(std::countr_zero(word)));
+            }
+        }
+
+        [[nodiscard]] std::vector<std::size_t> Indices() const
+        {
+            std::vector<std::size_t> indices;
+            indices.reserve(Count());
+            ForEach([&](std::size_t row) { indices.push_back(row); });
+            return indices;
+        }
+
+    private:
+        void clearTail() noexcept
+        {
+            if ((m_size & 63) != 0)
+                m_words.back() &= (std::uint64_t{ 1 } << (m_size & 63)) - 1;
+        }
+
+    private:
+        std::vector<std::uint64_t> m_words;
+        std::size_t m_size = 0;
+    };
+
+    namespace detail
+    {
+        // Branch-free compare of a whole column against one constant, 64 rows per
+        // output word. The inner loop has no data-dependent control flow, so the
+        // compiler turns it into vector compares.
+        template<typename T, typename Compare>
+        void CompareColumn(std::span<const T> values, T constant, Compare compare, SelectionBitmap& out) noexcept
+        {
+            auto words = out.Words();
+            const std::size_t full = values.size() / 64;
+
+            for (std::size_t w = 0; w < full; ++w)
+            {
+                const T* block = values.data() + w * 64;
+                std::uint64_t bits = 0;
+                for (std::size_t j = 0; j < 64; ++j)
+                    bits |= std::uint64_t{ compare(block[j], constant) } << j;
+                words[w] = bits;
+            }
+
+            if (const std::size_t rest = values.size() - full * 64; rest != 0)
+            {
+                const T* block = values.data() + full * 64;
+                std::uint64_t bits = 0;
+                for (std::size_t j = 0; j < rest; ++j)
+                    bits |= std::uint64_t{ compare(block[j], constant) } << j;
+                words[full] = bits;
+            }
+        }
+
+        template<typename T>
+        void CompareColumn(std::span<const T> values, T constant, Wql::CompareOp op, SelectionBitmap& out) noexcept
+        {
+            switch (op)
+            {
+            case Wql::CompareOp::Equal:        return CompareColumn(values, constant, std::equal_to<T>{}, out);
+            case Wql::CompareOp::NotEqual:     return CompareColumn(values, constant, std::not_equal_to<T>{}, out);
+            case Wql::CompareOp::Less:         return CompareColumn(values, constant, std::less<T>{}, out);
+            case Wql::CompareOp::LessEqual:    return CompareColumn(values, constant, std::less_equal<T>{}, out);
+            case Wql::CompareOp::Greater:      return CompareColumn(values, constant, std::greater<T>{}, out);
+            case Wql::CompareOp::GreaterEqual: return CompareColumn(values, constant, std::greater_equal<T>{}, out);
+            default:                           return;
+            }
+        }
+
+        // Integer columns compared with a fractional constant, e.g. "Size > 2.5".
+        template<typename Compare>
+        void CompareAsDouble(std::span<const std::int64_t> values, bool isUnsigned, double constant, Compare compare, SelectionBitmap& out) noexcept
+        {
+            auto words = out.Words();
+            for (std::size_t w = 0; w * 64 < values.size(); ++w)
+            {
+                const std::size_t count = std::min<std::size_t>(64, values.size() - w * 64);
+                const std::int64_t* block = values.data() + w * 64;
+                std::uint64_t bits = 0;
+                for (std::size_t j = 0; j < count; ++j)
+                {
+                    const double value = isUnsigned ? static_cast<double>(static_cast<std::uint64_t>(block[j])) : static_cast<double>(block[j]);
+                    bits |= std::uint64_t{ compare(value, constant) } << j;
+                }
+                words[w] = bits;
+            }
+        }
+
+        inline void CompareAsDouble(std::span<const std::int64_t> values, bool isUnsigned, double constant, Wql::CompareOp op, SelectionBitmap& out) noexcept
+        {
+            switch (op)
+            {
+            case Wql::CompareOp::Equal:        return CompareAsDouble(values, isUnsigned, constant, std::equal_to<double>{}, out);
+            case Wql::CompareOp::NotEqual:     return CompareAsDouble(values, isUnsigned, constant, std::not_equal_to<double>{}, out);
+            case Wql::CompareOp::Less:         return CompareAsDouble(values, isUnsigned, constant, std::less<double>{}, out);
+            case Wql::CompareOp::LessEqual:    return CompareAsDouble(values, isUnsigned, constant, std::less_equal<double>{}, out);
+            case Wql::CompareOp::Greater:      return CompareAsDouble(values, isUnsigned, constant, std::greater<double>{}, out);
+            case Wql::CompareOp::GreaterEqual: return CompareAsDouble(values, isUnsigned, constant, std::greater_equal<double>{}, out);
+            default:                           return;
+            }
+        }
+
+        // Case-insensitive (ASCII) three-way compare, as WQL compares strings.
+        [[nodiscard]] inline int CompareIgnoreCase(std::wstring_view left, std::wstring_view right) noexcept
+        {
+            const std::size_t count = (std::min)(left.size(), right.size());
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                const wchar_t a = Wql::ToUpperAscii(left[i]);
+                const wchar_t b = Wql::ToUpperAscii(right[i]);
+                if (a != b)
+                    return a < b ? -1 : 1;
+            }
+            return left.size() == right.size() ? 0 : (left.size() < right.size() ? -1 : 1);
+        }
+
+        [[nodiscard]] inline bool MatchSet(std::wstring_view pattern, std::size_t& position, wchar_t c) noexcept
+        {
+            // position is just past '['; leaves it just past ']'.
+            bool negate = position < pattern.size() && pattern[position] == L'^';
+            if (negate)
+                ++position;
+
+            bool matched = false;
+            const wchar_t upper = Wql::ToUpperAscii(c);
+            while (position < pattern.size() && pattern[position] != L']')
+            {
+                const wchar_t low = Wql::ToUpperAscii(pattern[position]);
+                if (position + 2 < pattern.size() && pattern[position + 1] == L'-' && pattern[position + 2] != L']')
+                {
+                    const wchar_t high = Wql::ToUpperAscii(pattern[position + 2]);
+                    matched |= upper >= low && upper <= high;
+                    position += 3;
+                }
+                else
+                {
+                    matched |= upper == low;
+                    ++position;
+                }
+            }
+            if (position < pattern.size())
+                ++position;
+
+            return matched != negate;
+        }
+
+        // WQL LIKE: % any run, _ any character, [abc] / [a-z] / [^abc] character sets.
+        [[nodiscard]] inline bool MatchLike(std::wstring_view text, std::wstring_view pattern) noexcept
+        {
+            std::size_t t = 0, p = 0;
+            std::size_t starPattern = std::wstring_view::npos, starText = 0;
+
+            while (t < text.size())
+            {
+                if (p < pattern.size() && pattern[p] == L'%')
+                {
+                    starPattern = ++p;
+                    starText = t;
+                    continue;
+                }
+
+                bool matched = false;
+                std::size_t next = p;
+                if (p < pattern.size())
+                {
+                    if (pattern[p] == L'_')
+                    {
+                        matched = true;
+                        next = p + 1;
+                    }
+                    else if (pattern[p] == L'[')
+                    {
+                        next = p + 1;
+                        matched = MatchSet(pattern, next, text[t]);
+                    }
+                    else
+                    {
+                        matched = Wql::ToUpperAscii(pattern[p]) == Wql::ToUpperAscii(text[t]);
+                        next = p + 1;
+                    }
+                }
+
+                if (matched)
+                {
+                    p = next;
+                    ++t;
+                }
+                else if (starPattern != std::wstring_view::npos)
+                {
+                    p = starPattern;
+                    t = ++starText;
+                }
+                else
+                {
+                    return false;
+                }
+            }
+
+            while (p < pattern.size() && pattern[p] == L'%')
+                ++p;
+            return p == pattern.size();
+        }
+
+        [[nodiscard]] inline std::optional<std::int64_t> ParseInteger(std::wstring const& text) noexcept
+        {
+            if (text.empty())
+                return std::nullopt;
+
+            wchar_t* end = nullptr;
+            const bool negative = text[0] == L'-';
+            const auto value = negative ? std::wcstoll(text.c_str(), &end, 10) : static_cast<std::int64_t>(std::wcstoull(text.c_str(), &end, 10));
+            if (end != text.c_str() + text.size())
+                return std::nullopt;
+            return value;
+        }
+
+        [[nodiscard]] inline std::optional<double> ParseReal(std::wstring const& text) noexcept
+        {
+            if (text.empty())
+                return std::nullopt;
+
+            wchar_t* end = nullptr;
+            const double value = std::wcstod(text.c_str(), &end);
+            if (end != text.c_str() + text.size())
+                return std::nullopt;
+            return value;
+        }
+    }
+
+    // A WQL WHERE clause compiled for evaluation against result tables already in
+    // memory. Numeric comparisons run as whole-column passes that write selection
+    // words directly; strings are compared case-insensitively like winmgmt does.
+    // Comparisons never select null cells (NOT is a plain complement, so it does),
+    // and a property the table does not have behaves as a column of nulls.
+    class Predicate
+    {
+    public:
+        // Selects every row.
+        Predicate() = default;
+
+        // Compiles query's WHERE clause; throws std::invalid_argument for ISA, which
+        // needs class metadata a table does not carry.
+        [[nodiscard]] static Predicate Compile(Wql::Query const& query)
+        {
+            Predicate predicate;
+            if (query.where != Wql::NoNode)
+                predicate.m_root = predicate.compile(query, query.where);
+            return predicate;
+        }
+
+        // Accepts a full SELECT statement or just a condition ("Name LIKE 'svc%'").
+        // Throws std::invalid_argument when the text does not parse.
+        [[nodiscard]] static Predicate Compile(std::wstring_view text)
+        {
+            auto trimmed = text.substr((std::min)(text.find_first_not_of(L" \t\r\n"), text.size()));
+            const bool isStatement = trimmed.size() >= 6 && Wql::EqualsIgnoreCase(trimmed.substr(0, 6), L"SELECT");
+
+            std::wstring statement = isStatement ? std::wstring{ text } : L"SELECT * FROM __Object WHERE " + std::wstring{ text };
+            auto parsed = Wql::Parse(statement);
+            if (!parsed)
+                throw std::invalid_argument("invalid WQL condition");
+
+            return Compile(parsed.query);
+        }
+
+        [[nodiscard]] bool SelectsAll() const noexcept { return m_root == Wql::NoNode; }
+
+        [[nodiscard]] SelectionBitmap Evaluate(ResultTable const& table) const
+        {
+            if (m_root == Wql::NoNode)
+                return SelectionBitmap{ table.RowCount(), true };
+            return evaluate(table, m_root);
+        }
+
+    private:
+        struct Node
+        {
+            Wql::ExprKind kind = Wql::ExprKind::Compare;
+            Wql::CompareOp op = Wql::CompareOp::Equal;
+            Wql::LiteralKind literalKind = Wql::LiteralKind::Null;
+            std::wstring property;
+            std::wstring otherProperty;
+            std::wstring text;
+            std::int64_t integer = 0;
+            double real = 0.0;
+            bool boolean = false;
+            std::uint32_t left = Wql::NoNode;
+            std::uint32_t right = Wql::NoNode;
+        };
+
+        std::uint32_t compile(Wql::Query const& query, std::uint32_t index)
+        {
+            auto const& expr = query.Node(index);
+            if (expr.kind == Wql::ExprKind::Isa)
+                throw std::invalid_argument("ISA cannot be evaluated against a result table");
+
+            Node node;
+            node.kind = expr.kind;
+            node.op = expr.op;
+            node.property.assign(expr.property);
+            node.otherProperty.assign(expr.otherProperty);
+            node.literalKind = expr.literal.kind;
+            node.text = expr.literal.kind == Wql::LiteralKind::String ? Wql::Unescape(expr.literal.text) : std::wstring{ expr.literal.text };
+            node.integer = expr.literal.integer;
+            node.real = expr.literal.real;
+            node.boolean = expr.literal.boolean;
+
+            if (expr.left != Wql::NoNode)
+                node.left = compile(query, expr.left);
+            if (expr.right != Wql::NoNode)
+                node.right = compile(query, expr.right);
+
+            m_nodes.push_back(std::move(node));
+            return static_cast<std::uint32_t>(m_nodes.size() - 1);
+        }
+
+        static Column const* findColumn(ResultTable const& table, std::wstring_view name)
+        {
+            if (auto index = table.Find(name))
+                return &table.GetColumn(*index);
+
+            for (auto const& column : table.Columns())
+            {
+                if (Wql::EqualsIgnoreCase(column.Name(), name))
+                    return &column;
+            }
+            return nullptr;
+        }
+
+        SelectionBitmap evaluate(ResultTable const& table, std::uint32_t index) const
+        {
+            auto const& node = m_nodes[index];
+            switch (node.kind)
+            {
+            case Wql::ExprKind::And:
+            {
+                auto result = evaluate(table, node.left);
+                if (!result.None())
+                    result &= evaluate(table, node.right);
+                return result;
+            }
+
+            case Wql::ExprKind::Or:
+            {
+                auto result = evaluate(table, node.left);
+                result |= evaluate(table, node.right);
+                return result;
+            }
+
+            case Wql::ExprKind::Not:
+            {
+                auto result = evaluate(table, node.left);
+                result.Invert();
+                return result;
+            }
+
+            case Wql::ExprKind::IsNull:
+            case Wql::ExprKind::IsNotNull:
+                return nullTest(table, node.property, node.kind == Wql::ExprKind::IsNull);
+
+            default:
+                return compare(table, node);
+            }
+        }
+
+        static SelectionBitmap nullTest(ResultTable const& table, std::wstring_view property, bool wantNull)
+        {
+            auto const* column = findColumn(table, property);
+            if (!column)
+                return SelectionBitmap{ table.RowCount(), wantNull };
+
+            SelectionBitmap result{ table.RowCount() };
+            auto words = result.Words();
+            auto nulls = column->Nulls().Words();
+            std::copy(nulls.begin(), nulls.end(), words.begin());
+
+            if (!wantNull)
+                result.Invert();
+            return result;
+        }
+
+        static SelectionBitmap compare(ResultTable const& table, Node const& node)
+        {
+            if (!node.otherProperty.empty())
+                return compareColumns(table, node);
+
+            // "x = NULL" and "x <> NULL" are accepted as spellings of IS [NOT] NULL.
+            if (node.literalKind == Wql::LiteralKind::Null)
+            {
+                if (node.op == Wql::CompareOp::Equal || node.op == Wql::CompareOp::NotEqual)
+                    return nullTest(table, node.property, node.op == Wql::CompareOp::Equal);
+                return SelectionBitmap{ table.RowCount() };
+            }
+
+            SelectionBitmap result{ table.RowCount() };
+            auto const* column = findColumn(table, node.property);
+            if (!column)
+                return result;
+
+            switch (column->Storage())
+            {
+            case StorageKind::Integer: compareIntegers(*column, node, result); break;
+            case StorageKind::Real:    compareReals(*column, node, result); break;
+            case StorageKind::Boolean: compareBooleans(*column, node, result); break;
+            case StorageKind::String:  compareStrings(*column, node, result); break;
+            default: break;
+            }
+
+            result.ExcludeNulls(column->Nulls());
+            return result;
+        }
+
+        static void compareIntegers(Column const& column, Node const& node, SelectionBitmap& result)
+        {
+            if (node.op == Wql::CompareOp::Like)
+                return;
+
+            const bool isUnsigned = column.Type() == PropertyType::UInt64;
+            std::optional<std::int64_t> constant;
+            std::optional<double> real;
+
+            switch (node.literalKind)
+            {
+            case Wql::LiteralKind::Integer: constant = node.integer; break;
+            case Wql::LiteralKind::Boolean: constant = node.boolean ? 1 : 0; break;
+            case Wql::LiteralKind::Real:    real = node.real; break;
+            case Wql::LiteralKind::String:
+                if (column.Type() == PropertyType::DateTime)
+                {
+                    if (auto parsed = ParseCimDateTime(node.text))
+                        constant = parsed->microseconds;
+                }
+                else if (!(constant = detail::ParseInteger(node.text)))
+                {
+                    real = detail::ParseReal(node.text);
+                }
+                break;
+            default:
+                break;
+            }
+
+            if (real)
+                return detail::CompareAsDouble(column.Integers(), isUnsigned, *real, node.op, result);
+            if (!constant)
+                return;
+
+            if (isUnsigned)
+            {
+                // Every unsigned value is above a negative constant.
+                const bool negative = node.literalKind == Wql::LiteralKind::String ? node.text.starts_with(L'-') : *constant < 0;
+                if (negative)
+                {
+                    const bool above = node.op == Wql::CompareOp::NotEqual || node.op == Wql::CompareOp::Greater || node.op == Wql::CompareOp::GreaterEqual;
+                    result = SelectionBitmap{ column.Size(), above };
+                    return;
+                }
+
+                auto values = column.Integers();
+                std::span<const std::uint64_t> bits{ reinterpret_cast<const std::uint64_t*>(values.data()), values.size() };
+                return detail::CompareColumn(bits, static_cast<std::uint64_t>(*constant), node.op, result);
+            }
+
+            detail::CompareColumn(column.Integers(), *constant, node.op, result);
+        }
+
+        static void compareReals(Column const& column, Node const& node, SelectionBitmap& result)
+        {
+            std::optional<double> constant;
+            switch (node.literalKind)
+            {
+            case Wql::LiteralKind::Integer: constant = static_cast<double>(node.integer); break;
+            case Wql::LiteralKind::Real:    constant = node.real; break;
+            case Wql::LiteralKind::Boolean: constant = node.boolean ? 1.0 : 0.0; break;
+            case Wql::LiteralKind::String:  constant = detail::ParseReal(node.text); break;
+            default: break;
+            }
+
+            if (constant && node.op != Wql::CompareOp::Like)
+                detail::CompareColumn(column.Reals(), *constant, node.op, result);
+        }
+
+        static void compareBooleans(Column const& column, Node const& node, SelectionBitmap& result)
+        {
+            std::optional<std::uint8_t> constant;
+            switch (node.literalKind)
+            {
+            case Wql::LiteralKind::Boolean: constant = node.boolean ? 1 : 0; break;
+            case Wql::LiteralKind::Integer: constant = node.integer != 0 ? 1 : 0; break;
+            case Wql::LiteralKind::String:
+                if (Wql::EqualsIgnoreCase(node.text, L"TRUE"))
+                    constant = 1;
+                else if (Wql::EqualsIgnoreCase(node.text, L"FALSE"))
+                    constant = 0;
+                break;
+            default:
+                break;
+            }
+
+            if (constant && node.op != Wql::CompareOp::Like)
+                detail::CompareColumn(column.Booleans(), *constant, node.op, result);
+        }
+
+        static void compareStrings(Column const& column, Node const& node, SelectionBitmap& result)
+        {
+            std::wstring_view constant = node.text;
+            const std::size_t rows = column.Size();
+
+            if (node.op == Wql::CompareOp::Like)
+            {
+                // 'prefix%' is by far the common shape; avoid the general matcher for it.
+                const auto special = constant.find_first_of(L"%_[");
+                const bool prefixOnly = special != std::wstring_view::npos && special + 1 == constant.size() && constant[special] == L'%';
+                const auto prefix = constant.substr(0, special);
+
+                for (std::size_t row = 0; row < rows; ++row)
+                {
+                    auto value = column.GetString(row);
+                    const bool matched = prefixOnly
+                        ? value.size() >= prefix.size() && detail::CompareIgnoreCase(value.substr(0, prefix.size()), prefix) == 0
+                        : detail::MatchLike(value, constant);
+                    if (matched)
+                        result.Set(row);
+                }
+                return;
+            }
+
+            for (std::size_t row = 0; row < rows; ++row)
+            {
+                if (matches(detail::CompareIgnoreCase(column.GetString(row), constant), node.op))
+                    result.Set(row);
+            }
+        }
+
+        // "x <> y": row by row, strings against strings and numbers against numbers;
+        // rows where either side is null never match.
+        static SelectionBitmap compareColumns(ResultTable const& table, Node const& node)
+        {
+            SelectionBitmap result{ table.RowCount() };
+            auto const* left = findColumn(table, node.property);
+            auto const* right = findColumn(table, node.otherProperty);
+            if (!left || !right || node.op == Wql::CompareOp::Like)
+                return result;
+
+            const auto leftStorage = left->Storage();
+            const auto rightStorage = right->Storage();
+            const bool strings = leftStorage == StorageKind::String && rightStorage == StorageKind::String;
+            const bool numbers = isNumeric(leftStorage) && isNumeric(rightStorage);
+            if (!strings && !numbers)
+                return result;
+
+            // Integers of the same signedness compare exactly, anything else as double.
+            const bool integers = leftStorage == StorageKind::Integer && rightStorage == StorageKind::Integer
+                && (left->Type() == PropertyType::UInt64) == (right->Type() == PropertyType::UInt64);
+            const bool isUnsigned = integers && left->Type() == PropertyType::UInt64;
+
+            for (std::size_t row = 0; row < table.RowCount(); ++row)
+            {
+                if (left->IsNull(row) || right->IsNull(row))
+                    continue;
+
+                int order = 0;
+                if (strings)
+                {
+                    order = detail::CompareIgnoreCase(left->GetString(row), right->GetString(row));
+                }
+                else if (isUnsigned)
+                {
+                    auto a = left->GetUInt64(row);
+                    auto b = right->GetUInt64(row);
+                    order = (a > b) - (a < b);
+                }
+                else if (integers)
+                {
+                    auto a = left->GetInt64(row);
+                    auto b = right->GetInt64(row);
+                    order = (a > b) - (a < b);
+                }
+                else
+                {
+                    auto a = left->GetValue(row).AsDouble();
+                    auto b = right->GetValue(row).AsDouble();
+                    if (std::isnan(a) || std::isnan(b))
+                    {
+                        // NaN is unordered; only <> holds.
+                        if (node.op == Wql::CompareOp::NotEqual)
+                            result.Set(row);
+                        continue;
+                    }
+                    order = (a > b) - (a < b);
+                }
+
+                if (matches(order, node.op))
+                    result.Set(row);
+            }
+            return result;
+        }
+
+        static bool isNumeric(StorageKind storage) noexcept
+        {
+            return storage == StorageKind::Integer || storage == StorageKind::Real || storage == StorageKind::Boolean;
+        }
+
+        static bool matches(int order, Wql::CompareOp op) noexcept
+        {
+            switch (op)
+            {
+            case Wql::CompareOp::Equal:        return order == 0;
+            case Wql::CompareOp::NotEqual:     return order != 0;
+            case Wql::CompareOp::Less:         return order < 0;
+            case Wql::CompareOp::LessEqual:    return order <= 0;
+            case Wql::CompareOp::Greater:      return order > 0;
+            case Wql::CompareOp::GreaterEqual: return order >= 0;
+            default:                           return false;
+            }
+        }
+
+    private:
+        std::vector<Node> m_nodes;
+        std::uint32_t m_root = Wql::NoNode;
+    };
+}
@@ -0,0 +1,259 @@
+#pragma once
+
+#include "SchemaCache.h"
+#include "WqlAst.h"
+#include "WqlLexer.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace Wmi
+{
+    // Properties consumers have read from the results of one query shape, in the
+    // order they were first read. Reading every property (enumerating an object)
+    // marks the profile as needing all of them.
+    class AccessProfile
+    {
+    public:
+        void Record(std::wstring_view name)
+        {
+            auto key = upper(name);
+            {
+                std::shared_lock lk(m_mutex);
+                if (m_keys.contains(key)) [[likely]]
+                    return;
+            }
+
+            std::unique_lock lk(m_mutex);
+            if (m_keys.insert(std::move(key)).second)
+                m_names.emplace_back(name);
+        }
+
+        void RecordAll() noexcept { m_all.store(true, std::memory_order_relaxed); }
+
+        [[nodiscard]] bool NeedsAll() const noexcept { return m_all.load(std::memory_order_relaxed); }
+
+        [[nodiscard]] std::vector<std::wstring> Properties() const
+        {
+            std::shared_lock lk(m_mutex);
+            return m_names;
+        }
+
+    private:
+        static std::wstring upper(std::wstring_view name)
+        {
+            std::wstring key;
+            key.reserve(name.size());
+            for (auto c : name)
+                key.push_back(Wql::ToUpperAscii(c));
+            return key;
+        }
+
+    private:
+        mutable std::shared_mutex m_mutex;
+        std::vector<std::wstring> m_names;
+        std::unordered_set<std::wstring, TransparentStringHash, TransparentStringEqual> m_keys;
+        std::atomic<bool> m_all{ false };
+    };
+
+    // Handed to the objects of one result. A read that fails on a projected result
+    // may only have failed because of the projection, so it widens the profile;
+    // on a full result it names a property the class does not have and is ignored.
+    class AccessRecorder
+    {
+    public:
+        AccessRecorder(std::shared_ptr<AccessProfile> profile, bool projected) noexcept
+            : m_profile(std::move(profile)), m_projected(projected)
+        {
+        }
+
+        [[nodiscard]] bool Projected() const noexcept { return m_projected; }
+
+        void Read(std::wstring_view name, bool found) const
+        {
+            if (found || m_projected)
+                m_profile->Record(name);
+        }
+
+        void ReadAll() const noexcept { m_profile->RecordAll(); }
+
+    private:
+        std::shared_ptr<AccessProfile> m_profile;
+        bool m_projected;
+    };
+
+    using AccessRecorderPtr = std::shared_ptr<const AccessRecorder>;
+
+    // The text to execute for one run of a query and, when its reads are being
+    // tracked, the recorder to attach to the resulting objects.
+    struct PreparedQuery
+    {
+        std::wstring text;
+        AccessRecorderPtr recorder;
+    };
+
+    struct ProjectionStats
+    {
+        std::uint64_t prepared = 0;
+        std::uint64_t projected = 0;
+        std::size_t shapes = 0;
+    };
+
+    // Replaces the '*' of "SELECT * FROM ..." with properties; nullopt when text is
+    // not a SELECT * statement or properties is empty.
+    [[nodiscard]] inline std::optional<std::wstring> ProjectSelectAll(std::wstring_view text, std::span<const std::wstring> properties)
+    {
+        if (properties.empty())
+            return std::nullopt;
+
+        Wql::Lexer lexer{ text };
+        auto select = lexer.Next();
+        auto star = lexer.Next();
+        if (select.kind != Wql::TokenKind::Identifier || !Wql::EqualsIgnoreCase(select.text, L"SELECT") || star.kind != Wql::TokenKind::Star)
+            return std::nullopt;
+
+        std::wstring projected;
+        projected.reserve(text.size() + properties.size() * 16);
+        projected.append(text.substr(0, star.offset));
+        for (std::size_t i = 0; i < properties.size(); ++i)
+        {
+            if (i != 0)
+                projected.append(L", ");
+            projected.append(properties[i]);
+        }
+        projected.append(text.substr(star.offset + 1));
+        return projected;
+    }
+
+    // Decides, per query shape, whether a SELECT * can be narrowed to the properties
+    // its consumers actually read. The first warmupRuns executions of a shape run
+    // unchanged while reads are recorded; later ones select only what was read.
+    // Tracking continues on projected runs, so a property read for the first time
+    // later is added to the next execution.
+    class ProjectionAdvisor
+    {
+    public:
+        explicit ProjectionAdvisor(std::size_t warmupRuns = 1) : m_warmupRuns(warmupRuns) {}
+
+        ProjectionAdvisor(const ProjectionAdvisor&) = delete;
+        ProjectionAdvisor& operator=(const ProjectionAdvisor&) = delete;
+
+        // key identifies the shape (e.g. namespace plus normalized text); query is
+        // text parsed. Anything other than SELECT * is returned untouched.
+        [[nodiscard]] PreparedQuery Prepare(std::wstring_view key, std::wstring_view text, Wql::Query const& query)
+        {
+            m_prepared.fetch_add(1, std::memory_order_relaxed);
+
+            PreparedQuery prepared{ std::wstring{ text }, nullptr };
+            if (query.kind != Wql::QueryKind::Select || !query.selectAll)
+                return prepared;
+
+            std::shared_ptr<AccessProfile> profile;
+            std::optional<std::vector<std::wstring>> pinned;
+            bool warm = false;
+            {
+                std::lock_guard lk(m_mutex);
+                auto& shape = m_shapes[std::wstring{ key }];
+                if (shape.disabled)
+                    return prepared;
+
+                pinned = shape.pinned;
+                if (!shape.profile)
+                    shape.profile = std::make_shared<AccessProfile>();
+                profile = shape.profile;
+                warm = ++shape.runs > m_warmupRuns;
+            }
+
+            if (pinned)
+            {
+                if (auto projected = ProjectSelectAll(text, *pinned))
+                {
+                    m_projected.fetch_add(1, std::memory_order_relaxed);
+                    prepared.text = std::move(*projected);
+                }
+                return prepared;
+            }
+
+            bool isProjected = false;
+            if (warm && !profile->NeedsAll())
+            {
+                auto properties = profile->Properties();
+                if (auto projected = ProjectSelectAll(text, properties))
+                {
+                    m_projected.fetch_add(1, std::memory_order_relaxed);
+                    prepared.text = std::move(*projected);
+                    isProjected = true;
+                }
+            }
+
+            prepared.recorder = std::make_shared<const AccessRecorder>(std::move(profile), isProjected);
+            return prepared;
+        }
+
+        // Always select exactly properties for key, whatever has been recorded.
+        void Pin(std::wstring_view key, std::vector<std::wstring> properties)
+        {
+            std::lock_guard lk(m_mutex);
+            auto& shape = m_shapes[std::wstring{ key }];
+            shape.pinned = std::move(properties);
+            shape.disabled = false;
+        }
+
+        // Always run key as written.
+        void Disable(std::wstring_view key)
+        {
+            std::lock_guard lk(m_mutex);
+            auto& shape = m_shapes[std::wstring{ key }];
+            shape.pinned.reset();
+            shape.disabled = true;
+        }
+
+        // Forgets overrides and recorded reads; key starts a new warm-up.
+        void Reset(std::wstring_view key)
+        {
+            std::lock_guard lk(m_mutex);
+            m_shapes.erase(std::wstring{ key });
+        }
+
+        void Clear()
+        {
+            std::lock_guard lk(m_mutex);
+            m_shapes.clear();
+        }
+
+        [[nodiscard]] ProjectionStats Stats() const
+        {
+            std::lock_guard lk(m_mutex);
+            return { m_prepared.load(std::memory_order_relaxed), m_projected.load(std::memory_order_relaxed), m_shapes.size() };
+        }
+
+    private:
+        struct Shape
+        {
+            std::shared_ptr<AccessProfile> profile;
+            std::optional<std::vector<std::wstring>> pinned;
+            std::uint64_t runs = 0;
+            bool disabled = false;
+        };
+
+    private:
+        std::size_t m_warmupRuns;
+
+        mutable std::mutex m_mutex;
+        std::unordered_map<std::wstring, Shape, TransparentStringHash, TransparentStringEqual> m_shapes;
+        std::atomic<std::uint64_t> m_prepared{ 0 };
+        std::atomic<std::uint64_t> m_projected{ 0 };
+    };
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "PropertyName.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace Wmi
+{
+    struct PropertyCacheStats
+    {
+        std::uint64_t hits = 0;
+        std::uint64_t conversions = 0;
+    };
+
+    // Properties of one object, converted the first time each is read and handed back
+    // from the cache afterwards. Bindings re-read the same few properties on every
+    // render, so a linear scan over what was touched beats hashing the name. Names
+    // match ignoring case, like ResultTable columns. Thread-safe; a conversion runs under
+    // the lock, so it happens at most once per property.
+    template<typename Cached>
+    class PropertyCache
+    {
+    public:
+        PropertyCache() = default;
+
+        PropertyCache(const PropertyCache&) = delete;
+        PropertyCache& operator=(const PropertyCache&) = delete;
+
+        // convert() produces the value on a miss. If it throws, nothing is cached and
+        // the next read tries again.
+        template<typename Convert>
+        [[nodiscard]] Cached Get(std::wstring_view name, Convert&& convert)
+        {
+            {
+                std::shared_lock lk(m_mutex);
+                if (auto cached = find(name))
+                {
+                    m_hits.fetch_add(1, std::memory_order_relaxed);
+                    return *cached;
+                }
+            }
+
+            std::lock_guard lk(m_mutex);
+            if (auto cached = find(name))
+            {
+                m_hits.fetch_add(1, std::memory_order_relaxed);
+                return *cached;
+            }
+
+            auto& entry = m_entries.emplace_back(std::wstring{ name }, std::forward<Convert>(convert)());
+            m_conversions.fetch_add(1, std::memory_order_relaxed);
+            return entry.second;
+        }
+
+        [[nodiscard]] std::size_t Size() const
+        {
+            std::shared_lock lk(m_mutex);
+            return m_entries.size();
+        }
+
+        [[nodiscard]] PropertyCacheStats Stats() const noexcept
+        {
+            return { m_hits.load(std::memory_order_relaxed), m_conversions.load(std::memory_order_relaxed) };
+        }
+
+    private:
+        const Cached* find(std::wstring_view name) const noexcept
+        {
+            for (auto const& [key, cached] : m_entries)
+            {
+                if (PropertyNamesEqual(key, name))
+                    return &cached;
+            }
+            return nullptr;
+        }
+
+    private:
+        mutable std::shared_mutex m_mutex;
+        std::vector<std::pair<std::wstring, Cached>> m_entries;
+        std::atomic<std::uint64_t> m_hits{ 0 };
+        std::atomic<std::uint64_t> m_conversions{ 0 };
+    };
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "WqlLexer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace Wmi
+{
+    // WMI property names are case-insensitive: IWbemClassObject::Get finds "Name" when
+    // asked for "name". Every lookup by property name folds ASCII case the same way.
+    [[nodiscard]] constexpr bool PropertyNamesEqual(std::wstring_view left, std::wstring_view right) noexcept
+    {
+        if (left.size() != right.size())
+            return false;
+
+        for (std::size_t i = 0; i < left.size(); ++i)
+        {
+            if (Wql::ToUpperAscii(left[i]) != Wql::ToUpperAscii(right[i]))
+                return false;
+        }
+        return true;
+    }
+
+    struct PropertyNameHash
+    {
+        using is_transparent = void;
+
+        // FNV-1a over the upper-cased characters.
+        std::size_t operator()(std::wstring_view name) const noexcept
+        {
+            std::uint64_t hash = 14695981039346656037ull;
+            for (auto c : name)
+            {
+                hash ^= static_cast<std::uint64_t>(Wql::ToUpperAscii(c));
+                hash *= 1099511628211ull;
+            }
+            return static_cast<std::size_t>(hash);
+        }
+    };
+
+    struct PropertyNameEqual
+    {
+        using is_transparent = void;
+
+        bool operator()(std::wstring_view left, std::wstring_view right) const noexcept
+        {
+            return PropertyNamesEqual(left, right);
+        }
+    };
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Wmi
+{
+    // Mirrors WinMgmt.PropertyType from WmiClassObjectProperty.idl; the numeric values
+    // must stay in sync so the two can be converted with a static_cast.
+    enum class PropertyType : std::uint8_t
+    {
+        Unknown,
+        Int8,
+        Int16,
+        Int32,
+        Int64,
+        UInt8,
+        UInt16,
+        UInt32,
+        UInt64,
+        Float,
+        Double,
+        Boolean,
+        String,
+        Null,
+        DateTime,
+        Reference,
+        Array
+    };
+
+    // Physical storage class shared by several logical property types.
+    enum class StorageKind : std::uint8_t
+    {
+        None,
+        Integer,
+        Real,
+        Boolean,
+        String,
+        Array
+    };
+
+    [[nodiscard]] constexpr StorageKind StorageOf(PropertyType type) noexcept
+    {
+        switch (type)
+        {
+        case PropertyType::Int8:
+        case PropertyType::Int16:
+        case PropertyType::Int32:
+        case PropertyType::Int64:
+        case PropertyType::UInt8:
+        case PropertyType::UInt16:
+        case PropertyType::UInt32:
+        case PropertyType::UInt64:
+        case PropertyType::DateTime:
+            return StorageKind::Integer;
+
+        case PropertyType::Float:
+        case PropertyType::Double:
+            return StorageKind::Real;
+
+        case PropertyType::Boolean:
+            return StorageKind::Boolean;
+
+        case PropertyType::String:
+        case PropertyType::Reference:
+            return StorageKind::String;
+
+        case PropertyType::Array:
+            return StorageKind::Array;
+
+        default:
+            return StorageKind::None;
+        }
+    }
+
+    // CIMTYPE values as returned by IWbemClassObject::Get/Next (see wbemcli.h).
+    namespace CimType
+    {
+        constexpr std::uint32_t SInt8 = 16;
+        constexpr std::uint32_t UInt8 = 17;
+        constexpr std::uint32_t SInt16 = 2;
+        constexpr std::uint32_t UInt16 = 18;
+        constexpr std::uint32_t SInt32 = 3;
+        constexpr std::uint32_t UInt32 = 19;
+        constexpr std::uint32_t SInt64 = 20;
+        constexpr std::uint32_t UInt64 = 21;
+        constexpr std::uint32_t Real32 = 4;
+        constexpr std::uint32_t Real64 = 5;
+        constexpr std::uint32_t Boolean = 11;
+        constexpr std::uint32_t String = 8;
+        constexpr std::uint32_t DateTime = 101;
+        constexpr std::uint32_t Reference = 102;
+        constexpr std::uint32_t Char16 = 103;
+        constexpr std::uint32_t Object = 13;
+        constexpr std::uint32_t ArrayFlag = 0x2000;
+    }
+
+    // Declared CIM type of a property, independent of the VARIANT type WMI happens
+    // to marshal it in (64-bit integers, for example, arrive as BSTRs).
+    [[nodiscard]] constexpr PropertyType PropertyTypeFromCimType(std::uint32_t cimType) noexcept
+    {
+        if (cimType & CimType::ArrayFlag)
+            return PropertyType::Array;
+
+        switch (cimType)
+        {
+        case CimType::SInt8:     return PropertyType::Int8;
+        case CimType::SInt16:    return PropertyType::Int16;
+        case CimType::SInt32:    return PropertyType::Int32;
+        case CimType::SInt64:    return PropertyType::Int64;
+        case CimType::UInt8:     return PropertyType::UInt8;
+        case CimType::UInt16:    return PropertyType::UInt16;
+        case CimType::Char16:    return PropertyType::UInt16;
+        case CimType::UInt32:    return PropertyType::UInt32;
+        case CimType::UInt64:    return PropertyType::UInt64;
+        case CimType::Real32:    return PropertyType::Float;
+        case CimType::Real64:    return PropertyType::Double;
+        case CimType::Boolean:   return PropertyType::Boolean;
+        case CimType::String:    return PropertyType::String;
+        case CimType::DateTime:  return PropertyType::DateTime;
+        case CimType::Reference: return PropertyType::Reference;
+        default:                 return PropertyType::Unknown;
+        }
+    }
+
+    // Element type of a CIM array property, Unknown for scalars.
+    [[nodiscard]] constexpr PropertyType ElementTypeFromCimType(std::uint32_t cimType) noexcept
+    {
+        return (cimType & CimType::ArrayFlag) ? PropertyTypeFromCimType(cimType & ~CimType::ArrayFlag) : PropertyType::Unknown;
+    }
+}
@@ -0,0 +1,214 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace Wmi
+{
+    // Result codes of a pull source, matching IEnumWbemClassObject::Next.
+    namespace PullStatus
+    {
+        constexpr std::int32_t Ok = 0;              // WBEM_S_NO_ERROR: the full count was returned
+        constexpr std::int32_t False = 1;           // WBEM_S_FALSE: fewer than requested, enumeration is over
+        constexpr std::int32_t TimedOut = 0x40004;  // WBEM_S_TIMEDOUT: partial batch, more may follow
+    }
+
+    struct BatchPolicyOptions
+    {
+        std::uint32_t initial = 64;
+        std::uint32_t minimum = 1;
+        std::uint32_t maximum = 1024;
+
+        // Preferred duration of one pull. Larger batches amortize the per-call round
+        // trip; smaller ones hand the first objects to the consumer sooner.
+        std::chrono::microseconds target{ 20'000 };
+    };
+
+    // Chooses how many objects to request per pull. A fixed policy always asks for
+    // the same count; an adaptive one moves halfway towards the count that would have
+    // taken `target` at the per-object cost observed on the previous pull.
+    class BatchPolicy
+    {
+    public:
+        BatchPolicy() : BatchPolicy(BatchPolicyOptions{}) {}
+
+        explicit BatchPolicy(std::uint32_t fixed) noexcept
+            : m_size(std::max<std::uint32_t>(fixed, 1)), m_minimum(m_size), m_maximum(m_size)
+        {
+        }
+
+        explicit BatchPolicy(BatchPolicyOptions const& options) noexcept
+            : m_minimum(std::max<std::uint32_t>(options.minimum, 1)),
+              m_maximum((std::max)(options.maximum, std::max<std::uint32_t>(options.minimum, 1))),
+              m_target(options.target)
+        {
+            m_size = std::clamp(options.initial, m_minimum, m_maximum);
+        }
+
+        [[nodiscard]] std::uint32_t Size() const noexcept { return m_size; }
+        [[nodiscard]] bool IsFixed() const noexcept { return m_minimum == m_maximum; }
+
+        void Observe(std::uint32_t returned, std::chrono::microseconds elapsed) noexcept
+        {
+            if (IsFixed() || returned == 0)
+                return;
+
+            const double perObject = (std::max)(1.0, static_cast<double>(elapsed.count())) / returned;
+            const double ideal = static_cast<double>(m_target.count()) / perObject;
+            const double next = (static_cast<double>(m_size) + ideal) / 2.0;
+
+            m_size = static_cast<std::uint32_t>(std::clamp(next, static_cast<double>(m_minimum), static_cast<double>(m_maximum)));
+        }
+
+    private:
+        std::uint32_t m_size = 1;
+        std::uint32_t m_minimum = 1;
+        std::uint32_t m_maximum = 1;
+        std::chrono::microseconds m_target{ 0 };
+    };
+
+    struct PullStats
+    {
+        std::uint64_t pulls = 0;
+        std::uint64_t items = 0;
+        std::uint32_t lastBatch = 0;
+        std::uint32_t peakBatch = 0;
+    };
+
+    // Forward-only, pull-based enumeration over a Source with
+    //   std::int32_t Next(std::uint32_t count, T* out, std::uint32_t& returned)
+    // that fills out[0, returned) and returns a PullStatus code or a negative error.
+    // Only the current batch is held: requesting the next one releases the previous
+    // items, so memory stays bounded by the batch size however large the result is.
+    // Not thread-safe; one consumer drives it.
+    template<typename T, typename Source>
+    class PullEnumerator
+    {
+    public:
+        PullEnumerator(Source source, BatchPolicy policy = {})
+            : m_source(std::move(source)), m_policy(policy)
+        {
+        }
+
+        PullEnumerator(const PullEnumerator&) = delete;
+        PullEnumerator& operator=(const PullEnumerator&) = delete;
+
+        // Returns the next batch, or an empty span once the source is exhausted or failed.
+        [[nodiscard]] std::span<T> NextBatch()
+        {
+            m_batch.clear();
+
+            // A timed-out pull that produced nothing is not the end; pull again.
+            while (m_batch.empty() && !m_completed)
+                pull();
+
+            m_position = m_batch.size();
+            return m_batch;
+        }
+
+        [[nodiscard]] bool IsCompleted() const noexcept { return m_completed && m_batch.empty(); }
+
+        // Negative when the source failed; PullStatus::Ok otherwise.
+        [[nodiscard]] std::int32_t Status() const noexcept { return m_status; }
+
+        [[nodiscard]] BatchPolicy const& Policy() const noexcept { return m_policy; }
+        [[nodiscard]] PullStats const& Stats() const noexcept { return m_stats; }
+        [[nodiscard]] Source& GetSource() noexcept { return m_source; }
+
+        // Item-at-a-time view: for (auto& item : enumerator) pulls batches on demand.
+        // Leaving a loop with break and iterating again resumes at the item it stopped on.
+        class iterator
+        {
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = T*;
+            using reference = T&;
+
+            iterator() = default;
+            explicit iterator(PullEnumerator* owner) : m_owner(owner->ensureItem() ? owner : nullptr) {}
+
+            reference operator*() const noexcept { return m_owner->m_batch[m_owner->m_position]; }
+            pointer operator->() const noexcept { return &m_owner->m_batch[m_owner->m_position]; }
+
+            iterator& operator++()
+            {
+                ++m_owner->m_position;
+                if (!m_owner->ensureItem())
+                    m_owner = nullptr;
+                return *this;
+            }
+
+            void operator++(int) { ++*this; }
+
+            friend bool operator==(iterator const& left, iterator const& right) noexcept { return left.m_owner == right.m_owner; }
+
+        private:
+            PullEnumerator* m_owner = nullptr;
+        };
+
+        [[nodiscard]] iterator begin() { return iterator{ this }; }
+        [[nodiscard]] iterator end() noexcept { return {}; }
+
+    private:
+        bool ensureItem()
+        {
+            if (m_position < m_batch.size())
+                return true;
+
+            (void)NextBatch();
+            m_position = 0;
+            return !m_batch.empty();
+        }
+
+        void pull()
+        {
+            const auto count = m_policy.Size();
+            m_batch.resize(count);
+
+            std::uint32_t returned = 0;
+            const auto start = std::chrono::steady_clock::now();
+            const auto status = m_source.Next(count, m_batch.data(), returned);
+            const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+            returned = (std::min)(returned, count);
+            m_batch.resize(returned);
+
+            ++m_stats.pulls;
+            m_stats.items += returned;
+            m_stats.lastBatch = returned;
+            m_stats.peakBatch = (std::max)(m_stats.peakBatch, returned);
+
+            if (status < 0)
+            {
+                m_status = status;
+                m_completed = true;
+                m_batch.clear();
+            }
+            else if (status == PullStatus::False || (status == PullStatus::Ok && returned < count))
+            {
+                m_completed = true;
+            }
+            else
+            {
+                m_policy.Observe(returned, elapsed);
+            }
+        }
+
+    private:
+        Source m_source;
+        BatchPolicy m_policy;
+        std::vector<T> m_batch;
+        std::size_t m_position = 0;
+        PullStats m_stats;
+        std::int32_t m_status = PullStatus::Ok;
+        bool m_completed = false;
+    };
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "ResultTable.h"
+
+#include <memory>
+#include <string_view>
+
+namespace Wmi
+{
+    using ResultTablePtr = std::shared_ptr<const ResultTable>;
+
+    // Source of query results underneath WmiDataContext. The live implementation
+    // talks to winmgmt; others replay recorded data so the layers above can be
+    // exercised without a Windows provider. Execute blocks until the whole result
+    // is available and reports failures by throwing.
+    class IQueryBackend
+    {
+    public:
+        virtual ~IQueryBackend() = default;
+
+        virtual ResultTablePtr Execute(std::wstring_view ns, std::wstring_view query) = 0;
+    };
+}
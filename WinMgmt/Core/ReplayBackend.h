@@ -0,0 +1,429 @@
+#pragma once
+
+#include "QueryBackend.h"
+#include "SchemaCache.h"
+#include "SnapshotFile.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cwchar>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Wmi
+{
+    struct ReplayOptions
+    {
+        // Added to every Execute to imitate provider cost.
+        std::chrono::microseconds latency{ 0 };
+
+        // When non-zero every result is resized to exactly this many rows by
+        // repeating (or truncating) the recorded ones.
+        std::size_t objectCount = 0;
+    };
+
+    struct ReplayStats
+    {
+        std::uint64_t executions = 0;
+        std::uint64_t misses = 0;
+        std::size_t snapshots = 0;
+    };
+
+    namespace detail
+    {
+        constexpr std::array<std::wstring_view, 17> PropertyTypeNames{
+            L"Unknown", L"Int8", L"Int16", L"Int32", L"Int64", L"UInt8", L"UInt16", L"UInt32", L"UInt64",
+            L"Float", L"Double", L"Boolean", L"String", L"Null", L"DateTime", L"Reference", L"Array"
+        };
+
+        [[nodiscard]] inline PropertyType PropertyTypeFromName(std::wstring_view name) noexcept
+        {
+            for (std::size_t i = 0; i < PropertyTypeNames.size(); ++i)
+            {
+                if (PropertyTypeNames[i] == name)
+                    return static_cast<PropertyType>(i);
+            }
+            return PropertyType::Unknown;
+        }
+
+        inline std::vector<std::wstring_view> SplitTabs(std::wstring_view line)
+        {
+            std::vector<std::wstring_view> fields;
+            std::size_t start = 0;
+            while (true)
+            {
+                auto tab = line.find(L'\t', start);
+                fields.push_back(line.substr(start, tab == std::wstring_view::npos ? std::wstring_view::npos : tab - start));
+                if (tab == std::wstring_view::npos)
+                    return fields;
+                start = tab + 1;
+            }
+        }
+
+        inline void AppendEscaped(std::wstring& out, std::wstring_view text)
+        {
+            for (auto c : text)
+            {
+                switch (c)
+                {
+                case L'\\': out.append(L"\\\\"); break;
+                case L'\t': out.append(L"\\t"); break;
+                case L'\n': out.append(L"\\n"); break;
+                case L'\r': out.append(L"\\r"); break;
+                default:    out.push_back(c); break;
+                }
+            }
+        }
+
+        inline std::wstring Unescape(std::wstring_view text)
+        {
+            std::wstring out;
+            out.reserve(text.size());
+            for (std::size_t i = 0; i < text.size(); ++i)
+            {
+                if (text[i] != L'\\' || i + 1 == text.size())
+                {
+                    out.push_back(text[i]);
+                    continue;
+                }
+
+                switch (text[++i])
+                {
+                case L't': out.push_back(L'\t'); break;
+                case L'n': out.push_back(L'\n'); break;
+                case L'r': out.push_back(L'\r'); break;
+                default:   out.push_back(text[i]); break;
+                }
+            }
+            return out;
+        }
+    }
+
+    // Serves queries from recorded result tables held in memory. Snapshots are
+    // keyed by namespace (case-insensitive) and exact query text, and can be saved
+    // to and loaded from a line-based text format:
+    //
+    //   WMISNAPSHOT 1
+    //   QUERY <namespace>\t<query>
+    //   COLUMNS <name>:<type>\t...
+    //   ROW <cell>\t...            (\N for null; \\, \t, \n, \r escaped)
+    //   END
+    //
+    // or to and from the binary format of SnapshotFile.h.
+    class ReplayBackend : public IQueryBackend
+    {
+    public:
+        explicit ReplayBackend(ReplayOptions options = {}) : m_options(options) {}
+
+        void Add(std::wstring_view ns, std::wstring_view query, ResultTablePtr table)
+        {
+            std::lock_guard lk(m_mutex);
+            auto& snapshot = m_snapshots[makeKey(ns, query)];
+            snapshot.ns.assign(ns);
+            snapshot.query.assign(query);
+            snapshot.recorded = std::move(table);
+            snapshot.scaled.reset();
+        }
+
+        ResultTablePtr Execute(std::wstring_view ns, std::wstring_view query) override
+        {
+            ResultTablePtr result;
+            {
+                std::lock_guard lk(m_mutex);
+                auto it = m_snapshots.find(makeKey(ns, query));
+                if (it == m_snapshots.end())
+                {
+                    m_misses.fetch_add(1, std::memory_order_relaxed);
+                    throw std::out_of_range("query has no recorded snapshot");
+                }
+
+                auto& snapshot = it->second;
+                if (m_options.objectCount == 0 || snapshot.recorded->RowCount() == m_options.objectCount)
+                    result = snapshot.recorded;
+                else
+                {
+                    if (!snapshot.scaled)
+                        snapshot.scaled = scale(*snapshot.recorded, m_options.objectCount);
+                    result = snapshot.scaled;
+                }
+            }
+
+            m_executions.fetch_add(1, std::memory_order_relaxed);
+            if (m_options.latency.count() > 0)
+                std::this_thread::sleep_for(m_options.latency);
+
+            return result;
+        }
+
+        [[nodiscard]] ReplayStats Stats() const
+        {
+            std::lock_guard lk(m_mutex);
+            return { m_executions.load(std::memory_order_relaxed), m_misses.load(std::memory_order_relaxed), m_snapshots.size() };
+        }
+
+        [[nodiscard]] std::wstring Save() const
+        {
+            std::wstring out = L"WMISNAPSHOT 1\n";
+
+            std::lock_guard lk(m_mutex);
+            for (auto const& [key, snapshot] : m_snapshots)
+            {
+                out.append(L"QUERY ");
+                detail::AppendEscaped(out, snapshot.ns);
+                out.push_back(L'\t');
+                detail::AppendEscaped(out, snapshot.query);
+                out.push_back(L'\n');
+                write(out, *snapshot.recorded);
+                out.append(L"END\n");
+            }
+            return out;
+        }
+
+        // Adds every snapshot in text; throws std::invalid_argument on malformed input.
+        void Load(std::wstring_view text)
+        {
+            std::size_t position = 0;
+            auto nextLine = [&]() -> std::optional<std::wstring_view> {
+                if (position >= text.size())
+                    return std::nullopt;
+                auto end = text.find(L'\n', position);
+                if (end == std::wstring_view::npos)
+                    end = text.size();
+                auto line = text.substr(position, end - position);
+                position = end + 1;
+                if (!line.empty() && line.back() == L'\r')
+                    line.remove_suffix(1);
+                return line;
+            };
+
+            auto header = nextLine();
+            if (!header || *header != L"WMISNAPSHOT 1")
+                throw std::invalid_argument("not a WMI snapshot");
+
+            while (auto line = nextLine())
+            {
+                if (line->empty())
+                    continue;
+
+                if (!line->starts_with(L"QUERY "))
+                    throw std::invalid_argument("expected QUERY");
+
+                auto target = detail::SplitTabs(line->substr(6));
+                if (target.size() != 2)
+                    throw std::invalid_argument("QUERY needs a namespace and a query");
+
+                auto table = std::make_shared<ResultTable>();
+                std::vector<std::size_t> columns;
+                while (true)
+                {
+                    auto row = nextLine();
+                    if (!row)
+                        throw std::invalid_argument("missing END");
+                    if (*row == L"END")
+                        break;
+
+                    if (row->starts_with(L"COLUMNS"))
+                    {
+                        if (row->size() <= 8)
+                            continue;
+
+                        for (auto field : detail::SplitTabs(row->substr(8)))
+                        {
+                            auto colon = field.rfind(L':');
+                            if (colon == std::wstring_view::npos)
+                                throw std::invalid_argument("column needs a type");
+                            columns.push_back(table->AddColumn(detail::Unescape(field.substr(0, colon)), detail::PropertyTypeFromName(field.substr(colon + 1))));
+                        }
+                    }
+                    else if (row->starts_with(L"ROW"))
+                    {
+                        auto cells = row->size() > 4 ? detail::SplitTabs(row->substr(4)) : std::vector<std::wstring_view>{};
+                        if (cells.size() != columns.size())
+                            throw std::invalid_argument("row width does not match COLUMNS");
+
+                        table->BeginRow();
+                        for (std::size_t i = 0; i < cells.size(); ++i)
+                            read(*table, columns[i], cells[i]);
+                        table->EndRow();
+                    }
+                    else
+                    {
+                        throw std::invalid_argument("expected COLUMNS, ROW or END");
+                    }
+                }
+
+                Add(detail::Unescape(target[0]), detail::Unescape(target[1]), std::move(table));
+            }
+        }
+
+        // Writes every snapshot to a binary snapshot file; the caller finishes the writer.
+        void Save(SnapshotWriter& writer) const
+        {
+            std::lock_guard lk(m_mutex);
+            for (auto const& [key, snapshot] : m_snapshots)
+                writer.Add(snapshot.ns, snapshot.query, *snapshot.recorded);
+        }
+
+        // Copies every result of a binary snapshot; the reader can go once this returns.
+        void Load(SnapshotReader const& reader)
+        {
+            std::wstring ns;
+            std::wstring query;
+            std::wstring scratch;
+            for (std::size_t i = 0; i < reader.ResultCount(); ++i)
+            {
+                auto result = reader.Result(i);
+                ns = detail::WidenUtf16(result.Namespace(), scratch);
+                query = detail::WidenUtf16(result.Query(), scratch);
+                Add(ns, query, result.ToTable());
+            }
+        }
+
+    private:
+        struct Snapshot
+        {
+            std::wstring ns;
+            std::wstring query;
+            ResultTablePtr recorded;
+            ResultTablePtr scaled;
+        };
+
+        static std::wstring makeKey(std::wstring_view ns, std::wstring_view query)
+        {
+            std::wstring key;
+            key.reserve(ns.size() + query.size() + 1);
+            for (auto c : ns)
+                key.push_back(static_cast<wchar_t>(c >= L'a' && c <= L'z' ? c - (L'a' - L'A') : c));
+            key.push_back(L'\n');
+            key.append(query);
+            return key;
+        }
+
+        static ResultTablePtr scale(ResultTable const& source, std::size_t rows)
+        {
+            auto table = std::make_shared<ResultTable>();
+            for (auto const& column : source.Columns())
+                table->AddColumn(column.Name(), column.Type());
+            table->Reserve(rows);
+
+            for (std::size_t row = 0; row < rows && source.RowCount() > 0; ++row)
+            {
+                const auto from = row % source.RowCount();
+                table->BeginRow();
+                for (std::size_t c = 0; c < source.ColumnCount(); ++c)
+                    table->AppendValue(c, source.GetColumn(c).GetValue(from));
+                table->EndRow();
+            }
+            return table;
+        }
+
+        static void write(std::wstring& out, ResultTable const& table)
+        {
+            out.append(L"COLUMNS");
+            for (std::size_t c = 0; c < table.ColumnCount(); ++c)
+            {
+                auto const& column = table.GetColumn(c);
+                out.push_back(c == 0 ? L' ' : L'\t');
+                detail::AppendEscaped(out, column.Name());
+                out.push_back(L':');
+                out.append(detail::PropertyTypeNames[static_cast<std::size_t>(column.Type())]);
+            }
+            out.push_back(L'\n');
+
+            wchar_t number[32];
+            for (std::size_t row = 0; row < table.RowCount(); ++row)
+            {
+                out.append(L"ROW");
+                for (std::size_t c = 0; c < table.ColumnCount(); ++c)
+                {
+                    out.push_back(c == 0 ? L' ' : L'\t');
+
+                    auto const& column = table.GetColumn(c);
+                    if (column.IsNull(row))
+                    {
+                        out.append(L"\\N");
+                        continue;
+                    }
+
+                    switch (column.Storage())
+                    {
+                    case StorageKind::Integer:
+                        if (column.Type() == PropertyType::UInt64)
+                            std::swprintf(number, 32, L"%llu", static_cast<unsigned long long>(column.GetUInt64(row)));
+                        else
+                            std::swprintf(number, 32, L"%lld", static_cast<long long>(column.GetInt64(row)));
+                        out.append(number);
+                        break;
+
+                    case StorageKind::Real:
+                        std::swprintf(number, 32, L"%.17g", column.GetDouble(row));
+                        out.append(number);
+                        break;
+
+                    case StorageKind::Boolean:
+                        out.push_back(column.GetBoolean(row) ? L'1' : L'0');
+                        break;
+
+                    case StorageKind::String:
+                        detail::AppendEscaped(out, column.GetString(row));
+                        break;
+
+                    default:
+                        out.append(L"\\N");
+                        break;
+                    }
+                }
+                out.push_back(L'\n');
+            }
+        }
+
+        static void read(ResultTable& table, std::size_t column, std::wstring_view cell)
+        {
+            if (cell == L"\\N")
+                return table.AppendNull(column);
+
+            auto const& target = table.GetColumn(column);
+            switch (target.Storage())
+            {
+            case StorageKind::Integer:
+            {
+                std::wstring text{ cell };
+                if (target.Type() == PropertyType::UInt64)
+                    return table.AppendInteger(column, static_cast<std::int64_t>(std::wcstoull(text.c_str(), nullptr, 10)));
+                return table.AppendInteger(column, std::wcstoll(text.c_str(), nullptr, 10));
+            }
+
+            case StorageKind::Real:
+                return table.AppendReal(column, std::wcstod(std::wstring{ cell }.c_str(), nullptr));
+
+            case StorageKind::Boolean:
+                return table.AppendBoolean(column, cell == L"1");
+
+            case StorageKind::String:
+                return table.AppendString(column, detail::Unescape(cell));
+
+            default:
+                return table.AppendNull(column);
+            }
+        }
+
+    private:
+        ReplayOptions m_options;
+
+        mutable std::mutex m_mutex;
+        std::unordered_map<std::wstring, Snapshot, TransparentStringHash, TransparentStringEqual> m_snapshots;
+        std::atomic<std::uint64_t> m_executions{ 0 };
+        std::atomic<std::uint64_t> m_misses{ 0 };
+    };
+}
@@ -0,0 +1,253 @@
+#pragma once
+
+#include "SchemaCache.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+namespace Wmi
+{
+    struct ResultCacheStats
+    {
+        std::uint64_t hits = 0;
+        std::uint64_t executions = 0;
+        std::uint64_t coalesced = 0;
+        std::uint64_t failures = 0;
+        std::size_t entries = 0;
+    };
+
+    // Query results cached for a per-call TTL, with single-flight execution: while
+    // a key is being computed every other caller for that key waits for the same
+    // result instead of starting its own. Result should be a cheap, immutable handle
+    // (a shared_ptr or a read-only WinRT view). Failures are handed to every waiter
+    // but never cached.
+    template<typename Result>
+    class ResultCache
+    {
+    public:
+        using clock = std::chrono::steady_clock;
+        using time_source = std::function<clock::time_point()>;
+
+        // Outcome of Acquire. Exactly one of: a cached value, a flight to wait on,
+        // or (IsLeader) the obligation to execute and then Publish or Fail.
+        class Lease
+        {
+        public:
+            [[nodiscard]] bool IsHit() const noexcept { return m_value.has_value(); }
+            [[nodiscard]] bool IsLeader() const noexcept { return m_promise != nullptr; }
+            [[nodiscard]] std::wstring const& Key() const noexcept { return m_key; }
+
+            // The cached value, or the flight's result; blocks for followers.
+            [[nodiscard]] Result Get() const
+            {
+                return m_value ? *m_value : m_flight.get();
+            }
+
+        private:
+            friend class ResultCache;
+
+            std::wstring m_key;
+            std::optional<Result> m_value;
+            std::shared_future<Result> m_flight;
+            std::shared_ptr<std::promise<Result>> m_promise;
+        };
+
+        explicit ResultCache(std::size_t maxEntries = 256, time_source now = &clock::now)
+            : m_maxEntries(maxEntries), m_now(std::move(now))
+        {
+        }
+
+        ResultCache(const ResultCache&) = delete;
+        ResultCache& operator=(const ResultCache&) = delete;
+
+        [[nodiscard]] Lease Acquire(std::wstring_view key)
+        {
+            Lease lease;
+            lease.m_key.assign(key);
+
+            std::lock_guard lk(m_mutex);
+            auto it = m_entries.find(key);
+            if (it != m_entries.end())
+            {
+                auto& entry = it->second;
+                if (entry.value && m_now() < entry.expires) [[likely]]
+                {
+                    ++m_stats.hits;
+                    lease.m_value = entry.value;
+                    return lease;
+                }
+
+                // A ready flight without a value was abandoned by its leader; start over.
+                if (entry.flight.valid() && entry.flight.wait_for(std::chrono::seconds{ 0 }) != std::future_status::ready)
+                {
+                    ++m_stats.coalesced;
+                    lease.m_flight = entry.flight;
+                    return lease;
+                }
+
+                entry.value.reset();
+                entry.flight = {};
+            }
+            else
+            {
+                it = m_entries.emplace(lease.m_key, Entry{}).first;
+            }
+
+            ++m_stats.executions;
+            lease.m_promise = std::make_shared<std::promise<Result>>();
+            lease.m_flight = lease.m_promise->get_future().share();
+            it->second.flight = lease.m_flight;
+            return lease;
+        }
+
+        // Completes a leader's flight, waking every follower, and keeps the value for ttl.
+        void Publish(Lease& lease, Result result, clock::duration ttl)
+        {
+            {
+                std::lock_guard lk(m_mutex);
+                auto it = m_entries.find(std::wstring_view{ lease.m_key });
+                if (it != m_entries.end() && ttl > clock::duration::zero())
+                {
+                    it->second.value = result;
+                    it->second.expires = m_now() + ttl;
+                    it->second.flight = {};
+                    trim();
+                }
+                else if (it != m_entries.end())
+                {
+                    m_entries.erase(it);
+                }
+            }
+
+            lease.m_promise->set_value(std::move(result));
+            lease.m_promise.reset();
+        }
+
+        void Fail(Lease& lease, std::exception_ptr error)
+        {
+            {
+                std::lock_guard lk(m_mutex);
+                ++m_stats.failures;
+                m_entries.erase(lease.m_key);
+            }
+
+            lease.m_promise->set_exception(std::move(error));
+            lease.m_promise.reset();
+        }
+
+        // Synchronous convenience over Acquire/Publish/Fail.
+        template<typename Execute>
+        Result GetOrExecute(std::wstring_view key, clock::duration ttl, Execute&& execute)
+        {
+            auto lease = Acquire(key);
+            if (!lease.IsLeader())
+                return lease.Get();
+
+            try
+            {
+                Result result = std::invoke(std::forward<Execute>(execute));
+                Publish(lease, result, ttl);
+                return result;
+            }
+            catch (...)
+            {
+                Fail(lease, std::current_exception());
+                throw;
+            }
+        }
+
+        // Drops a cached value; an execution already in flight still completes.
+        void Invalidate(std::wstring_view key)
+        {
+            std::lock_guard lk(m_mutex);
+            auto it = m_entries.find(key);
+            if (it != m_entries.end() && !it->second.flight.valid())
+                m_entries.erase(it);
+            else if (it != m_entries.end())
+                it->second.value.reset();
+        }
+
+        void Clear()
+        {
+            std::lock_guard lk(m_mutex);
+            for (auto it = m_entries.begin(); it != m_entries.end();)
+            {
+                if (it->second.flight.valid())
+                {
+                    it->second.value.reset();
+                    ++it;
+                }
+                else
+                {
+                    it = m_entries.erase(it);
+                }
+            }
+        }
+
+        [[nodiscard]] ResultCacheStats Stats() const
+        {
+            std::lock_guard lk(m_mutex);
+            auto stats = m_stats;
+            stats.entries = m_entries.size();
+            return stats;
+        }
+
+    private:
+        struct Entry
+        {
+            std::optional<Result> value;
+            clock::time_point expires{};
+            std::shared_future<Result> flight;
+        };
+
+        // Called with the lock held: drop expired values first, then the entry
+        // closest to expiry, until the cache fits.
+        void trim()
+        {
+            if (m_entries.size() <= m_maxEntries)
+                return;
+
+            const auto now = m_now();
+            for (auto it = m_entries.begin(); it != m_entries.end();)
+            {
+                if (!it->second.flight.valid() && now >= it->second.expires)
+                    it = m_entries.erase(it);
+                else
+                    ++it;
+            }
+
+            while (m_entries.size() > m_maxEntries)
+            {
+                auto victim = m_entries.end();
+                for (auto it = m_entries.begin(); it != m_entries.end(); ++it)
+                {
+                    if (!it->second.flight.valid() && (victim == m_entries.end() || it->second.expires < victim->second.expires))
+                        victim = it;
+                }
+
+                if (victim == m_entries.end())
+                    break;
+                m_entries.erase(victim);
+            }
+        }
+
+    private:
+        std::size_t m_maxEntries;
+        time_source m_now;
+
+        mutable std::mutex m_mutex;
+        std::unordered_map<std::wstring, Entry, TransparentStringHash, TransparentStringEqual> m_entries;
+        ResultCacheStats m_stats;
+    };
+}
@@ -0,0 +1,653 @@
+#pragma once
+
+#include "CimDateTime.h"
+#include "PropertyType.h"
+#include "ResultTable.h"
+#include "WmiValue.h"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define WMI_EXPORTER_SSE2 1
+#endif
+
+namespace Wmi
+{
+    enum class ExportFormat : std::uint8_t
+    {
+        // One JSON object per row and line, keyed by column name.
+        JsonLines,
+
+        // RFC 4180: a header line of column names, CRLF line ends, fields quoted only
+        // when they contain a comma, quote or line break.
+        Csv
+    };
+
+    struct ExportStats
+    {
+        std::uint64_t rows = 0;
+        std::uint64_t bytes = 0;
+
+        // From Begin to Finish, or to now while the export is still running.
+        std::chrono::nanoseconds elapsed{ 0 };
+
+        [[nodiscard]] double BytesPerSecond() const noexcept
+        {
+            return elapsed.count() > 0 ? static_cast<double>(bytes) * 1e9 / static_cast<double>(elapsed.count()) : 0.0;
+        }
+    };
+
+    namespace detail
+    {
+        // Characters that go out unchanged: ASCII other than the ones the format escapes.
+        template<bool Json>
+        [[nodiscard]] constexpr bool IsPlainAscii(wchar_t c) noexcept
+        {
+            const auto code = static_cast<std::uint32_t>(c);
+            if constexpr (Json)
+                return code >= 0x20 && code < 0x80 && code != '"' && code != '\\';
+            else
+                return code < 0x80 && code != '"';
+        }
+
+        // Copies the leading run of plain characters, narrowing them to bytes. Stops at
+        // the first other character, at end, or once out reaches outEnd. Returns the
+        // number of characters copied.
+        template<bool Json>
+        std::size_t CopyPlainAscii(const wchar_t* text, const wchar_t* end, char* out, const char* outEnd) noexcept
+        {
+            const wchar_t* p = text;
+
+#ifdef WMI_EXPORTER_SSE2
+            // Checks and narrows a whole register of characters at once; the first one that
+            // needs work ends the run.
+            constexpr std::size_t Lanes = 16 / sizeof(wchar_t);
+            while (static_cast<std::size_t>(end - p) >= Lanes && static_cast<std::size_t>(outEnd - out) >= 8)
+            {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                int special;
+                int lanes;
+                if constexpr (sizeof(wchar_t) == 2)
+                {
+                    __m128i bad = _mm_cmpeq_epi16(v, _mm_set1_epi16('"'));
+                    if constexpr (Json)
+                    {
+                        bad = _mm_or_si128(bad, _mm_cmpeq_epi16(v, _mm_set1_epi16('\\')));
+                        bad = _mm_or_si128(bad, _mm_cmplt_epi16(v, _mm_set1_epi16(0x20)));
+                    }
+                    const __m128i ascii = _mm_cmpeq_epi16(_mm_and_si128(v, _mm_set1_epi16(static_cast<short>(0xFF80))), _mm_setzero_si128());
+                    special = (_mm_movemask_epi8(bad) | ~_mm_movemask_epi8(ascii)) & 0xFFFF;
+                    lanes = 2;
+                    if (special == 0)
+                        _mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(v, v));
+                }
+                else
+                {
+                    __m128i bad = _mm_cmpeq_epi32(v, _mm_set1_epi32('"'));
+                    if constexpr (Json)
+                    {
+                        bad = _mm_or_si128(bad, _mm_cmpeq_epi32(v, _mm_set1_epi32('\\')));
+                        bad = _mm_or_si128(bad, _mm_cmplt_epi32(v, _mm_set1_epi32(0x20)));
+                    }
+                    const __m128i ascii = _mm_cmpeq_epi32(_mm_and_si128(v, _mm_set1_epi32(static_cast<int>(0xFFFFFF80))), _mm_setzero_si128());
+                    special = (_mm_movemask_epi8(bad) | ~_mm_movemask_epi8(ascii)) & 0xFFFF;
+                    lanes = 4;
+                    if (special == 0)
+                    {
+                        const __m128i words = _mm_packs_epi32(v, v);
+                        const int bytes = _mm_cvtsi128_si32(_mm_packus_epi16(words, words));
+                        std::memcpy(out, &bytes, sizeof(bytes));
+                    }
+                }
+
+                if (special != 0)
+                {
+                    const auto run = static_cast<std::size_t>(std::countr_zero(static_cast<unsigned>(special)) / lanes);
+                    for (std::size_t i = 0; i < run; ++i)
+                        *out++ = static_cast<char>(p[i]);
+                    return static_cast<std::size_t>(p - text) + run;
+                }
+
+                p += Lanes;
+                out += Lanes;
+            }
+#endif
+
+            while (p < end && out < outEnd && IsPlainAscii<Json>(*p))
+                *out++ = static_cast<char>(*p++);
+            return static_cast<std::size_t>(p - text);
+        }
+
+        // Whether a CSV field must be quoted.
+        [[nodiscard]] inline bool CsvNeedsQuotes(std::wstring_view text) noexcept
+        {
+            const wchar_t* p = text.data();
+            const wchar_t* end = p + text.size();
+
+#ifdef WMI_EXPORTER_SSE2
+            constexpr std::size_t Lanes = 16 / sizeof(wchar_t);
+            for (; static_cast<std::size_t>(end - p) >= Lanes; p += Lanes)
+            {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                __m128i hit;
+                if constexpr (sizeof(wchar_t) == 2)
+                {
+                    hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi16(v, _mm_set1_epi16(',')), _mm_cmpeq_epi16(v, _mm_set1_epi16('"'))),
+                                       _mm_or_si128(_mm_cmpeq_epi16(v, _mm_set1_epi16('\r')), _mm_cmpeq_epi16(v, _mm_set1_epi16('\n'))));
+                }
+                else
+                {
+                    hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi32(v, _mm_set1_epi32(',')), _mm_cmpeq_epi32(v, _mm_set1_epi32('"'))),
+                                       _mm_or_si128(_mm_cmpeq_epi32(v, _mm_set1_epi32('\r')), _mm_cmpeq_epi32(v, _mm_set1_epi32('\n'))));
+                }
+                if (_mm_movemask_epi8(hit) != 0)
+                    return true;
+            }
+#endif
+
+            for (; p < end; ++p)
+            {
+                if (*p == L',' || *p == L'"' || *p == L'\r' || *p == L'\n')
+                    return true;
+            }
+            return false;
+        }
+
+        // Writes the UTF-8 form of the code point starting at *p and advances p past it.
+        // Unpaired surrogates become U+FFFD.
+        inline char* EncodeUtf8(const wchar_t*& p, const wchar_t* end, char* out) noexcept
+        {
+            auto code = static_cast<std::uint32_t>(*p++);
+            if constexpr (sizeof(wchar_t) == 2)
+            {
+                if (code >= 0xD800 && code < 0xDC00 && p < end && static_cast<std::uint32_t>(*p) >= 0xDC00 && static_cast<std::uint32_t>(*p) < 0xE000)
+                    code = 0x10000 + ((code - 0xD800) << 10) + (static_cast<std::uint32_t>(*p++) - 0xDC00);
+            }
+            if ((code >= 0xD800 && code < 0xE000) || code > 0x10FFFF)
+                code = 0xFFFD;
+
+            if (code < 0x80)
+            {
+                *out++ = static_cast<char>(code);
+            }
+            else if (code < 0x800)
+            {
+                *out++ = static_cast<char>(0xC0 | (code >> 6));
+                *out++ = static_cast<char>(0x80 | (code & 0x3F));
+            }
+            else if (code < 0x10000)
+            {
+                *out++ = static_cast<char>(0xE0 | (code >> 12));
+                *out++ = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                *out++ = static_cast<char>(0x80 | (code & 0x3F));
+            }
+            else
+            {
+                *out++ = static_cast<char>(0xF0 | (code >> 18));
+                *out++ = static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+                *out++ = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                *out++ = static_cast<char>(0x80 | (code & 0x3F));
+            }
+            return out;
+        }
+    }
+
+    // Streams rows as UTF-8 JSON Lines or CSV through a fixed-size buffer, so memory
+    // stays the same however many rows are written. Values are written from their
+    // typed storage: integers and reals through std::to_chars, strings through a
+    // vectorized ASCII path with a scalar fallback for escapes and non-ASCII text.
+    // DateTime values go out as ISO 8601 UTC strings.
+    //
+    // Column names are fixed by Begin (or the first table written); every later row
+    // or table must have the same ones. Not thread-safe.
+    class ResultExporter
+    {
+    public:
+        // Receives each full buffer, then the remainder on Finish; may throw to abort.
+        using Sink = std::function<void(std::string_view)>;
+
+        static constexpr std::size_t DefaultBufferBytes = 64u << 10;
+
+        ResultExporter(ExportFormat format, Sink sink, std::size_t bufferBytes = DefaultBufferBytes)
+            : m_format(format), m_sink(std::move(sink)), m_capacity((std::max)(bufferBytes, MinBufferBytes)),
+              m_buffer(std::make_unique_for_overwrite<char[]>(m_capacity))
+        {
+        }
+
+        ResultExporter(ExportFormat format, std::ostream& out, std::size_t bufferBytes = DefaultBufferBytes)
+            : ResultExporter(format, [&out](std::string_view chunk) {
+                  out.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+                  if (!out)
+                      throw std::runtime_error("export write failed");
+              }, bufferBytes)
+        {
+        }
+
+        ResultExporter(const ResultExporter&) = delete;
+        ResultExporter& operator=(const ResultExporter&) = delete;
+
+        // Fixes the column names and writes the CSV header line.
+        void Begin(std::span<const std::wstring_view> columns)
+        {
+            if (m_begun) [[unlikely]]
+                throw std::logic_error("export already begun");
+            m_begun = true;
+            m_started = std::chrono::steady_clock::now();
+
+            for (std::size_t c = 0; c < columns.size(); ++c)
+            {
+                m_names.emplace_back(columns[c]);
+
+                // Each JSON key is escaped once, with its separator, and copied per row.
+                std::string key = c == 0 ? "{\"" : ",\"";
+                appendEscapedTo(key, columns[c], true);
+                key += "\":";
+                m_keys += key;
+                m_keyEnds.push_back(m_keys.size());
+            }
+
+            if (m_format == ExportFormat::Csv)
+            {
+                for (std::size_t c = 0; c < columns.size(); ++c)
+                {
+                    if (c > 0)
+                        put(',');
+                    writeCsvString(columns[c]);
+                }
+                put("\r\n");
+            }
+        }
+
+        // Writes one row; values line up with the columns given to Begin and are
+        // written by their own types.
+        void WriteRow(std::span<const Value> values)
+        {
+            if (!m_begun || values.size() != m_names.size()) [[unlikely]]
+                throw std::invalid_argument("row does not match the export columns");
+
+            beginRow();
+            for (std::size_t c = 0; c < values.size(); ++c)
+            {
+                beginCell(c);
+                writeValue(values[c]);
+            }
+            endRow();
+        }
+
+        // Writes every row of table, beginning the export with its columns if needed.
+        void Write(ResultTable const& table)
+        {
+            if (!m_begun)
+            {
+                std::vector<std::wstring_view> columns;
+                for (auto const& column : table.Columns())
+                    columns.push_back(column.Name());
+                Begin(columns);
+            }
+            else if (!sameColumns(table))
+            {
+                throw std::invalid_argument("table does not match the export columns");
+            }
+
+            for (std::size_t row = 0; row < table.RowCount(); ++row)
+            {
+                beginRow();
+                for (std::size_t c = 0; c < table.ColumnCount(); ++c)
+                {
+                    beginCell(c);
+                    writeCell(table.GetColumn(c), row);
+                }
+                endRow();
+            }
+        }
+
+        // Hands what is buffered to the sink and stops the clock; nothing may be written after.
+        void Finish()
+        {
+            flush();
+            m_finished = std::chrono::steady_clock::now();
+            m_done = true;
+        }
+
+        [[nodiscard]] ExportStats Stats() const noexcept
+        {
+            ExportStats stats;
+            stats.rows = m_rows;
+            stats.bytes = m_flushed + m_used;
+            if (m_begun)
+                stats.elapsed = (m_done ? m_finished : std::chrono::steady_clock::now()) - m_started;
+            return stats;
+        }
+
+    private:
+        static constexpr std::size_t MinBufferBytes = 256;
+
+        // Room guaranteed before writing a number, a date or a step of string escaping.
+        static constexpr std::size_t ReserveBytes = 64;
+
+        bool sameColumns(ResultTable const& table) const noexcept
+        {
+            if (table.ColumnCount() != m_names.size())
+                return false;
+            for (std::size_t c = 0; c < m_names.size(); ++c)
+            {
+                if (table.GetColumn(c).Name() != m_names[c])
+                    return false;
+            }
+            return true;
+        }
+
+        void beginRow()
+        {
+            if (m_done) [[unlikely]]
+                throw std::logic_error("export already finished");
+        }
+
+        void beginCell(std::size_t column)
+        {
+            if (m_format == ExportFormat::JsonLines)
+            {
+                const auto from = column == 0 ? 0 : m_keyEnds[column - 1];
+                put(std::string_view{ m_keys }.substr(from, m_keyEnds[column] - from));
+            }
+            else if (column > 0)
+            {
+                put(',');
+            }
+        }
+
+        void endRow()
+        {
+            if (m_format == ExportFormat::JsonLines)
+                put(m_names.empty() ? "{}\n" : "}\n");
+            else
+                put("\r\n");
+            ++m_rows;
+        }
+
+        void writeCell(Column const& column, std::size_t row)
+        {
+            if (column.IsNull(row))
+                return writeNull();
+
+            switch (column.Storage())
+            {
+            case StorageKind::Integer: return writeInteger(column.GetInt64(row), column.Type());
+            case StorageKind::Real:    return writeReal(column.GetDouble(row), column.Type());
+            case StorageKind::Boolean: return put(column.GetBoolean(row) ? std::string_view{ "true" } : std::string_view{ "false" });
+            case StorageKind::String:  return writeString(column.GetString(row));
+            default:                   return writeNull();
+            }
+        }
+
+        // Arrays, which no format here represents, are written as null.
+        void writeValue(Value const& value)
+        {
+            if (value.IsNull())
+                return writeNull();
+
+            switch (value.Storage())
+            {
+            case StorageKind::Integer: return writeInteger(value.AsInt64(), value.Type());
+            case StorageKind::Real:    return writeReal(value.AsDouble(), value.Type());
+            case StorageKind::Boolean: return put(value.AsBoolean() ? std::string_view{ "true" } : std::string_view{ "false" });
+            case StorageKind::String:  return writeString(value.AsString());
+            default:                   return writeNull();
+            }
+        }
+
+        void writeNull()
+        {
+            if (m_format == ExportFormat::JsonLines)
+                put("null");
+        }
+
+        void writeInteger(std::int64_t value, PropertyType type)
+        {
+            if (type == PropertyType::DateTime)
+                return writeDateTime(value);
+
+            reserve(ReserveBytes);
+            char* out = m_buffer.get() + m_used;
+            auto result = type == PropertyType::UInt64
+                ? std::to_chars(out, out + ReserveBytes, static_cast<std::uint64_t>(value))
+                : std::to_chars(out, out + ReserveBytes, value);
+            m_used = static_cast<std::size_t>(result.ptr - m_buffer.get());
+        }
+
+        void writeReal(double value, PropertyType type)
+        {
+            // JSON has no NaN or infinity.
+            if (!std::isfinite(value) && m_format == ExportFormat::JsonLines)
+                return put("null");
+
+            reserve(ReserveBytes);
+            char* out = m_buffer.get() + m_used;
+            auto result = type == PropertyType::Float
+                ? std::to_chars(out, out + ReserveBytes, static_cast<float>(value))
+                : std::to_chars(out, out + ReserveBytes, value);
+            m_used = static_cast<std::size_t>(result.ptr - m_buffer.get());
+        }
+
+        // yyyy-mm-ddTHH:MM:SS.ffffffZ
+        void writeDateTime(std::int64_t microseconds)
+        {
+            std::int64_t days = microseconds / 86'400'000'000;
+            std::int64_t rest = microseconds % 86'400'000'000;
+            if (rest < 0)
+            {
+                rest += 86'400'000'000;
+                --days;
+            }
+
+            std::int64_t year = 0, month = 0, day = 0;
+            detail::CivilFromDays(days, year, month, day);
+
+            char text[32];
+            char* p = text;
+            auto digits = [&p](std::int64_t value, int count) {
+                for (int i = count - 1; i >= 0; --i, value /= 10)
+                    p[i] = static_cast<char>('0' + value % 10);
+                p += count;
+            };
+
+            if (m_format == ExportFormat::JsonLines)
+                *p++ = '"';
+            digits(year, 4);
+            *p++ = '-';
+            digits(month, 2);
+            *p++ = '-';
+            digits(day, 2);
+            *p++ = 'T';
+            digits(rest / 3'600'000'000, 2);
+            *p++ = ':';
+            digits(rest / 60'000'000 % 60, 2);
+            *p++ = ':';
+            digits(rest / 1'000'000 % 60, 2);
+            *p++ = '.';
+            digits(rest % 1'000'000, 6);
+            *p++ = 'Z';
+            if (m_format == ExportFormat::JsonLines)
+                *p++ = '"';
+
+            put(std::string_view{ text, static_cast<std::size_t>(p - text) });
+        }
+
+        void writeString(std::wstring_view value)
+        {
+            if (m_format == ExportFormat::Csv)
+                return writeCsvString(value);
+
+            put('"');
+            writeEscaped<true>(value);
+            put('"');
+        }
+
+        void writeCsvString(std::wstring_view value)
+        {
+            if (!detail::CsvNeedsQuotes(value))
+                return writeEscaped<false>(value);
+
+            put('"');
+            writeEscaped<false>(value);
+            put('"');
+        }
+
+        // JSON escapes quotes, backslashes and control characters; CSV doubles quotes
+        // (the caller adds the surrounding ones). Everything else is copied as UTF-8.
+        template<bool Json>
+        void writeEscaped(std::wstring_view value)
+        {
+            const wchar_t* p = value.data();
+            const wchar_t* end = p + value.size();
+            while (p < end)
+            {
+                reserve(2 * ReserveBytes);
+                char* out = m_buffer.get() + m_used;
+                char* outEnd = m_buffer.get() + m_capacity;
+
+                // Plain runs fill the buffer up to ReserveBytes from its end, which leaves
+                // room for any one escape.
+                while (outEnd - out > static_cast<std::ptrdiff_t>(ReserveBytes))
+                {
+                    const auto plain = detail::CopyPlainAscii<Json>(p, end, out, outEnd - ReserveBytes);
+                    p += plain;
+                    out += plain;
+                    if (p == end || outEnd - out <= static_cast<std::ptrdiff_t>(ReserveBytes))
+                        break;
+
+                    out = escapeOne<Json>(p, end, out);
+                }
+
+                m_used = static_cast<std::size_t>(out - m_buffer.get());
+            }
+        }
+
+        // Writes the escaped form of a character that is not plain.
+        template<bool Json>
+        static char* escapeOne(const wchar_t*& p, const wchar_t* end, char* out) noexcept
+        {
+            const auto code = static_cast<std::uint32_t>(*p);
+            if (code >= 0x80)
+                return detail::EncodeUtf8(p, end, out);
+
+            ++p;
+            if constexpr (!Json)
+            {
+                if (code == '"')
+                    *out++ = '"';
+                *out++ = static_cast<char>(code);
+                return out;
+            }
+            else
+            {
+                *out++ = '\\';
+                switch (code)
+                {
+                case '"':  *out++ = '"'; break;
+                case '\\': *out++ = '\\'; break;
+                case '\b': *out++ = 'b'; break;
+                case '\f': *out++ = 'f'; break;
+                case '\n': *out++ = 'n'; break;
+                case '\r': *out++ = 'r'; break;
+                case '\t': *out++ = 't'; break;
+                default:
+                    static constexpr char hex[] = "0123456789abcdef";
+                    *out++ = 'u';
+                    *out++ = '0';
+                    *out++ = '0';
+                    *out++ = hex[code >> 4];
+                    *out++ = hex[code & 0xF];
+                    break;
+                }
+                return out;
+            }
+        }
+
+        // Used for the JSON keys, which are built once outside the buffer.
+        static void appendEscapedTo(std::string& out, std::wstring_view value, bool json)
+        {
+            const wchar_t* p = value.data();
+            const wchar_t* end = p + value.size();
+            char step[8];
+            while (p < end)
+            {
+                if (json ? detail::IsPlainAscii<true>(*p) : detail::IsPlainAscii<false>(*p))
+                {
+                    out.push_back(static_cast<char>(*p++));
+                    continue;
+                }
+                char* last = json ? escapeOne<true>(p, end, step) : escapeOne<false>(p, end, step);
+                out.append(step, last);
+            }
+        }
+
+        void put(char c)
+        {
+            reserve(1);
+            m_buffer[m_used++] = c;
+        }
+
+        void put(std::string_view text)
+        {
+            while (!text.empty())
+            {
+                reserve(1);
+                const auto count = (std::min)(text.size(), m_capacity - m_used);
+                std::memcpy(m_buffer.get() + m_used, text.data(), count);
+                m_used += count;
+                text.remove_prefix(count);
+            }
+        }
+
+        void reserve(std::size_t bytes)
+        {
+            if (m_capacity - m_used < bytes)
+                flush();
+        }
+
+        void flush()
+        {
+            if (m_used == 0)
+                return;
+
+            m_sink(std::string_view{ m_buffer.get(), m_used });
+            m_flushed += m_used;
+            m_used = 0;
+        }
+
+    private:
+        ExportFormat m_format;
+        Sink m_sink;
+        const std::size_t m_capacity;
+        std::unique_ptr<char[]> m_buffer;
+        std::size_t m_used = 0;
+
+        bool m_begun = false;
+        bool m_done = false;
+        std::vector<std::wstring> m_names;
+        std::string m_keys;
+        std::vector<std::size_t> m_keyEnds;
+
+        std::uint64_t m_rows = 0;
+        std::uint64_t m_flushed = 0;
+        std::chrono::steady_clock::time_point m_started;
+        std::chrono::steady_clock::time_point m_finished;
+    };
+}
@@ -0,0 +1,433 @@
+#pragma once
+
+#include "PropertyName.h"
+#include "PropertyType.h"
+#include "StringPool.h"
+#include "WmiValue.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Wmi
+{
+    class NullBitmap
+    {
+    public:
+        void PushBack(bool isNull)
+        {
+            if ((m_size & 63) == 0)
+                m_words.push_back(0);
+
+            if (isNull)
+                m_words.back() |= std::uint64_t{ 1 } << (m_size & 63);
+
+            ++m_size;
+        }
+
+        void Set(std::size_t index, bool isNull) noexcept
+        {
+            const auto mask = std::uint64_t{ 1 } << (index & 63);
+            if (isNull)
+                m_words[index >> 6] |= mask;
+            else
+                m_words[index >> 6] &= ~mask;
+        }
+
+        [[nodiscard]] bool IsNull(std::size_t index) const noexcept
+        {
+            return (m_words[index >> 6] >> (index & 63)) & 1;
+        }
+
+        [[nodiscard]] std::size_t Size() const noexcept { return m_size; }
+        [[nodiscard]] std::span<const std::uint64_t> Words() const noexcept { return m_words; }
+
+        void Reserve(std::size_t bits) { m_words.reserve((bits + 63) / 64); }
+
+    private:
+        std::vector<std::uint64_t> m_words;
+        std::size_t m_size = 0;
+    };
+
+    // One typed property column. Integers of every width share an int64 array
+    // (UInt64 keeps its bit pattern), Float/Double share a double array and strings
+    // are stored back to back in a single character buffer indexed by offsets.
+    //
+    // A string column given a StringPool keeps one pooled handle per row instead. If
+    // most of its first PoolSampleRows values turn out to be new to the pool, the
+    // column is high-cardinality: it moves what it has to the character buffer and
+    // stops pooling. It does the same once the pool refuses a value.
+    class Column
+    {
+    public:
+        static constexpr std::size_t PoolSampleRows = 1024;
+
+        // pool is ignored for non-string columns and must outlive the column.
+        Column(std::wstring name, PropertyType type, StringPool* pool = nullptr)
+            : m_name(std::move(name)), m_type(type), m_storage(StorageOf(type))
+        {
+            if (m_storage == StorageKind::String)
+            {
+                m_offsets.push_back(0);
+                m_pool = pool;
+            }
+        }
+
+        [[nodiscard]] std::wstring const& Name() const noexcept { return m_name; }
+        [[nodiscard]] PropertyType Type() const noexcept { return m_type; }
+        [[nodiscard]] StorageKind Storage() const noexcept { return m_storage; }
+        [[nodiscard]] std::size_t Size() const noexcept { return m_nulls.Size(); }
+
+        // Whether the strings are currently kept as pooled handles.
+        [[nodiscard]] bool IsPooled() const noexcept { return m_pool != nullptr; }
+
+        [[nodiscard]] bool IsNull(std::size_t row) const noexcept { return m_nulls.IsNull(row); }
+        [[nodiscard]] NullBitmap const& Nulls() const noexcept { return m_nulls; }
+
+        [[nodiscard]] std::span<const std::int64_t> Integers() const noexcept { return m_integers; }
+        [[nodiscard]] std::span<const double> Reals() const noexcept { return m_reals; }
+        [[nodiscard]] std::span<const std::uint8_t> Booleans() const noexcept { return m_booleans; }
+
+        [[nodiscard]] std::int64_t GetInt64(std::size_t row) const noexcept { return m_integers[row]; }
+        [[nodiscard]] std::uint64_t GetUInt64(std::size_t row) const noexcept { return static_cast<std::uint64_t>(m_integers[row]); }
+        [[nodiscard]] double GetDouble(std::size_t row) const noexcept { return m_reals[row]; }
+        [[nodiscard]] bool GetBoolean(std::size_t row) const noexcept { return m_booleans[row] != 0; }
+
+        [[nodiscard]] std::wstring_view GetString(std::size_t row) const noexcept
+        {
+            if (m_pool)
+                return m_pooled[row].View();
+
+            return { m_chars.data() + m_offsets[row], m_offsets[row + 1] - m_offsets[row] };
+        }
+
+        [[nodiscard]] Value GetValue(std::size_t row) const noexcept
+        {
+            if (IsNull(row))
+                return Value::Null();
+
+            switch (m_storage)
+            {
+            case StorageKind::Integer: return Value::FromInt64(m_integers[row], m_type);
+            case StorageKind::Real:    return Value::FromDouble(m_reals[row], m_type);
+            case StorageKind::Boolean: return Value::FromBoolean(m_booleans[row] != 0);
+            case StorageKind::String:  return Value::FromString(GetString(row), m_type);
+            default:                   return Value::Unknown();
+            }
+        }
+
+        // Appends a converted value; anything that does not fit the column becomes null.
+        void AppendValue(Value const& value)
+        {
+            if (value.IsNull() || value.Storage() != m_storage)
+                return AppendNull();
+
+            switch (m_storage)
+            {
+            case StorageKind::Integer: return AppendInteger(value.AsInt64());
+            case StorageKind::Real:    return AppendReal(value.AsDouble());
+            case StorageKind::Boolean: return AppendBoolean(value.AsBoolean());
+            case StorageKind::String:  return AppendString(value.AsString());
+            default:                   return AppendNull();
+            }
+        }
+
+        void AppendNull()
+        {
+            switch (m_storage)
+            {
+            case StorageKind::Integer: m_integers.push_back(0); break;
+            case StorageKind::Real:    m_reals.push_back(0.0); break;
+            case StorageKind::Boolean: m_booleans.push_back(0); break;
+            case StorageKind::String:
+                if (m_pool)
+                    m_pooled.emplace_back();
+                else
+                    m_offsets.push_back(m_offsets.back());
+                break;
+            default: break;
+            }
+            m_nulls.PushBack(true);
+        }
+
+        void AppendInteger(std::int64_t value)
+        {
+            expect(StorageKind::Integer);
+            m_integers.push_back(value);
+            m_nulls.PushBack(false);
+        }
+
+        void AppendReal(double value)
+        {
+            expect(StorageKind::Real);
+            m_reals.push_back(value);
+            m_nulls.PushBack(false);
+        }
+
+        void AppendBoolean(bool value)
+        {
+            expect(StorageKind::Boolean);
+            m_booleans.push_back(value ? 1 : 0);
+            m_nulls.PushBack(false);
+        }
+
+        void AppendString(std::wstring_view value)
+        {
+            expect(StorageKind::String);
+            if (m_pool && appendPooled(value))
+                return;
+
+            m_chars.insert(m_chars.end(), value.begin(), value.end());
+            m_offsets.push_back(static_cast<std::uint32_t>(m_chars.size()));
+            m_nulls.PushBack(false);
+        }
+
+        void Reserve(std::size_t rows)
+        {
+            switch (m_storage)
+            {
+            case StorageKind::Integer: m_integers.reserve(rows); break;
+            case StorageKind::Real:    m_reals.reserve(rows); break;
+            case StorageKind::Boolean: m_booleans.reserve(rows); break;
+            case StorageKind::String:
+                if (m_pool)
+                    m_pooled.reserve(rows);
+                else
+                    m_offsets.reserve(rows + 1);
+                break;
+            default: break;
+            }
+            m_nulls.Reserve(rows);
+        }
+
+        [[nodiscard]] std::size_t MemoryUsage() const noexcept
+        {
+            return m_integers.capacity() * sizeof(std::int64_t)
+                + m_reals.capacity() * sizeof(double)
+                + m_booleans.capacity()
+                + m_chars.capacity() * sizeof(wchar_t)
+                + m_offsets.capacity() * sizeof(std::uint32_t)
+                + m_pooled.capacity() * sizeof(InternedString)
+                + m_nulls.Words().size() * sizeof(std::uint64_t);
+        }
+
+    private:
+        bool appendPooled(std::wstring_view value)
+        {
+            bool added;
+            auto pooled = m_pool->Intern(value, added);
+            if (!pooled) [[unlikely]]
+            {
+                unpool();
+                return false;
+            }
+
+            m_pooled.push_back(pooled);
+            m_nulls.PushBack(false);
+
+            if (m_sampled < PoolSampleRows)
+            {
+                m_fresh += added ? 1 : 0;
+                if (++m_sampled == PoolSampleRows && m_fresh * 2 > m_sampled)
+                    unpool();
+            }
+            return true;
+        }
+
+        // Moves pooled strings into the character buffer; the column stops pooling for good.
+        void unpool()
+        {
+            for (std::size_t row = 0; row < m_pooled.size(); ++row)
+            {
+                auto value = m_pooled[row].View();
+                m_chars.insert(m_chars.end(), value.begin(), value.end());
+                m_offsets.push_back(static_cast<std::uint32_t>(m_chars.size()));
+            }
+
+            m_pooled = {};
+            m_pool = nullptr;
+        }
+
+        void expect(StorageKind kind) const
+        {
+            if (m_storage != kind) [[unlikely]]
+                throw std::invalid_argument("value does not match column storage");
+        }
+
+    private:
+        std::wstring m_name;
+        PropertyType m_type;
+        StorageKind m_storage;
+
+        std::vector<std::int64_t> m_integers;
+        std::vector<double> m_reals;
+        std::vector<std::uint8_t> m_booleans;
+        std::vector<wchar_t> m_chars;
+        std::vector<std::uint32_t> m_offsets;
+        NullBitmap m_nulls;
+
+        StringPool* m_pool = nullptr;
+        std::vector<InternedString> m_pooled;
+        std::size_t m_sampled = 0;
+        std::size_t m_fresh = 0;
+    };
+
+    class ResultTable;
+
+    // Non-owning view of one row; valid for as long as the table is alive.
+    class RowView
+    {
+    public:
+        RowView(ResultTable const& table, std::size_t row) noexcept : m_table(&table), m_row(row) {}
+
+        [[nodiscard]] std::size_t Index() const noexcept { return m_row; }
+        [[nodiscard]] ResultTable const& Table() const noexcept { return *m_table; }
+
+        [[nodiscard]] bool IsNull(std::size_t column) const noexcept;
+        [[nodiscard]] std::int64_t GetInt64(std::size_t column) const noexcept;
+        [[nodiscard]] std::uint64_t GetUInt64(std::size_t column) const noexcept;
+        [[nodiscard]] double GetDouble(std::size_t column) const noexcept;
+        [[nodiscard]] bool GetBoolean(std::size_t column) const noexcept;
+        [[nodiscard]] std::wstring_view GetString(std::size_t column) const noexcept;
+        [[nodiscard]] Value GetValue(std::size_t column) const noexcept;
+
+    private:
+        ResultTable const* m_table;
+        std::size_t m_row;
+    };
+
+    // Columnar result set. Rows are appended with BeginRow/Append*/EndRow; any column
+    // not written for a row is padded with null, and columns first seen mid-stream are
+    // back-filled with nulls for the earlier rows.
+    class ResultTable
+    {
+    public:
+        ResultTable() = default;
+
+        // String columns added from now on deduplicate their values through pool,
+        // which may be shared with other tables of the same context.
+        explicit ResultTable(std::shared_ptr<StringPool> pool) : m_strings(std::move(pool)) {}
+
+        ResultTable(ResultTable&&) = default;
+        ResultTable& operator=(ResultTable&&) = default;
+        ResultTable(const ResultTable&) = delete;
+        ResultTable& operator=(const ResultTable&) = delete;
+
+        std::size_t AddColumn(std::wstring_view name, PropertyType type)
+        {
+            if (auto existing = Find(name))
+                return *existing;
+
+            auto& column = m_columns.emplace_back(std::wstring{ name }, type, m_strings.get());
+            column.Reserve(m_rowCount);
+            for (std::size_t i = 0; i < m_rowCount; ++i)
+                column.AppendNull();
+
+            m_index.clear();
+            for (std::size_t i = 0; i < m_columns.size(); ++i)
+                m_index.emplace(m_columns[i].Name(), i);
+
+            return m_columns.size() - 1;
+        }
+
+        // Ignores case, as IWbemClassObject::Get does.
+        [[nodiscard]] std::optional<std::size_t> Find(std::wstring_view name) const
+        {
+            auto it = m_index.find(name);
+            if (it == m_index.end())
+                return std::nullopt;
+            return it->second;
+        }
+
+        void Reserve(std::size_t rows)
+        {
+            for (auto& column : m_columns)
+                column.Reserve(rows);
+        }
+
+        void BeginRow() noexcept {}
+
+        void AppendNull(std::size_t column) { writable(column).AppendNull(); }
+        void AppendInteger(std::size_t column, std::int64_t value) { writable(column).AppendInteger(value); }
+        void AppendReal(std::size_t column, double value) { writable(column).AppendReal(value); }
+        void AppendBoolean(std::size_t column, bool value) { writable(column).AppendBoolean(value); }
+        void AppendString(std::size_t column, std::wstring_view value) { writable(column).AppendString(value); }
+        void AppendValue(std::size_t column, Value const& value) { writable(column).AppendValue(value); }
+
+        void EndRow()
+        {
+            ++m_rowCount;
+            for (auto& column : m_columns)
+            {
+                if (column.Size() < m_rowCount)
+                    column.AppendNull();
+            }
+        }
+
+        [[nodiscard]] std::size_t RowCount() const noexcept { return m_rowCount; }
+        [[nodiscard]] std::size_t ColumnCount() const noexcept { return m_columns.size(); }
+        [[nodiscard]] Column const& GetColumn(std::size_t index) const noexcept { return m_columns[index]; }
+        [[nodiscard]] std::span<const Column> Columns() const noexcept { return m_columns; }
+        [[nodiscard]] RowView Row(std::size_t index) const noexcept { return { *this, index }; }
+
+        // A new table of the given rows, in that order, with the same columns and pool.
+        [[nodiscard]] ResultTable Select(std::span<const std::uint32_t> rows) const
+        {
+            ResultTable selected{ m_strings };
+            for (auto const& column : m_columns)
+                selected.AddColumn(column.Name(), column.Type());
+            selected.Reserve(rows.size());
+
+            for (auto row : rows)
+            {
+                selected.BeginRow();
+                for (std::size_t c = 0; c < m_columns.size(); ++c)
+                    selected.AppendValue(c, m_columns[c].GetValue(row));
+                selected.EndRow();
+            }
+            return selected;
+        }
+
+        void UseStringPool(std::shared_ptr<StringPool> pool) noexcept { m_strings = std::move(pool); }
+        [[nodiscard]] std::shared_ptr<StringPool> const& Strings() const noexcept { return m_strings; }
+
+        // Excludes the string pool, which may be shared.
+        [[nodiscard]] std::size_t MemoryUsage() const noexcept
+        {
+            std::size_t bytes = sizeof(*this);
+            for (auto const& column : m_columns)
+                bytes += sizeof(Column) + column.Name().capacity() * sizeof(wchar_t) + column.MemoryUsage();
+            return bytes;
+        }
+
+    private:
+        Column& writable(std::size_t column)
+        {
+            auto& c = m_columns.at(column);
+            if (c.Size() != m_rowCount) [[unlikely]]
+                throw std::logic_error("column already written for the current row");
+            return c;
+        }
+
+    private:
+        std::vector<Column> m_columns;
+        std::unordered_map<std::wstring_view, std::size_t, PropertyNameHash, PropertyNameEqual> m_index;
+        std::size_t m_rowCount = 0;
+        std::shared_ptr<StringPool> m_strings;
+    };
+
+    inline bool RowView::IsNull(std::size_t column) const noexcept { return m_table->GetColumn(column).IsNull(m_row); }
+    inline std::int64_t RowView::GetInt64(std::size_t column) const noexcept { return m_table->GetColumn(column).GetInt64(m_row); }
+    inline std::uint64_t RowView::GetUInt64(std::size_t column) const noexcept { return m_table->GetColumn(column).GetUInt64(m_row); }
+    inline double RowView::GetDouble(std::size_t column) const noexcept { return m_table->GetColumn(column).GetDouble(m_row); }
+    inline bool RowView::GetBoolean(std::size_t column) const noexcept { return m_table->GetColumn(column).GetBoolean(m_row); }
+    inline std::wstring_view RowView::GetString(std::size_t column) const noexcept { return m_table->GetColumn(column).GetString(m_row); }
+    inline Value RowView::GetValue(std::size_t column) const noexcept { return m_table->GetColumn(column).GetValue(m_row); }
+}
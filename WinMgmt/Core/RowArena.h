@@ -0,0 +1,163 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace Wmi
+{
+    struct RowArenaStats
+    {
+        std::size_t rows = 0;
+        std::size_t chunks = 0;
+        std::size_t bytesReserved = 0;
+    };
+
+    // Rows of one result set, stored in chunks that double in size: appending costs one
+    // allocation per chunk rather than per row, never moves a row that is already
+    // stored, and everything is freed together with the arena. Appending is for one
+    // thread at a time; once filled, rows can be read from any thread. The allocator
+    // only ever sees whole chunks, which is what the benchmarks count.
+    template<typename Row, typename Allocator = std::allocator<Row>>
+    class RowArena
+    {
+    public:
+        explicit RowArena(std::size_t firstChunk = 256, Allocator allocator = Allocator())
+            : m_first(std::bit_ceil(std::max<std::size_t>(firstChunk, 1))), m_allocator(std::move(allocator))
+        {
+        }
+
+        RowArena(const RowArena&) = delete;
+        RowArena& operator=(const RowArena&) = delete;
+
+        ~RowArena()
+        {
+            for (std::size_t i = 0; i < m_chunks.size(); ++i)
+            {
+                const auto used = (std::min)(m_size - chunkStart(i), capacityOf(i));
+                std::destroy_n(m_chunks[i], used);
+                traits::deallocate(m_allocator, m_chunks[i], capacityOf(i));
+            }
+        }
+
+        Row& Append(Row row)
+        {
+            if (m_size == chunkStart(m_chunks.size())) [[unlikely]]
+                m_chunks.push_back(traits::allocate(m_allocator, capacityOf(m_chunks.size())));
+
+            auto [chunk, offset] = locate(m_size);
+            auto* slot = std::construct_at(m_chunks[chunk] + offset, std::move(row));
+            ++m_size;
+            return *slot;
+        }
+
+        // Lets the arena be filled like a container, e.g. by MpscBatchQueue::Drain.
+        void push_back(Row row) { Append(std::move(row)); }
+
+        [[nodiscard]] Row& operator[](std::size_t index) noexcept
+        {
+            auto [chunk, offset] = locate(index);
+            return m_chunks[chunk][offset];
+        }
+
+        [[nodiscard]] Row const& operator[](std::size_t index) const noexcept
+        {
+            auto [chunk, offset] = locate(index);
+            return m_chunks[chunk][offset];
+        }
+
+        [[nodiscard]] std::size_t Size() const noexcept { return m_size; }
+
+        [[nodiscard]] RowArenaStats Stats() const noexcept
+        {
+            return { m_size, m_chunks.size(), chunkStart(m_chunks.size()) * sizeof(Row) };
+        }
+
+    private:
+        using traits = std::allocator_traits<Allocator>;
+
+        // Chunk k holds m_first << k rows and starts at row m_first * (2^k - 1).
+        [[nodiscard]] std::size_t capacityOf(std::size_t chunk) const noexcept { return m_first << chunk; }
+        [[nodiscard]] std::size_t chunkStart(std::size_t chunk) const noexcept { return m_first * ((std::size_t{ 1 } << chunk) - 1); }
+
+        [[nodiscard]] std::pair<std::size_t, std::size_t> locate(std::size_t index) const noexcept
+        {
+            const auto chunk = static_cast<std::size_t>(std::bit_width(index / m_first + 1) - 1);
+            return { chunk, index - chunkStart(chunk) };
+        }
+
+    private:
+        std::size_t m_first;
+        std::size_t m_size = 0;
+        std::vector<Row*> m_chunks;
+        [[no_unique_address]] Allocator m_allocator;
+    };
+
+    // Per-row objects made on first touch and kept for later touches, so a result set
+    // pays for wrappers only on the rows someone actually reads. Projection must be
+    // constructible from nullptr and test false while empty, as shared_ptr and
+    // C++/WinRT references do. Thread-safe.
+    template<typename Projection>
+    class LazyProjection
+    {
+    public:
+        explicit LazyProjection(std::size_t rows)
+            : m_slots(rows, Projection{ nullptr })
+        {
+        }
+
+        // make(row) runs without the lock, so a slow conversion holds up no other row.
+        // Threads racing for the same untouched row may each run it; the first result
+        // stored is the one every caller gets, and the others are dropped.
+        template<typename Make>
+        [[nodiscard]] Projection Get(std::size_t row, Make&& make)
+        {
+            {
+                std::lock_guard lk(m_mutex);
+                if (auto const& slot = m_slots[row])
+                    return slot;
+            }
+
+            Projection made = std::forward<Make>(make)(row);
+
+            std::lock_guard lk(m_mutex);
+            auto& slot = m_slots[row];
+            if (!slot)
+            {
+                slot = std::move(made);
+                ++m_materialized;
+            }
+            return slot;
+        }
+
+        // Position of an already made projection; rows not made yet cannot match.
+        [[nodiscard]] std::optional<std::size_t> Find(Projection const& projection) const
+        {
+            std::lock_guard lk(m_mutex);
+            for (std::size_t i = 0; i < m_slots.size(); ++i)
+            {
+                if (m_slots[i] && m_slots[i] == projection)
+                    return i;
+            }
+            return std::nullopt;
+        }
+
+        [[nodiscard]] std::size_t Size() const noexcept { return m_slots.size(); }
+
+        [[nodiscard]] std::size_t Materialized() const
+        {
+            std::lock_guard lk(m_mutex);
+            return m_materialized;
+        }
+
+    private:
+        mutable std::mutex m_mutex;
+        std::vector<Projection> m_slots;
+        std::size_t m_materialized = 0;
+    };
+}
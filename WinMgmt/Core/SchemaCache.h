@@ -0,0 +1,200 @@
+#pragma once
+
+#include "PropertyName.h"
+#include "PropertyType.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace Wmi
+{
+    struct TransparentStringHash
+    {
+        using is_transparent = void;
+
+        std::size_t operator()(std::wstring_view value) const noexcept
+        {
+            return std::hash<std::wstring_view>{}(value);
+        }
+    };
+
+    struct TransparentStringEqual
+    {
+        using is_transparent = void;
+
+        template<typename Left, typename Right>
+        bool operator()(Left const& left, Right const& right) const noexcept
+        {
+            return std::wstring_view{ left } == std::wstring_view{ right };
+        }
+    };
+
+    // Property layout of one WMI class: stable indices, declared types and the
+    // interned names. Shared by every object of that class.
+    template<typename String>
+    class BasicClassSchema
+    {
+    public:
+        BasicClassSchema(std::vector<String> names, std::vector<PropertyType> types, std::vector<PropertyType> elementTypes = {})
+            : m_names(std::move(names)), m_types(std::move(types)), m_elementTypes(std::move(elementTypes))
+        {
+            m_elementTypes.resize(m_names.size(), PropertyType::Unknown);
+            m_index.reserve(m_names.size());
+            for (std::size_t i = 0; i < m_names.size(); ++i)
+                m_index.emplace(std::wstring_view{ m_names[i] }, i);
+        }
+
+        BasicClassSchema(const BasicClassSchema&) = delete;
+        BasicClassSchema& operator=(const BasicClassSchema&) = delete;
+
+        [[nodiscard]] std::size_t Size() const noexcept { return m_names.size(); }
+        [[nodiscard]] String const& Name(std::size_t index) const noexcept { return m_names[index]; }
+        [[nodiscard]] PropertyType Type(std::size_t index) const noexcept { return m_types[index]; }
+        [[nodiscard]] PropertyType ElementType(std::size_t index) const noexcept { return m_elementTypes[index]; }
+
+        [[nodiscard]] std::optional<std::size_t> Find(std::wstring_view name) const
+        {
+            auto it = m_index.find(name);
+            if (it == m_index.end())
+                return std::nullopt;
+            return it->second;
+        }
+
+    private:
+        std::vector<String> m_names;
+        std::vector<PropertyType> m_types;
+        std::vector<PropertyType> m_elementTypes;
+        std::unordered_map<std::wstring_view, std::size_t, PropertyNameHash, PropertyNameEqual> m_index;
+    };
+
+    struct SchemaCacheStats
+    {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        std::size_t classes = 0;
+        std::size_t internedNames = 0;
+    };
+
+    // Process-wide cache of class schemas keyed by namespace and class name.
+    // Property names are interned across classes, so "Name" or "Caption" exist once.
+    template<typename String>
+    class BasicSchemaCache
+    {
+    public:
+        using schema_type = BasicClassSchema<String>;
+        using schema_ptr = std::shared_ptr<const schema_type>;
+
+        struct PropertyInfo
+        {
+            std::wstring_view name;
+            PropertyType type;
+            PropertyType elementType = PropertyType::Unknown;
+        };
+
+        [[nodiscard]] schema_ptr Find(std::wstring_view ns, std::wstring_view className) const
+        {
+            auto key = makeKey(ns, className);
+            std::shared_lock lk(m_mutex);
+            auto it = m_schemas.find(key);
+            return it == m_schemas.end() ? nullptr : it->second;
+        }
+
+        // enumerate(callback) must call callback(PropertyInfo) once per property;
+        // it only runs the first time a class is seen.
+        template<typename Enumerate>
+        schema_ptr GetOrAdd(std::wstring_view ns, std::wstring_view className, Enumerate&& enumerate)
+        {
+            auto key = makeKey(ns, className);
+            {
+                std::shared_lock lk(m_mutex);
+                auto it = m_schemas.find(key);
+                if (it != m_schemas.end()) [[likely]]
+                {
+                    m_hits.fetch_add(1, std::memory_order_relaxed);
+                    return it->second;
+                }
+            }
+
+            std::vector<std::wstring> names;
+            std::vector<PropertyType> types;
+            std::vector<PropertyType> elementTypes;
+            std::invoke(std::forward<Enumerate>(enumerate), [&](PropertyInfo const& info) {
+                names.emplace_back(info.name);
+                types.push_back(info.type);
+                elementTypes.push_back(info.elementType);
+            });
+
+            std::unique_lock lk(m_mutex);
+            auto it = m_schemas.find(key);
+            if (it != m_schemas.end())
+            {
+                m_hits.fetch_add(1, std::memory_order_relaxed);
+                return it->second;
+            }
+
+            std::vector<String> interned;
+            interned.reserve(names.size());
+            for (auto const& name : names)
+                interned.push_back(intern(name));
+
+            auto schema = std::make_shared<const schema_type>(std::move(interned), std::move(types), std::move(elementTypes));
+            m_schemas.emplace(std::move(key), schema);
+            m_misses.fetch_add(1, std::memory_order_relaxed);
+            return schema;
+        }
+
+        void Clear()
+        {
+            std::unique_lock lk(m_mutex);
+            m_schemas.clear();
+            m_names.clear();
+        }
+
+        [[nodiscard]] SchemaCacheStats Stats() const
+        {
+            std::shared_lock lk(m_mutex);
+            return { m_hits.load(std::memory_order_relaxed), m_misses.load(std::memory_order_relaxed), m_schemas.size(), m_names.size() };
+        }
+
+    private:
+        static std::wstring makeKey(std::wstring_view ns, std::wstring_view className)
+        {
+            std::wstring key;
+            key.reserve(ns.size() + className.size() + 1);
+            for (auto c : ns)
+                key.push_back(static_cast<wchar_t>(c >= L'a' && c <= L'z' ? c - (L'a' - L'A') : c));
+            key.push_back(L':');
+            for (auto c : className)
+                key.push_back(static_cast<wchar_t>(c >= L'a' && c <= L'z' ? c - (L'a' - L'A') : c));
+            return key;
+        }
+
+        String const& intern(std::wstring const& name)
+        {
+            auto it = m_names.find(std::wstring_view{ name });
+            if (it != m_names.end())
+                return *it;
+
+            return *m_names.emplace(std::wstring_view{ name }).first;
+        }
+
+    private:
+        mutable std::shared_mutex m_mutex;
+        std::unordered_map<std::wstring, schema_ptr, TransparentStringHash, TransparentStringEqual> m_schemas;
+        std::unordered_set<String, TransparentStringHash, TransparentStringEqual> m_names;
+        std::atomic<std::uint64_t> m_hits{ 0 };
+        std::atomic<std::uint64_t> m_misses{ 0 };
+    };
+}
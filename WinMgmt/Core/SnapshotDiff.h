@@ -0,0 +1,379 @@
+#pragma once
+
+#include "ResultTable.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Wmi
+{
+    // One object present in both snapshots whose values differ. Its changed
+    // properties are propertyCount entries of SnapshotDiff::ChangedProperties.
+    struct RowChange
+    {
+        std::uint32_t before = 0;
+        std::uint32_t after = 0;
+        std::uint32_t firstProperty = 0;
+        std::uint32_t propertyCount = 0;
+    };
+
+    // Result of comparing two snapshots. Rows are indices into the tables that were
+    // compared and property names are views of their column names, so both tables
+    // must outlive the diff.
+    class SnapshotDiff
+    {
+    public:
+        // Rows of the newer table whose key was not in the older one, in table order.
+        [[nodiscard]] std::span<const std::uint32_t> Added() const noexcept { return m_added; }
+
+        // Rows of the older table whose key is gone, in table order.
+        [[nodiscard]] std::span<const std::uint32_t> Removed() const noexcept { return m_removed; }
+
+        [[nodiscard]] std::span<const RowChange> Changed() const noexcept { return m_changed; }
+
+        // Property indices; see PropertyName.
+        [[nodiscard]] std::span<const std::uint32_t> ChangedProperties(RowChange const& change) const noexcept
+        {
+            return std::span<const std::uint32_t>{ m_properties }.subspan(change.firstProperty, change.propertyCount);
+        }
+
+        // The newer table's columns come first, followed by those only the older one has.
+        [[nodiscard]] std::wstring_view PropertyName(std::uint32_t property) const noexcept { return m_names[property]; }
+        [[nodiscard]] std::size_t PropertyCount() const noexcept { return m_names.size(); }
+
+        [[nodiscard]] std::size_t Unchanged() const noexcept { return m_unchanged; }
+        [[nodiscard]] bool Empty() const noexcept { return m_added.empty() && m_removed.empty() && m_changed.empty(); }
+
+        // Keeps capacity, so a diff reused across polls stops allocating once warm.
+        void Clear() noexcept
+        {
+            m_added.clear();
+            m_removed.clear();
+            m_changed.clear();
+            m_properties.clear();
+            m_names.clear();
+            m_unchanged = 0;
+        }
+
+    private:
+        friend class SnapshotDiffer;
+
+        std::vector<std::uint32_t> m_added;
+        std::vector<std::uint32_t> m_removed;
+        std::vector<RowChange> m_changed;
+        std::vector<std::uint32_t> m_properties;
+        std::vector<std::wstring_view> m_names;
+        std::size_t m_unchanged = 0;
+    };
+
+    // Compares two results of the same query by object identity. Objects are matched
+    // on their key properties (by default __PATH, or __RELPATH) through an open-
+    // addressing index over the older snapshot; every row's values are folded into a
+    // 64-bit hash column by column, and only rows whose hashes differ are compared
+    // property by property. The whole diff is linear in rows times columns.
+    //
+    // Scratch buffers are kept between calls, so one differ per polled query avoids
+    // reallocating on every refresh. Not thread-safe.
+    class SnapshotDiffer
+    {
+    public:
+        [[nodiscard]] SnapshotDiff Diff(ResultTable const& before, ResultTable const& after, std::span<const std::wstring> keyProperties = {})
+        {
+            SnapshotDiff diff;
+            Diff(before, after, keyProperties, diff);
+            return diff;
+        }
+
+        // Throws std::invalid_argument when a key property is missing from either non-empty
+        // table, or when no keys are given and the tables carry neither __PATH nor __RELPATH.
+        void Diff(ResultTable const& before, ResultTable const& after, std::span<const std::wstring> keyProperties, SnapshotDiff& out)
+        {
+            if (before.RowCount() >= (std::numeric_limits<std::uint32_t>::max)() || after.RowCount() >= (std::numeric_limits<std::uint32_t>::max)()) [[unlikely]]
+                throw std::length_error("snapshot is too large to diff");
+
+            out.Clear();
+            alignColumns(before, after, out);
+
+            // Nothing to match against; an empty result may not even have columns.
+            if (before.RowCount() == 0 || after.RowCount() == 0)
+            {
+                for (std::uint32_t row = 0; row < after.RowCount(); ++row)
+                    out.m_added.push_back(row);
+                for (std::uint32_t row = 0; row < before.RowCount(); ++row)
+                    out.m_removed.push_back(row);
+                return;
+            }
+
+            resolveKeys(keyProperties, out);
+
+            hashColumns(before, m_beforeColumns, m_keys, m_beforeKeyHash);
+            hashColumns(after, m_afterColumns, m_keys, m_afterKeyHash);
+            match(before, after);
+
+            hashColumns(before, m_beforeColumns, {}, m_beforeRowHash);
+            hashColumns(after, m_afterColumns, {}, m_afterRowHash);
+
+            for (std::uint32_t row = 0; row < after.RowCount(); ++row)
+            {
+                const auto partner = m_afterMatch[row];
+                if (partner == unmatched)
+                    out.m_added.push_back(row);
+                else if (m_beforeRowHash[partner] == m_afterRowHash[row]) [[likely]]
+                    ++out.m_unchanged;
+                else
+                    compareRow(partner, row, out);
+            }
+
+            for (std::uint32_t row = 0; row < before.RowCount(); ++row)
+            {
+                if (!m_beforeMatched[row])
+                    out.m_removed.push_back(row);
+            }
+        }
+
+    private:
+        static constexpr std::uint32_t unmatched = (std::numeric_limits<std::uint32_t>::max)();
+        static constexpr std::uint64_t nullHash = 0x6A09E667F3BCC909ull;
+
+        static constexpr std::uint64_t mix(std::uint64_t x) noexcept
+        {
+            x ^= x >> 30;
+            x *= 0xBF58476D1CE4E5B9ull;
+            x ^= x >> 27;
+            x *= 0x94D049BB133111EBull;
+            x ^= x >> 31;
+            return x;
+        }
+
+        static constexpr std::uint64_t combine(std::uint64_t hash, std::uint64_t value) noexcept
+        {
+            return mix(hash + 0x9E3779B97F4A7C15ull + value);
+        }
+
+        // Properties are matched by name; either table may lack some of them.
+        void alignColumns(ResultTable const& before, ResultTable const& after, SnapshotDiff& out)
+        {
+            m_beforeColumns.clear();
+            m_afterColumns.clear();
+
+            for (std::size_t i = 0; i < after.ColumnCount(); ++i)
+            {
+                auto const& column = after.GetColumn(i);
+                auto match = before.Find(column.Name());
+                out.m_names.push_back(column.Name());
+                m_afterColumns.push_back(&column);
+                m_beforeColumns.push_back(match ? &before.GetColumn(*match) : nullptr);
+            }
+
+            for (std::size_t i = 0; i < before.ColumnCount(); ++i)
+            {
+                auto const& column = before.GetColumn(i);
+                if (after.Find(column.Name()))
+                    continue;
+
+                out.m_names.push_back(column.Name());
+                m_afterColumns.push_back(nullptr);
+                m_beforeColumns.push_back(&column);
+            }
+        }
+
+        void resolveKeys(std::span<const std::wstring> keyProperties, SnapshotDiff const& out)
+        {
+            m_keys.clear();
+
+            auto find = [&](std::wstring_view name) -> std::size_t {
+                for (std::size_t i = 0; i < out.m_names.size(); ++i)
+                {
+                    if (PropertyNamesEqual(out.m_names[i], name) && m_beforeColumns[i] && m_afterColumns[i])
+                        return i;
+                }
+                return unmatched;
+            };
+
+            if (keyProperties.empty())
+            {
+                for (auto name : { std::wstring_view{ L"__PATH" }, std::wstring_view{ L"__RELPATH" } })
+                {
+                    if (auto index = find(name); index != unmatched)
+                    {
+                        m_keys.push_back(index);
+                        return;
+                    }
+                }
+                throw std::invalid_argument("snapshots have no __PATH; name the key properties to match objects on");
+            }
+
+            for (auto const& name : keyProperties)
+            {
+                auto index = find(name);
+                if (index == unmatched) [[unlikely]]
+                    throw std::invalid_argument("key property is missing from one of the snapshots");
+                m_keys.push_back(index);
+            }
+        }
+
+        // Folds the selected columns (all of them when selection is empty) into one hash
+        // per row, a column at a time so each pass walks one contiguous array.
+        static void hashColumns(ResultTable const& table, std::span<Column const* const> columns, std::span<const std::size_t> selection, std::vector<std::uint64_t>& hashes)
+        {
+            hashes.assign(table.RowCount(), 0);
+            if (selection.empty())
+            {
+                for (auto const* column : columns)
+                    hashColumn(column, hashes);
+            }
+            else
+            {
+                for (auto index : selection)
+                    hashColumn(columns[index], hashes);
+            }
+        }
+
+        static void hashColumn(Column const* column, std::span<std::uint64_t> hashes)
+        {
+            if (!column)
+            {
+                for (auto& hash : hashes)
+                    hash = combine(hash, nullHash);
+                return;
+            }
+
+            auto const& nulls = column->Nulls();
+            const auto salt = static_cast<std::uint64_t>(column->Type()) << 56;
+            const auto rows = hashes.size();
+
+            switch (column->Storage())
+            {
+            case StorageKind::Integer:
+            {
+                auto values = column->Integers();
+                for (std::size_t row = 0; row < rows; ++row)
+                    hashes[row] = combine(hashes[row], nulls.IsNull(row) ? nullHash : mix(static_cast<std::uint64_t>(values[row]) ^ salt));
+                break;
+            }
+            case StorageKind::Real:
+            {
+                auto values = column->Reals();
+                for (std::size_t row = 0; row < rows; ++row)
+                {
+                    // +0.0 and -0.0 compare equal, so they must hash alike.
+                    const double value = values[row] == 0.0 ? 0.0 : values[row];
+                    hashes[row] = combine(hashes[row], nulls.IsNull(row) ? nullHash : mix(std::bit_cast<std::uint64_t>(value) ^ salt));
+                }
+                break;
+            }
+            case StorageKind::Boolean:
+            {
+                auto values = column->Booleans();
+                for (std::size_t row = 0; row < rows; ++row)
+                    hashes[row] = combine(hashes[row], nulls.IsNull(row) ? nullHash : mix(values[row] ^ salt));
+                break;
+            }
+            case StorageKind::String:
+            {
+                for (std::size_t row = 0; row < rows; ++row)
+                    hashes[row] = combine(hashes[row], nulls.IsNull(row) ? nullHash : std::hash<std::wstring_view>{}(column->GetString(row)) ^ salt);
+                break;
+            }
+            default:
+                for (auto& hash : hashes)
+                    hash = combine(hash, nullHash);
+                break;
+            }
+        }
+
+        [[nodiscard]] static Value valueAt(Column const* column, std::size_t row) noexcept
+        {
+            return column ? column->GetValue(row) : Value::Null();
+        }
+
+        [[nodiscard]] bool sameKey(std::size_t beforeRow, std::size_t afterRow) const noexcept
+        {
+            for (auto index : m_keys)
+            {
+                if (!(valueAt(m_beforeColumns[index], beforeRow) == valueAt(m_afterColumns[index], afterRow)))
+                    return false;
+            }
+            return true;
+        }
+
+        // Indexes the older snapshot by key hash (linear probing, at most half full) and
+        // pairs every row of the newer one with the first unclaimed row of equal key, so
+        // duplicate keys pair up in order instead of colliding.
+        void match(ResultTable const& before, ResultTable const& after)
+        {
+            const std::size_t beforeRows = before.RowCount();
+            const std::size_t capacity = std::bit_ceil(std::max<std::size_t>(beforeRows * 2, 16));
+            const std::size_t mask = capacity - 1;
+
+            m_slots.assign(capacity, unmatched);
+            for (std::uint32_t row = 0; row < beforeRows; ++row)
+            {
+                auto slot = static_cast<std::size_t>(m_beforeKeyHash[row]) & mask;
+                while (m_slots[slot] != unmatched)
+                    slot = (slot + 1) & mask;
+                m_slots[slot] = row;
+            }
+
+            m_beforeMatched.assign(beforeRows, 0);
+            m_afterMatch.assign(after.RowCount(), unmatched);
+            for (std::uint32_t row = 0; row < after.RowCount(); ++row)
+            {
+                const auto hash = m_afterKeyHash[row];
+                for (auto slot = static_cast<std::size_t>(hash) & mask; m_slots[slot] != unmatched; slot = (slot + 1) & mask)
+                {
+                    const auto candidate = m_slots[slot];
+                    if (m_beforeKeyHash[candidate] == hash && !m_beforeMatched[candidate] && sameKey(candidate, row))
+                    {
+                        m_beforeMatched[candidate] = 1;
+                        m_afterMatch[row] = candidate;
+                        break;
+                    }
+                }
+            }
+        }
+
+        void compareRow(std::uint32_t beforeRow, std::uint32_t afterRow, SnapshotDiff& out) const
+        {
+            RowChange change{ beforeRow, afterRow, static_cast<std::uint32_t>(out.m_properties.size()), 0 };
+            for (std::size_t i = 0; i < m_afterColumns.size(); ++i)
+            {
+                if (!(valueAt(m_beforeColumns[i], beforeRow) == valueAt(m_afterColumns[i], afterRow)))
+                {
+                    out.m_properties.push_back(static_cast<std::uint32_t>(i));
+                    ++change.propertyCount;
+                }
+            }
+
+            // Only a NaN stored with different bit patterns hashes apart yet compares
+            // equal property by property; such a row counts as unchanged.
+            if (change.propertyCount == 0) [[unlikely]]
+                ++out.m_unchanged;
+            else
+                out.m_changed.push_back(change);
+        }
+
+    private:
+        std::vector<Column const*> m_beforeColumns;
+        std::vector<Column const*> m_afterColumns;
+        std::vector<std::size_t> m_keys;
+
+        std::vector<std::uint64_t> m_beforeKeyHash;
+        std::vector<std::uint64_t> m_afterKeyHash;
+        std::vector<std::uint64_t> m_beforeRowHash;
+        std::vector<std::uint64_t> m_afterRowHash;
+
+        std::vector<std::uint32_t> m_slots;
+        std::vector<std::uint8_t> m_beforeMatched;
+        std::vector<std::uint32_t> m_afterMatch;
+    };
+}
@@ -0,0 +1,761 @@
+#pragma once
+
+#include "PropertyType.h"
+#include "ResultTable.h"
+#include "StringPool.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Wmi
+{
+    // Binary counterpart of the ReplayBackend text snapshot, meant to be mapped rather
+    // than parsed. Every number is little-endian and every section starts on an 8-byte
+    // boundary, so a mapped file can be read in place:
+    //
+    //   header     magic, version, file size and the offsets of the three tables below
+    //   blocks     per result and column: a null bitmap (omitted when nothing is null)
+    //              and the values - int64, double, one byte per boolean, or a uint32
+    //              string id per row
+    //   strings    uint64 offsets[count + 1] in UTF-16 units, then the characters; every
+    //              name, namespace, query and string value is stored once, id 0 is ""
+    //   schemas    per distinct class layout: class name and {name, type} per column
+    //   results    per recorded query: namespace, query, schema, row count and the
+    //              location of each column's blocks
+    //
+    // Strings are UTF-16 whatever the writer's wchar_t, so snapshots recorded on
+    // Windows read the same on Linux. A reader accepts any minor version of its major
+    // one; a writer only ever appends fields behind the ones documented here.
+    static_assert(std::endian::native == std::endian::little, "snapshot files are read in place and are little-endian");
+
+    namespace detail
+    {
+        inline constexpr std::array<char, 8> SnapshotMagic{ 'W', 'M', 'I', 'S', 'N', 'A', 'P', 'B' };
+
+        struct SnapshotHeader
+        {
+            std::array<char, 8> magic;
+            std::uint16_t major;
+            std::uint16_t minor;
+            std::uint32_t headerBytes;
+            std::uint64_t fileBytes;
+            std::uint64_t strings;
+            std::uint64_t schemas;
+            std::uint64_t results;
+            std::uint32_t stringCount;
+            std::uint32_t schemaCount;
+            std::uint32_t resultCount;
+            std::uint32_t reserved;
+        };
+
+        struct SchemaRecord
+        {
+            std::uint32_t className;
+            std::uint32_t columnCount;
+            std::uint64_t columns;
+        };
+
+        struct ColumnRecord
+        {
+            std::uint32_t name;
+            PropertyType type;
+            StorageKind storage;
+            std::uint16_t reserved;
+        };
+
+        struct ResultRecord
+        {
+            std::uint32_t ns;
+            std::uint32_t query;
+            std::uint32_t schema;
+            std::uint32_t reserved;
+            std::uint64_t rows;
+            std::uint64_t blocks;
+        };
+
+        struct BlockRecord
+        {
+            std::uint64_t nulls;
+            std::uint64_t data;
+            std::uint64_t bytes;
+        };
+
+        static_assert(sizeof(SnapshotHeader) == 64 && sizeof(SchemaRecord) == 16 && sizeof(ColumnRecord) == 8
+            && sizeof(ResultRecord) == 32 && sizeof(BlockRecord) == 24, "snapshot records are fixed-size");
+
+        [[nodiscard]] constexpr std::size_t SnapshotValueBytes(StorageKind storage) noexcept
+        {
+            switch (storage)
+            {
+            case StorageKind::Integer: return sizeof(std::int64_t);
+            case StorageKind::Real:    return sizeof(double);
+            case StorageKind::Boolean: return sizeof(std::uint8_t);
+            case StorageKind::String:  return sizeof(std::uint32_t);
+            default:                   return 0;
+            }
+        }
+
+        inline void AppendUtf16(std::u16string& out, std::wstring_view value)
+        {
+            if constexpr (sizeof(wchar_t) == sizeof(char16_t))
+            {
+                out.append(reinterpret_cast<const char16_t*>(value.data()), value.size());
+            }
+            else
+            {
+                for (auto c : value)
+                {
+                    const auto code = static_cast<std::uint32_t>(c);
+                    if (code < 0x10000)
+                    {
+                        out.push_back(static_cast<char16_t>(code));
+                        continue;
+                    }
+                    out.push_back(static_cast<char16_t>(0xD800 + ((code - 0x10000) >> 10)));
+                    out.push_back(static_cast<char16_t>(0xDC00 + ((code - 0x10000) & 0x3FF)));
+                }
+            }
+        }
+
+        // A view of value as wchar_t: the same characters where wchar_t is UTF-16,
+        // otherwise decoded into scratch.
+        [[nodiscard]] inline std::wstring_view WidenUtf16(std::u16string_view value, std::wstring& scratch)
+        {
+            if constexpr (sizeof(wchar_t) == sizeof(char16_t))
+            {
+                return { reinterpret_cast<const wchar_t*>(value.data()), value.size() };
+            }
+            else
+            {
+                scratch.clear();
+                for (std::size_t i = 0; i < value.size(); ++i)
+                {
+                    const auto high = static_cast<std::uint32_t>(value[i]);
+                    if (high >= 0xD800 && high < 0xDC00 && i + 1 < value.size())
+                    {
+                        const auto low = static_cast<std::uint32_t>(value[i + 1]);
+                        if (low >= 0xDC00 && low < 0xE000)
+                        {
+                            scratch.push_back(static_cast<wchar_t>(0x10000 + ((high - 0xD800) << 10) + (low - 0xDC00)));
+                            ++i;
+                            continue;
+                        }
+                    }
+                    scratch.push_back(static_cast<wchar_t>(high));
+                }
+                return scratch;
+            }
+        }
+    }
+
+    // Writes result tables to a snapshot file. Column blocks go out as each table is
+    // added; the string, schema and result tables follow on Finish, which then patches
+    // the header, so out must be seekable (an std::ofstream opened in binary mode).
+    // Memory held between Add calls is the distinct strings seen so far. Not thread-safe.
+    class SnapshotWriter
+    {
+    public:
+        static constexpr std::uint16_t Major = 1;
+        static constexpr std::uint16_t Minor = 0;
+
+        explicit SnapshotWriter(std::ostream& out) : m_out(out)
+        {
+            detail::SnapshotHeader header{};
+            write(&header, sizeof(header));
+            (void)intern(L"");
+        }
+
+        SnapshotWriter(const SnapshotWriter&) = delete;
+        SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+        // className labels the schema; tables with the same class and columns share one.
+        void Add(std::wstring_view ns, std::wstring_view query, ResultTable const& table, std::wstring_view className = {})
+        {
+            if (m_finished) [[unlikely]]
+                throw std::logic_error("snapshot already finished");
+
+            detail::ResultRecord result{};
+            result.ns = intern(ns);
+            result.query = intern(query);
+            result.schema = schemaOf(className, table);
+            result.rows = table.RowCount();
+            result.blocks = m_blocks.size();
+
+            for (auto const& column : table.Columns())
+                m_blocks.push_back(writeColumn(column, table.RowCount()));
+
+            m_results.push_back(result);
+        }
+
+        // Writes the tables and the header; the writer takes no more results after this.
+        void Finish()
+        {
+            if (m_finished) [[unlikely]]
+                throw std::logic_error("snapshot already finished");
+            m_finished = true;
+
+            detail::SnapshotHeader header{};
+            header.magic = detail::SnapshotMagic;
+            header.major = Major;
+            header.minor = Minor;
+            header.headerBytes = sizeof(header);
+
+            header.strings = align();
+            std::uint64_t offset = 0;
+            for (auto const* value : m_strings)
+            {
+                write(&offset, sizeof(offset));
+                offset += value->size();
+            }
+            write(&offset, sizeof(offset));
+            for (auto const* value : m_strings)
+                write(value->data(), value->size() * sizeof(char16_t));
+
+            std::vector<detail::SchemaRecord> schemas;
+            for (auto const& schema : m_schemas)
+            {
+                const auto columns = align();
+                write(schema.columns.data(), schema.columns.size() * sizeof(detail::ColumnRecord));
+                schemas.push_back({ schema.className, static_cast<std::uint32_t>(schema.columns.size()), columns });
+            }
+            header.schemas = align();
+            write(schemas.data(), schemas.size() * sizeof(detail::SchemaRecord));
+
+            // Each result's blocks were queued by index; they are written ahead of the
+            // result table and the index becomes their offset.
+            const auto blocks = align();
+            write(m_blocks.data(), m_blocks.size() * sizeof(detail::BlockRecord));
+            for (auto& result : m_results)
+                result.blocks = blocks + result.blocks * sizeof(detail::BlockRecord);
+
+            header.results = align();
+            write(m_results.data(), m_results.size() * sizeof(detail::ResultRecord));
+
+            header.fileBytes = m_position;
+            header.stringCount = static_cast<std::uint32_t>(m_strings.size());
+            header.schemaCount = static_cast<std::uint32_t>(schemas.size());
+            header.resultCount = static_cast<std::uint32_t>(m_results.size());
+
+            m_out.seekp(0);
+            m_out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            m_out.seekp(static_cast<std::streamoff>(m_position));
+            m_out.flush();
+            if (!m_out) [[unlikely]]
+                throw std::runtime_error("snapshot write failed");
+        }
+
+        [[nodiscard]] std::uint64_t BytesWritten() const noexcept { return m_position; }
+
+    private:
+        static constexpr std::size_t IdBatch = 4096;
+
+        struct Schema
+        {
+            std::uint32_t className;
+            std::vector<detail::ColumnRecord> columns;
+        };
+
+        std::uint32_t intern(std::wstring_view value)
+        {
+            m_scratch.clear();
+            detail::AppendUtf16(m_scratch, value);
+
+            auto [it, added] = m_ids.try_emplace(m_scratch, static_cast<std::uint32_t>(m_strings.size()));
+            if (added)
+                m_strings.push_back(&it->first);
+            return it->second;
+        }
+
+        std::uint32_t schemaOf(std::wstring_view className, ResultTable const& table)
+        {
+            Schema schema{ intern(className), {} };
+            for (auto const& column : table.Columns())
+                schema.columns.push_back({ intern(column.Name()), column.Type(), column.Storage(), 0 });
+
+            auto same = [&](Schema const& other) {
+                return other.className == schema.className && other.columns.size() == schema.columns.size()
+                    && std::equal(other.columns.begin(), other.columns.end(), schema.columns.begin(), [](auto const& a, auto const& b) {
+                           return a.name == b.name && a.type == b.type;
+                       });
+            };
+
+            if (auto it = std::find_if(m_schemas.begin(), m_schemas.end(), same); it != m_schemas.end())
+                return static_cast<std::uint32_t>(it - m_schemas.begin());
+
+            m_schemas.push_back(std::move(schema));
+            return static_cast<std::uint32_t>(m_schemas.size() - 1);
+        }
+
+        detail::BlockRecord writeColumn(Column const& column, std::size_t rows)
+        {
+            detail::BlockRecord block{};
+
+            auto words = column.Nulls().Words();
+            if (std::any_of(words.begin(), words.end(), [](std::uint64_t word) { return word != 0; }))
+            {
+                block.nulls = align();
+                write(words.data(), words.size() * sizeof(std::uint64_t));
+            }
+
+            block.data = align();
+            switch (column.Storage())
+            {
+            case StorageKind::Integer:
+                write(column.Integers().data(), rows * sizeof(std::int64_t));
+                break;
+
+            case StorageKind::Real:
+                write(column.Reals().data(), rows * sizeof(double));
+                break;
+
+            case StorageKind::Boolean:
+                write(column.Booleans().data(), rows);
+                break;
+
+            case StorageKind::String:
+            {
+                // Strings go out as ids in fixed batches, so a column never needs a second copy.
+                std::array<std::uint32_t, IdBatch> ids;
+                for (std::size_t row = 0; row < rows; row += IdBatch)
+                {
+                    const auto count = (std::min)(IdBatch, rows - row);
+                    for (std::size_t i = 0; i < count; ++i)
+                        ids[i] = column.IsNull(row + i) ? 0 : intern(column.GetString(row + i));
+                    write(ids.data(), count * sizeof(std::uint32_t));
+                }
+                break;
+            }
+
+            default:
+                break;
+            }
+
+            block.bytes = m_position - block.data;
+            return block;
+        }
+
+        std::uint64_t align()
+        {
+            static constexpr char padding[8]{};
+            write(padding, (8 - m_position % 8) % 8);
+            return m_position;
+        }
+
+        void write(const void* data, std::size_t bytes)
+        {
+            if (bytes == 0)
+                return;
+
+            m_out.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+            if (!m_out) [[unlikely]]
+                throw std::runtime_error("snapshot write failed");
+            m_position += bytes;
+        }
+
+    private:
+        std::ostream& m_out;
+        std::uint64_t m_position = 0;
+        bool m_finished = false;
+
+        std::unordered_map<std::u16string, std::uint32_t> m_ids;
+        std::vector<const std::u16string*> m_strings;
+        std::u16string m_scratch;
+
+        std::vector<Schema> m_schemas;
+        std::vector<detail::BlockRecord> m_blocks;
+        std::vector<detail::ResultRecord> m_results;
+    };
+
+    // Read-only mapping of a whole file. An empty file maps to an empty span.
+    class MappedFile
+    {
+    public:
+        MappedFile() noexcept = default;
+
+        explicit MappedFile(std::filesystem::path const& path)
+        {
+#ifdef _WIN32
+            HANDLE file = ::CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+            if (file == INVALID_HANDLE_VALUE)
+                throw std::runtime_error("cannot open snapshot file");
+
+            LARGE_INTEGER size{};
+            if (!::GetFileSizeEx(file, &size))
+            {
+                ::CloseHandle(file);
+                throw std::runtime_error("cannot open snapshot file");
+            }
+
+            m_size = static_cast<std::size_t>(size.QuadPart);
+            if (m_size > 0)
+            {
+                HANDLE mapping = ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                if (mapping)
+                {
+                    m_data = static_cast<const std::byte*>(::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+                    ::CloseHandle(mapping);
+                }
+            }
+            ::CloseHandle(file);
+#else
+            const int file = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (file < 0)
+                throw std::runtime_error("cannot open snapshot file");
+
+            struct stat info{};
+            if (::fstat(file, &info) != 0)
+            {
+                ::close(file);
+                throw std::runtime_error("cannot open snapshot file");
+            }
+
+            m_size = static_cast<std::size_t>(info.st_size);
+            if (m_size > 0)
+            {
+                void* view = ::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, file, 0);
+                if (view != MAP_FAILED)
+                    m_data = static_cast<const std::byte*>(view);
+            }
+            ::close(file);
+#endif
+            if (m_size > 0 && !m_data)
+                throw std::runtime_error("cannot map snapshot file");
+        }
+
+        MappedFile(MappedFile&& other) noexcept
+            : m_data(std::exchange(other.m_data, nullptr)), m_size(std::exchange(other.m_size, 0))
+        {
+        }
+
+        MappedFile& operator=(MappedFile&& other) noexcept
+        {
+            if (this != &other)
+            {
+                unmap();
+                m_data = std::exchange(other.m_data, nullptr);
+                m_size = std::exchange(other.m_size, 0);
+            }
+            return *this;
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        ~MappedFile() { unmap(); }
+
+        [[nodiscard]] std::span<const std::byte> Bytes() const noexcept { return { m_data, m_size }; }
+
+    private:
+        void unmap() noexcept
+        {
+            if (!m_data)
+                return;
+#ifdef _WIN32
+            ::UnmapViewOfFile(m_data);
+#else
+            ::munmap(const_cast<std::byte*>(m_data), m_size);
+#endif
+            m_data = nullptr;
+        }
+
+    private:
+        const std::byte* m_data = nullptr;
+        std::size_t m_size = 0;
+    };
+
+    class SnapshotReader;
+
+    // One recorded query inside a snapshot. Spans and strings point into the
+    // snapshot's bytes and stay valid while the reader is alive and not moved.
+    class SnapshotResult
+    {
+    public:
+        [[nodiscard]] std::u16string_view Namespace() const noexcept;
+        [[nodiscard]] std::u16string_view Query() const noexcept;
+        [[nodiscard]] std::u16string_view ClassName() const noexcept;
+
+        [[nodiscard]] std::size_t RowCount() const noexcept { return static_cast<std::size_t>(m_entry->rows); }
+        [[nodiscard]] std::size_t ColumnCount() const noexcept { return m_schema->columnCount; }
+
+        [[nodiscard]] std::u16string_view ColumnName(std::size_t column) const noexcept;
+        [[nodiscard]] PropertyType ColumnType(std::size_t column) const noexcept { return m_columns[column].type; }
+        [[nodiscard]] StorageKind ColumnStorage(std::size_t column) const noexcept { return m_columns[column].storage; }
+        [[nodiscard]] std::optional<std::size_t> Find(std::u16string_view name) const noexcept;
+
+        [[nodiscard]] bool IsNull(std::size_t row, std::size_t column) const noexcept
+        {
+            auto nulls = m_blocks[column].nulls;
+            if (nulls == 0)
+                return false;
+
+            std::uint64_t word;
+            std::memcpy(&word, m_base + nulls + (row >> 6) * sizeof(word), sizeof(word));
+            return (word >> (row & 63)) & 1;
+        }
+
+        // The stored values of a column; null rows hold 0 (or string id 0).
+        [[nodiscard]] std::span<const std::int64_t> Integers(std::size_t column) const noexcept { return values<std::int64_t>(column, StorageKind::Integer); }
+        [[nodiscard]] std::span<const double> Reals(std::size_t column) const noexcept { return values<double>(column, StorageKind::Real); }
+        [[nodiscard]] std::span<const std::uint8_t> Booleans(std::size_t column) const noexcept { return values<std::uint8_t>(column, StorageKind::Boolean); }
+        [[nodiscard]] std::span<const std::uint32_t> StringIds(std::size_t column) const noexcept { return values<std::uint32_t>(column, StorageKind::String); }
+
+        [[nodiscard]] std::int64_t GetInt64(std::size_t row, std::size_t column) const noexcept { return Integers(column)[row]; }
+        [[nodiscard]] std::uint64_t GetUInt64(std::size_t row, std::size_t column) const noexcept { return static_cast<std::uint64_t>(Integers(column)[row]); }
+        [[nodiscard]] double GetDouble(std::size_t row, std::size_t column) const noexcept { return Reals(column)[row]; }
+        [[nodiscard]] bool GetBoolean(std::size_t row, std::size_t column) const noexcept { return Booleans(column)[row] != 0; }
+        [[nodiscard]] std::u16string_view GetString(std::size_t row, std::size_t column) const noexcept;
+
+        // Copies the result into a table, for callers that need owned rows (a warm
+        // cache, a ReplayBackend). pool is handed to the table as in ResultTable.
+        [[nodiscard]] std::shared_ptr<ResultTable> ToTable(std::shared_ptr<StringPool> pool = nullptr) const
+        {
+            auto table = std::make_shared<ResultTable>(std::move(pool));
+
+            std::wstring scratch;
+            for (std::size_t c = 0; c < ColumnCount(); ++c)
+                table->AddColumn(detail::WidenUtf16(ColumnName(c), scratch), ColumnType(c));
+            table->Reserve(RowCount());
+
+            for (std::size_t row = 0; row < RowCount(); ++row)
+            {
+                table->BeginRow();
+                for (std::size_t c = 0; c < ColumnCount(); ++c)
+                {
+                    if (IsNull(row, c))
+                    {
+                        table->AppendNull(c);
+                        continue;
+                    }
+
+                    switch (ColumnStorage(c))
+                    {
+                    case StorageKind::Integer: table->AppendInteger(c, GetInt64(row, c)); break;
+                    case StorageKind::Real:    table->AppendReal(c, GetDouble(row, c)); break;
+                    case StorageKind::Boolean: table->AppendBoolean(c, GetBoolean(row, c)); break;
+                    case StorageKind::String:  table->AppendString(c, detail::WidenUtf16(GetString(row, c), scratch)); break;
+                    default:                   table->AppendNull(c); break;
+                    }
+                }
+                table->EndRow();
+            }
+            return table;
+        }
+
+    private:
+        friend class SnapshotReader;
+
+        SnapshotResult(SnapshotReader const& reader, const detail::ResultRecord* entry) noexcept;
+
+        template<typename T>
+        std::span<const T> values(std::size_t column, StorageKind storage) const noexcept
+        {
+            if (m_columns[column].storage != storage)
+                return {};
+            return { reinterpret_cast<const T*>(m_base + m_blocks[column].data), RowCount() };
+        }
+
+    private:
+        SnapshotReader const* m_reader;
+        const std::byte* m_base;
+        const detail::ResultRecord* m_entry;
+        const detail::SchemaRecord* m_schema;
+        const detail::ColumnRecord* m_columns;
+        const detail::BlockRecord* m_blocks;
+    };
+
+    // Serves a snapshot straight from its bytes, normally a mapping of the file. Open
+    // checks the header and that every table and block lies inside the file, which
+    // touches only the metadata, so its cost does not grow with the row count. String
+    // ids and offsets are checked as they are read instead: a damaged one reads as an
+    // empty string rather than outside the file. Throws std::invalid_argument on
+    // anything else that is not a readable snapshot. Thread-safe for reading.
+    class SnapshotReader
+    {
+    public:
+        [[nodiscard]] static SnapshotReader Open(std::filesystem::path const& path)
+        {
+            MappedFile file{ path };
+            auto bytes = file.Bytes();
+            return SnapshotReader{ bytes, std::move(file) };
+        }
+
+        // Reads bytes in place; they must stay alive and 8-byte aligned.
+        explicit SnapshotReader(std::span<const std::byte> bytes) : SnapshotReader(bytes, MappedFile{}) {}
+
+        SnapshotReader(SnapshotReader&&) noexcept = default;
+        SnapshotReader& operator=(SnapshotReader&&) noexcept = default;
+
+        [[nodiscard]] std::uint16_t Major() const noexcept { return m_header->major; }
+        [[nodiscard]] std::uint16_t Minor() const noexcept { return m_header->minor; }
+        [[nodiscard]] std::size_t Size() const noexcept { return m_bytes.size(); }
+
+        [[nodiscard]] std::size_t StringCount() const noexcept { return m_header->stringCount; }
+
+        [[nodiscard]] std::u16string_view String(std::uint32_t id) const noexcept
+        {
+            if (id >= m_header->stringCount) [[unlikely]]
+                return {};
+
+            std::uint64_t range[2];
+            std::memcpy(range, m_base + m_header->strings + id * sizeof(std::uint64_t), sizeof(range));
+            if (range[0] > range[1] || range[1] > m_chars) [[unlikely]]
+                return {};
+
+            return { reinterpret_cast<const char16_t*>(m_base + m_charsOffset) + range[0], static_cast<std::size_t>(range[1] - range[0]) };
+        }
+
+        [[nodiscard]] std::size_t ResultCount() const noexcept { return m_header->resultCount; }
+
+        [[nodiscard]] SnapshotResult Result(std::size_t index) const noexcept
+        {
+            return { *this, reinterpret_cast<const detail::ResultRecord*>(m_base + m_header->results) + index };
+        }
+
+        // Namespaces compare case-insensitively (ASCII), queries exactly, as in ReplayBackend.
+        [[nodiscard]] std::optional<SnapshotResult> Find(std::u16string_view ns, std::u16string_view query) const noexcept
+        {
+            auto upper = [](char16_t c) { return c >= u'a' && c <= u'z' ? static_cast<char16_t>(c - (u'a' - u'A')) : c; };
+            for (std::size_t i = 0; i < ResultCount(); ++i)
+            {
+                auto result = Result(i);
+                auto name = result.Namespace();
+                if (result.Query() == query && name.size() == ns.size()
+                    && std::equal(name.begin(), name.end(), ns.begin(), [&](char16_t a, char16_t b) { return upper(a) == upper(b); }))
+                    return result;
+            }
+            return std::nullopt;
+        }
+
+    private:
+        friend class SnapshotResult;
+
+        SnapshotReader(std::span<const std::byte> bytes, MappedFile file) : m_file(std::move(file)), m_bytes(bytes), m_base(bytes.data())
+        {
+            if (reinterpret_cast<std::uintptr_t>(m_base) % alignof(std::uint64_t) != 0)
+                throw std::invalid_argument("snapshot bytes must be 8-byte aligned");
+            if (m_bytes.size() < sizeof(detail::SnapshotHeader))
+                throw std::invalid_argument("not a WMI snapshot");
+
+            m_header = reinterpret_cast<const detail::SnapshotHeader*>(m_base);
+            if (m_header->magic != detail::SnapshotMagic)
+                throw std::invalid_argument("not a WMI snapshot");
+            if (m_header->major != SnapshotWriter::Major)
+                throw std::invalid_argument("unsupported snapshot version");
+            if (m_header->headerBytes < sizeof(detail::SnapshotHeader) || m_header->fileBytes != m_bytes.size())
+                throw std::invalid_argument("snapshot is truncated");
+
+            const auto stringOffsets = (std::uint64_t{ m_header->stringCount } + 1) * sizeof(std::uint64_t);
+            check(m_header->strings, stringOffsets);
+            m_charsOffset = m_header->strings + stringOffsets;
+            m_chars = (m_bytes.size() - m_charsOffset) / sizeof(char16_t);
+
+            check(m_header->schemas, std::uint64_t{ m_header->schemaCount } * sizeof(detail::SchemaRecord));
+            auto schemas = reinterpret_cast<const detail::SchemaRecord*>(m_base + m_header->schemas);
+            for (std::uint32_t s = 0; s < m_header->schemaCount; ++s)
+            {
+                check(schemas[s].columns, std::uint64_t{ schemas[s].columnCount } * sizeof(detail::ColumnRecord));
+                auto columns = reinterpret_cast<const detail::ColumnRecord*>(m_base + schemas[s].columns);
+                for (std::uint32_t c = 0; c < schemas[s].columnCount; ++c)
+                {
+                    if (columns[c].storage != StorageOf(columns[c].type))
+                        throw std::invalid_argument("snapshot column storage does not match its type");
+                }
+            }
+
+            check(m_header->results, std::uint64_t{ m_header->resultCount } * sizeof(detail::ResultRecord));
+            auto results = reinterpret_cast<const detail::ResultRecord*>(m_base + m_header->results);
+            for (std::uint32_t r = 0; r < m_header->resultCount; ++r)
+            {
+                if (results[r].schema >= m_header->schemaCount)
+                    throw std::invalid_argument("snapshot result refers to a missing schema");
+
+                auto const& schema = schemas[results[r].schema];
+                check(results[r].blocks, std::uint64_t{ schema.columnCount } * sizeof(detail::BlockRecord));
+
+                const auto rows = results[r].rows;
+                if (rows > m_bytes.size())
+                    throw std::invalid_argument("snapshot is truncated");
+
+                auto columns = reinterpret_cast<const detail::ColumnRecord*>(m_base + schema.columns);
+                auto blocks = reinterpret_cast<const detail::BlockRecord*>(m_base + results[r].blocks);
+                for (std::uint32_t c = 0; c < schema.columnCount; ++c)
+                {
+                    if (blocks[c].bytes != rows * detail::SnapshotValueBytes(columns[c].storage))
+                        throw std::invalid_argument("snapshot block does not match its row count");
+                    check(blocks[c].data, blocks[c].bytes);
+                    if (blocks[c].nulls != 0)
+                        check(blocks[c].nulls, (rows + 63) / 64 * sizeof(std::uint64_t));
+                }
+            }
+        }
+
+        // Every table starts 8-byte aligned and ends inside the file.
+        void check(std::uint64_t offset, std::uint64_t bytes) const
+        {
+            if (offset % alignof(std::uint64_t) != 0 || offset < sizeof(detail::SnapshotHeader)
+                || offset > m_bytes.size() || bytes > m_bytes.size() - offset)
+                throw std::invalid_argument("snapshot is truncated");
+        }
+
+    private:
+        MappedFile m_file;
+        std::span<const std::byte> m_bytes;
+        const std::byte* m_base;
+        const detail::SnapshotHeader* m_header = nullptr;
+        std::uint64_t m_charsOffset = 0;
+        std::uint64_t m_chars = 0;
+    };
+
+    inline SnapshotResult::SnapshotResult(SnapshotReader const& reader, const detail::ResultRecord* entry) noexcept
+        : m_reader(&reader), m_base(reader.m_base), m_entry(entry)
+    {
+        m_schema = reinterpret_cast<const detail::SchemaRecord*>(m_base + reader.m_header->schemas) + entry->schema;
+        m_columns = reinterpret_cast<const detail::ColumnRecord*>(m_base + m_schema->columns);
+        m_blocks = reinterpret_cast<const detail::BlockRecord*>(m_base + entry->blocks);
+    }
+
+    inline std::u16string_view SnapshotResult::Namespace() const noexcept { return m_reader->String(m_entry->ns); }
+    inline std::u16string_view SnapshotResult::Query() const noexcept { return m_reader->String(m_entry->query); }
+    inline std::u16string_view SnapshotResult::ClassName() const noexcept { return m_reader->String(m_schema->className); }
+    inline std::u16string_view SnapshotResult::ColumnName(std::size_t column) const noexcept { return m_reader->String(m_columns[column].name); }
+
+    inline std::u16string_view SnapshotResult::GetString(std::size_t row, std::size_t column) const noexcept
+    {
+        auto ids = StringIds(column);
+        return ids.empty() ? std::u16string_view{} : m_reader->String(ids[row]);
+    }
+
+    inline std::optional<std::size_t> SnapshotResult::Find(std::u16string_view name) const noexcept
+    {
+        for (std::size_t c = 0; c < ColumnCount(); ++c)
+        {
+            if (ColumnName(c) == name)
+                return c;
+        }
+        return std::nullopt;
+    }
+}
@@ -0,0 +1,230 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace Wmi
+{
+    struct StringPoolStats
+    {
+        // Strings handed to Intern and answered from the pool, and how many were distinct.
+        std::uint64_t total = 0;
+        std::uint64_t unique = 0;
+
+        // Strings left to the caller: longer than the pool takes, or the pool was full.
+        std::uint64_t refused = 0;
+
+        // Character bytes of every pooled request, and of the distinct strings kept.
+        std::uint64_t bytesRequested = 0;
+        std::uint64_t bytesStored = 0;
+
+        [[nodiscard]] std::uint64_t BytesSaved() const noexcept { return bytesRequested - bytesStored; }
+    };
+
+    // A string kept by a StringPool: one pointer, with the length stored in front of
+    // the characters. Two handles from the same pool are equal exactly when their
+    // strings are. Valid while the pool is alive; a default handle is empty.
+    class InternedString
+    {
+    public:
+        constexpr InternedString() noexcept = default;
+
+        [[nodiscard]] std::wstring_view View() const noexcept
+        {
+            if (!m_chars)
+                return {};
+
+            std::uint32_t length;
+            std::memcpy(&length, reinterpret_cast<const std::byte*>(m_chars) - sizeof(length), sizeof(length));
+            return { m_chars, length };
+        }
+
+        [[nodiscard]] explicit operator bool() const noexcept { return m_chars != nullptr; }
+
+        friend bool operator==(InternedString left, InternedString right) noexcept { return left.m_chars == right.m_chars; }
+
+    private:
+        friend class StringPool;
+        explicit InternedString(const wchar_t* chars) noexcept : m_chars(chars) {}
+
+        const wchar_t* m_chars = nullptr;
+    };
+
+    // Deduplicating store for strings that repeat across a result set or a context:
+    // property names and low-cardinality values such as Status, Manufacturer or
+    // driver paths. Strings are hashed to one of a fixed set of shards, each with its
+    // own lock, set and character blocks, so concurrent producers rarely meet.
+    // Nothing is ever removed; maxBytes bounds the pool, after which new strings are
+    // refused and callers keep their own copy. Thread-safe.
+    class StringPool
+    {
+    public:
+        static constexpr std::size_t DefaultMaxBytes = 64u << 20;
+        static constexpr std::size_t DefaultMaxLength = 1024;
+
+        explicit StringPool(std::size_t maxBytes = DefaultMaxBytes, std::size_t maxLength = DefaultMaxLength)
+            : m_maxBytes(maxBytes), m_maxLength(maxLength)
+        {
+        }
+
+        StringPool(const StringPool&) = delete;
+        StringPool& operator=(const StringPool&) = delete;
+
+        // Returns the pooled copy of value, or an empty handle when value is refused.
+        [[nodiscard]] InternedString Intern(std::wstring_view value)
+        {
+            bool added;
+            return Intern(value, added);
+        }
+
+        // added tells whether value was new to the pool.
+        [[nodiscard]] InternedString Intern(std::wstring_view value, bool& added)
+        {
+            added = false;
+            if (value.size() > m_maxLength) [[unlikely]]
+            {
+                m_refused.fetch_add(1, std::memory_order_relaxed);
+                return {};
+            }
+
+            const auto hash = std::hash<std::wstring_view>{}(value);
+            // The top bits pick the shard, leaving the low ones to the shard's own buckets.
+            auto& shard = m_shards[hash >> (std::numeric_limits<std::size_t>::digits - ShardBits)];
+            const auto bytes = value.size() * sizeof(wchar_t);
+
+            {
+                std::shared_lock lk(shard.mutex);
+                if (auto it = shard.strings.find(value); it != shard.strings.end())
+                    return found(it->data(), bytes);
+            }
+
+            std::lock_guard lk(shard.mutex);
+            if (auto it = shard.strings.find(value); it != shard.strings.end())
+                return found(it->data(), bytes);
+
+            const auto size = entrySize(value.size());
+            if (m_reserved.fetch_add(size, std::memory_order_relaxed) + size > m_maxBytes) [[unlikely]]
+            {
+                m_reserved.fetch_sub(size, std::memory_order_relaxed);
+                m_refused.fetch_add(1, std::memory_order_relaxed);
+                return {};
+            }
+
+            auto* chars = shard.store(value, size);
+            shard.strings.insert(std::wstring_view{ chars, value.size() });
+
+            added = true;
+            m_unique.fetch_add(1, std::memory_order_relaxed);
+            m_bytesStored.fetch_add(bytes, std::memory_order_relaxed);
+            return found(chars, bytes);
+        }
+
+        [[nodiscard]] StringPoolStats Stats() const noexcept
+        {
+            return {
+                m_total.load(std::memory_order_relaxed),
+                m_unique.load(std::memory_order_relaxed),
+                m_refused.load(std::memory_order_relaxed),
+                m_bytesRequested.load(std::memory_order_relaxed),
+                m_bytesStored.load(std::memory_order_relaxed)
+            };
+        }
+
+        // Bytes taken by the strings kept so far, out of MaxBytes.
+        [[nodiscard]] std::size_t ReservedBytes() const noexcept { return m_reserved.load(std::memory_order_relaxed); }
+        [[nodiscard]] std::size_t MaxBytes() const noexcept { return m_maxBytes; }
+
+        // Character blocks plus an estimate of the hash sets' buckets and nodes.
+        [[nodiscard]] std::size_t MemoryUsage() const
+        {
+            std::size_t bytes = sizeof(*this);
+            for (auto& shard : m_shards)
+            {
+                std::shared_lock lk(shard.mutex);
+                for (auto const& block : shard.blocks)
+                    bytes += block.size;
+                bytes += shard.strings.bucket_count() * sizeof(void*) + shard.strings.size() * (sizeof(std::wstring_view) + 2 * sizeof(void*));
+            }
+            return bytes;
+        }
+
+    private:
+        static constexpr std::size_t ShardBits = 4;
+        static constexpr std::size_t ShardCount = std::size_t{ 1 } << ShardBits;
+        static constexpr std::size_t BlockBytes = 64u << 10;
+
+        // Length header, the characters and a terminator, rounded so the next header stays aligned.
+        static std::size_t entrySize(std::size_t length) noexcept
+        {
+            const auto bytes = sizeof(std::uint32_t) + (length + 1) * sizeof(wchar_t);
+            return (bytes + alignof(std::uint32_t) - 1) & ~(alignof(std::uint32_t) - 1);
+        }
+
+        struct Block
+        {
+            std::unique_ptr<std::byte[]> data;
+            std::size_t size;
+        };
+
+        struct Shard
+        {
+            mutable std::shared_mutex mutex;
+            std::unordered_set<std::wstring_view> strings;
+            std::vector<Block> blocks;
+            std::size_t used = BlockBytes;
+
+            // Copies value into the current block, starting a new one when it is full.
+            const wchar_t* store(std::wstring_view value, std::size_t size)
+            {
+                if (used + size > BlockBytes)
+                {
+                    const auto blockSize = (std::max)(size, BlockBytes);
+                    blocks.push_back({ std::make_unique_for_overwrite<std::byte[]>(blockSize), blockSize });
+                    used = 0;
+                }
+
+                auto* entry = blocks.back().data.get() + used;
+                used += size;
+
+                const auto length = static_cast<std::uint32_t>(value.size());
+                std::memcpy(entry, &length, sizeof(length));
+
+                auto* chars = reinterpret_cast<wchar_t*>(entry + sizeof(length));
+                std::memcpy(chars, value.data(), value.size() * sizeof(wchar_t));
+                chars[value.size()] = L'\0';
+                return chars;
+            }
+        };
+
+        InternedString found(const wchar_t* stored, std::size_t bytes) noexcept
+        {
+            m_total.fetch_add(1, std::memory_order_relaxed);
+            m_bytesRequested.fetch_add(bytes, std::memory_order_relaxed);
+            return InternedString{ stored };
+        }
+
+    private:
+        const std::size_t m_maxBytes;
+        const std::size_t m_maxLength;
+        std::array<Shard, ShardCount> m_shards;
+
+        std::atomic<std::size_t> m_reserved{ 0 };
+        std::atomic<std::uint64_t> m_total{ 0 };
+        std::atomic<std::uint64_t> m_unique{ 0 };
+        std::atomic<std::uint64_t> m_refused{ 0 };
+        std::atomic<std::uint64_t> m_bytesRequested{ 0 };
+        std::atomic<std::uint64_t> m_bytesStored{ 0 };
+    };
+}
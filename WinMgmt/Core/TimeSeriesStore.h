@@ -0,0 +1,495 @@
+#pragma once
+
+#include "PropertyType.h"
+#include "ResultTable.h"
+#include "SchemaCache.h"
+#include "WmiValue.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Wmi
+{
+    struct TimeSeriesOptions
+    {
+        // Budget for every series together. Beyond it the oldest sealed chunks, of any
+        // series, are dropped; chunks still being appended to are never dropped.
+        std::size_t maxBytes = 64u << 20;
+
+        // Samples per chunk; a full chunk is sealed and a new one started.
+        std::size_t chunkSamples = 256;
+    };
+
+    struct TimeSeriesStats
+    {
+        std::size_t series = 0;
+
+        // Samples and chunks currently held.
+        std::uint64_t samples = 0;
+        std::uint64_t chunks = 0;
+
+        // Samples refused for being older than their series' latest, and samples
+        // dropped with evicted chunks.
+        std::uint64_t outOfOrder = 0;
+        std::uint64_t evictedSamples = 0;
+
+        // Encoded bytes of the samples held.
+        std::uint64_t encodedBytes = 0;
+
+        // 8 bytes of timestamp and 8 of value per sample, as a plain array would take.
+        [[nodiscard]] std::uint64_t RawBytes() const noexcept { return samples * 16; }
+
+        [[nodiscard]] double CompressionRatio() const noexcept
+        {
+            return encodedBytes > 0 ? static_cast<double>(RawBytes()) / static_cast<double>(encodedBytes) : 0.0;
+        }
+    };
+
+    struct TimeSeriesSample
+    {
+        // Microseconds since the Unix epoch, like CIM DATETIME values.
+        std::int64_t time = 0;
+        Value value;
+    };
+
+    namespace detail
+    {
+        [[nodiscard]] constexpr std::uint64_t ZigZag(std::int64_t value) noexcept
+        {
+            return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+        }
+
+        [[nodiscard]] constexpr std::int64_t UnZigZag(std::uint64_t value) noexcept
+        {
+            return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+        }
+
+        inline void PutVarint(std::vector<std::uint8_t>& out, std::uint64_t value)
+        {
+            while (value >= 0x80)
+            {
+                out.push_back(static_cast<std::uint8_t>(value | 0x80));
+                value >>= 7;
+            }
+            out.push_back(static_cast<std::uint8_t>(value));
+        }
+
+        [[nodiscard]] inline std::uint64_t GetVarint(const std::uint8_t*& p) noexcept
+        {
+            std::uint64_t value = 0;
+            for (int shift = 0;; shift += 7)
+            {
+                const auto byte = *p++;
+                value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+                if (byte < 0x80)
+                    return value;
+            }
+        }
+    }
+
+    // History of polled numeric properties, one series per (object identity, property),
+    // e.g. ("_Total", "PercentProcessorTime") of Win32_PerfRawData_PerfOS_Processor.
+    // Each series is a run of append-only chunks that decode on their own:
+    //
+    //   time     the first as a zigzag varint, then the delta, then deltas of deltas,
+    //            which are 0 (one byte) for a steady poll interval
+    //   integer  the same scheme on the value bits, so an unchanged value or a counter
+    //            rising at a steady rate costs one byte
+    //   real     XOR with the previous value's bits; a tag byte gives the count of
+    //            leading zero bytes and of bytes kept, so an unchanged value is one byte
+    //
+    // Booleans are integers 0 and 1; strings and arrays are not kept. A series takes
+    // the type of its first sample. Thread-safe; scans share a lock that appends take
+    // exclusively.
+    class TimeSeriesStore
+    {
+    public:
+        explicit TimeSeriesStore(TimeSeriesOptions options = {})
+            : m_options(options)
+        {
+            m_options.chunkSamples = (std::max)(m_options.chunkSamples, std::size_t{ 2 });
+        }
+
+        TimeSeriesStore(const TimeSeriesStore&) = delete;
+        TimeSeriesStore& operator=(const TimeSeriesStore&) = delete;
+
+        // False when value is null or not numeric, or when time is earlier than the
+        // series' latest sample.
+        bool Append(std::wstring_view identity, std::wstring_view property, std::int64_t time, Value const& value)
+        {
+            if (!isNumeric(value))
+                return false;
+
+            std::lock_guard lk(m_mutex);
+            makeKey(m_key, identity, property);
+            const bool added = append(series(value.Type()), time, value);
+            evict();
+            return added;
+        }
+
+        // Appends every numeric cell of table at time, each row's series named by its
+        // identityColumn value; rows with a null identity are skipped. Returns the
+        // number of samples added. Throws std::invalid_argument if identityColumn is
+        // missing or not a string column.
+        std::size_t Append(std::int64_t time, ResultTable const& table, std::wstring_view identityColumn)
+        {
+            auto identity = table.Find(identityColumn);
+            if (!identity || table.GetColumn(*identity).Storage() != StorageKind::String)
+                throw std::invalid_argument("identity column must be a string column of the table");
+
+            std::vector<std::size_t> numeric;
+            for (std::size_t c = 0; c < table.ColumnCount(); ++c)
+            {
+                auto storage = table.GetColumn(c).Storage();
+                if (storage == StorageKind::Integer || storage == StorageKind::Real || storage == StorageKind::Boolean)
+                    numeric.push_back(c);
+            }
+
+            std::size_t added = 0;
+            std::lock_guard lk(m_mutex);
+            auto const& identities = table.GetColumn(*identity);
+            for (std::size_t row = 0; row < table.RowCount(); ++row)
+            {
+                if (identities.IsNull(row))
+                    continue;
+
+                for (auto c : numeric)
+                {
+                    auto const& column = table.GetColumn(c);
+                    if (column.IsNull(row))
+                        continue;
+
+                    makeKey(m_key, identities.GetString(row), column.Name());
+                    if (append(series(column.Type()), time, column.GetValue(row)))
+                        ++added;
+                }
+            }
+            evict();
+            return added;
+        }
+
+        // Calls visit(TimeSeriesSample const&) for each sample of the series with
+        // from <= time <= to, oldest first, under the store's shared lock. Returns the
+        // number visited.
+        template<typename Visit>
+        std::size_t Scan(std::wstring_view identity, std::wstring_view property, std::int64_t from, std::int64_t to, Visit&& visit) const
+        {
+            std::wstring key;
+            makeKey(key, identity, property);
+
+            std::shared_lock lk(m_mutex);
+            auto it = m_series.find(key);
+            if (it == m_series.end() || from > to)
+                return 0;
+
+            auto const& series = it->second;
+            auto first = std::partition_point(series.chunks.begin(), series.chunks.end(), [from](Chunk const& chunk) { return chunk.lastTime < from; });
+
+            std::size_t visited = 0;
+            for (auto chunk = first; chunk != series.chunks.end() && chunk->firstTime <= to; ++chunk)
+            {
+                bool more = true;
+                decode(*chunk, series.storage, [&](std::int64_t time, std::uint64_t bits) {
+                    if (time > to)
+                        return more = false;
+                    if (time >= from)
+                    {
+                        visit(TimeSeriesSample{ time, toValue(series.type, series.storage, bits) });
+                        ++visited;
+                    }
+                    return true;
+                });
+                if (!more)
+                    break;
+            }
+            return visited;
+        }
+
+        [[nodiscard]] std::vector<TimeSeriesSample> Range(std::wstring_view identity, std::wstring_view property, std::int64_t from, std::int64_t to) const
+        {
+            std::vector<TimeSeriesSample> samples;
+            Scan(identity, property, from, to, [&](TimeSeriesSample const& sample) { samples.push_back(sample); });
+            return samples;
+        }
+
+        [[nodiscard]] TimeSeriesStats Stats() const
+        {
+            std::shared_lock lk(m_mutex);
+            TimeSeriesStats stats;
+            stats.series = m_series.size();
+            stats.samples = m_samples;
+            stats.chunks = m_chunks;
+            stats.outOfOrder = m_outOfOrder;
+            stats.evictedSamples = m_evictedSamples;
+            stats.encodedBytes = m_encodedBytes;
+            return stats;
+        }
+
+        // What the budget is checked against: chunk buffers and headers, series and keys.
+        [[nodiscard]] std::size_t MemoryUsage() const
+        {
+            std::shared_lock lk(m_mutex);
+            return m_bytes;
+        }
+
+    private:
+        struct Chunk
+        {
+            std::int64_t firstTime = 0;
+            std::int64_t lastTime = 0;
+            std::uint32_t count = 0;
+            std::vector<std::uint8_t> bytes;
+        };
+
+        struct Series
+        {
+            PropertyType type = PropertyType::Unknown;
+            StorageKind storage = StorageKind::None;
+            std::deque<Chunk> chunks;
+
+            // Encoder state of the last chunk.
+            std::int64_t lastTime = 0;
+            std::int64_t timeDelta = 0;
+            std::uint64_t lastBits = 0;
+            std::uint64_t valueDelta = 0;
+        };
+
+        // Chunk header plus an allowance for the deque's bookkeeping.
+        static constexpr std::size_t ChunkOverhead = sizeof(Chunk) + sizeof(void*);
+        static constexpr std::size_t SeriesOverhead = sizeof(Series) + sizeof(std::wstring) + 4 * sizeof(void*);
+
+        static bool isNumeric(Value const& value) noexcept
+        {
+            auto storage = value.Storage();
+            return !value.IsNull() && (storage == StorageKind::Integer || storage == StorageKind::Real || storage == StorageKind::Boolean);
+        }
+
+        static void makeKey(std::wstring& key, std::wstring_view identity, std::wstring_view property)
+        {
+            key.assign(identity);
+            key.push_back(L'\n');
+            key.append(property);
+        }
+
+        // The series named by m_key, created with type if new.
+        Series& series(PropertyType type)
+        {
+            auto it = m_series.find(m_key);
+            if (it != m_series.end())
+                return it->second;
+
+            auto& created = m_series.emplace(m_key, Series{}).first->second;
+            created.type = type;
+            created.storage = StorageOf(type) == StorageKind::Real ? StorageKind::Real : StorageKind::Integer;
+            m_bytes += SeriesOverhead + m_key.capacity() * sizeof(wchar_t);
+            return created;
+        }
+
+        static std::uint64_t toBits(StorageKind storage, Value const& value) noexcept
+        {
+            if (storage == StorageKind::Real)
+                return std::bit_cast<std::uint64_t>(value.AsDouble());
+            return static_cast<std::uint64_t>(value.AsInt64());
+        }
+
+        static Value toValue(PropertyType type, StorageKind storage, std::uint64_t bits) noexcept
+        {
+            if (storage == StorageKind::Real)
+                return Value::FromDouble(std::bit_cast<double>(bits), type);
+            if (type == PropertyType::Boolean)
+                return Value::FromBoolean(bits != 0);
+            return Value::FromInt64(static_cast<std::int64_t>(bits), type);
+        }
+
+        bool append(Series& series, std::int64_t time, Value const& value)
+        {
+            if (!series.chunks.empty() && time < series.lastTime)
+            {
+                ++m_outOfOrder;
+                return false;
+            }
+
+            const auto bits = toBits(series.storage, value);
+            if (series.chunks.empty() || series.chunks.back().count >= m_options.chunkSamples)
+                seal(series);
+
+            auto& chunk = series.chunks.back();
+            const auto before = chunk.bytes.size();
+            const auto capacity = chunk.bytes.capacity();
+
+            if (chunk.count == 0)
+            {
+                chunk.firstTime = time;
+                detail::PutVarint(chunk.bytes, detail::ZigZag(time));
+                if (series.storage == StorageKind::Real)
+                    putReal(chunk.bytes, bits);
+                else
+                    detail::PutVarint(chunk.bytes, detail::ZigZag(static_cast<std::int64_t>(bits)));
+                series.timeDelta = 0;
+                series.valueDelta = 0;
+            }
+            else
+            {
+                const auto timeDelta = time - series.lastTime;
+                detail::PutVarint(chunk.bytes, detail::ZigZag(timeDelta - series.timeDelta));
+                series.timeDelta = timeDelta;
+
+                if (series.storage == StorageKind::Real)
+                {
+                    putReal(chunk.bytes, bits ^ series.lastBits);
+                }
+                else
+                {
+                    // Wrapping arithmetic keeps UInt64 counters exact.
+                    const auto valueDelta = bits - series.lastBits;
+                    detail::PutVarint(chunk.bytes, detail::ZigZag(static_cast<std::int64_t>(valueDelta - series.valueDelta)));
+                    series.valueDelta = valueDelta;
+                }
+            }
+
+            chunk.lastTime = time;
+            ++chunk.count;
+            series.lastTime = time;
+            series.lastBits = bits;
+
+            ++m_samples;
+            m_encodedBytes += chunk.bytes.size() - before;
+            m_bytes += chunk.bytes.capacity() - capacity;
+            return true;
+        }
+
+        // Tag: leading zero bytes in the high nibble, bytes kept in the low one; the
+        // kept bytes follow, most significant first. Zero is the tag alone.
+        static void putReal(std::vector<std::uint8_t>& out, std::uint64_t bits)
+        {
+            if (bits == 0)
+            {
+                out.push_back(0);
+                return;
+            }
+
+            const int leading = std::countl_zero(bits) / 8;
+            const int trailing = std::countr_zero(bits) / 8;
+            const int kept = 8 - leading - trailing;
+            out.push_back(static_cast<std::uint8_t>(leading << 4 | kept));
+            for (int i = 0; i < kept; ++i)
+                out.push_back(static_cast<std::uint8_t>(bits >> (8 * (7 - leading - i))));
+        }
+
+        static std::uint64_t getReal(const std::uint8_t*& p) noexcept
+        {
+            const auto tag = *p++;
+            const int leading = tag >> 4;
+            const int kept = tag & 0xF;
+
+            std::uint64_t bits = 0;
+            for (int i = 0; i < kept; ++i)
+                bits |= std::uint64_t{ *p++ } << (8 * (7 - leading - i));
+            return bits;
+        }
+
+        // Calls emit(time, bits) for each sample of chunk until it returns false.
+        template<typename Emit>
+        static void decode(Chunk const& chunk, StorageKind storage, Emit&& emit)
+        {
+            const std::uint8_t* p = chunk.bytes.data();
+            std::int64_t time = 0;
+            std::int64_t timeDelta = 0;
+            std::uint64_t bits = 0;
+            std::uint64_t valueDelta = 0;
+
+            for (std::uint32_t i = 0; i < chunk.count; ++i)
+            {
+                if (i == 0)
+                {
+                    time = detail::UnZigZag(detail::GetVarint(p));
+                    bits = storage == StorageKind::Real ? getReal(p) : static_cast<std::uint64_t>(detail::UnZigZag(detail::GetVarint(p)));
+                }
+                else
+                {
+                    timeDelta += detail::UnZigZag(detail::GetVarint(p));
+                    time += timeDelta;
+
+                    if (storage == StorageKind::Real)
+                    {
+                        bits ^= getReal(p);
+                    }
+                    else
+                    {
+                        valueDelta += static_cast<std::uint64_t>(detail::UnZigZag(detail::GetVarint(p)));
+                        bits += valueDelta;
+                    }
+                }
+
+                if (!emit(time, bits))
+                    return;
+            }
+        }
+
+        // Trims the full last chunk (if any), queues it for eviction and starts a new one.
+        void seal(Series& series)
+        {
+            if (!series.chunks.empty())
+            {
+                auto& last = series.chunks.back();
+                const auto capacity = last.bytes.capacity();
+                last.bytes.shrink_to_fit();
+                m_bytes -= capacity - last.bytes.capacity();
+                m_sealed.push_back(&series);
+            }
+
+            series.chunks.emplace_back();
+            ++m_chunks;
+            m_bytes += ChunkOverhead;
+        }
+
+        // Drops the oldest sealed chunks until the store is back within budget.
+        void evict()
+        {
+            while (m_bytes > m_options.maxBytes && !m_sealed.empty())
+            {
+                auto* series = m_sealed.front();
+                m_sealed.pop_front();
+
+                auto& oldest = series->chunks.front();
+                m_bytes -= ChunkOverhead + oldest.bytes.capacity();
+                m_encodedBytes -= oldest.bytes.size();
+                m_samples -= oldest.count;
+                m_evictedSamples += oldest.count;
+                --m_chunks;
+                series->chunks.pop_front();
+            }
+        }
+
+    private:
+        TimeSeriesOptions m_options;
+
+        mutable std::shared_mutex m_mutex;
+        std::unordered_map<std::wstring, Series, TransparentStringHash, TransparentStringEqual> m_series;
+
+        // Sealed chunks oldest first, by series; each series seals its chunks in order,
+        // so the series' front chunk is the one meant.
+        std::deque<Series*> m_sealed;
+        std::wstring m_key;
+
+        std::size_t m_bytes = 0;
+        std::uint64_t m_samples = 0;
+        std::uint64_t m_chunks = 0;
+        std::uint64_t m_outOfOrder = 0;
+        std::uint64_t m_evictedSamples = 0;
+        std::uint64_t m_encodedBytes = 0;
+    };
+}
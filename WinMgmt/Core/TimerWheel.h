@@ -0,0 +1,109 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Wmi
+{
+    // Hashed timer wheel: time is cut into ticks of `resolution`, and a timer lives in
+    // the slot of its tick modulo the slot count. Scheduling is O(1) and advancing
+    // only visits the slots of the ticks that passed, so thousands of timers cost
+    // nothing while they are not due. Timers fire at the first tick at or after their
+    // deadline, i.e. up to one resolution late, never early.
+    //
+    // Timers cannot be cancelled; callers ignore the ids they no longer know when
+    // those fire. Not thread-safe.
+    class TimerWheel
+    {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        TimerWheel(clock::duration resolution, std::size_t slots, clock::time_point origin)
+            : m_resolution((std::max)(resolution, clock::duration{ 1 })), m_slots(std::max<std::size_t>(slots, 1)), m_origin(origin)
+        {
+        }
+
+        void Schedule(std::uint64_t id, clock::time_point due)
+        {
+            const auto tick = (std::max)(tickOf(due), m_current + 1);
+            m_slots[tick % m_slots.size()].push_back({ id, tick });
+            ++m_size;
+        }
+
+        // Fires every timer due by now as fire(id), in deadline order.
+        // fire may Schedule new timers (they land after now) but not Advance.
+        template<typename Fire>
+        void Advance(clock::time_point now, Fire&& fire)
+        {
+            if (now < m_origin)
+                return;
+
+            const auto target = static_cast<std::uint64_t>((now - m_origin) / m_resolution);
+            if (target <= m_current)
+                return;
+
+            // After a jump of a whole revolution or more, every slot is due once.
+            const auto ticks = target - m_current;
+            const auto visits = std::min<std::uint64_t>(ticks, m_slots.size());
+
+            m_due.clear();
+            for (std::uint64_t i = 1; i <= visits; ++i)
+                collect(m_slots[(m_current + i) % m_slots.size()], target);
+            m_current = target;
+
+            std::sort(m_due.begin(), m_due.end(), [](Timer const& left, Timer const& right) {
+                return left.tick != right.tick ? left.tick < right.tick : left.id < right.id;
+            });
+
+            for (auto const& timer : m_due)
+                fire(timer.id);
+        }
+
+        [[nodiscard]] std::size_t Size() const noexcept { return m_size; }
+        [[nodiscard]] clock::duration Resolution() const noexcept { return m_resolution; }
+
+    private:
+        struct Timer
+        {
+            std::uint64_t id;
+            std::uint64_t tick;
+        };
+
+        // Rounds up, so a deadline between two ticks fires on the later one.
+        [[nodiscard]] std::uint64_t tickOf(clock::time_point due) const noexcept
+        {
+            if (due <= m_origin)
+                return 0;
+            return static_cast<std::uint64_t>((due - m_origin + m_resolution - clock::duration{ 1 }) / m_resolution);
+        }
+
+        void collect(std::vector<Timer>& slot, std::uint64_t target)
+        {
+            for (std::size_t i = 0; i < slot.size();)
+            {
+                if (slot[i].tick <= target)
+                {
+                    m_due.push_back(slot[i]);
+                    slot[i] = slot.back();
+                    slot.pop_back();
+                    --m_size;
+                }
+                else
+                {
+                    ++i;
+                }
+            }
+        }
+
+    private:
+        clock::duration m_resolution;
+        std::vector<std::vector<Timer>> m_slots;
+        clock::time_point m_origin;
+        std::uint64_t m_current = 0;
+        std::size_t m_size = 0;
+        std::vector<Timer> m_due;
+    };
+}
@@ -0,0 +1,250 @@
+#pragma once
+
+#include "CimDateTime.h"
+#include "PropertyType.h"
+#include "WmiValue.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cwchar>
+#include <string_view>
+
+namespace Wmi
+{
+    // VARTYPE values from wtypes.h, so the conversion can be compiled and tested
+    // against VARIANT look-alikes off Windows.
+    namespace VarType
+    {
+        constexpr std::uint16_t Empty = 0;
+        constexpr std::uint16_t Null = 1;
+        constexpr std::uint16_t I2 = 2;
+        constexpr std::uint16_t I4 = 3;
+        constexpr std::uint16_t R4 = 4;
+        constexpr std::uint16_t R8 = 5;
+        constexpr std::uint16_t BStr = 8;
+        constexpr std::uint16_t Bool = 11;
+        constexpr std::uint16_t I1 = 16;
+        constexpr std::uint16_t UI1 = 17;
+        constexpr std::uint16_t UI2 = 18;
+        constexpr std::uint16_t UI4 = 19;
+        constexpr std::uint16_t I8 = 20;
+        constexpr std::uint16_t UI8 = 21;
+        constexpr std::uint16_t Int = 22;
+        constexpr std::uint16_t UInt = 23;
+        constexpr std::uint16_t Array = 0x2000;
+    }
+
+    struct NullTerminatedLength
+    {
+        std::size_t operator()(const wchar_t* value) const noexcept
+        {
+            return value ? std::wcslen(value) : 0;
+        }
+    };
+
+    // Parses an optionally signed decimal integer; CIM sint64/uint64 values arrive as strings.
+    [[nodiscard]] constexpr bool ParseInteger(std::wstring_view text, std::uint64_t& magnitude, bool& negative) noexcept
+    {
+        std::size_t i = 0;
+        negative = false;
+        if (i < text.size() && (text[i] == L'-' || text[i] == L'+'))
+            negative = text[i++] == L'-';
+
+        if (i == text.size())
+            return false;
+
+        std::uint64_t value = 0;
+        for (; i < text.size(); ++i)
+        {
+            auto digit = static_cast<std::uint64_t>(text[i] - L'0');
+            if (digit > 9 || value > (UINT64_MAX - digit) / 10)
+                return false;
+            value = value * 10 + digit;
+        }
+
+        magnitude = value;
+        return true;
+    }
+
+    namespace detail
+    {
+        [[nodiscard]] constexpr PropertyType Prefer(PropertyType declared, PropertyType observed) noexcept
+        {
+            return StorageOf(declared) == StorageOf(observed) ? declared : observed;
+        }
+
+        [[nodiscard]] constexpr bool IsUnsigned(PropertyType type) noexcept
+        {
+            return type == PropertyType::UInt8 || type == PropertyType::UInt16 || type == PropertyType::UInt32 || type == PropertyType::UInt64;
+        }
+
+        // WMI hands out uint32 properties as VT_I4 and so on; re-read the bits as unsigned
+        // when the declared type says so.
+        [[nodiscard]] constexpr Value Integer(std::int64_t value, unsigned bits, PropertyType declared, PropertyType observed) noexcept
+        {
+            auto type = Prefer(declared, observed);
+            if (IsUnsigned(type) && bits < 64)
+                return Value::FromUInt64(static_cast<std::uint64_t>(value) & ((std::uint64_t{ 1 } << bits) - 1), type);
+            return Value::FromInt64(value, type);
+        }
+    }
+
+    [[nodiscard]] constexpr std::size_t ElementSize(std::uint16_t varType) noexcept
+    {
+        switch (varType)
+        {
+        case VarType::I1:
+        case VarType::UI1:
+            return 1;
+        case VarType::I2:
+        case VarType::UI2:
+        case VarType::Bool:
+            return 2;
+        case VarType::I4:
+        case VarType::UI4:
+        case VarType::R4:
+        case VarType::Int:
+        case VarType::UInt:
+            return 4;
+        case VarType::I8:
+        case VarType::UI8:
+        case VarType::R8:
+            return 8;
+        case VarType::BStr:
+            return sizeof(const wchar_t*);
+        default:
+            return 0;
+        }
+    }
+
+    // Element type implied by a VARTYPE, used when an array's declared type is unknown.
+    [[nodiscard]] constexpr PropertyType PropertyTypeFromVarType(std::uint16_t varType) noexcept
+    {
+        switch (varType)
+        {
+        case VarType::I1:   return PropertyType::Int8;
+        case VarType::I2:   return PropertyType::Int16;
+        case VarType::I4:
+        case VarType::Int:  return PropertyType::Int32;
+        case VarType::I8:   return PropertyType::Int64;
+        case VarType::UI1:  return PropertyType::UInt8;
+        case VarType::UI2:  return PropertyType::UInt16;
+        case VarType::UI4:
+        case VarType::UInt: return PropertyType::UInt32;
+        case VarType::UI8:  return PropertyType::UInt64;
+        case VarType::R4:   return PropertyType::Float;
+        case VarType::R8:   return PropertyType::Double;
+        case VarType::Bool: return PropertyType::Boolean;
+        case VarType::BStr: return PropertyType::String;
+        default:            return PropertyType::Unknown;
+        }
+    }
+
+    [[nodiscard]] constexpr PropertyType ElementTypeOf(ArrayView const& array) noexcept
+    {
+        return array.ElementType() != PropertyType::Unknown ? array.ElementType() : PropertyTypeFromVarType(array.VarType());
+    }
+
+    // Converts a BSTR according to its declared type: CIM 64-bit integers and
+    // DATETIMEs are parsed, everything else stays a view over the text.
+    [[nodiscard]] constexpr Value ConvertText(std::wstring_view text, PropertyType declared) noexcept
+    {
+        if (declared == PropertyType::DateTime)
+        {
+            if (auto parsed = ParseCimDateTime(text))
+                return Value::FromInt64(parsed->microseconds, PropertyType::DateTime);
+
+            // Intervals and wildcard timestamps have no single point in time.
+            return Value::FromString(text);
+        }
+
+        if (StorageOf(declared) == StorageKind::Integer)
+        {
+            std::uint64_t magnitude = 0;
+            bool negative = false;
+            if (!ParseInteger(text, magnitude, negative))
+                return Value::Null();
+
+            return negative ? Value::FromInt64(-static_cast<std::int64_t>(magnitude), declared) : Value::FromUInt64(magnitude, declared);
+        }
+
+        return Value::FromString(text, detail::Prefer(declared, PropertyType::String));
+    }
+
+    // Converts element i of an array without touching the others.
+    template<typename Length = NullTerminatedLength>
+    [[nodiscard]] Value ArrayElement(ArrayView const& array, std::size_t i, Length length = {}) noexcept
+    {
+        auto declared = array.ElementType();
+        switch (array.VarType())
+        {
+        case VarType::I1:   return detail::Integer(array.As<std::int8_t>()[i], 8, declared, PropertyType::Int8);
+        case VarType::I2:   return detail::Integer(array.As<std::int16_t>()[i], 16, declared, PropertyType::Int16);
+        case VarType::I4:
+        case VarType::Int:  return detail::Integer(array.As<std::int32_t>()[i], 32, declared, PropertyType::Int32);
+        case VarType::I8:   return detail::Integer(array.As<std::int64_t>()[i], 64, declared, PropertyType::Int64);
+        case VarType::UI1:  return detail::Integer(array.As<std::uint8_t>()[i], 8, declared, PropertyType::UInt8);
+        case VarType::UI2:  return detail::Integer(array.As<std::uint16_t>()[i], 16, declared, PropertyType::UInt16);
+        case VarType::UI4:
+        case VarType::UInt: return detail::Integer(array.As<std::uint32_t>()[i], 32, declared, PropertyType::UInt32);
+        case VarType::UI8:  return Value::FromUInt64(array.As<std::uint64_t>()[i], detail::Prefer(declared, PropertyType::UInt64));
+        case VarType::R4:   return Value::FromDouble(array.As<float>()[i], detail::Prefer(declared, PropertyType::Float));
+        case VarType::R8:   return Value::FromDouble(array.As<double>()[i], detail::Prefer(declared, PropertyType::Double));
+        case VarType::Bool: return Value::FromBoolean(array.As<std::int16_t>()[i] != 0);
+
+        case VarType::BStr:
+        {
+            auto item = array.As<const wchar_t*>()[i];
+            return ConvertText({ item, length(item) }, declared);
+        }
+
+        default:
+            return Value::Unknown();
+        }
+    }
+
+    // Converts a VARIANT (or anything with the same member names) into a Value without
+    // allocating. String results point into the VARIANT's BSTR.
+    // Arrays become an ArrayView over the SAFEARRAY data; declaredElement carries the
+    // element's CIM type so ArrayElement can apply the same rules as for scalars.
+    template<typename Variant, typename Length = NullTerminatedLength>
+    [[nodiscard]] Value ConvertVariant(Variant const& var, PropertyType declared = PropertyType::Unknown, Length length = {}, PropertyType declaredElement = PropertyType::Unknown) noexcept
+    {
+        if (var.vt & VarType::Array)
+        {
+            auto elementVarType = static_cast<std::uint16_t>(var.vt & ~VarType::Array);
+            if (!var.parray || var.parray->cDims != 1 || ElementSize(elementVarType) == 0)
+                return Value::Unknown();
+
+            return Value::FromArray({ var.parray->pvData, static_cast<std::uint32_t>(var.parray->rgsabound[0].cElements), elementVarType, declaredElement });
+        }
+
+        switch (var.vt)
+        {
+        case VarType::I1:   return detail::Integer(static_cast<std::int8_t>(var.cVal), 8, declared, PropertyType::Int8);
+        case VarType::I2:   return detail::Integer(var.iVal, 16, declared, PropertyType::Int16);
+        case VarType::I4:
+        case VarType::Int:  return detail::Integer(var.lVal, 32, declared, PropertyType::Int32);
+        case VarType::I8:   return detail::Integer(var.llVal, 64, declared, PropertyType::Int64);
+        case VarType::UI1:  return detail::Integer(var.bVal, 8, declared, PropertyType::UInt8);
+        case VarType::UI2:  return detail::Integer(var.uiVal, 16, declared, PropertyType::UInt16);
+        case VarType::UI4:
+        case VarType::UInt: return detail::Integer(var.ulVal, 32, declared, PropertyType::UInt32);
+        case VarType::UI8:  return Value::FromUInt64(var.ullVal, detail::Prefer(declared, PropertyType::UInt64));
+
+        case VarType::R4:   return Value::FromDouble(var.fltVal, detail::Prefer(declared, PropertyType::Float));
+        case VarType::R8:   return Value::FromDouble(var.dblVal, detail::Prefer(declared, PropertyType::Double));
+
+        case VarType::Bool: return Value::FromBoolean(var.boolVal != 0);
+
+        case VarType::BStr: return ConvertText({ var.bstrVal, length(var.bstrVal) }, declared);
+
+        case VarType::Empty:
+        case VarType::Null:
+            return Value::Null();
+
+        default:
+            return Value::Unknown();
+        }
+    }
+}
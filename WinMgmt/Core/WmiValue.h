@@ -0,0 +1,192 @@
+#pragma once
+
+#include "PropertyType.h"
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+namespace Wmi
+{
+    // Non-owning view over the elements of a one-dimensional array (typically a
+    // SAFEARRAY's data block). varType is the VARTYPE of the stored elements,
+    // elementType the declared CIM type they represent.
+    class ArrayView
+    {
+    public:
+        constexpr ArrayView() noexcept = default;
+        constexpr ArrayView(const void* data, std::uint32_t count, std::uint16_t varType, PropertyType elementType) noexcept
+            : m_data(data), m_count(count), m_varType(varType), m_elementType(elementType)
+        {
+        }
+
+        [[nodiscard]] constexpr const void* Data() const noexcept { return m_data; }
+        [[nodiscard]] constexpr std::uint32_t Size() const noexcept { return m_count; }
+        [[nodiscard]] constexpr bool Empty() const noexcept { return m_count == 0; }
+        [[nodiscard]] constexpr std::uint16_t VarType() const noexcept { return m_varType; }
+        [[nodiscard]] constexpr PropertyType ElementType() const noexcept { return m_elementType; }
+
+        // Typed span over the raw elements; the caller picks T to match VarType().
+        template<typename T>
+        [[nodiscard]] std::span<const T> As() const noexcept
+        {
+            return { static_cast<const T*>(m_data), m_count };
+        }
+
+    private:
+        const void* m_data = nullptr;
+        std::uint32_t m_count = 0;
+        std::uint16_t m_varType = 0;
+        PropertyType m_elementType = PropertyType::Unknown;
+    };
+
+    // Compact, trivially copyable property value. Numeric values are stored inline;
+    // strings are a non-owning view, so whoever produced the value (a VARIANT, a
+    // result table, a snapshot) must outlive it.
+    class Value
+    {
+    public:
+        constexpr Value() noexcept = default;
+
+        [[nodiscard]] static constexpr Value Null() noexcept { return Value{ PropertyType::Null }; }
+        [[nodiscard]] static constexpr Value Unknown() noexcept { return Value{ PropertyType::Unknown }; }
+
+        [[nodiscard]] static constexpr Value FromInt64(std::int64_t value, PropertyType type = PropertyType::Int64) noexcept
+        {
+            Value v{ type };
+            v.m_int = value;
+            return v;
+        }
+
+        [[nodiscard]] static constexpr Value FromUInt64(std::uint64_t value, PropertyType type = PropertyType::UInt64) noexcept
+        {
+            Value v{ type };
+            v.m_int = static_cast<std::int64_t>(value);
+            return v;
+        }
+
+        [[nodiscard]] static constexpr Value FromDouble(double value, PropertyType type = PropertyType::Double) noexcept
+        {
+            Value v{ type };
+            v.m_real = value;
+            return v;
+        }
+
+        [[nodiscard]] static constexpr Value FromBoolean(bool value) noexcept
+        {
+            Value v{ PropertyType::Boolean };
+            v.m_bool = value;
+            return v;
+        }
+
+        [[nodiscard]] static constexpr Value FromString(std::wstring_view value, PropertyType type = PropertyType::String) noexcept
+        {
+            Value v{ type };
+            v.m_chars = value.data();
+            v.m_length = static_cast<std::uint32_t>(value.size());
+            return v;
+        }
+
+        [[nodiscard]] static constexpr Value FromArray(ArrayView const& value) noexcept
+        {
+            Value v{ PropertyType::Array };
+            v.m_array = value.Data();
+            v.m_length = value.Size();
+            v.m_elementVarType = value.VarType();
+            v.m_elementType = value.ElementType();
+            return v;
+        }
+
+        [[nodiscard]] constexpr PropertyType Type() const noexcept { return m_type; }
+        [[nodiscard]] constexpr PropertyType ElementType() const noexcept { return m_elementType; }
+        [[nodiscard]] constexpr StorageKind Storage() const noexcept { return StorageOf(m_type); }
+        [[nodiscard]] constexpr bool IsNull() const noexcept { return m_type == PropertyType::Null || m_type == PropertyType::Unknown; }
+
+        // Accessors convert between numeric storage kinds; they return 0/false/empty for
+        // anything that is not numeric or, for AsString, not a string.
+        [[nodiscard]] constexpr std::int64_t AsInt64() const noexcept
+        {
+            switch (Storage())
+            {
+            case StorageKind::Integer: return m_int;
+            case StorageKind::Real:    return static_cast<std::int64_t>(m_real);
+            case StorageKind::Boolean: return m_bool ? 1 : 0;
+            default:                   return 0;
+            }
+        }
+
+        [[nodiscard]] constexpr std::uint64_t AsUInt64() const noexcept
+        {
+            return static_cast<std::uint64_t>(AsInt64());
+        }
+
+        [[nodiscard]] constexpr double AsDouble() const noexcept
+        {
+            switch (Storage())
+            {
+            case StorageKind::Integer: return m_type == PropertyType::UInt64 ? static_cast<double>(static_cast<std::uint64_t>(m_int)) : static_cast<double>(m_int);
+            case StorageKind::Real:    return m_real;
+            case StorageKind::Boolean: return m_bool ? 1.0 : 0.0;
+            default:                   return 0.0;
+            }
+        }
+
+        [[nodiscard]] constexpr bool AsBoolean() const noexcept
+        {
+            switch (Storage())
+            {
+            case StorageKind::Boolean: return m_bool;
+            case StorageKind::Integer: return m_int != 0;
+            case StorageKind::Real:    return m_real != 0.0;
+            default:                   return false;
+            }
+        }
+
+        [[nodiscard]] constexpr std::wstring_view AsString() const noexcept
+        {
+            return Storage() == StorageKind::String ? std::wstring_view{ m_chars, m_length } : std::wstring_view{};
+        }
+
+        [[nodiscard]] constexpr ArrayView AsArray() const noexcept
+        {
+            return m_type == PropertyType::Array ? ArrayView{ m_array, m_length, m_elementVarType, m_elementType } : ArrayView{};
+        }
+
+        friend constexpr bool operator==(Value const& left, Value const& right) noexcept
+        {
+            if (left.m_type != right.m_type)
+                return false;
+
+            switch (left.Storage())
+            {
+            case StorageKind::Integer: return left.m_int == right.m_int;
+            case StorageKind::Real:    return left.m_real == right.m_real;
+            case StorageKind::Boolean: return left.m_bool == right.m_bool;
+            case StorageKind::String:  return left.AsString() == right.AsString();
+            case StorageKind::Array:   return left.m_array == right.m_array && left.m_length == right.m_length;
+            default:                   return true;
+            }
+        }
+
+    private:
+        constexpr explicit Value(PropertyType type) noexcept : m_type(type) {}
+
+    private:
+        union
+        {
+            std::int64_t m_int = 0;
+            double m_real;
+            bool m_bool;
+            const wchar_t* m_chars;
+            const void* m_array;
+        };
+        std::uint32_t m_length = 0;
+        PropertyType m_type = PropertyType::Null;
+        PropertyType m_elementType = PropertyType::Unknown;
+        std::uint16_t m_elementVarType = 0;
+    };
+
+    static_assert(std::is_trivially_copyable_v<Value>);
+    static_assert(sizeof(Value) <= 16);
+}
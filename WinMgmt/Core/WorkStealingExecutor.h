@@ -0,0 +1,171 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Wmi
+{
+    struct WorkStealingStats
+    {
+        std::uint64_t executed = 0;
+        std::uint64_t stolen = 0;
+    };
+
+    // Fixed pool of worker threads, each with its own task deque. A task submitted
+    // from a worker goes to that worker's deque and is taken back newest first, so
+    // follow-up work stays on the thread that produced it; submissions from outside
+    // are spread round-robin. An idle worker steals the oldest task of another.
+    // The deques are mutex-guarded: tasks here are whole queries, so contention on
+    // them is negligible next to the work.
+    //
+    // Destruction runs every queued task, then joins the workers. A task that throws
+    // terminates the process, as on a plain std::thread.
+    class WorkStealingExecutor
+    {
+    public:
+        using task = std::function<void()>;
+
+        // 0 workers means one per hardware thread. threadInit runs first on every worker,
+        // e.g. to join a COM apartment.
+        explicit WorkStealingExecutor(std::size_t workers = 0, std::function<void()> threadInit = {})
+            : m_queues(workers ? workers : (std::max)(1u, std::thread::hardware_concurrency()))
+        {
+            for (auto& queue : m_queues)
+                queue = std::make_unique<Queue>();
+
+            m_threads.reserve(m_queues.size());
+            for (std::size_t i = 0; i < m_queues.size(); ++i)
+                m_threads.emplace_back([this, i, threadInit] {
+                    if (threadInit)
+                        threadInit();
+                    work(i);
+                });
+        }
+
+        WorkStealingExecutor(const WorkStealingExecutor&) = delete;
+        WorkStealingExecutor& operator=(const WorkStealingExecutor&) = delete;
+
+        ~WorkStealingExecutor()
+        {
+            {
+                std::lock_guard lk(m_idleMutex);
+                m_stopping = true;
+            }
+            m_idle.notify_all();
+
+            for (auto& thread : m_threads)
+                thread.join();
+        }
+
+        void Submit(task work)
+        {
+            const auto index = t_owner == this ? t_index : m_nextQueue.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+            {
+                std::lock_guard lk(m_queues[index]->mutex);
+                m_queues[index]->tasks.push_back(std::move(work));
+            }
+
+            m_queued.fetch_add(1, std::memory_order_release);
+
+            // Taking the lock orders the count before a worker's check-then-wait.
+            {
+                std::lock_guard lk(m_idleMutex);
+            }
+            m_idle.notify_one();
+        }
+
+        [[nodiscard]] std::size_t WorkerCount() const noexcept { return m_queues.size(); }
+
+        [[nodiscard]] WorkStealingStats Stats() const noexcept
+        {
+            return { m_executed.load(std::memory_order_relaxed), m_stolen.load(std::memory_order_relaxed) };
+        }
+
+    private:
+        struct Queue
+        {
+            std::mutex mutex;
+            std::deque<task> tasks;
+        };
+
+        void work(std::size_t index)
+        {
+            t_owner = this;
+            t_index = index;
+
+            for (;;)
+            {
+                task next;
+                if (popLocal(index, next) || steal(index, next))
+                {
+                    m_queued.fetch_sub(1, std::memory_order_relaxed);
+                    next();
+                    m_executed.fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
+
+                std::unique_lock lk(m_idleMutex);
+                if (m_stopping && m_queued.load(std::memory_order_acquire) == 0)
+                    break;
+
+                m_idle.wait(lk, [this] { return m_stopping || m_queued.load(std::memory_order_acquire) > 0; });
+            }
+
+            t_owner = nullptr;
+        }
+
+        bool popLocal(std::size_t index, task& out)
+        {
+            auto& queue = *m_queues[index];
+            std::lock_guard lk(queue.mutex);
+            if (queue.tasks.empty())
+                return false;
+
+            out = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+            return true;
+        }
+
+        bool steal(std::size_t index, task& out)
+        {
+            for (std::size_t offset = 1; offset < m_queues.size(); ++offset)
+            {
+                auto& queue = *m_queues[(index + offset) % m_queues.size()];
+                std::lock_guard lk(queue.mutex);
+                if (queue.tasks.empty())
+                    continue;
+
+                out = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+                m_stolen.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+            return false;
+        }
+
+    private:
+        static inline thread_local const WorkStealingExecutor* t_owner = nullptr;
+        static inline thread_local std::size_t t_index = 0;
+
+        std::vector<std::unique_ptr<Queue>> m_queues;
+        std::vector<std::thread> m_threads;
+        std::atomic<std::size_t> m_nextQueue{ 0 };
+        std::atomic<std::size_t> m_queued{ 0 };
+        std::atomic<std::uint64_t> m_executed{ 0 };
+        std::atomic<std::uint64_t> m_stolen{ 0 };
+
+        std::mutex m_idleMutex;
+        std::condition_variable m_idle;
+        bool m_stopping = false;
+    };
+}
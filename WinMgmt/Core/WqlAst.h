@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace Wmi::Wql
+{
+    constexpr std::uint32_t NoNode = (std::numeric_limits<std::uint32_t>::max)();
+
+    enum class QueryKind : std::uint8_t
+    {
+        Select,
+        Associators,
+        References
+    };
+
+    enum class LiteralKind : std::uint8_t
+    {
+        String,
+        Integer,
+        Real,
+        Boolean,
+        Null
+    };
+
+    // Literal as written in the query. String text keeps its escape sequences.
+    struct Literal
+    {
+        LiteralKind kind = LiteralKind::Null;
+        std::wstring_view text;
+        std::int64_t integer = 0;
+        double real = 0.0;
+        bool boolean = false;
+        std::uint32_t offset = 0;
+    };
+
+    enum class ExprKind : std::uint8_t
+    {
+        Compare,
+        And,
+        Or,
+        Not,
+        IsNull,
+        IsNotNull,
+        Isa
+    };
+
+    enum class CompareOp : std::uint8_t
+    {
+        Equal,
+        NotEqual,
+        Less,
+        LessEqual,
+        Greater,
+        GreaterEqual,
+        Like
+    };
+
+    // WHERE clause node. Children are indices into Query::expressions; comparisons
+    // are normalized so the property is always on the left ("5 < x" becomes "x > 5").
+    // A comparison of two properties ("TargetInstance.State <> PreviousInstance.State")
+    // has the right one in otherProperty and no literal.
+    struct Expr
+    {
+        ExprKind kind = ExprKind::Compare;
+        CompareOp op = CompareOp::Equal;
+        std::wstring_view property;
+        std::wstring_view otherProperty;
+        Literal literal;
+        std::uint32_t left = NoNode;
+        std::uint32_t right = NoNode;
+        std::uint32_t offset = 0;
+    };
+
+    // WHERE clause of ASSOCIATORS OF / REFERENCES OF.
+    struct AssociationFilter
+    {
+        std::wstring_view assocClass;
+        std::wstring_view resultClass;
+        std::wstring_view resultRole;
+        std::wstring_view role;
+        std::wstring_view requiredQualifier;
+        std::wstring_view requiredAssocQualifier;
+        bool classDefsOnly = false;
+        bool schemaOnly = false;
+        bool keysOnly = false;
+    };
+
+    // Parsed WQL statement. Every view points into the text that was parsed, so the
+    // query text must outlive the AST.
+    struct Query
+    {
+        QueryKind kind = QueryKind::Select;
+
+        // SELECT
+        bool selectAll = false;
+        std::vector<std::wstring_view> properties;
+        std::wstring_view className;
+        std::optional<double> within;
+        std::uint32_t where = NoNode;
+        std::vector<Expr> expressions;
+
+        // Event aggregation: GROUP WITHIN n [BY properties] [HAVING condition]
+        std::optional<double> groupWithin;
+        std::vector<std::wstring_view> groupBy;
+        std::uint32_t having = NoNode;
+
+        // ASSOCIATORS OF / REFERENCES OF
+        std::wstring_view objectPath;
+        AssociationFilter association;
+
+        [[nodiscard]] Expr const* Where() const noexcept { return where == NoNode ? nullptr : &expressions[where]; }
+        [[nodiscard]] Expr const& Node(std::uint32_t index) const noexcept { return expressions[index]; }
+    };
+
+    enum class ErrorCode : std::uint8_t
+    {
+        None,
+        InvalidToken,
+        UnterminatedString,
+        UnexpectedToken,
+        ExpectedSelect,
+        ExpectedFrom,
+        ExpectedClassName,
+        ExpectedProperty,
+        ExpectedOperator,
+        ExpectedLiteral,
+        ExpectedRightParen,
+        ExpectedObjectPath,
+        ExpectedNumber,
+        UnexpectedEnd
+    };
+
+    struct ParseError
+    {
+        ErrorCode code = ErrorCode::None;
+        std::uint32_t offset = 0;
+        std::wstring_view message;
+    };
+
+    struct ParseResult
+    {
+        Query query;
+        ParseError error;
+
+        [[nodiscard]] bool Ok() const noexcept { return error.code == ErrorCode::None; }
+        explicit operator bool() const noexcept { return Ok(); }
+    };
+}
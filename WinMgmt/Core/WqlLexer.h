@@ -0,0 +1,263 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace Wmi::Wql
+{
+    enum class TokenKind : std::uint8_t
+    {
+        End,
+        Identifier,
+        String,
+        Integer,
+        Real,
+        ObjectPath,
+        Comma,
+        Dot,
+        Star,
+        LeftParen,
+        RightParen,
+        LeftBrace,
+        RightBrace,
+        Equal,
+        NotEqual,
+        Less,
+        LessEqual,
+        Greater,
+        GreaterEqual,
+        Error
+    };
+
+    // A token is a view into the query text; String tokens exclude the quotes and
+    // keep escape sequences as written (see Unescape).
+    struct Token
+    {
+        TokenKind kind = TokenKind::End;
+        std::wstring_view text;
+        std::uint32_t offset = 0;
+    };
+
+    [[nodiscard]] constexpr wchar_t ToUpperAscii(wchar_t c) noexcept
+    {
+        return c >= L'a' && c <= L'z' ? static_cast<wchar_t>(c - (L'a' - L'A')) : c;
+    }
+
+    // WQL keywords and identifiers compare case-insensitively; keyword is upper case.
+    [[nodiscard]] constexpr bool EqualsIgnoreCase(std::wstring_view text, std::wstring_view keyword) noexcept
+    {
+        if (text.size() != keyword.size())
+            return false;
+
+        for (std::size_t i = 0; i < text.size(); ++i)
+        {
+            if (ToUpperAscii(text[i]) != ToUpperAscii(keyword[i]))
+                return false;
+        }
+        return true;
+    }
+
+    [[nodiscard]] inline std::wstring Unescape(std::wstring_view raw)
+    {
+        std::wstring text;
+        text.reserve(raw.size());
+        for (std::size_t i = 0; i < raw.size(); ++i)
+        {
+            if (raw[i] == L'\\' && i + 1 < raw.size())
+                ++i;
+            text.push_back(raw[i]);
+        }
+        return text;
+    }
+
+    // Single pass, allocation-free tokenizer over a WQL string.
+    class Lexer
+    {
+    public:
+        constexpr explicit Lexer(std::wstring_view text) noexcept : m_text(text) {}
+
+        [[nodiscard]] constexpr std::wstring_view Text() const noexcept { return m_text; }
+        [[nodiscard]] constexpr std::uint32_t Position() const noexcept { return static_cast<std::uint32_t>(m_position); }
+
+        [[nodiscard]] constexpr Token Next() noexcept
+        {
+            skipWhitespace();
+            if (m_position >= m_text.size())
+                return make(TokenKind::End, m_position, m_position);
+
+            const auto start = m_position;
+            const wchar_t c = m_text[m_position];
+
+            if (isIdentifierStart(c))
+            {
+                while (m_position < m_text.size() && isIdentifierPart(m_text[m_position]))
+                    ++m_position;
+                return make(TokenKind::Identifier, start, m_position);
+            }
+
+            if (isDigit(c) || (c == L'-' && m_position + 1 < m_text.size() && (isDigit(m_text[m_position + 1]) || m_text[m_position + 1] == L'.')) ||
+                (c == L'.' && m_position + 1 < m_text.size() && isDigit(m_text[m_position + 1])))
+                return number(start);
+
+            if (c == L'\'' || c == L'"')
+                return string(start, c);
+
+            ++m_position;
+            switch (c)
+            {
+            case L',': return make(TokenKind::Comma, start, m_position);
+            case L'.': return make(TokenKind::Dot, start, m_position);
+            case L'*': return make(TokenKind::Star, start, m_position);
+            case L'(': return make(TokenKind::LeftParen, start, m_position);
+            case L')': return make(TokenKind::RightParen, start, m_position);
+            case L'{': return make(TokenKind::LeftBrace, start, m_position);
+            case L'}': return make(TokenKind::RightBrace, start, m_position);
+            case L'=': return make(TokenKind::Equal, start, m_position);
+
+            case L'<':
+                if (accept(L'>')) return make(TokenKind::NotEqual, start, m_position);
+                if (accept(L'=')) return make(TokenKind::LessEqual, start, m_position);
+                return make(TokenKind::Less, start, m_position);
+
+            case L'>':
+                if (accept(L'=')) return make(TokenKind::GreaterEqual, start, m_position);
+                return make(TokenKind::Greater, start, m_position);
+
+            case L'!':
+                if (accept(L'=')) return make(TokenKind::NotEqual, start, m_position);
+                return make(TokenKind::Error, start, m_position);
+
+            default:
+                return make(TokenKind::Error, start, m_position);
+            }
+        }
+
+        // Object paths in ASSOCIATORS OF / REFERENCES OF are taken verbatim up to the
+        // closing brace, skipping braces inside quoted key values.
+        [[nodiscard]] constexpr Token ObjectPath() noexcept
+        {
+            skipWhitespace();
+            const auto start = m_position;
+            wchar_t quote = 0;
+            while (m_position < m_text.size())
+            {
+                const wchar_t c = m_text[m_position];
+                if (quote)
+                {
+                    if (c == L'\\')
+                        ++m_position;
+                    else if (c == quote)
+                        quote = 0;
+                }
+                else if (c == L'"' || c == L'\'')
+                {
+                    quote = c;
+                }
+                else if (c == L'}')
+                {
+                    auto end = m_position;
+                    while (end > start && isWhitespace(m_text[end - 1]))
+                        --end;
+                    return make(TokenKind::ObjectPath, start, end);
+                }
+                ++m_position;
+            }
+            return make(TokenKind::Error, start, m_position);
+        }
+
+    private:
+        [[nodiscard]] static constexpr bool isWhitespace(wchar_t c) noexcept { return c == L' ' || c == L'\t' || c == L'\r' || c == L'\n'; }
+        [[nodiscard]] static constexpr bool isDigit(wchar_t c) noexcept { return c >= L'0' && c <= L'9'; }
+
+        [[nodiscard]] static constexpr bool isIdentifierStart(wchar_t c) noexcept
+        {
+            return (c >= L'a' && c <= L'z') || (c >= L'A' && c <= L'Z') || c == L'_' || c > 0x7F;
+        }
+
+        [[nodiscard]] static constexpr bool isIdentifierPart(wchar_t c) noexcept { return isIdentifierStart(c) || isDigit(c); }
+
+        constexpr void skipWhitespace() noexcept
+        {
+            while (m_position < m_text.size() && isWhitespace(m_text[m_position]))
+                ++m_position;
+        }
+
+        constexpr bool accept(wchar_t c) noexcept
+        {
+            if (m_position < m_text.size() && m_text[m_position] == c)
+            {
+                ++m_position;
+                return true;
+            }
+            return false;
+        }
+
+        [[nodiscard]] constexpr Token make(TokenKind kind, std::size_t start, std::size_t end) const noexcept
+        {
+            return { kind, m_text.substr(start, end - start), static_cast<std::uint32_t>(start) };
+        }
+
+        [[nodiscard]] constexpr Token number(std::size_t start) noexcept
+        {
+            bool real = false;
+            accept(L'-');
+            while (m_position < m_text.size() && isDigit(m_text[m_position]))
+                ++m_position;
+
+            if (accept(L'.'))
+            {
+                real = true;
+                while (m_position < m_text.size() && isDigit(m_text[m_position]))
+                    ++m_position;
+            }
+
+            if (m_position < m_text.size() && (m_text[m_position] == L'e' || m_text[m_position] == L'E'))
+            {
+                real = true;
+                ++m_position;
+                if (!accept(L'+'))
+                    accept(L'-');
+
+                const auto digits = m_position;
+                while (m_position < m_text.size() && isDigit(m_text[m_position]))
+                    ++m_position;
+                if (digits == m_position)
+                    return make(TokenKind::Error, start, m_position);
+            }
+
+            if (m_position < m_text.size() && isIdentifierStart(m_text[m_position]))
+                return make(TokenKind::Error, start, m_position + 1);
+
+            return make(real ? TokenKind::Real : TokenKind::Integer, start, m_position);
+        }
+
+        [[nodiscard]] constexpr Token string(std::size_t start, wchar_t quote) noexcept
+        {
+            ++m_position;
+            while (m_position < m_text.size())
+            {
+                const wchar_t c = m_text[m_position];
+                if (c == L'\\' && m_position + 1 < m_text.size())
+                {
+                    m_position += 2;
+                    continue;
+                }
+
+                if (c == quote)
+                {
+                    auto token = make(TokenKind::String, start + 1, m_position);
+                    ++m_position;
+                    return token;
+                }
+                ++m_position;
+            }
+            return make(TokenKind::Error, start, m_position);
+        }
+
+    private:
+        std::wstring_view m_text;
+        std::size_t m_position = 0;
+    };
+}
@@ -0,0 +1,616 @@
+#pragma once
+
+#include "WqlAst.h"
+#include "WqlLexer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string_view>
+
+namespace Wmi::Wql
+{
+    namespace detail
+    {
+        [[nodiscard]] constexpr double ParseReal(std::wstring_view text) noexcept
+        {
+            std::size_t i = 0;
+            const bool negative = i < text.size() && text[i] == L'-';
+            if (negative)
+                ++i;
+
+            double value = 0.0;
+            for (; i < text.size() && text[i] >= L'0' && text[i] <= L'9'; ++i)
+                value = value * 10.0 + (text[i] - L'0');
+
+            if (i < text.size() && text[i] == L'.')
+            {
+                double scale = 0.1;
+                for (++i; i < text.size() && text[i] >= L'0' && text[i] <= L'9'; ++i, scale /= 10.0)
+                    value += (text[i] - L'0') * scale;
+            }
+
+            if (i < text.size() && (text[i] == L'e' || text[i] == L'E'))
+            {
+                ++i;
+                const bool negativeExponent = i < text.size() && text[i] == L'-';
+                if (i < text.size() && (text[i] == L'-' || text[i] == L'+'))
+                    ++i;
+
+                int exponent = 0;
+                for (; i < text.size() && text[i] >= L'0' && text[i] <= L'9'; ++i)
+                    exponent = exponent < 400 ? exponent * 10 + (text[i] - L'0') : exponent;
+
+                for (; exponent > 0; --exponent)
+                    value = negativeExponent ? value / 10.0 : value * 10.0;
+            }
+
+            return negative ? -value : value;
+        }
+
+        // Returns false when the literal does not fit in an int64.
+        [[nodiscard]] constexpr bool ParseInt64(std::wstring_view text, std::int64_t& value) noexcept
+        {
+            std::size_t i = 0;
+            const bool negative = !text.empty() && text[0] == L'-';
+            if (negative)
+                ++i;
+
+            std::uint64_t magnitude = 0;
+            const std::uint64_t limit = negative ? std::uint64_t{ 1 } << 63 : (std::uint64_t{ 1 } << 63) - 1;
+            for (; i < text.size(); ++i)
+            {
+                const auto digit = static_cast<std::uint64_t>(text[i] - L'0');
+                if (magnitude > (limit - digit) / 10)
+                    return false;
+                magnitude = magnitude * 10 + digit;
+            }
+
+            value = negative ? static_cast<std::int64_t>(0 - magnitude) : static_cast<std::int64_t>(magnitude);
+            return true;
+        }
+
+        [[nodiscard]] constexpr CompareOp Mirror(CompareOp op) noexcept
+        {
+            switch (op)
+            {
+            case CompareOp::Less:         return CompareOp::Greater;
+            case CompareOp::LessEqual:    return CompareOp::GreaterEqual;
+            case CompareOp::Greater:      return CompareOp::Less;
+            case CompareOp::GreaterEqual: return CompareOp::LessEqual;
+            default:                      return op;
+            }
+        }
+    }
+
+    // Recursive-descent parser for the WQL subset WMI accepts: data and event
+    // SELECT queries (with WITHIN and GROUP), ASSOCIATORS OF and REFERENCES OF. Parsing stops
+    // at the first error, which is reported with its character offset.
+    class Parser
+    {
+    public:
+        explicit Parser(std::wstring_view text) noexcept : m_lexer(text) {}
+
+        [[nodiscard]] ParseResult Parse()
+        {
+            advance();
+            if (m_result.Ok())
+                statement();
+
+            if (m_result.Ok() && m_current.kind != TokenKind::End)
+                fail(ErrorCode::UnexpectedToken, L"unexpected text after the end of the query");
+
+            return std::move(m_result);
+        }
+
+    private:
+        void statement()
+        {
+            if (isKeyword(L"SELECT"))
+                return select();
+
+            if (isKeyword(L"ASSOCIATORS"))
+                return association(QueryKind::Associators);
+
+            if (isKeyword(L"REFERENCES"))
+                return association(QueryKind::References);
+
+            fail(ErrorCode::ExpectedSelect, L"expected SELECT, ASSOCIATORS OF or REFERENCES OF");
+        }
+
+        void select()
+        {
+            auto& query = m_result.query;
+            query.kind = QueryKind::Select;
+            advance();
+
+            if (m_current.kind == TokenKind::Star)
+            {
+                query.selectAll = true;
+                advance();
+            }
+            else
+            {
+                do
+                {
+                    if (m_current.kind == TokenKind::Comma)
+                        advance();
+
+                    auto name = propertyName();
+                    if (name.empty())
+                        return;
+                    query.properties.push_back(name);
+                } while (m_result.Ok() && m_current.kind == TokenKind::Comma);
+            }
+
+            if (!expectKeyword(L"FROM", ErrorCode::ExpectedFrom, L"expected FROM"))
+                return;
+
+            if (m_current.kind != TokenKind::Identifier || isReserved())
+                return void(fail(ErrorCode::ExpectedClassName, L"expected a class name"));
+
+            query.className = m_current.text;
+            advance();
+
+            within();
+            if (m_result.Ok() && acceptKeyword(L"WHERE"))
+                query.where = disjunction();
+
+            // WMI also accepts WITHIN after the WHERE clause.
+            if (m_result.Ok() && !query.within)
+                within();
+
+            if (m_result.Ok() && acceptKeyword(L"GROUP"))
+                group();
+        }
+
+        void within()
+        {
+            if (acceptKeyword(L"WITHIN"))
+                m_result.query.within = seconds();
+        }
+
+        void group()
+        {
+            auto& query = m_result.query;
+            if (!expectKeyword(L"WITHIN", ErrorCode::UnexpectedToken, L"expected WITHIN after GROUP"))
+                return;
+
+            query.groupWithin = seconds();
+            if (m_result.Ok() && acceptKeyword(L"BY"))
+            {
+                do
+                {
+                    if (m_current.kind == TokenKind::Comma)
+                        advance();
+
+                    auto name = propertyName();
+                    if (name.empty())
+                        return;
+                    query.groupBy.push_back(name);
+                } while (m_result.Ok() && m_current.kind == TokenKind::Comma);
+            }
+
+            if (m_result.Ok() && acceptKeyword(L"HAVING"))
+                query.having = disjunction();
+        }
+
+        std::optional<double> seconds()
+        {
+            if (m_current.kind != TokenKind::Integer && m_current.kind != TokenKind::Real)
+            {
+                fail(ErrorCode::ExpectedNumber, L"expected an interval in seconds");
+                return std::nullopt;
+            }
+
+            auto value = detail::ParseReal(m_current.text);
+            advance();
+            return value;
+        }
+
+        void association(QueryKind kind)
+        {
+            auto& query = m_result.query;
+            query.kind = kind;
+            advance();
+
+            if (!expectKeyword(L"OF", ErrorCode::UnexpectedToken, L"expected OF"))
+                return;
+
+            if (m_current.kind != TokenKind::LeftBrace)
+                return void(fail(ErrorCode::ExpectedObjectPath, L"expected '{' before the object path"));
+
+            auto path = m_lexer.ObjectPath();
+            if (path.kind != TokenKind::ObjectPath || path.text.empty())
+                return void(fail(ErrorCode::ExpectedObjectPath, L"expected an object path closed by '}'", path.offset));
+
+            query.objectPath = path.text;
+            advance();
+            if (!expect(TokenKind::RightBrace, ErrorCode::ExpectedObjectPath, L"expected '}'"))
+                return;
+
+            if (!acceptKeyword(L"WHERE"))
+                return;
+
+            auto& filter = query.association;
+            bool any = false;
+            while (m_result.Ok() && m_current.kind == TokenKind::Identifier)
+            {
+                auto name = m_current;
+                advance();
+
+                if (EqualsIgnoreCase(name.text, L"CLASSDEFSONLY"))
+                    filter.classDefsOnly = true;
+                else if (EqualsIgnoreCase(name.text, L"SCHEMAONLY"))
+                    filter.schemaOnly = true;
+                else if (EqualsIgnoreCase(name.text, L"KEYSONLY"))
+                    filter.keysOnly = true;
+                else if (auto* target = associationTarget(kind, name.text))
+                {
+                    if (!expect(TokenKind::Equal, ErrorCode::ExpectedOperator, L"expected '='"))
+                        return;
+                    if (m_current.kind != TokenKind::Identifier)
+                        return void(fail(ErrorCode::ExpectedClassName, L"expected a class, role or qualifier name"));
+
+                    *target = m_current.text;
+                    advance();
+                }
+                else
+                {
+                    return void(fail(ErrorCode::UnexpectedToken, L"unknown association filter", name.offset));
+                }
+                any = true;
+            }
+
+            if (m_result.Ok() && !any)
+                fail(ErrorCode::UnexpectedToken, L"expected an association filter after WHERE");
+        }
+
+        [[nodiscard]] std::wstring_view* associationTarget(QueryKind kind, std::wstring_view name) noexcept
+        {
+            auto& filter = m_result.query.association;
+            if (EqualsIgnoreCase(name, L"RESULTCLASS"))
+                return &filter.resultClass;
+            if (EqualsIgnoreCase(name, L"ROLE"))
+                return &filter.role;
+            if (EqualsIgnoreCase(name, L"REQUIREDQUALIFIER"))
+                return &filter.requiredQualifier;
+
+            if (kind != QueryKind::Associators)
+                return nullptr;
+
+            if (EqualsIgnoreCase(name, L"ASSOCCLASS"))
+                return &filter.assocClass;
+            if (EqualsIgnoreCase(name, L"RESULTROLE"))
+                return &filter.resultRole;
+            if (EqualsIgnoreCase(name, L"REQUIREDASSOCQUALIFIER"))
+                return &filter.requiredAssocQualifier;
+
+            return nullptr;
+        }
+
+        std::uint32_t disjunction()
+        {
+            auto left = conjunction();
+            while (m_result.Ok() && isKeyword(L"OR"))
+            {
+                auto offset = m_current.offset;
+                advance();
+                auto right = conjunction();
+                left = add(node(ExprKind::Or, offset, left, right));
+            }
+            return left;
+        }
+
+        std::uint32_t conjunction()
+        {
+            auto left = negation();
+            while (m_result.Ok() && isKeyword(L"AND"))
+            {
+                auto offset = m_current.offset;
+                advance();
+                auto right = negation();
+                left = add(node(ExprKind::And, offset, left, right));
+            }
+            return left;
+        }
+
+        std::uint32_t negation()
+        {
+            if (isKeyword(L"NOT"))
+            {
+                auto offset = m_current.offset;
+                advance();
+                auto operand = negation();
+                return add(node(ExprKind::Not, offset, operand));
+            }
+            return primary();
+        }
+
+        std::uint32_t primary()
+        {
+            if (!m_result.Ok())
+                return NoNode;
+
+            if (m_current.kind == TokenKind::LeftParen)
+            {
+                advance();
+                auto inner = disjunction();
+                if (m_result.Ok())
+                    expect(TokenKind::RightParen, ErrorCode::ExpectedRightParen, L"expected ')'");
+                return inner;
+            }
+
+            if (m_current.kind == TokenKind::Identifier && !isLiteralKeyword())
+                return predicate();
+
+            // Literal on the left: "5 < Priority".
+            auto expr = node(ExprKind::Compare, m_current.offset);
+            if (!literal(expr.literal))
+                return NoNode;
+
+            CompareOp op{};
+            if (!comparison(op))
+                return NoNode;
+
+            expr.op = detail::Mirror(op);
+            expr.property = propertyName();
+            return m_result.Ok() ? add(expr) : NoNode;
+        }
+
+        std::uint32_t predicate()
+        {
+            auto expr = node(ExprKind::Compare, m_current.offset);
+            expr.property = propertyName();
+            if (!m_result.Ok())
+                return NoNode;
+
+            if (acceptKeyword(L"IS"))
+            {
+                expr.kind = acceptKeyword(L"NOT") ? ExprKind::IsNotNull : ExprKind::IsNull;
+                if (!expectKeyword(L"NULL", ErrorCode::ExpectedLiteral, L"expected NULL"))
+                    return NoNode;
+                return add(expr);
+            }
+
+            if (acceptKeyword(L"ISA"))
+            {
+                expr.kind = ExprKind::Isa;
+                if (m_current.kind != TokenKind::String)
+                    return fail(ErrorCode::ExpectedLiteral, L"expected a quoted class name after ISA");
+                literal(expr.literal);
+                return add(expr);
+            }
+
+            bool negated = false;
+            if (isKeyword(L"NOT"))
+            {
+                negated = true;
+                advance();
+                if (!isKeyword(L"LIKE"))
+                    return fail(ErrorCode::ExpectedOperator, L"expected LIKE after NOT");
+            }
+
+            if (acceptKeyword(L"LIKE"))
+            {
+                expr.op = CompareOp::Like;
+                if (m_current.kind != TokenKind::String)
+                    return fail(ErrorCode::ExpectedLiteral, L"expected a quoted pattern after LIKE");
+                literal(expr.literal);
+
+                auto like = add(expr);
+                return negated ? add(node(ExprKind::Not, expr.offset, like)) : like;
+            }
+
+            if (!comparison(expr.op))
+                return NoNode;
+
+            if (m_current.kind == TokenKind::Identifier && !isLiteralKeyword() && !isReserved())
+            {
+                expr.otherProperty = propertyName();
+                return m_result.Ok() ? add(expr) : NoNode;
+            }
+
+            if (!literal(expr.literal))
+                return NoNode;
+
+            return add(expr);
+        }
+
+        bool comparison(CompareOp& op)
+        {
+            switch (m_current.kind)
+            {
+            case TokenKind::Equal:        op = CompareOp::Equal; break;
+            case TokenKind::NotEqual:     op = CompareOp::NotEqual; break;
+            case TokenKind::Less:         op = CompareOp::Less; break;
+            case TokenKind::LessEqual:    op = CompareOp::LessEqual; break;
+            case TokenKind::Greater:      op = CompareOp::Greater; break;
+            case TokenKind::GreaterEqual: op = CompareOp::GreaterEqual; break;
+            default:
+                fail(ErrorCode::ExpectedOperator, L"expected a comparison operator");
+                return false;
+            }
+            advance();
+            return m_result.Ok();
+        }
+
+        bool literal(Literal& value)
+        {
+            value.offset = m_current.offset;
+            value.text = m_current.text;
+
+            switch (m_current.kind)
+            {
+            case TokenKind::String:
+                value.kind = LiteralKind::String;
+                break;
+
+            case TokenKind::Integer:
+                value.kind = LiteralKind::Integer;
+                if (!detail::ParseInt64(m_current.text, value.integer))
+                {
+                    value.kind = LiteralKind::Real;
+                    value.real = detail::ParseReal(m_current.text);
+                }
+                break;
+
+            case TokenKind::Real:
+                value.kind = LiteralKind::Real;
+                value.real = detail::ParseReal(m_current.text);
+                break;
+
+            case TokenKind::Identifier:
+                if (EqualsIgnoreCase(m_current.text, L"TRUE") || EqualsIgnoreCase(m_current.text, L"FALSE"))
+                {
+                    value.kind = LiteralKind::Boolean;
+                    value.boolean = EqualsIgnoreCase(m_current.text, L"TRUE");
+                    break;
+                }
+                if (EqualsIgnoreCase(m_current.text, L"NULL"))
+                {
+                    value.kind = LiteralKind::Null;
+                    break;
+                }
+                [[fallthrough]];
+
+            default:
+                fail(ErrorCode::ExpectedLiteral, L"expected a string, number, TRUE, FALSE or NULL");
+                return false;
+            }
+
+            advance();
+            return m_result.Ok();
+        }
+
+        // Property names may be qualified for embedded objects (TargetInstance.Name);
+        // the result is one view spanning all parts.
+        std::wstring_view propertyName()
+        {
+            if (m_current.kind != TokenKind::Identifier || isReserved())
+            {
+                fail(ErrorCode::ExpectedProperty, L"expected a property name");
+                return {};
+            }
+
+            const auto start = m_current.offset;
+            auto end = start + static_cast<std::uint32_t>(m_current.text.size());
+            advance();
+
+            while (m_result.Ok() && m_current.kind == TokenKind::Dot)
+            {
+                advance();
+                if (m_current.kind != TokenKind::Identifier)
+                {
+                    fail(ErrorCode::ExpectedProperty, L"expected a property name after '.'");
+                    return {};
+                }
+                end = m_current.offset + static_cast<std::uint32_t>(m_current.text.size());
+                advance();
+            }
+
+            return m_lexer.Text().substr(start, end - start);
+        }
+
+        [[nodiscard]] static Expr node(ExprKind kind, std::uint32_t offset, std::uint32_t left = NoNode, std::uint32_t right = NoNode) noexcept
+        {
+            Expr expr;
+            expr.kind = kind;
+            expr.offset = offset;
+            expr.left = left;
+            expr.right = right;
+            return expr;
+        }
+
+        std::uint32_t add(Expr const& expr)
+        {
+            if (!m_result.Ok())
+                return NoNode;
+
+            m_result.query.expressions.push_back(expr);
+            return static_cast<std::uint32_t>(m_result.query.expressions.size() - 1);
+        }
+
+        void advance() noexcept
+        {
+            m_current = m_lexer.Next();
+            if (m_current.kind == TokenKind::Error)
+            {
+                const bool quoted = !m_current.text.empty() && (m_current.text[0] == L'\'' || m_current.text[0] == L'"');
+                quoted ? fail(ErrorCode::UnterminatedString, L"unterminated string literal") : fail(ErrorCode::InvalidToken, L"invalid character");
+            }
+        }
+
+        std::uint32_t fail(ErrorCode code, std::wstring_view message) noexcept
+        {
+            if (m_current.kind == TokenKind::End && code != ErrorCode::UnexpectedToken)
+                code = ErrorCode::UnexpectedEnd;
+            return fail(code, message, m_current.offset);
+        }
+
+        std::uint32_t fail(ErrorCode code, std::wstring_view message, std::uint32_t offset) noexcept
+        {
+            if (m_result.Ok())
+                m_result.error = { code, offset, message };
+            return NoNode;
+        }
+
+        [[nodiscard]] bool isKeyword(std::wstring_view keyword) const noexcept
+        {
+            return m_current.kind == TokenKind::Identifier && EqualsIgnoreCase(m_current.text, keyword);
+        }
+
+        [[nodiscard]] bool isLiteralKeyword() const noexcept
+        {
+            return isKeyword(L"TRUE") || isKeyword(L"FALSE") || isKeyword(L"NULL");
+        }
+
+        [[nodiscard]] bool isReserved() const noexcept
+        {
+            for (auto keyword : { L"SELECT", L"FROM", L"WHERE", L"AND", L"OR", L"NOT", L"WITHIN", L"IS", L"ISA", L"LIKE", L"GROUP", L"BY", L"HAVING" })
+            {
+                if (isKeyword(keyword))
+                    return true;
+            }
+            return false;
+        }
+
+        bool acceptKeyword(std::wstring_view keyword) noexcept
+        {
+            if (!isKeyword(keyword))
+                return false;
+            advance();
+            return true;
+        }
+
+        bool expectKeyword(std::wstring_view keyword, ErrorCode code, std::wstring_view message) noexcept
+        {
+            if (acceptKeyword(keyword))
+                return m_result.Ok();
+            fail(code, message);
+            return false;
+        }
+
+        bool expect(TokenKind kind, ErrorCode code, std::wstring_view message) noexcept
+        {
+            if (m_current.kind != kind)
+            {
+                fail(code, message);
+                return false;
+            }
+            advance();
+            return m_result.Ok();
+        }
+
+    private:
+        Lexer m_lexer;
+        Token m_current;
+        ParseResult m_result;
+    };
+
+    [[nodiscard]] inline ParseResult Parse(std::wstring_view text)
+    {
+        return Parser{ text }.Parse();
+    }
+}
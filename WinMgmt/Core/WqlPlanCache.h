@@ -0,0 +1,237 @@
+#pragma once
+
+#include "SchemaCache.h"
+#include "WqlParser.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Wmi::Wql
+{
+    // A parsed query shape. The AST refers to text, the first query seen with this
+    // shape; literals of later queries are returned separately by PlanCache::Lookup.
+    struct QueryPlan
+    {
+        std::wstring normalized;
+        std::wstring text;
+        Query query;
+        std::size_t literalCount = 0;
+    };
+
+    using QueryPlanPtr = std::shared_ptr<const QueryPlan>;
+
+    struct PlanLookup
+    {
+        QueryPlanPtr plan;
+        std::vector<Token> literals;
+        ParseError error;
+        bool hit = false;
+
+        explicit operator bool() const noexcept { return plan != nullptr; }
+    };
+
+    struct PlanCacheStats
+    {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        std::uint64_t evictions = 0;
+        std::size_t size = 0;
+        std::size_t capacity = 0;
+    };
+
+    // Builds the cache key for a query: keywords and identifiers upper-cased, tokens
+    // separated by one space, string literals replaced by '?' and numbers by '#'.
+    // Object paths are kept as written: the plan's objectPath is read from the first
+    // text, and an empty path must still reach the parser. Literal tokens are
+    // appended to literals in query order. Returns false if the text does not tokenize.
+    [[nodiscard]] inline bool Normalize(std::wstring_view text, std::wstring& key, std::vector<Token>* literals = nullptr)
+    {
+        key.clear();
+        key.reserve(text.size());
+
+        Lexer lexer{ text };
+        for (auto token = lexer.Next(); token.kind != TokenKind::End; token = lexer.Next())
+        {
+            if (!key.empty())
+                key.push_back(L' ');
+
+            switch (token.kind)
+            {
+            case TokenKind::Identifier:
+                for (auto c : token.text)
+                    key.push_back(ToUpperAscii(c));
+                break;
+
+            case TokenKind::String:
+                key.push_back(L'?');
+                if (literals)
+                    literals->push_back(token);
+                break;
+
+            case TokenKind::Integer:
+            case TokenKind::Real:
+                key.push_back(L'#');
+                if (literals)
+                    literals->push_back(token);
+                break;
+
+            case TokenKind::LeftBrace:
+            {
+                auto path = lexer.ObjectPath();
+                if (path.kind != TokenKind::ObjectPath)
+                    return false;
+
+                key.append(L"{ ").append(path.text);
+                break;
+            }
+
+            case TokenKind::Error:
+                return false;
+
+            default:
+                key.append(token.text);
+                break;
+            }
+        }
+        return true;
+    }
+
+    // Bounded LRU map from normalized WQL to parsed plans. The key space is split
+    // across independently locked shards so concurrent pollers rarely contend;
+    // normalization and parsing happen outside any lock.
+    class PlanCache
+    {
+    public:
+        explicit PlanCache(std::size_t capacity = 1024, std::size_t shardCount = 8)
+            : m_capacity(capacity), m_shards(shardCount == 0 ? 1 : shardCount)
+        {
+            const auto perShard = (capacity + m_shards.size() - 1) / m_shards.size();
+            for (auto& shard : m_shards)
+                shard.capacity = perShard == 0 ? 1 : perShard;
+        }
+
+        PlanCache(const PlanCache&) = delete;
+        PlanCache& operator=(const PlanCache&) = delete;
+
+        // Returns the cached plan for text's shape, parsing and inserting it on a miss.
+        // Queries that fail to parse are not cached; the error is returned instead.
+        [[nodiscard]] PlanLookup Lookup(std::wstring_view text)
+        {
+            PlanLookup result;
+            std::wstring key;
+            if (!Normalize(text, key, &result.literals))
+            {
+                m_misses.fetch_add(1, std::memory_order_relaxed);
+                result.error = Parse(text).error;
+                return result;
+            }
+
+            auto& shard = shardFor(key);
+            {
+                std::lock_guard lk(shard.mutex);
+                auto it = shard.index.find(std::wstring_view{ key });
+                if (it != shard.index.end()) [[likely]]
+                {
+                    shard.order.splice(shard.order.begin(), shard.order, it->second);
+                    m_hits.fetch_add(1, std::memory_order_relaxed);
+                    result.plan = *it->second;
+                    result.hit = true;
+                    return result;
+                }
+            }
+
+            m_misses.fetch_add(1, std::memory_order_relaxed);
+
+            auto plan = std::make_shared<QueryPlan>();
+            plan->normalized = std::move(key);
+            plan->text.assign(text);
+
+            auto parsed = Parse(plan->text);
+            if (!parsed)
+            {
+                result.error = parsed.error;
+                return result;
+            }
+
+            plan->query = std::move(parsed.query);
+            plan->literalCount = result.literals.size();
+            result.plan = insert(shard, std::move(plan));
+            return result;
+        }
+
+        void Clear()
+        {
+            for (auto& shard : m_shards)
+            {
+                std::lock_guard lk(shard.mutex);
+                shard.index.clear();
+                shard.order.clear();
+            }
+        }
+
+        [[nodiscard]] PlanCacheStats Stats() const
+        {
+            std::size_t size = 0;
+            for (auto& shard : m_shards)
+            {
+                std::lock_guard lk(shard.mutex);
+                size += shard.order.size();
+            }
+
+            return { m_hits.load(std::memory_order_relaxed), m_misses.load(std::memory_order_relaxed),
+                m_evictions.load(std::memory_order_relaxed), size, m_capacity };
+        }
+
+    private:
+        struct Shard
+        {
+            mutable std::mutex mutex;
+            std::list<QueryPlanPtr> order;
+            std::unordered_map<std::wstring_view, std::list<QueryPlanPtr>::iterator> index;
+            std::size_t capacity = 0;
+        };
+
+        Shard& shardFor(std::wstring_view key) noexcept
+        {
+            return m_shards[TransparentStringHash{}(key) % m_shards.size()];
+        }
+
+        QueryPlanPtr insert(Shard& shard, std::shared_ptr<QueryPlan> plan)
+        {
+            std::lock_guard lk(shard.mutex);
+
+            // Another thread may have parsed the same shape meanwhile; keep the first.
+            auto it = shard.index.find(std::wstring_view{ plan->normalized });
+            if (it != shard.index.end())
+                return *it->second;
+
+            shard.order.push_front(std::move(plan));
+            shard.index.emplace(std::wstring_view{ shard.order.front()->normalized }, shard.order.begin());
+
+            if (shard.order.size() > shard.capacity)
+            {
+                shard.index.erase(std::wstring_view{ shard.order.back()->normalized });
+                shard.order.pop_back();
+                m_evictions.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            return shard.order.front();
+        }
+
+    private:
+        std::size_t m_capacity;
+        std::vector<Shard> m_shards;
+        std::atomic<std::uint64_t> m_hits{ 0 };
+        std::atomic<std::uint64_t> m_misses{ 0 };
+        std::atomic<std::uint64_t> m_evictions{ 0 };
+    };
+}
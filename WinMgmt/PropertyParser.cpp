@@ -1,53 +1,265 @@
 #include "pch.h"
 #include "PropertyParser.h"
 
-winrt::WinMgmt::WmiClassObjectProperty PropertyParser::CreateFromVartype(_bstr_t const& name, _variant_t const& var)
+#include <shared_mutex>
+#include <unordered_map>
+
+static_assert(static_cast<int>(winrt::WinMgmt::PropertyType::Array) == static_cast<int>(Wmi::PropertyType::Array),
+    "Wmi::PropertyType must mirror WinMgmt.PropertyType");
+
+namespace
+{
+    // winrt::clock counts 100ns ticks from 1601-01-01, CIM values are microseconds from 1970-01-01.
+    constexpr int64_t UnixEpochTicks = 116444736000000000;
+
+    winrt::Windows::Foundation::DateTime ToDateTime(int64_t microseconds) noexcept
+    {
+        return winrt::Windows::Foundation::DateTime{ winrt::Windows::Foundation::TimeSpan{ microseconds * 10 + UnixEpochTicks } };
+    }
+
+    template<typename T, typename Project, typename Create>
+    winrt::Windows::Foundation::IInspectable BoxArray(Wmi::ArrayView const& array, Project&& project, Create&& create)
+    {
+        auto items = std::make_unique<T[]>(array.Size());
+        for (std::size_t i = 0; i < array.Size(); i++)
+            items[i] = project(PropertyParser::ArrayElement(array, i));
+
+        return create(winrt::array_view<T const>{ items.get(), items.get() + array.Size() });
+    }
+}
+
+winrt::WinMgmt::WmiClassObjectProperty PropertyParser::CreateFromVartype(_bstr_t const& name, _variant_t& var)
+{
+    return CreateFromVartype(winrt::hstring{ name }, var);
+}
+
+winrt::WinMgmt::WmiClassObjectProperty PropertyParser::CreateFromVartype(winrt::hstring const& name, _variant_t& var, Wmi::PropertyType declared, Wmi::PropertyType declaredElement)
+{
+    if (V_ISARRAY(&var) || V_VT(&var) == VT_BSTR)
+    {
+        // Move the SAFEARRAY or BSTR into the property, which then views it instead of copying.
+        auto owner = std::make_shared<_variant_t>(var.Detach(), false);
+        return winrt::make<winrt::WinMgmt::implementation::WmiClassObjectProperty>(name, Convert(*owner, declared, declaredElement), owner);
+    }
+
+    return winrt::make<winrt::WinMgmt::implementation::WmiClassObjectProperty>(name, Convert(var, declared), nullptr);
+}
+
+winrt::WinMgmt::WmiClassObjectProperty PropertyParser::CreateFromCell(std::shared_ptr<const Wmi::ResultTable> const& table, std::size_t column, std::size_t row)
+{
+    auto const& col = table->GetColumn(column);
+
+    // The table outlives the property through the owner reference, so strings stay views.
+    return winrt::make<winrt::WinMgmt::implementation::WmiClassObjectProperty>(InternName(col.Name()), col.GetValue(row), table);
+}
+
+winrt::hstring PropertyParser::InternName(std::wstring_view name)
+{
+    // Keys view the characters of the hstring they map to.
+    static std::shared_mutex mutex;
+    static std::unordered_map<std::wstring_view, winrt::hstring> names;
+
+    {
+        std::shared_lock lk(mutex);
+        if (auto it = names.find(name); it != names.end())
+            return it->second;
+    }
+
+    std::lock_guard lk(mutex);
+    if (auto it = names.find(name); it != names.end())
+        return it->second;
+
+    winrt::hstring interned{ name };
+    names.emplace(std::wstring_view{ interned }, interned);
+    return interned;
+}
+
+Wmi::Value PropertyParser::Convert(VARIANT const& var, Wmi::PropertyType declared, Wmi::PropertyType declaredElement) noexcept
+{
+    return Wmi::ConvertVariant(var, declared, [](BSTR value) noexcept { return static_cast<std::size_t>(::SysStringLen(value)); }, declaredElement);
+}
+
+Wmi::Value PropertyParser::ArrayElement(Wmi::ArrayView const& array, std::size_t index) noexcept
+{
+    return Wmi::ArrayElement(array, index, [](const wchar_t* value) noexcept { return static_cast<std::size_t>(::SysStringLen(const_cast<BSTR>(value))); });
+}
+
+winrt::Windows::Foundation::IInspectable PropertyParser::Box(Wmi::Value const& value)
 {
     using namespace winrt;
 
-    switch (var.vt)
+    switch (value.Type())
     {
-    case VT_I1:
-        return WinMgmt::WmiClassObjectProperty{ hstring{name}, box_value(var.bVal), WinMgmt::PropertyType::Int8 };
+    case Wmi::PropertyType::Int8:
+    case Wmi::PropertyType::UInt8:
+        return box_value(static_cast<uint8_t>(value.AsInt64()));
 
-    case VT_I2: // short / Int16
-        return WinMgmt::WmiClassObjectProperty{ hstring{name}, box_value(var.iVal), WinMgmt::PropertyType::Int16 };
+    case Wmi::PropertyType::Int16:
+        return box_value(static_cast<int16_t>(value.AsInt64()));
 
-    case VT_I4: // int / Int32
-        return WinMgmt::WmiClassObjectProperty{ hstring{name}, box_value(var.intVal), WinMgmt::PropertyType::Int32 };
+    case Wmi::PropertyType::Int32:
+        return box_value(static_cast<int32_t>(value.AsInt64()));
 
-    case VT_I8: // INT64
-        return WinMgmt::WmiClassObjectProperty{ hstring{name}, box_value(var.llVal), WinMgmt::PropertyType::Int64 };
+    case Wmi::PropertyType::Int64:
+        return box_value(value.AsInt64());
 
-    case VT_UI1:
-        return WinMgmt::WmiClassObjectProperty{ hstring{name}, box_value(var.bVal), WinMgmt::PropertyType::UInt8 };
+    case Wmi::PropertyType::UInt16:
+        return box_value(static_cast<uint16_t>(value.AsInt64()));
 
-    case VT_UI2: // UInt16
-        return WinMgmt::WmiClassObjectProperty{ hstring{name}, box_value(var.uiVal), WinMgmt::PropertyType::UInt16 };
+    case Wmi::PropertyType::UInt32:
+        return box_value(static_cast<uint32_t>(value.AsInt64()));
 
-    case VT_UI4: // UInt32
-        return WinMgmt::WmiClassObjectProperty{ hstring{name}, box_value(var.uintVal), WinMgmt::PropertyType::UInt32 };
+    case Wmi::PropertyType::UInt64:
+        return box_value(value.AsUInt64());
 
-    case VT_UI8: // UInt64
-        return WinMgmt::WmiClassObjectProperty{ hstring{name}, box_value(var.ullVal), WinMgmt::PropertyType::UInt64 };
+    case Wmi::PropertyType::Float:
+        return box_value(static_cast<float>(value.AsDouble()));
 
-    case VT_R4: // float
-        return WinMgmt::WmiClassObjectProperty{ hstring{name}, box_value(var.fltVal), WinMgmt::PropertyType::Float };
+    case Wmi::PropertyType::Double:
+        return box_value(value.AsDouble());
 
-    case VT_R8: // double
-        return WinMgmt::WmiClassObjectProperty{ hstring{name}, box_value(var.dblVal), WinMgmt::PropertyType::Double };
+    case Wmi::PropertyType::Boolean:
+        return box_value(value.AsBoolean());
 
-    case VT_BOOL:
-        return WinMgmt::WmiClassObjectProperty{ hstring{name}, box_value(var.boolVal == VARIANT_TRUE), WinMgmt::PropertyType::Boolean };
+    case Wmi::PropertyType::String:
+    case Wmi::PropertyType::Reference:
+        return box_value(hstring{ value.AsString() });
 
-    case VT_BSTR:
-        return WinMgmt::WmiClassObjectProperty{ hstring{name}, box_value(hstring{var.bstrVal}), WinMgmt::PropertyType::String };
+    case Wmi::PropertyType::DateTime:
+        return box_value(ToDateTime(value.AsInt64()));
 
-    case VT_EMPTY:
-    case VT_NULL:
-        return WinMgmt::WmiClassObjectProperty{ hstring{name}, nullptr, WinMgmt::PropertyType::Null };
+    case Wmi::PropertyType::Array:
+        return BoxArray(value.AsArray());
 
     default:
-        return WinMgmt::WmiClassObjectProperty{ hstring{name}, nullptr, WinMgmt::PropertyType::Unknown };
+        return nullptr;
     }
 }
+
+winrt::Windows::Foundation::IInspectable PropertyParser::BoxArray(Wmi::ArrayView const& array)
+{
+    using winrt::Windows::Foundation::PropertyValue;
+    using Wmi::Value;
+
+    switch (Wmi::ElementTypeOf(array))
+    {
+    case Wmi::PropertyType::Int8:
+    case Wmi::PropertyType::UInt8:
+        return ::BoxArray<uint8_t>(array, [](Value v) { return static_cast<uint8_t>(v.AsInt64()); }, &PropertyValue::CreateUInt8Array);
+
+    case Wmi::PropertyType::Int16:
+        return ::BoxArray<int16_t>(array, [](Value v) { return static_cast<int16_t>(v.AsInt64()); }, &PropertyValue::CreateInt16Array);
+
+    case Wmi::PropertyType::Int32:
+        return ::BoxArray<int32_t>(array, [](Value v) { return static_cast<int32_t>(v.AsInt64()); }, &PropertyValue::CreateInt32Array);
+
+    case Wmi::PropertyType::Int64:
+        return ::BoxArray<int64_t>(array, [](Value v) { return v.AsInt64(); }, &PropertyValue::CreateInt64Array);
+
+    case Wmi::PropertyType::UInt16:
+        return ::BoxArray<uint16_t>(array, [](Value v) { return static_cast<uint16_t>(v.AsInt64()); }, &PropertyValue::CreateUInt16Array);
+
+    case Wmi::PropertyType::UInt32:
+        return ::BoxArray<uint32_t>(array, [](Value v) { return static_cast<uint32_t>(v.AsInt64()); }, &PropertyValue::CreateUInt32Array);
+
+    case Wmi::PropertyType::UInt64:
+        return ::BoxArray<uint64_t>(array, [](Value v) { return v.AsUInt64(); }, &PropertyValue::CreateUInt64Array);
+
+    case Wmi::PropertyType::Float:
+        return ::BoxArray<float>(array, [](Value v) { return static_cast<float>(v.AsDouble()); }, &PropertyValue::CreateSingleArray);
+
+    case Wmi::PropertyType::Double:
+        return ::BoxArray<double>(array, [](Value v) { return v.AsDouble(); }, &PropertyValue::CreateDoubleArray);
+
+    case Wmi::PropertyType::Boolean:
+        return ::BoxArray<bool>(array, [](Value v) { return v.AsBoolean(); }, &PropertyValue::CreateBooleanArray);
+
+    case Wmi::PropertyType::DateTime:
+        return ::BoxArray<winrt::Windows::Foundation::DateTime>(array, [](Value v) { return ToDateTime(v.AsInt64()); }, &PropertyValue::CreateDateTimeArray);
+
+    case Wmi::PropertyType::String:
+    case Wmi::PropertyType::Reference:
+        return ::BoxArray<winrt::hstring>(array, [](Value v) { return winrt::hstring{ v.AsString() }; }, &PropertyValue::CreateStringArray);
+
+    default:
+        return nullptr;
+    }
+}
+
+Wmi::Value PropertyParser::Unbox(winrt::Windows::Foundation::IInspectable const& value, winrt::WinMgmt::PropertyType type, winrt::hstring& storage)
+{
+    using namespace winrt;
+
+    if (!value)
+        return Wmi::Value::Null();
+
+    auto wmiType = static_cast<Wmi::PropertyType>(type);
+    switch (wmiType)
+    {
+    case Wmi::PropertyType::Int8:
+    case Wmi::PropertyType::UInt8:
+        return Wmi::Value::FromInt64(unbox_value_or<uint8_t>(value, 0), wmiType);
+
+    case Wmi::PropertyType::Int16:
+        return Wmi::Value::FromInt64(unbox_value_or<int16_t>(value, 0), wmiType);
+
+    case Wmi::PropertyType::Int32:
+        return Wmi::Value::FromInt64(unbox_value_or<int32_t>(value, 0), wmiType);
+
+    case Wmi::PropertyType::Int64:
+        return Wmi::Value::FromInt64(unbox_value_or<int64_t>(value, 0), wmiType);
+
+    case Wmi::PropertyType::UInt16:
+        return Wmi::Value::FromUInt64(unbox_value_or<uint16_t>(value, 0), wmiType);
+
+    case Wmi::PropertyType::UInt32:
+        return Wmi::Value::FromUInt64(unbox_value_or<uint32_t>(value, 0), wmiType);
+
+    case Wmi::PropertyType::UInt64:
+        return Wmi::Value::FromUInt64(unbox_value_or<uint64_t>(value, 0), wmiType);
+
+    case Wmi::PropertyType::Float:
+        return Wmi::Value::FromDouble(unbox_value_or<float>(value, 0.0f), wmiType);
+
+    case Wmi::PropertyType::Double:
+        return Wmi::Value::FromDouble(unbox_value_or<double>(value, 0.0), wmiType);
+
+    case Wmi::PropertyType::Boolean:
+        return Wmi::Value::FromBoolean(unbox_value_or<bool>(value, false));
+
+    case Wmi::PropertyType::String:
+    case Wmi::PropertyType::Reference:
+        storage = unbox_value_or<hstring>(value, hstring{});
+        return Wmi::Value::FromString(storage, wmiType);
+
+    case Wmi::PropertyType::DateTime:
+    {
+        auto ticks = unbox_value_or<Windows::Foundation::DateTime>(value, {}).time_since_epoch().count();
+        return Wmi::Value::FromInt64((ticks - UnixEpochTicks) / 10, wmiType);
+    }
+
+    default:
+        return Wmi::Value::Unknown();
+    }
+}
+
+void PropertyParser::AppendRow(Wmi::ResultTable& table, IWbemClassObject* object, WmiClassSchema const& schema)
+{
+    _variant_t var;
+
+    table.BeginRow();
+    for (std::size_t i = 0; i < schema.Size(); i++)
+    {
+        auto column = table.AddColumn(schema.Name(i), schema.Type(i));
+
+        var.Clear();
+        winrt::check_hresult(object->Get(schema.Name(i).c_str(), 0, &var, nullptr, nullptr));
+        AppendCell(table, column, var);
+    }
+    table.EndRow();
+}
+
+void PropertyParser::AppendCell(Wmi::ResultTable& table, std::size_t column, VARIANT const& var)
+{
+    table.AppendValue(column, Convert(var, table.GetColumn(column).Type()));
+}
@@ -1,8 +1,35 @@
 #pragma once
 #include "WmiClassObjectProperty.h"
+#include "Core/ResultTable.h"
+#include "Core/VariantConverter.h"
+#include "WmiSchemaCache.h"
 
 struct PropertyParser
 {
-	static winrt::WinMgmt::WmiClassObjectProperty CreateFromVartype(_bstr_t const& name, _variant_t const& var);
-};
+	static winrt::WinMgmt::WmiClassObjectProperty CreateFromVartype(_bstr_t const& name, _variant_t& var);
+
+	// Array and string values take ownership of var's SAFEARRAY or BSTR so the property can expose it without copying.
+	static winrt::WinMgmt::WmiClassObjectProperty CreateFromVartype(winrt::hstring const& name, _variant_t& var,
+		Wmi::PropertyType declared = Wmi::PropertyType::Unknown, Wmi::PropertyType declaredElement = Wmi::PropertyType::Unknown);
+
+	// One hstring per distinct property name for the whole process; names come from
+	// class schemas, so the set stays small.
+	static winrt::hstring InternName(std::wstring_view name);
+
+	static winrt::WinMgmt::WmiClassObjectProperty CreateFromCell(std::shared_ptr<const Wmi::ResultTable> const& table, std::size_t column, std::size_t row);
+
+	static Wmi::Value Convert(VARIANT const& var, Wmi::PropertyType declared = Wmi::PropertyType::Unknown,
+		Wmi::PropertyType declaredElement = Wmi::PropertyType::Unknown) noexcept;
+
+	static Wmi::Value ArrayElement(Wmi::ArrayView const& array, std::size_t index) noexcept;
 
+	static winrt::Windows::Foundation::IInspectable Box(Wmi::Value const& value);
+
+	static winrt::Windows::Foundation::IInspectable BoxArray(Wmi::ArrayView const& array);
+
+	static Wmi::Value Unbox(winrt::Windows::Foundation::IInspectable const& value, winrt::WinMgmt::PropertyType type, winrt::hstring& storage);
+
+	static void AppendRow(Wmi::ResultTable& table, IWbemClassObject* object, WmiClassSchema const& schema);
+
+	static void AppendCell(Wmi::ResultTable& table, std::size_t column, VARIANT const& var);
+};
@@ -12,8 +12,48 @@ namespace winrt::WinMgmt::implementation
     {
         m_object.copy_from(pObject);
     }
-    [[nodiscard]] Windows::Foundation::Collections::IVectorView<WinMgmt::WmiClassObjectProperty> WmiClassObject::Properties() const noexcept
+
+    WmiClassObject::WmiClassObject(IWbemClassObject* pObject, WmiClassSchemaPtr schema, Wmi::AccessRecorderPtr recorder)
+        : m_schema(std::move(schema)), m_recorder(std::move(recorder))
+    {
+        m_object.copy_from(pObject);
+    }
+
+    WmiClassObject::WmiClassObject(std::shared_ptr<const Wmi::ResultTable> table, std::size_t row, Wmi::AccessRecorderPtr recorder)
+        : m_table(std::move(table)), m_row(row), m_recorder(std::move(recorder))
     {
+    }
+
+    [[nodiscard]] Windows::Foundation::Collections::IVectorView<WinMgmt::WmiClassObjectProperty> WmiClassObject::Properties() const
+    {
+        if (m_recorder)
+            m_recorder->ReadAll();
+
+        if (m_table)
+        {
+            auto props = single_threaded_vector<WinMgmt::WmiClassObjectProperty>();
+            for (std::size_t i = 0; i < m_table->ColumnCount(); ++i)
+                props.Append(m_properties.Get(m_table->GetColumn(i).Name(), [&] { return PropertyParser::CreateFromCell(m_table, i, m_row); }));
+
+            return props.GetView();
+        }
+
+        if (m_schema)
+        {
+            _variant_t var;
+
+            auto props = single_threaded_vector<WinMgmt::WmiClassObjectProperty>();
+            for (std::size_t i = 0; i < m_schema->Size(); ++i)
+            {
+                props.Append(m_properties.Get(m_schema->Name(i), [&] {
+                    var.Clear();
+                    winrt::check_hresult(m_object->Get(m_schema->Name(i).c_str(), 0, &var, nullptr, nullptr));
+                    return PropertyParser::CreateFromVartype(m_schema->Name(i), var, m_schema->Type(i), m_schema->ElementType(i));
+                }));
+            }
+            return props.GetView();
+        }
+
         winrt::check_hresult(m_object->BeginEnumeration(WBEM_FLAG_NONSYSTEM_ONLY));
 
         _bstr_t name;
@@ -28,7 +68,8 @@ namespace winrt::WinMgmt::implementation
             HRESULT hr = m_object->Next(0, &name.GetBSTR(), &var, nullptr, nullptr);
             if (hr == WBEM_S_NO_ERROR) [[likely]]
             {
-                props.Append(PropertyParser::CreateFromVartype(name, var));
+                std::wstring_view key{ static_cast<const wchar_t*>(name), name.length() };
+                props.Append(m_properties.Get(key, [&] { return PropertyParser::CreateFromVartype(name, var); }));
             }
             else
             {
@@ -40,9 +81,42 @@ namespace winrt::WinMgmt::implementation
 
     [[nodiscard]] WinMgmt::WmiClassObjectProperty WmiClassObject::GetProperty(hstring const& name)
     {
+        try
+        {
+            auto property = m_properties.Get(name, [&] { return convert(name); });
+            if (m_recorder)
+                m_recorder->Read(name, true);
+
+            return property;
+        }
+        catch (...)
+        {
+            if (m_recorder)
+                m_recorder->Read(name, false);
+            throw;
+        }
+    }
+
+    WinMgmt::WmiClassObjectProperty WmiClassObject::convert(hstring const& name) const
+    {
+        if (m_table)
+        {
+            auto column = m_table->Find(name);
+            if (!column) [[unlikely]]
+                throw winrt::hresult_error(WBEM_E_NOT_FOUND, L"property not found");
+
+            return PropertyParser::CreateFromCell(m_table, *column, m_row);
+        }
+
         _variant_t var;
         winrt::check_hresult(m_object->Get(name.c_str(), 0, &var, nullptr, nullptr));
 
-        return PropertyParser::CreateFromVartype(name.c_str(), var);
+        if (m_schema)
+        {
+            if (auto index = m_schema->Find(name))
+                return PropertyParser::CreateFromVartype(m_schema->Name(*index), var, m_schema->Type(*index), m_schema->ElementType(*index));
+        }
+
+        return PropertyParser::CreateFromVartype(name, var);
     }
 }
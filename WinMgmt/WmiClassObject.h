@@ -2,6 +2,12 @@
 
 #include "WmiClassObject.g.h"
 #include "WmiClassObjectProperty.h"
+#include "Core/Projection.h"
+#include "Core/PropertyCache.h"
+#include "Core/ResultTable.h"
+#include "WmiSchemaCache.h"
+
+#include <memory>
 
 namespace winrt::WinMgmt::implementation
 {
@@ -9,12 +15,35 @@ namespace winrt::WinMgmt::implementation
     {
         WmiClassObject() = default;
         WmiClassObject(IWbemClassObject* pObject);
+        WmiClassObject(IWbemClassObject* pObject, WmiClassSchemaPtr schema, Wmi::AccessRecorderPtr recorder = nullptr);
+        WmiClassObject(std::shared_ptr<const Wmi::ResultTable> table, std::size_t row, Wmi::AccessRecorderPtr recorder = nullptr);
 
-        Windows::Foundation::Collections::IVectorView<WinMgmt::WmiClassObjectProperty> Properties() const noexcept;
+        Windows::Foundation::Collections::IVectorView<WinMgmt::WmiClassObjectProperty> Properties() const;
         WinMgmt::WmiClassObjectProperty GetProperty(hstring const& name);
 
+        // Backing table of a table-backed object, null for live IWbemClassObject wrappers.
+        std::shared_ptr<const Wmi::ResultTable> const& Table() const noexcept { return m_table; }
+
+        Wmi::AccessRecorderPtr const& Recorder() const noexcept { return m_recorder; }
+
+        // Properties converted so far, and reads answered from the cache.
+        Wmi::PropertyCacheStats PropertyStats() const noexcept { return m_properties.Stats(); }
+
+    private:
+        WinMgmt::WmiClassObjectProperty convert(hstring const& name) const;
+
     private:
         winrt::com_ptr<IWbemClassObject> m_object{ nullptr };
+        WmiClassSchemaPtr m_schema;
+
+        std::shared_ptr<const Wmi::ResultTable> m_table;
+        std::size_t m_row = 0;
+
+        // Set when the data context tracks which properties are read (projection pushdown).
+        Wmi::AccessRecorderPtr m_recorder;
+
+        // Each property is fetched and converted on first read only.
+        mutable Wmi::PropertyCache<WinMgmt::WmiClassObjectProperty> m_properties;
     };
 }
 
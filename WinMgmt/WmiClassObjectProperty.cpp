@@ -4,18 +4,38 @@
 #include "WmiClassObjectProperty.g.cpp"
 #endif
 
+#include "PropertyParser.h"
+
 namespace winrt::WinMgmt::implementation
 {
 	WmiClassObjectProperty::WmiClassObjectProperty(winrt::hstring name, Windows::Foundation::IInspectable const& value, PropertyType type)
-		: m_name(name), m_value(value), m_type(type) {}
+		: m_name(name), m_type(type)
+	{
+		m_raw = PropertyParser::Unbox(value, type, m_text);
+		std::call_once(m_boxed, [&] { m_value = value; });
+	}
+
+	WmiClassObjectProperty::WmiClassObjectProperty(winrt::hstring name, Wmi::Value value, std::shared_ptr<const void> owner)
+		: m_name(std::move(name)), m_type(static_cast<PropertyType>(value.Type())), m_raw(value), m_owner(std::move(owner))
+	{
+		if (m_raw.Storage() == Wmi::StorageKind::String && !m_owner)
+		{
+			m_text = winrt::hstring{ m_raw.AsString() };
+			m_raw = Wmi::Value::FromString(m_text, m_raw.Type());
+		}
+	}
 
 	winrt::hstring WmiClassObjectProperty::Name() const noexcept
 	{
 		return m_name;
 	}
 
-	winrt::Windows::Foundation::IInspectable WmiClassObjectProperty::Value() const noexcept
+	// Boxing is deferred until a caller (typically a XAML binding) asks for an object.
+	winrt::Windows::Foundation::IInspectable WmiClassObjectProperty::Value() const
 	{
+		std::call_once(m_boxed, [this] {
+			m_value = m_raw.Storage() == Wmi::StorageKind::String ? winrt::box_value(AsString()) : PropertyParser::Box(m_raw);
+		});
 		return m_value;
 	}
 
@@ -23,4 +43,46 @@ namespace winrt::WinMgmt::implementation
 	{
 		return m_type;
 	}
+
+	PropertyType WmiClassObjectProperty::ElementType() const noexcept
+	{
+		return static_cast<PropertyType>(m_raw.ElementType());
+	}
+
+	int64_t WmiClassObjectProperty::AsInt64() const noexcept
+	{
+		return m_raw.AsInt64();
+	}
+
+	uint64_t WmiClassObjectProperty::AsUInt64() const noexcept
+	{
+		return m_raw.AsUInt64();
+	}
+
+	double WmiClassObjectProperty::AsDouble() const noexcept
+	{
+		return m_raw.AsDouble();
+	}
+
+	bool WmiClassObjectProperty::AsBoolean() const noexcept
+	{
+		return m_raw.AsBoolean();
+	}
+
+	winrt::hstring WmiClassObjectProperty::AsString() const
+	{
+		if (m_raw.Storage() != Wmi::StorageKind::String)
+			return m_text;
+
+		std::call_once(m_copied, [this] {
+			if (m_text.empty())
+				m_text = winrt::hstring{ m_raw.AsString() };
+		});
+		return m_text;
+	}
+
+	Wmi::Value WmiClassObjectProperty::Raw() const noexcept
+	{
+		return m_raw;
+	}
 }
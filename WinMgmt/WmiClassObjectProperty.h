@@ -1,6 +1,10 @@
 ﻿#pragma once
 
 #include "WmiClassObjectProperty.g.h"
+#include "Core/WmiValue.h"
+
+#include <memory>
+#include <mutex>
 
 namespace winrt::WinMgmt::implementation
 {
@@ -9,16 +13,36 @@ namespace winrt::WinMgmt::implementation
         WmiClassObjectProperty() = default;
         WmiClassObjectProperty(winrt::hstring name, winrt::Windows::Foundation::IInspectable const& value, PropertyType type);
 
+        // owner keeps the storage behind string and array values alive; without one strings are copied.
+        WmiClassObjectProperty(winrt::hstring name, Wmi::Value value, std::shared_ptr<const void> owner);
+
         winrt::hstring Name() const noexcept;
 
-        Windows::Foundation::IInspectable Value() const noexcept;
+        Windows::Foundation::IInspectable Value() const;
         
         PropertyType Type() const noexcept;
+        PropertyType ElementType() const noexcept;
+
+        int64_t AsInt64() const noexcept;
+        uint64_t AsUInt64() const noexcept;
+        double AsDouble() const noexcept;
+        bool AsBoolean() const noexcept;
+        winrt::hstring AsString() const;
+
+        Wmi::Value Raw() const noexcept;
 
     private:
         winrt::hstring m_name;
-        PropertyType m_type;
-        Windows::Foundation::IInspectable m_value{ nullptr };
+        PropertyType m_type{ PropertyType::Null };
+        Wmi::Value m_raw;
+        std::shared_ptr<const void> m_owner;
+
+        // Strings viewed over the owner are copied into an hstring once, when first asked for.
+        mutable std::once_flag m_copied;
+        mutable winrt::hstring m_text;
+
+        mutable std::once_flag m_boxed;
+        mutable Windows::Foundation::IInspectable m_value{ nullptr };
     };
 }
 
@@ -0,0 +1,109 @@
+#include "pch.h"
+#include "WmiConnectionPool.h"
+
+namespace
+{
+    // A proxy may only be called from the apartment it was obtained in: each STA is
+    // its own apartment, every MTA thread shares one. Thread ids are multiples of 4,
+    // so they cannot collide with the MTA and neutral scopes.
+    std::uint64_t CurrentApartment() noexcept
+    {
+        APTTYPE type{};
+        APTTYPEQUALIFIER qualifier{};
+        if (FAILED(CoGetApartmentType(&type, &qualifier)))
+            return 0;
+
+        switch (type)
+        {
+        case APTTYPE_STA:
+        case APTTYPE_MAINSTA:
+            return GetCurrentThreadId();
+        case APTTYPE_NA:
+            return 1;
+        default:
+            return 0;
+        }
+    }
+}
+
+WmiServices WmiConnector::Connect(Wmi::ConnectionKey const& key)
+{
+    winrt::com_ptr<IWbemLocator> locator;
+    winrt::check_hresult(CoCreateInstance(
+        CLSID_WbemLocator,
+        NULL,
+        CLSCTX_INPROC_SERVER,
+        __uuidof(IWbemLocator),
+        locator.put_void()
+    ));
+
+    std::wstring path = key.server.empty() ? key.ns : L"\\\\" + key.server + L"\\" + key.ns;
+
+    WmiServices services;
+    winrt::check_hresult(locator->ConnectServer(
+        _bstr_t(path.c_str()),
+        key.user.empty() ? _bstr_t() : _bstr_t(key.user.c_str()),
+        NULL,
+        0,
+        NULL,
+        0,
+        0,
+        services.put()
+    ));
+
+    WmiConnectionPool::SetProxyBlanket(services.get());
+
+    return services;
+}
+
+bool WmiConnector::IsHealthy(WmiServices const& services)
+{
+    // __SystemClass exists in every namespace and is served without touching a provider.
+    winrt::com_ptr<IWbemClassObject> probe;
+    return SUCCEEDED(services->GetObject(_bstr_t(L"__SystemClass"), 0, NULL, probe.put(), NULL));
+}
+
+[[nodiscard]] Wmi::ConnectionPool<WmiServices>& WmiConnectionPool::Instance()
+{
+    static Wmi::ConnectionPool<WmiServices> pool{ std::make_shared<WmiConnector>(), std::chrono::seconds{ 30 }, &std::chrono::steady_clock::now, &CurrentApartment };
+    return pool;
+}
+
+void WmiConnectionPool::SetProxyBlanket(IUnknown* proxy)
+{
+    winrt::check_hresult(CoSetProxyBlanket(
+        proxy,
+        RPC_C_AUTHN_WINNT,
+        RPC_C_AUTHZ_NONE,
+        NULL,
+        RPC_C_AUTHN_LEVEL_CALL,
+        RPC_C_IMP_LEVEL_IMPERSONATE,
+        NULL,
+        EOAC_NONE
+    ));
+}
+
+void WmiConnectionPool::CancelAsyncCall(AgileServices const& services, IWbemObjectSink* sink) noexcept
+{
+    // Cancellation fires on whatever thread the token or timeout was on, so the call
+    // goes through this apartment's proxy, which needs the blanket set again.
+    try
+    {
+        if (auto proxy = services.get())
+        {
+            SetProxyBlanket(proxy.get());
+            proxy->CancelAsyncCall(sink);
+        }
+    }
+    catch (...)
+    {
+    }
+}
+
+[[nodiscard]] bool WmiConnectionPool::IsTransportError(HRESULT hr) noexcept
+{
+    return hr == RPC_E_DISCONNECTED
+        || hr == HRESULT_FROM_WIN32(RPC_S_SERVER_UNAVAILABLE)
+        || hr == HRESULT_FROM_WIN32(RPC_S_CALL_FAILED)
+        || hr == WBEM_E_TRANSPORT_FAILURE;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include "Core/ConnectionPool.h"
+
+using WmiServices = winrt::com_ptr<IWbemServices>;
+
+// A WmiServices that can be resolved in any apartment.
+using AgileServices = winrt::agile_ref<IWbemServices>;
+
+struct WmiConnector : Wmi::IConnector<WmiServices>
+{
+	WmiServices Connect(Wmi::ConnectionKey const& key) override;
+
+	bool IsHealthy(WmiServices const& services) override;
+};
+
+struct WmiConnectionPool
+{
+	static Wmi::ConnectionPool<WmiServices>& Instance();
+
+	// RPC failures that mean the connection itself is gone rather than the call.
+	static bool IsTransportError(HRESULT hr) noexcept;
+
+	// Every proxy obtained from a pooled connection needs the same blanket.
+	static void SetProxyBlanket(IUnknown* proxy);
+
+	// Cancels the async call delivering to sink from any thread; failures are ignored,
+	// the call is ending either way.
+	static void CancelAsyncCall(AgileServices const& services, IWbemObjectSink* sink) noexcept;
+};
@@ -4,47 +4,111 @@
 #include "WmiDataContext.g.cpp"
 #endif
 
+#include "PropertyParser.h"
+#include "WmiEnumSource.h"
+#include "WmiEventSink.h"
+#include "WmiExecutor.h"
+#include "WmiPlanCache.h"
+#include "WmiProjectionAdvisor.h"
 #include "WmiQuerySink.h"
+#include "WmiResultCache.h"
+#include "WmiRowCollection.h"
+#include "WmiSchemaCache.h"
+#include "WmiStreamSink.h"
+#include "WmiTableSink.h"
+#include "WmiWbemBackend.h"
+#include "Core/Predicate.h"
+#include "Core/ReplayBackend.h"
+#include "Core/ResultExporter.h"
+#include "Core/SnapshotDiff.h"
+#include "Core/SnapshotFile.h"
+
+#include <filesystem>
+#include <fstream>
+
+static_assert(static_cast<int>(winrt::WinMgmt::WmiExportFormat::Csv) == static_cast<int>(Wmi::ExportFormat::Csv),
+    "Wmi::ExportFormat must mirror WinMgmt.WmiExportFormat");
 
 namespace winrt::WinMgmt::implementation
 {
-    WmiDataContext::WmiDataContext()
-    {
-        initialize();
-    }
-
-    void WmiDataContext::initialize()
-    {
-        winrt::com_ptr<IWbemLocator> locator;
-        winrt::check_hresult(CoCreateInstance(
-            CLSID_WbemLocator,
-            NULL,
-            CLSCTX_INPROC_SERVER,
-            __uuidof(IWbemLocator),
-            locator.put_void()
-        ));
-
-        winrt::check_hresult(locator->ConnectServer(
-            _bstr_t(m_namespace.c_str()),
-            NULL,
-            NULL,
-            0,
-            NULL,
-            0,
-            0,
-            m_services.put()
-        ));
-
-        winrt::check_hresult(CoSetProxyBlanket(
-            m_services.get(),
-            RPC_C_AUTHN_WINNT,
-            RPC_C_AUTHZ_NONE,
-            NULL,
-            RPC_C_AUTHN_LEVEL_CALL,
-            RPC_C_IMP_LEVEL_IMPERSONATE,
-            NULL,
-            EOAC_NONE
-        ));
+    // Connections come from the process-wide pool on first use, so constructing a
+    // context is free and a Namespace or Server change takes effect on the next query.
+    Wmi::ConnectionKey WmiDataContext::connectionKey() const
+    {
+        return { std::wstring{ m_server }, std::wstring{ m_namespace }, {} };
+    }
+
+    Wmi::ResultTablePtr WmiDataContext::tableOf(winrt::Windows::Foundation::Collections::IVectorView<winrt::WinMgmt::WmiClassObject> const& results)
+    {
+        static const auto empty = std::make_shared<const Wmi::ResultTable>();
+        if (results.Size() == 0)
+            return empty;
+
+        // Table-backed results list every row of one table in order, so a row index
+        // is also the index of its existing object.
+        auto const& table = winrt::get_self<WmiClassObject>(results.GetAt(0))->Table();
+        if (!table || table->RowCount() != results.Size()) [[unlikely]]
+            throw winrt::hresult_invalid_argument(L"expected a complete QueryTableAsync, QueryCachedAsync or Filter result");
+
+        return table;
+    }
+
+    WmiServices WmiDataContext::execQuery(hstring const& query, IWbemObjectSink* sink) const
+    {
+        return WmiWbemBackend::Start(connectionKey(), query, sink);
+    }
+
+    std::wstring WmiDataContext::cacheKey(hstring const& query) const
+    {
+        return WmiResultCache::Key(m_server, m_backendId, m_namespace, query, m_projectionPushdown && !m_backend);
+    }
+
+    Wmi::PreparedQuery WmiDataContext::prepare(hstring const& query, Wmi::Wql::PlanLookup const& lookup) const
+    {
+        if (!m_projectionPushdown)
+            return { std::wstring{ query }, nullptr };
+
+        return WmiProjectionAdvisor::Instance().Prepare(WmiProjectionAdvisor::Key(m_namespace, *lookup.plan), query, lookup.plan->query);
+    }
+
+    WmiDataContext::WmiDataContext(std::shared_ptr<Wmi::IQueryBackend> backend)
+        : m_backend(std::move(backend)), m_backendId(WmiResultCache::NewBackendId())
+    {
+    }
+
+    Wmi::ReplayOptions WmiDataContext::replayOptions(winrt::Windows::Foundation::TimeSpan const& latency, uint32_t objectCount) noexcept
+    {
+        Wmi::ReplayOptions options;
+        options.latency = std::chrono::duration_cast<std::chrono::microseconds>(latency);
+        options.objectCount = objectCount;
+        return options;
+    }
+
+    winrt::WinMgmt::WmiDataContext WmiDataContext::FromSnapshot(hstring const& snapshot, winrt::Windows::Foundation::TimeSpan const& latency, uint32_t objectCount)
+    {
+        auto backend = std::make_shared<Wmi::ReplayBackend>(replayOptions(latency, objectCount));
+        backend->Load(snapshot);
+
+        return winrt::make<WmiDataContext>(std::move(backend));
+    }
+
+    winrt::WinMgmt::WmiDataContext WmiDataContext::FromSnapshotFile(hstring const& path, winrt::Windows::Foundation::TimeSpan const& latency, uint32_t objectCount)
+    {
+        auto backend = std::make_shared<Wmi::ReplayBackend>(replayOptions(latency, objectCount));
+        backend->Load(Wmi::SnapshotReader::Open(std::filesystem::path{ std::wstring_view{ path } }));
+
+        return winrt::make<WmiDataContext>(std::move(backend));
+    }
+
+    // Non-live backends only produce tables, so every query shape is served as table rows.
+    winrt::Windows::Foundation::IAsyncOperation<winrt::Windows::Foundation::Collections::IVectorView<winrt::WinMgmt::WmiClassObject>> WmiDataContext::backendQueryAsync(hstring query)
+    {
+        auto backend = m_backend;
+        auto ns = m_namespace;
+
+        co_await winrt::resume_background();
+
+        co_return WmiTableSink::Rows(backend->Execute(ns, query));
     }
 
     void WmiDataContext::Namespace(hstring const& value)
@@ -60,22 +124,399 @@ namespace winrt::WinMgmt::implementation
         return m_namespace;
     }
 
+    void WmiDataContext::Server(hstring const& value)
+    {
+        m_server = value;
+    }
+
+    [[nodiscard]] hstring WmiDataContext::Server() const noexcept
+    {
+        return m_server;
+    }
+
+    void WmiDataContext::ProjectionPushdown(bool value) noexcept
+    {
+        m_projectionPushdown = value;
+    }
+
+    [[nodiscard]] bool WmiDataContext::ProjectionPushdown() const noexcept
+    {
+        return m_projectionPushdown;
+    }
+
+    void WmiDataContext::ExecutionMode(winrt::WinMgmt::WmiExecutionMode value) noexcept
+    {
+        m_executionMode = value;
+    }
+
+    [[nodiscard]] winrt::WinMgmt::WmiExecutionMode WmiDataContext::ExecutionMode() const noexcept
+    {
+        return m_executionMode;
+    }
+
+    void WmiDataContext::Timeout(winrt::Windows::Foundation::TimeSpan const& value) noexcept
+    {
+        m_timeout = value;
+    }
+
+    [[nodiscard]] winrt::Windows::Foundation::TimeSpan WmiDataContext::Timeout() const noexcept
+    {
+        return m_timeout;
+    }
+
+    void WmiDataContext::SetProjection(hstring const& query, winrt::Windows::Foundation::Collections::IIterable<hstring> const& properties)
+    {
+        auto key = WmiProjectionAdvisor::Key(m_namespace, *WmiPlanCache::Resolve(query).plan);
+        if (!properties)
+            return WmiProjectionAdvisor::Instance().Disable(key);
+
+        std::vector<std::wstring> names;
+        for (auto const& property : properties)
+            names.emplace_back(property);
+
+        WmiProjectionAdvisor::Instance().Pin(key, std::move(names));
+    }
+
+    void WmiDataContext::UseStringPool(std::shared_ptr<Wmi::StringPool> strings) noexcept
+    {
+        m_strings = std::move(strings);
+    }
+
+    void WmiDataContext::ResetProjection(hstring const& query)
+    {
+        WmiProjectionAdvisor::Instance().Reset(WmiProjectionAdvisor::Key(m_namespace, *WmiPlanCache::Resolve(query).plan));
+    }
+
     [[nodiscard]] winrt::Windows::Foundation::IAsyncOperation<winrt::Windows::Foundation::Collections::IVectorView<winrt::WinMgmt::WmiClassObject>>WmiDataContext::QueryAsync(hstring const& query)
     {
-        if (!m_services) [[unlikely]]
-            throw winrt::hresult_error(E_POINTER, L"data context services is null!");
+        auto lookup = WmiPlanCache::Resolve(query);
+
+        if (m_backend)
+            co_return co_await backendQueryAsync(query);
+
+        auto prepared = prepare(query, lookup);
+        if (m_executionMode == winrt::WinMgmt::WmiExecutionMode::Semisynchronous)
+            co_return co_await pullQueryAsync(std::move(prepared), false);
+
+        auto timeout = m_timeout;
+        auto cancellation = co_await winrt::get_cancellation_token();
+
+        hstring text{ prepared.text };
+        auto sink = winrt::make_self<WmiQuerySink>(WmiSchemaScope{ m_namespace, text }, prepared.recorder);
+        sink->Started(execQuery(text, sink.get()));
 
-        auto sink = winrt::make_self<WmiQuerySink>();
-        winrt::check_hresult(m_services->ExecQueryAsync(
-            _bstr_t(L"WQL"),
-            _bstr_t(query.c_str()),
-            0,
-            NULL,
-            sink.get()
-        ));
+        // Cancelling the operation stops the provider call and frees what it delivered so far.
+        cancellation.callback([sink] { sink->Call().Cancel(WBEM_E_CALL_CANCELLED); });
 
-        co_await sink->WaitAsync();
+        co_await sink->WaitAsync(timeout);
 
         co_return sink->Results();
     }
+
+    winrt::Windows::Foundation::IAsyncOperation<winrt::Windows::Foundation::Collections::IVectorView<winrt::WinMgmt::WmiClassObject>> WmiDataContext::pullQueryAsync(Wmi::PreparedQuery prepared, bool asTable)
+    {
+        auto key = connectionKey();
+        hstring text{ prepared.text };
+        WmiSchemaScope schemas{ m_namespace, text };
+        auto strings = m_strings;
+        auto deadline = WmiEnumSource::DeadlineAfter(m_timeout);
+        auto cancellation = co_await winrt::get_cancellation_token();
+
+        co_await winrt::resume_background();
+
+        // The default policy sizes pulls adaptively, so fast providers get large
+        // batches and slow ones still deliver objects promptly.
+        WmiPullEnumerator enumerator{ WmiEnumSource{ WmiWbemBackend::StartForwardOnly(key, text) } };
+        enumerator.GetSource().Limit(deadline, [cancellation] { return cancellation(); });
+
+        if (asTable)
+        {
+            auto table = std::make_shared<Wmi::ResultTable>(std::move(strings));
+            for (auto const& object : enumerator)
+            {
+                auto schema = schemas.Resolve(object.get());
+                PropertyParser::AppendRow(*table, object.get(), *schema);
+            }
+            winrt::check_hresult(enumerator.Status());
+
+            co_return WmiTableSink::Rows(table, prepared.recorder);
+        }
+
+        auto rows = std::make_shared<Wmi::RowArena<winrt::com_ptr<IWbemClassObject>>>();
+        for (auto const& object : enumerator)
+        {
+            rows->Append(object);
+        }
+        winrt::check_hresult(enumerator.Status());
+
+        co_return WmiQuerySink::Rows(std::move(rows), schemas, prepared.recorder);
+    }
+
+    [[nodiscard]] winrt::Windows::Foundation::IAsyncOperation<winrt::Windows::Foundation::Collections::IVectorView<winrt::WinMgmt::WmiClassObject>> WmiDataContext::QueryTableAsync(hstring const& query)
+    {
+        auto lookup = WmiPlanCache::Resolve(query);
+
+        if (m_backend)
+            co_return co_await backendQueryAsync(query);
+
+        auto prepared = prepare(query, lookup);
+        if (m_executionMode == winrt::WinMgmt::WmiExecutionMode::Semisynchronous)
+            co_return co_await pullQueryAsync(std::move(prepared), true);
+
+        auto timeout = m_timeout;
+        auto cancellation = co_await winrt::get_cancellation_token();
+
+        hstring text{ prepared.text };
+        auto sink = winrt::make_self<WmiTableSink>(WmiSchemaScope{ m_namespace, text }, m_strings);
+        sink->Started(execQuery(text, sink.get()));
+
+        cancellation.callback([sink] { sink->Call().Cancel(WBEM_E_CALL_CANCELLED); });
+
+        co_await sink->WaitAsync(timeout);
+
+        co_return WmiTableSink::Rows(sink->TakeTable(), prepared.recorder);
+    }
+
+    [[nodiscard]] winrt::WinMgmt::WmiQueryStream WmiDataContext::QueryStream(hstring const& query, uint32_t batchSize)
+    {
+        auto lookup = WmiPlanCache::Resolve(query);
+
+        if (m_backend) [[unlikely]]
+            throw winrt::hresult_not_implemented(L"streaming is only available against winmgmt");
+
+        auto prepared = prepare(query, lookup);
+        hstring text{ prepared.text };
+        WmiSchemaScope schemas{ m_namespace, text };
+
+        if (m_executionMode == winrt::WinMgmt::WmiExecutionMode::Semisynchronous)
+        {
+            auto enumerator = std::make_unique<WmiPullEnumerator>(WmiEnumSource{ WmiWbemBackend::StartForwardOnly(connectionKey(), text) }, Wmi::BatchPolicy{ batchSize });
+            return winrt::make<WmiQueryStream>(std::move(enumerator), std::move(schemas), std::move(prepared.recorder), m_timeout);
+        }
+
+        // A handful of batches in flight is enough to hide provider latency
+        // without letting a slow consumer accumulate the whole result set.
+        constexpr std::size_t maxPendingBatches = 4;
+
+        auto sink = winrt::make_self<WmiStreamSink>(std::move(schemas), std::move(prepared.recorder), batchSize, maxPendingBatches);
+        auto services = execQuery(text, sink.get());
+
+        return winrt::make<WmiQueryStream>(services, std::move(sink));
+    }
+
+    [[nodiscard]] winrt::WinMgmt::WmiEventSubscription WmiDataContext::Subscribe(hstring const& query, uint32_t maxBatch, winrt::Windows::Foundation::TimeSpan const& maxDelay)
+    {
+        WmiPlanCache::Resolve(query);
+
+        if (m_backend) [[unlikely]]
+            throw winrt::hresult_not_implemented(L"event subscriptions are only available against winmgmt");
+
+        // Bounds what an absent consumer can pile up; anything beyond is dropped and
+        // reported through DroppedEvents.
+        constexpr std::size_t maxPendingEvents = 64 * 1024;
+
+        Wmi::EventCoalescerOptions options{ maxBatch, std::chrono::duration_cast<std::chrono::milliseconds>(maxDelay), maxPendingEvents };
+        auto sink = winrt::make_self<WmiEventSink>(WmiSchemaScope{ m_namespace, query }, options);
+        auto services = WmiWbemBackend::StartNotification(connectionKey(), query, sink.get());
+
+        return winrt::make<WmiEventSubscription>(services, std::move(sink));
+    }
+
+    [[nodiscard]] winrt::WinMgmt::WmiFanOutStream WmiDataContext::FanOut(winrt::Windows::Foundation::Collections::IVectorView<hstring> const& namespaces, winrt::Windows::Foundation::Collections::IVectorView<hstring> const& queries, uint32_t maxConcurrency)
+    {
+        if (!namespaces || !queries || namespaces.Size() != queries.Size()) [[unlikely]]
+            throw winrt::hresult_invalid_argument(L"every query needs a namespace");
+
+        std::vector<Wmi::FanOutQuery> pairs;
+        pairs.reserve(queries.Size());
+        for (uint32_t i = 0; i < queries.Size(); ++i)
+        {
+            auto query = queries.GetAt(i);
+            WmiPlanCache::Resolve(query);
+            pairs.push_back({ std::wstring{ namespaces.GetAt(i) }, std::wstring{ query } });
+        }
+
+        // The live backend only holds the server name; connections come from the shared pool.
+        std::shared_ptr<Wmi::IQueryBackend> backend = m_backend;
+        if (!backend)
+            backend = std::make_shared<WmiWbemBackend>(std::wstring{ m_server }, m_timeout, m_strings);
+
+        auto run = Wmi::FanOut::Start(WmiExecutor::Instance(), std::move(backend), std::move(pairs), maxConcurrency);
+        return winrt::make<WmiFanOutStream>(std::move(run));
+    }
+
+    [[nodiscard]] winrt::Windows::Foundation::IAsyncOperation<winrt::Windows::Foundation::Collections::IVectorView<winrt::WinMgmt::WmiClassObject>> WmiDataContext::QueryCachedAsync(hstring query, winrt::Windows::Foundation::TimeSpan ttl)
+    {
+        auto& cache = WmiResultCache::Instance();
+        auto lease = cache.Acquire(cacheKey(query));
+
+        if (lease.IsHit())
+            co_return lease.Get();
+
+        if (!lease.IsLeader())
+        {
+            // Another caller is already running this query; wait for its result off the caller's thread.
+            co_await winrt::resume_background();
+            co_return lease.Get();
+        }
+
+        try
+        {
+            // Table-backed results do not reference IWbemClassObject, so one result
+            // can be handed to callers on any thread.
+            auto result = co_await QueryTableAsync(query);
+            cache.Publish(lease, result, ttl);
+            co_return result;
+        }
+        catch (...)
+        {
+            cache.Fail(lease, std::current_exception());
+            throw;
+        }
+    }
+
+    void WmiDataContext::InvalidateCachedQuery(hstring const& query)
+    {
+        WmiResultCache::Instance().Invalidate(cacheKey(query));
+    }
+
+    winrt::Windows::Foundation::Collections::IVectorView<winrt::WinMgmt::WmiClassObject> WmiDataContext::Filter(winrt::Windows::Foundation::Collections::IVectorView<winrt::WinMgmt::WmiClassObject> const& results, hstring const& condition)
+    {
+        auto predicate = Wmi::Predicate::Compile(condition);
+        if (results.Size() == 0 || predicate.SelectsAll())
+            return results;
+
+        auto table = tableOf(results);
+        auto selected = predicate.Evaluate(*table);
+
+        std::vector<uint32_t> rows;
+        rows.reserve(selected.Count());
+        selected.ForEach([&](std::size_t row) { rows.push_back(static_cast<uint32_t>(row)); });
+
+        // The selected rows get a table of their own, so the result can be filtered,
+        // diffed or exported again like any QueryTableAsync result.
+        auto const& recorder = winrt::get_self<WmiClassObject>(results.GetAt(0))->Recorder();
+        return WmiTableSink::Rows(std::make_shared<const Wmi::ResultTable>(table->Select(rows)), recorder);
+    }
+
+    winrt::WinMgmt::WmiSnapshotDiff WmiDataContext::Diff(winrt::Windows::Foundation::Collections::IVectorView<winrt::WinMgmt::WmiClassObject> const& before, winrt::Windows::Foundation::Collections::IVectorView<winrt::WinMgmt::WmiClassObject> const& after, winrt::Windows::Foundation::Collections::IIterable<hstring> const& keyProperties)
+    {
+        std::vector<std::wstring> keys;
+        if (keyProperties)
+        {
+            for (auto const& key : keyProperties)
+                keys.emplace_back(key);
+        }
+
+        if (keys.empty()) [[unlikely]]
+            throw winrt::hresult_invalid_argument(L"name the key properties to match objects on, such as Handle for Win32_Process");
+
+        auto beforeTable = tableOf(before);
+        auto afterTable = tableOf(after);
+
+        Wmi::SnapshotDiffer differ;
+        auto diff = differ.Diff(*beforeTable, *afterTable, keys);
+        return winrt::make<WmiSnapshotDiff>(before, after, diff);
+    }
+
+    winrt::Windows::Foundation::IAsyncOperation<hstring> WmiDataContext::RecordSnapshotAsync(winrt::Windows::Foundation::Collections::IIterable<hstring> queries)
+    {
+        auto backend = m_backend;
+        std::wstring ns{ m_namespace };
+        std::wstring server{ m_server };
+        auto timeout = m_timeout;
+
+        co_await winrt::resume_background();
+
+        Wmi::ReplayBackend recorder;
+        record(recorder, backend, server, ns, timeout, queries);
+
+        co_return hstring{ recorder.Save() };
+    }
+
+    winrt::Windows::Foundation::IAsyncAction WmiDataContext::RecordSnapshotFileAsync(winrt::Windows::Foundation::Collections::IIterable<hstring> queries, hstring path)
+    {
+        auto backend = m_backend;
+        std::wstring ns{ m_namespace };
+        std::wstring server{ m_server };
+        auto timeout = m_timeout;
+
+        co_await winrt::resume_background();
+
+        Wmi::ReplayBackend recorder;
+        record(recorder, backend, server, ns, timeout, queries);
+
+        std::ofstream out{ std::filesystem::path{ std::wstring_view{ path } }, std::ios::binary | std::ios::trunc };
+        if (!out)
+            throw std::runtime_error("cannot create snapshot file");
+
+        Wmi::SnapshotWriter writer{ out };
+        recorder.Save(writer);
+        writer.Finish();
+    }
+
+    winrt::Windows::Foundation::IAsyncOperation<uint64_t> WmiDataContext::ExportAsync(winrt::Windows::Foundation::Collections::IVectorView<winrt::WinMgmt::WmiClassObject> results, hstring path, winrt::WinMgmt::WmiExportFormat format)
+    {
+        co_await winrt::resume_background();
+
+        std::ofstream out{ std::filesystem::path{ std::wstring_view{ path } }, std::ios::binary | std::ios::trunc };
+        if (!out)
+            throw std::runtime_error("cannot create export file");
+
+        Wmi::ResultExporter exporter{ static_cast<Wmi::ExportFormat>(format), out };
+        const auto size = results.Size();
+
+        Wmi::ResultTablePtr table = size > 0 ? winrt::get_self<WmiClassObject>(results.GetAt(0))->Table() : nullptr;
+        if (table && table->RowCount() == size)
+        {
+            exporter.Write(*table);
+        }
+        else if (size > 0)
+        {
+            std::vector<hstring> names;
+            for (auto const& property : results.GetAt(0).Properties())
+                names.push_back(property.Name());
+
+            exporter.Begin(std::vector<std::wstring_view>(names.begin(), names.end()));
+
+            // Properties hold the memory their values view until the row is written.
+            std::vector<WinMgmt::WmiClassObjectProperty> properties(names.size(), nullptr);
+            std::vector<Wmi::Value> values(names.size());
+            for (auto const& row : results)
+            {
+                for (std::size_t c = 0; c < names.size(); ++c)
+                {
+                    try
+                    {
+                        properties[c] = row.GetProperty(names[c]);
+                        values[c] = winrt::get_self<WmiClassObjectProperty>(properties[c])->Raw();
+                    }
+                    catch (winrt::hresult_error const& e)
+                    {
+                        if (e.code() != WBEM_E_NOT_FOUND)
+                            throw;
+                        properties[c] = nullptr;
+                        values[c] = Wmi::Value::Null();
+                    }
+                }
+                exporter.WriteRow(values);
+            }
+        }
+
+        exporter.Finish();
+        co_return exporter.Stats().bytes;
+    }
+
+    void WmiDataContext::record(Wmi::ReplayBackend& recorder, std::shared_ptr<Wmi::IQueryBackend> const& backend, std::wstring const& server,
+                                std::wstring const& ns, winrt::Windows::Foundation::TimeSpan timeout, winrt::Windows::Foundation::Collections::IIterable<hstring> const& queries)
+    {
+        WmiWbemBackend live{ server, timeout };
+        Wmi::IQueryBackend& source = backend ? *backend : live;
+
+        for (auto const& query : queries)
+        {
+            WmiPlanCache::Resolve(query);
+            recorder.Add(ns, query, source.Execute(ns, query));
+        }
+    }
 }
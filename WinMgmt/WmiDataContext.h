@@ -2,26 +2,125 @@
 
 #include "WmiDataContext.g.h"
 #include "WmiClassObject.h"
+#include "WmiEventSubscription.h"
+#include "WmiFanOutStream.h"
+#include "WmiQueryStream.h"
+#include "WmiSnapshotDiff.h"
+#include "WmiConnectionPool.h"
+#include "Core/Projection.h"
+#include "Core/QueryBackend.h"
+#include "Core/ReplayBackend.h"
+#include "Core/StringPool.h"
+#include "Core/WqlPlanCache.h"
 
 namespace winrt::WinMgmt::implementation
 {
     struct WmiDataContext : WmiDataContextT<WmiDataContext>
     {
-        WmiDataContext();
+        WmiDataContext() = default;
+        explicit WmiDataContext(std::shared_ptr<Wmi::IQueryBackend> backend);
+
+        static winrt::WinMgmt::WmiDataContext FromSnapshot(hstring const& snapshot, winrt::Windows::Foundation::TimeSpan const& latency, uint32_t objectCount);
+
+        static winrt::WinMgmt::WmiDataContext FromSnapshotFile(hstring const& path, winrt::Windows::Foundation::TimeSpan const& latency, uint32_t objectCount);
 
         hstring Namespace() const noexcept;
 
         void Namespace(hstring const& value);
 
+        hstring Server() const noexcept;
+
+        void Server(hstring const& value);
+
+        bool ProjectionPushdown() const noexcept;
+
+        void ProjectionPushdown(bool value) noexcept;
+
+        winrt::WinMgmt::WmiExecutionMode ExecutionMode() const noexcept;
+
+        void ExecutionMode(winrt::WinMgmt::WmiExecutionMode value) noexcept;
+
+        winrt::Windows::Foundation::TimeSpan Timeout() const noexcept;
+
+        void Timeout(winrt::Windows::Foundation::TimeSpan const& value) noexcept;
+
+        void SetProjection(hstring const& query, winrt::Windows::Foundation::Collections::IIterable<hstring> const& properties);
+
+        void ResetProjection(hstring const& query);
+
+        // Replaces the pool for tables produced from now on; tables already produced
+        // keep theirs. Lets a caller that makes a context per query share one pool.
+        void UseStringPool(std::shared_ptr<Wmi::StringPool> strings) noexcept;
+
         winrt::Windows::Foundation::IAsyncOperation<winrt::Windows::Foundation::Collections::IVectorView<winrt::WinMgmt::WmiClassObject>> QueryAsync(hstring const& query);
 
+        winrt::Windows::Foundation::IAsyncOperation<winrt::Windows::Foundation::Collections::IVectorView<winrt::WinMgmt::WmiClassObject>> QueryTableAsync(hstring const& query);
+
+        winrt::WinMgmt::WmiQueryStream QueryStream(hstring const& query, uint32_t batchSize);
+
+        winrt::WinMgmt::WmiEventSubscription Subscribe(hstring const& query, uint32_t maxBatch, winrt::Windows::Foundation::TimeSpan const& maxDelay);
+
+        winrt::WinMgmt::WmiFanOutStream FanOut(winrt::Windows::Foundation::Collections::IVectorView<hstring> const& namespaces, winrt::Windows::Foundation::Collections::IVectorView<hstring> const& queries, uint32_t maxConcurrency);
+
+        winrt::Windows::Foundation::IAsyncOperation<winrt::Windows::Foundation::Collections::IVectorView<winrt::WinMgmt::WmiClassObject>> QueryCachedAsync(hstring query, winrt::Windows::Foundation::TimeSpan ttl);
+
+        void InvalidateCachedQuery(hstring const& query);
+
+        static winrt::Windows::Foundation::Collections::IVectorView<winrt::WinMgmt::WmiClassObject> Filter(winrt::Windows::Foundation::Collections::IVectorView<winrt::WinMgmt::WmiClassObject> const& results, hstring const& condition);
+
+        static winrt::WinMgmt::WmiSnapshotDiff Diff(winrt::Windows::Foundation::Collections::IVectorView<winrt::WinMgmt::WmiClassObject> const& before, winrt::Windows::Foundation::Collections::IVectorView<winrt::WinMgmt::WmiClassObject> const& after, winrt::Windows::Foundation::Collections::IIterable<hstring> const& keyProperties);
+
+        winrt::Windows::Foundation::IAsyncOperation<hstring> RecordSnapshotAsync(winrt::Windows::Foundation::Collections::IIterable<hstring> queries);
+
+        winrt::Windows::Foundation::IAsyncAction RecordSnapshotFileAsync(winrt::Windows::Foundation::Collections::IIterable<hstring> queries, hstring path);
+
+        static winrt::Windows::Foundation::IAsyncOperation<uint64_t> ExportAsync(winrt::Windows::Foundation::Collections::IVectorView<winrt::WinMgmt::WmiClassObject> results, hstring path, winrt::WinMgmt::WmiExportFormat format);
+
     private:
 
-        void initialize();
-        
+        Wmi::ConnectionKey connectionKey() const;
+
+        // The table behind a complete table-backed result; an empty table for an empty result.
+        static Wmi::ResultTablePtr tableOf(winrt::Windows::Foundation::Collections::IVectorView<winrt::WinMgmt::WmiClassObject> const& results);
+
+        static Wmi::ReplayOptions replayOptions(winrt::Windows::Foundation::TimeSpan const& latency, uint32_t objectCount) noexcept;
+
+        // Runs each query against the context's backend, or a live one, on the calling thread.
+        static void record(Wmi::ReplayBackend& recorder, std::shared_ptr<Wmi::IQueryBackend> const& backend, std::wstring const& server,
+                           std::wstring const& ns, winrt::Windows::Foundation::TimeSpan timeout, winrt::Windows::Foundation::Collections::IIterable<hstring> const& queries);
+
+        // Starts query on a pooled connection and returns that connection.
+        WmiServices execQuery(hstring const& query, IWbemObjectSink* sink) const;
+
+        // Applies projection pushdown to a resolved query when it is enabled.
+        Wmi::PreparedQuery prepare(hstring const& query, Wmi::Wql::PlanLookup const& lookup) const;
+
+        // The result cache key of query. Backends replay the recorded text, so only live
+        // queries are ever projected.
+        std::wstring cacheKey(hstring const& query) const;
+
+        winrt::Windows::Foundation::IAsyncOperation<winrt::Windows::Foundation::Collections::IVectorView<winrt::WinMgmt::WmiClassObject>> backendQueryAsync(hstring query);
+
+        // Semisynchronous execution: pulls the whole result on a background thread into
+        // objects (asTable false) or a ResultTable (asTable true).
+        winrt::Windows::Foundation::IAsyncOperation<winrt::Windows::Foundation::Collections::IVectorView<winrt::WinMgmt::WmiClassObject>> pullQueryAsync(Wmi::PreparedQuery prepared, bool asTable);
+
     private:
-        winrt::com_ptr<IWbemServices> m_services{ nullptr };
+        // Null for the live winmgmt path, which keeps IWbemClassObject-backed results and streaming.
+        std::shared_ptr<Wmi::IQueryBackend> m_backend;
+
+        // Tells this context's cached results apart from other backends'; 0 for winmgmt.
+        uint64_t m_backendId = 0;
         hstring m_namespace{ L"ROOT\\CIMV2" };
+        hstring m_server;
+        bool m_projectionPushdown = false;
+        winrt::WinMgmt::WmiExecutionMode m_executionMode = winrt::WinMgmt::WmiExecutionMode::Asynchronous;
+        winrt::Windows::Foundation::TimeSpan m_timeout{};
+
+        // Shared by every table this context produces, so values repeated across its
+        // rows and queries are stored once. Each table holds a reference, so the pool
+        // lives until the context and the last of its tables are gone.
+        std::shared_ptr<Wmi::StringPool> m_strings{ std::make_shared<Wmi::StringPool>() };
     };
 }
 
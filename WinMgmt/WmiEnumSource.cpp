@@ -0,0 +1,45 @@
+#include "pch.h"
+#include "WmiEnumSource.h"
+
+WmiEnumSource::WmiEnumSource(winrt::com_ptr<IEnumWbemClassObject> enumerator)
+    : m_enumerator(std::move(enumerator))
+{
+}
+
+void WmiEnumSource::Limit(clock::time_point deadline, std::function<bool()> cancelled)
+{
+    m_deadline = deadline;
+    m_cancelled = std::move(cancelled);
+}
+
+[[nodiscard]] WmiEnumSource::clock::time_point WmiEnumSource::DeadlineAfter(winrt::Windows::Foundation::TimeSpan timeout) noexcept
+{
+    return timeout.count() > 0 ? clock::now() + timeout : clock::time_point::max();
+}
+
+std::int32_t WmiEnumSource::Next(std::uint32_t count, winrt::com_ptr<IWbemClassObject>* out, std::uint32_t& returned)
+{
+    returned = 0;
+    if (m_cancelled && m_cancelled())
+        return WBEM_E_CALL_CANCELLED;
+
+    const auto now = clock::now();
+    if (now >= m_deadline)
+        return WBEM_E_TIMED_OUT;
+
+    // A slice that ends with fewer objects returns WBEM_S_TIMEDOUT, and the
+    // enumerator pulls again after the checks above.
+    const auto wait = (std::min)(WaitSlice, std::chrono::ceil<std::chrono::milliseconds>(m_deadline - now));
+
+    m_objects.assign(count, nullptr);
+
+    ULONG fetched = 0;
+    HRESULT hr = m_enumerator->Next(static_cast<long>(wait.count()), count, m_objects.data(), &fetched);
+
+    // Ownership of each returned reference moves into the caller's batch.
+    for (ULONG i = 0; i < fetched; i++)
+        out[i].attach(m_objects[i]);
+
+    returned = fetched;
+    return hr;
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include "Core/PullEnumerator.h"
+
+#include <chrono>
+#include <functional>
+#include <vector>
+
+// Pull source over a forward-only IEnumWbemClassObject for Wmi::PullEnumerator.
+struct WmiEnumSource
+{
+	using clock = std::chrono::steady_clock;
+
+	explicit WmiEnumSource(winrt::com_ptr<IEnumWbemClassObject> enumerator);
+
+	// Next fails with WBEM_E_TIMED_OUT once deadline has passed, and with
+	// WBEM_E_CALL_CANCELLED once cancelled returns true. Both are checked between
+	// waits of at most WaitSlice, so neither is held up by a silent provider.
+	void Limit(clock::time_point deadline, std::function<bool()> cancelled = nullptr);
+
+	std::int32_t Next(std::uint32_t count, winrt::com_ptr<IWbemClassObject>* out, std::uint32_t& returned);
+
+	// The deadline timeout from now; a zero timeout never expires.
+	static clock::time_point DeadlineAfter(winrt::Windows::Foundation::TimeSpan timeout) noexcept;
+
+	static constexpr std::chrono::milliseconds WaitSlice{ 250 };
+
+private:
+	winrt::com_ptr<IEnumWbemClassObject> m_enumerator;
+	std::vector<IWbemClassObject*> m_objects;
+	clock::time_point m_deadline = clock::time_point::max();
+	std::function<bool()> m_cancelled;
+};
+
+using WmiPullEnumerator = Wmi::PullEnumerator<winrt::com_ptr<IWbemClassObject>, WmiEnumSource>;
@@ -0,0 +1,54 @@
+#include "pch.h"
+#include "WmiEventSink.h"
+
+WmiEventSink::WmiEventSink(WmiSchemaScope schemas, Wmi::EventCoalescerOptions const& options)
+    : m_schemas(std::move(schemas)), m_coalescer(options, [this] { ::SetEvent(m_wake.get()); })
+{
+}
+
+HRESULT STDMETHODCALLTYPE WmiEventSink::Indicate(LONG lObjectCount, IWbemClassObject** apObjArray) noexcept
+{
+    if (!apObjArray) [[unlikely]]
+        return E_POINTER;
+
+    try
+    {
+        // Objects are built before taking the coalescer's lock, so the consumer is
+        // only held up for the hand-off of the whole delivery.
+        std::vector<winrt::WinMgmt::WmiClassObject> events;
+        events.reserve(lObjectCount);
+        for (LONG i = 0; i < lObjectCount; i++) [[likely]]
+        {
+            auto schema = m_schemas.Resolve(apObjArray[i]);
+            events.push_back(winrt::make<winrt::WinMgmt::implementation::WmiClassObject>(apObjArray[i], std::move(schema)));
+        }
+
+        // Events past the pending bound are dropped and counted rather than
+        // stalling winmgmt's delivery thread.
+        m_coalescer.PostAll(std::move(events));
+    }
+    catch (...)
+    {
+        return winrt::to_hresult();
+    }
+    return WBEM_S_NO_ERROR;
+}
+
+HRESULT STDMETHODCALLTYPE WmiEventSink::SetStatus(LONG lFlags, HRESULT hResult, BSTR strParam, IWbemClassObject* pObjParam) noexcept
+{
+    // A subscription only completes when it is cancelled or fails.
+    if (lFlags == WBEM_STATUS_COMPLETE)
+        m_coalescer.Complete(hResult);
+
+    return WBEM_S_NO_ERROR;
+}
+
+[[nodiscard]] WmiEventSink::coalescer_type& WmiEventSink::Coalescer() noexcept
+{
+    return m_coalescer;
+}
+
+[[nodiscard]] HANDLE WmiEventSink::WakeEvent() const noexcept
+{
+    return m_wake.get();
+}
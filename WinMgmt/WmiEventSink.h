@@ -0,0 +1,25 @@
+#pragma once
+#include "WmiClassObject.h"
+#include "Core/EventCoalescer.h"
+
+// Receives ExecNotificationQueryAsync deliveries and coalesces them into batches.
+struct WmiEventSink : winrt::implements<WmiEventSink, IWbemObjectSink>
+{
+	using coalescer_type = Wmi::EventCoalescer<winrt::WinMgmt::WmiClassObject>;
+
+	WmiEventSink(WmiSchemaScope schemas, Wmi::EventCoalescerOptions const& options);
+
+	HRESULT STDMETHODCALLTYPE Indicate(LONG lObjectCount, IWbemClassObject** apObjArray) noexcept override;
+
+	HRESULT STDMETHODCALLTYPE SetStatus(LONG lFlags, HRESULT hResult, [[maybe_unused]] BSTR strParam, [[maybe_unused]] IWbemClassObject* pObjParam) noexcept override;
+
+	coalescer_type& Coalescer() noexcept;
+
+	// Auto-reset event set whenever a batch may have become due or the stream ended.
+	HANDLE WakeEvent() const noexcept;
+
+private:
+	WmiSchemaScope m_schemas;
+	winrt::handle m_wake{ ::CreateEventW(NULL, FALSE, FALSE, NULL) };
+	coalescer_type m_coalescer;
+};
@@ -0,0 +1,85 @@
+﻿#include "pch.h"
+#include "WmiEventSubscription.h"
+#if __has_include("WmiEventSubscription.g.cpp")
+#include "WmiEventSubscription.g.cpp"
+#endif
+
+namespace winrt::WinMgmt::implementation
+{
+    WmiEventSubscription::WmiEventSubscription(winrt::com_ptr<IWbemServices> services, winrt::com_ptr<WmiEventSink> sink)
+        : m_services(std::move(services)), m_sink(std::move(sink))
+    {
+    }
+
+    WmiEventSubscription::~WmiEventSubscription()
+    {
+        Close();
+    }
+
+    [[nodiscard]] Windows::Foundation::IAsyncOperation<Windows::Foundation::Collections::IVectorView<WinMgmt::WmiClassObject>> WmiEventSubscription::NextBatchAsync()
+    {
+        auto strong = get_strong();
+        auto& coalescer = m_sink->Coalescer();
+
+        // Waits on the sink's event instead of the blocking Pop, so no threadpool thread
+        // is held while the subscription is idle. The event is auto-reset and set after
+        // every state change, so a change between TryPop and the wait is not missed.
+        std::optional<std::vector<WinMgmt::WmiClassObject>> batch;
+        while (!(batch = coalescer.TryPop()))
+        {
+            if (coalescer.IsCompleted())
+                break;
+
+            if (auto due = coalescer.DueAt())
+            {
+                const auto wait = std::chrono::ceil<Windows::Foundation::TimeSpan>(*due - WmiEventSink::coalescer_type::clock::now());
+                if (wait > Windows::Foundation::TimeSpan::zero())
+                    co_await winrt::resume_on_signal(m_sink->WakeEvent(), wait);
+            }
+            else
+            {
+                co_await winrt::resume_on_signal(m_sink->WakeEvent());
+            }
+        }
+
+        if (!batch)
+        {
+            // Cancellation through Close is the normal way for a subscription to end.
+            auto status = m_sink->Coalescer().Status();
+            if (status != WBEM_E_CALL_CANCELLED)
+                winrt::check_hresult(status);
+            co_return single_threaded_vector<WinMgmt::WmiClassObject>().GetView();
+        }
+
+        co_return single_threaded_vector<WinMgmt::WmiClassObject>(std::move(*batch)).GetView();
+    }
+
+    [[nodiscard]] bool WmiEventSubscription::IsCompleted() const
+    {
+        return m_sink->Coalescer().IsCompleted();
+    }
+
+    [[nodiscard]] uint32_t WmiEventSubscription::MaxBatch() const noexcept
+    {
+        return static_cast<uint32_t>(m_sink->Coalescer().MaxBatch());
+    }
+
+    [[nodiscard]] Windows::Foundation::TimeSpan WmiEventSubscription::MaxDelay() const noexcept
+    {
+        return std::chrono::duration_cast<Windows::Foundation::TimeSpan>(m_sink->Coalescer().MaxDelay());
+    }
+
+    [[nodiscard]] uint64_t WmiEventSubscription::DroppedEvents() const
+    {
+        return m_sink->Coalescer().Stats().dropped;
+    }
+
+    void WmiEventSubscription::Close()
+    {
+        if (!m_sink->Coalescer().IsCompleted())
+        {
+            m_sink->Coalescer().Cancel(WBEM_E_CALL_CANCELLED);
+            m_services->CancelAsyncCall(m_sink.get());
+        }
+    }
+}
@@ -0,0 +1,29 @@
+﻿#pragma once
+
+#include "WmiEventSubscription.g.h"
+#include "WmiEventSink.h"
+
+namespace winrt::WinMgmt::implementation
+{
+    struct WmiEventSubscription : WmiEventSubscriptionT<WmiEventSubscription>
+    {
+        WmiEventSubscription(winrt::com_ptr<IWbemServices> services, winrt::com_ptr<WmiEventSink> sink);
+        ~WmiEventSubscription();
+
+        Windows::Foundation::IAsyncOperation<Windows::Foundation::Collections::IVectorView<WinMgmt::WmiClassObject>> NextBatchAsync();
+
+        bool IsCompleted() const;
+
+        uint32_t MaxBatch() const noexcept;
+
+        Windows::Foundation::TimeSpan MaxDelay() const noexcept;
+
+        uint64_t DroppedEvents() const;
+
+        void Close();
+
+    private:
+        winrt::com_ptr<IWbemServices> m_services{ nullptr };
+        winrt::com_ptr<WmiEventSink> m_sink{ nullptr };
+    };
+}
@@ -0,0 +1,10 @@
+#include "pch.h"
+#include "WmiExecutor.h"
+
+[[nodiscard]] Wmi::WorkStealingExecutor& WmiExecutor::Instance()
+{
+    // Never destroyed: joining worker threads from a DLL's static destructors runs
+    // under the loader lock and would deadlock.
+    static auto* executor = new Wmi::WorkStealingExecutor(0, [] { winrt::init_apartment(winrt::apartment_type::multi_threaded); });
+    return *executor;
+}
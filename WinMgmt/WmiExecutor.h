@@ -0,0 +1,8 @@
+#pragma once
+#include "Core/WorkStealingExecutor.h"
+
+struct WmiExecutor
+{
+	// Process-wide workers for fan-out queries, one per hardware thread, each in the MTA.
+	static Wmi::WorkStealingExecutor& Instance();
+};
@@ -0,0 +1,48 @@
+﻿#include "pch.h"
+#include "WmiFanOutResult.h"
+#if __has_include("WmiFanOutResult.g.cpp")
+#include "WmiFanOutResult.g.cpp"
+#endif
+
+namespace winrt::WinMgmt::implementation
+{
+    WmiFanOutResult::WmiFanOutResult(uint32_t source, hstring ns, hstring query, Windows::Foundation::Collections::IVectorView<WinMgmt::WmiClassObject> results, winrt::hresult status, Windows::Foundation::TimeSpan queueTime, Windows::Foundation::TimeSpan elapsed)
+        : m_source(source), m_namespace(std::move(ns)), m_query(std::move(query)), m_results(std::move(results)), m_status(status), m_queueTime(queueTime), m_elapsed(elapsed)
+    {
+    }
+
+    [[nodiscard]] uint32_t WmiFanOutResult::Source() const noexcept
+    {
+        return m_source;
+    }
+
+    [[nodiscard]] hstring WmiFanOutResult::Namespace() const noexcept
+    {
+        return m_namespace;
+    }
+
+    [[nodiscard]] hstring WmiFanOutResult::Query() const noexcept
+    {
+        return m_query;
+    }
+
+    [[nodiscard]] Windows::Foundation::Collections::IVectorView<WinMgmt::WmiClassObject> WmiFanOutResult::Results() const noexcept
+    {
+        return m_results;
+    }
+
+    [[nodiscard]] winrt::hresult WmiFanOutResult::Status() const noexcept
+    {
+        return m_status;
+    }
+
+    [[nodiscard]] Windows::Foundation::TimeSpan WmiFanOutResult::QueueTime() const noexcept
+    {
+        return m_queueTime;
+    }
+
+    [[nodiscard]] Windows::Foundation::TimeSpan WmiFanOutResult::Elapsed() const noexcept
+    {
+        return m_elapsed;
+    }
+}
@@ -0,0 +1,34 @@
+﻿#pragma once
+
+#include "WmiFanOutResult.g.h"
+
+namespace winrt::WinMgmt::implementation
+{
+    struct WmiFanOutResult : WmiFanOutResultT<WmiFanOutResult>
+    {
+        WmiFanOutResult(uint32_t source, hstring ns, hstring query, Windows::Foundation::Collections::IVectorView<WinMgmt::WmiClassObject> results, winrt::hresult status, Windows::Foundation::TimeSpan queueTime, Windows::Foundation::TimeSpan elapsed);
+
+        uint32_t Source() const noexcept;
+
+        hstring Namespace() const noexcept;
+
+        hstring Query() const noexcept;
+
+        Windows::Foundation::Collections::IVectorView<WinMgmt::WmiClassObject> Results() const noexcept;
+
+        winrt::hresult Status() const noexcept;
+
+        Windows::Foundation::TimeSpan QueueTime() const noexcept;
+
+        Windows::Foundation::TimeSpan Elapsed() const noexcept;
+
+    private:
+        uint32_t m_source;
+        hstring m_namespace;
+        hstring m_query;
+        Windows::Foundation::Collections::IVectorView<WinMgmt::WmiClassObject> m_results;
+        winrt::hresult m_status;
+        Windows::Foundation::TimeSpan m_queueTime;
+        Windows::Foundation::TimeSpan m_elapsed;
+    };
+}
@@ -0,0 +1,70 @@
+﻿#include "pch.h"
+#include "WmiFanOutStream.h"
+#if __has_include("WmiFanOutStream.g.cpp")
+#include "WmiFanOutStream.g.cpp"
+#endif
+
+#include "WmiFanOutResult.h"
+#include "WmiTableSink.h"
+
+namespace winrt::WinMgmt::implementation
+{
+    WmiFanOutStream::WmiFanOutStream(std::shared_ptr<Wmi::FanOut> run)
+        : m_run(std::move(run))
+    {
+    }
+
+    WmiFanOutStream::~WmiFanOutStream()
+    {
+        Close();
+    }
+
+    [[nodiscard]] Windows::Foundation::IAsyncOperation<WinMgmt::WmiFanOutResult> WmiFanOutStream::NextAsync()
+    {
+        auto strong = get_strong();
+        co_await winrt::resume_background();
+
+        auto result = m_run->Next();
+        if (!result)
+            co_return nullptr;
+
+        Windows::Foundation::Collections::IVectorView<WinMgmt::WmiClassObject> results{ nullptr };
+        winrt::hresult status;
+        if (result->error)
+        {
+            try
+            {
+                std::rethrow_exception(result->error);
+            }
+            catch (...)
+            {
+                status = winrt::to_hresult();
+            }
+            results = single_threaded_vector<WinMgmt::WmiClassObject>().GetView();
+        }
+        else
+        {
+            results = WmiTableSink::Rows(result->table);
+        }
+
+        auto const& query = m_run->Queries()[result->source];
+        co_return winrt::make<WmiFanOutResult>(
+            static_cast<uint32_t>(result->source),
+            hstring{ query.ns },
+            hstring{ query.query },
+            results,
+            status,
+            std::chrono::duration_cast<Windows::Foundation::TimeSpan>(result->queued),
+            std::chrono::duration_cast<Windows::Foundation::TimeSpan>(result->elapsed));
+    }
+
+    [[nodiscard]] bool WmiFanOutStream::IsCompleted() const
+    {
+        return m_run->IsCompleted();
+    }
+
+    void WmiFanOutStream::Close()
+    {
+        m_run->Cancel();
+    }
+}
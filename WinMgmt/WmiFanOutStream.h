@@ -0,0 +1,24 @@
+﻿#pragma once
+
+#include "WmiFanOutStream.g.h"
+#include "Core/FanOut.h"
+
+#include <memory>
+
+namespace winrt::WinMgmt::implementation
+{
+    struct WmiFanOutStream : WmiFanOutStreamT<WmiFanOutStream>
+    {
+        explicit WmiFanOutStream(std::shared_ptr<Wmi::FanOut> run);
+        ~WmiFanOutStream();
+
+        Windows::Foundation::IAsyncOperation<WinMgmt::WmiFanOutResult> NextAsync();
+
+        bool IsCompleted() const;
+
+        void Close();
+
+    private:
+        std::shared_ptr<Wmi::FanOut> m_run;
+    };
+}
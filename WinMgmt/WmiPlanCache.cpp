@@ -0,0 +1,17 @@
+#include "pch.h"
+#include "WmiPlanCache.h"
+
+[[nodiscard]] Wmi::Wql::PlanCache& WmiPlanCache::Instance() noexcept
+{
+    static Wmi::Wql::PlanCache cache;
+    return cache;
+}
+
+[[nodiscard]] Wmi::Wql::PlanLookup WmiPlanCache::Resolve(winrt::hstring const& query)
+{
+    auto lookup = Instance().Lookup(query);
+    if (!lookup) [[unlikely]]
+        throw winrt::hresult_error(WBEM_E_INVALID_QUERY, winrt::hstring{ lookup.error.message });
+
+    return lookup;
+}
@@ -0,0 +1,13 @@
+#pragma once
+#include "Core/WqlPlanCache.h"
+
+struct WmiPlanCache
+{
+	// Returns the parsed plan for query, throwing WBEM_E_INVALID_QUERY with the
+	// parser's message when it is not valid WQL. Every query entry point resolves
+	// first, so malformed WQL is rejected locally instead of paying for a round trip
+	// to winmgmt.
+	static Wmi::Wql::PlanLookup Resolve(winrt::hstring const& query);
+
+	static Wmi::Wql::PlanCache& Instance() noexcept;
+};
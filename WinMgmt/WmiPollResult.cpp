@@ -0,0 +1,38 @@
+﻿#include "pch.h"
+#include "WmiPollResult.h"
+#if __has_include("WmiPollResult.g.cpp")
+#include "WmiPollResult.g.cpp"
+#endif
+
+namespace winrt::WinMgmt::implementation
+{
+    WmiPollResult::WmiPollResult(uint64_t id, hstring ns, hstring query, Windows::Foundation::Collections::IVectorView<WinMgmt::WmiClassObject> results, winrt::hresult status)
+        : m_id(id), m_namespace(std::move(ns)), m_query(std::move(query)), m_results(std::move(results)), m_status(status)
+    {
+    }
+
+    [[nodiscard]] uint64_t WmiPollResult::Id() const noexcept
+    {
+        return m_id;
+    }
+
+    [[nodiscard]] hstring WmiPollResult::Namespace() const noexcept
+    {
+        return m_namespace;
+    }
+
+    [[nodiscard]] hstring WmiPollResult::Query() const noexcept
+    {
+        return m_query;
+    }
+
+    [[nodiscard]] Windows::Foundation::Collections::IVectorView<WinMgmt::WmiClassObject> WmiPollResult::Results() const noexcept
+    {
+        return m_results;
+    }
+
+    [[nodiscard]] winrt::hresult WmiPollResult::Status() const noexcept
+    {
+        return m_status;
+    }
+}
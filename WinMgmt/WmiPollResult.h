@@ -0,0 +1,28 @@
+﻿#pragma once
+
+#include "WmiPollResult.g.h"
+
+namespace winrt::WinMgmt::implementation
+{
+    struct WmiPollResult : WmiPollResultT<WmiPollResult>
+    {
+        WmiPollResult(uint64_t id, hstring ns, hstring query, Windows::Foundation::Collections::IVectorView<WinMgmt::WmiClassObject> results, winrt::hresult status);
+
+        uint64_t Id() const noexcept;
+
+        hstring Namespace() const noexcept;
+
+        hstring Query() const noexcept;
+
+        Windows::Foundation::Collections::IVectorView<WinMgmt::WmiClassObject> Results() const noexcept;
+
+        winrt::hresult Status() const noexcept;
+
+    private:
+        uint64_t m_id;
+        hstring m_namespace;
+        hstring m_query;
+        Windows::Foundation::Collections::IVectorView<WinMgmt::WmiClassObject> m_results;
+        winrt::hresult m_status;
+    };
+}
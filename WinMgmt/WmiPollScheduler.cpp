@@ -0,0 +1,233 @@
+﻿#include "pch.h"
+#include "WmiPollScheduler.h"
+#if __has_include("WmiPollScheduler.g.cpp")
+#include "WmiPollScheduler.g.cpp"
+#endif
+
+#include "WmiClassObject.h"
+#include "WmiDataContext.h"
+#include "WmiPlanCache.h"
+#include "WmiPollResult.h"
+
+namespace winrt::WinMgmt::implementation
+{
+    namespace
+    {
+        // The wheel turns every resolution; slots cover about half a minute per revolution.
+        constexpr std::chrono::milliseconds resolution{ 50 };
+        constexpr std::size_t wheelSlots = 512;
+
+        // Bounds what one namespace's pool holds before later runs start a new one.
+        constexpr std::size_t maxPoolBytes = 8u << 20;
+
+        // winrt::clock counts 100ns ticks from 1601-01-01, history microseconds from 1970-01-01.
+        constexpr int64_t UnixEpochTicks = 116444736000000000;
+
+        int64_t toMicroseconds(Windows::Foundation::DateTime const& time) noexcept
+        {
+            return (time.time_since_epoch().count() - UnixEpochTicks) / 10;
+        }
+
+        Wmi::PollSchedulerOptions schedulerOptions(uint32_t maxConcurrentPerNamespace)
+        {
+            Wmi::PollSchedulerOptions options;
+            options.resolution = resolution;
+            options.wheelSlots = wheelSlots;
+            options.maxConcurrentPerNamespace = maxConcurrentPerNamespace;
+            return options;
+        }
+    }
+
+    WmiPollScheduler::WmiPollScheduler(hstring const& server, uint32_t maxConcurrentPerNamespace)
+        : m_server(server),
+          m_scheduler(schedulerOptions(maxConcurrentPerNamespace), [this](Wmi::PollRun const& run) { execute(run); })
+    {
+        m_driver = std::thread([this] { drive(); });
+    }
+
+    WmiPollScheduler::~WmiPollScheduler()
+    {
+        Close();
+    }
+
+    uint64_t WmiPollScheduler::Register(hstring const& ns, hstring const& query, Windows::Foundation::TimeSpan const& interval, Windows::Foundation::TimeSpan const& jitter, WinMgmt::WmiOverlapPolicy overlap)
+    {
+        // Rejects malformed WQL now rather than on every tick.
+        WmiPlanCache::Resolve(query);
+
+        Wmi::PollRegistration registration;
+        registration.ns = ns;
+        registration.query = query;
+        registration.interval = std::chrono::duration_cast<std::chrono::milliseconds>(interval);
+        registration.jitter = std::chrono::duration_cast<std::chrono::milliseconds>(jitter);
+        registration.overlap = overlap == WinMgmt::WmiOverlapPolicy::Merge ? Wmi::OverlapPolicy::Merge : Wmi::OverlapPolicy::Skip;
+
+        return m_scheduler.Register(std::move(registration));
+    }
+
+    bool WmiPollScheduler::Unregister(uint64_t id)
+    {
+        {
+            std::lock_guard lk(m_mutex);
+            m_recorded.erase(id);
+        }
+        return m_scheduler.Unregister(id);
+    }
+
+    Windows::Foundation::TimeSpan WmiPollScheduler::Timeout() const noexcept
+    {
+        return Windows::Foundation::TimeSpan{ m_timeout.load(std::memory_order_relaxed) };
+    }
+
+    void WmiPollScheduler::Timeout(Windows::Foundation::TimeSpan const& value) noexcept
+    {
+        m_timeout.store(value.count(), std::memory_order_relaxed);
+    }
+
+    void WmiPollScheduler::RecordHistory(uint64_t id, hstring const& identityProperty)
+    {
+        if (identityProperty.empty())
+            throw winrt::hresult_invalid_argument(L"history needs an identity property");
+
+        std::lock_guard lk(m_mutex);
+        m_recorded.insert_or_assign(id, std::wstring{ identityProperty });
+    }
+
+    Windows::Foundation::Collections::IVectorView<WinMgmt::WmiHistorySample> WmiPollScheduler::History(hstring const& identity, hstring const& property, Windows::Foundation::DateTime const& from, Windows::Foundation::DateTime const& to)
+    {
+        std::vector<WinMgmt::WmiHistorySample> samples;
+        m_history.Scan(identity, property, toMicroseconds(from), toMicroseconds(to), [&](Wmi::TimeSeriesSample const& sample) {
+            WinMgmt::WmiHistorySample projected{};
+            projected.Time = Windows::Foundation::DateTime{ Windows::Foundation::TimeSpan{ sample.time * 10 + UnixEpochTicks } };
+            if (sample.value.Storage() == Wmi::StorageKind::Real)
+                projected.Real = sample.value.AsDouble();
+            else
+                projected.Integer = sample.value.AsInt64();
+            samples.push_back(projected);
+        });
+
+        return single_threaded_vector(std::move(samples)).GetView();
+    }
+
+    winrt::event_token WmiPollScheduler::ResultsReady(Windows::Foundation::TypedEventHandler<WinMgmt::WmiPollScheduler, WinMgmt::WmiPollResult> const& handler)
+    {
+        return m_resultsReady.add(handler);
+    }
+
+    void WmiPollScheduler::ResultsReady(winrt::event_token const& token) noexcept
+    {
+        m_resultsReady.remove(token);
+    }
+
+    void WmiPollScheduler::Close()
+    {
+        {
+            std::lock_guard lk(m_mutex);
+            if (m_closed)
+                return;
+            m_closed = true;
+        }
+
+        m_stop.notify_all();
+        if (m_driver.joinable())
+            m_driver.join();
+    }
+
+    void WmiPollScheduler::drive()
+    {
+        std::unique_lock lk(m_mutex);
+        while (!m_closed)
+        {
+            lk.unlock();
+            m_scheduler.Poll();
+            lk.lock();
+
+            m_stop.wait_for(lk, resolution, [this] { return m_closed; });
+        }
+    }
+
+    winrt::fire_and_forget WmiPollScheduler::execute(Wmi::PollRun run)
+    {
+        // Dispatch happens on the driver thread; the query must not hold up the wheel.
+        auto weak = get_weak();
+        hstring server = m_server;
+        auto timeout = Timeout();
+        auto strings = this->strings(run.ns);
+        co_await winrt::resume_background();
+
+        Windows::Foundation::Collections::IVectorView<WinMgmt::WmiClassObject> results{ nullptr };
+        winrt::hresult status;
+        try
+        {
+            auto context = winrt::make_self<WmiDataContext>();
+            context->Server(server);
+            context->Namespace(hstring{ run.ns });
+            context->Timeout(timeout);
+            context->UseStringPool(std::move(strings));
+
+            // Table-backed results can be handed to handlers on any thread.
+            results = co_await context->QueryTableAsync(hstring{ run.query });
+        }
+        catch (...)
+        {
+            status = winrt::to_hresult();
+            results = single_threaded_vector<WinMgmt::WmiClassObject>().GetView();
+        }
+
+        auto self = weak.get();
+        if (!self)
+            co_return;
+
+        // Free the namespace slot before handing out the result, so a slow handler
+        // does not hold back the next run.
+        self->m_scheduler.Complete(run.id);
+
+        if (status == S_OK)
+            self->record(run.id, results);
+
+        {
+            std::lock_guard lk(self->m_mutex);
+            if (self->m_closed)
+                co_return;
+        }
+
+        self->m_resultsReady(*self, winrt::make<WmiPollResult>(run.id, hstring{ run.ns }, hstring{ run.query }, results, status));
+    }
+
+    std::shared_ptr<Wmi::StringPool> WmiPollScheduler::strings(std::wstring const& ns)
+    {
+        std::lock_guard lk(m_mutex);
+        auto& pool = m_strings[ns];
+
+        // A full pool refuses every new value, so rather than let later runs store
+        // them all inline, start over; results still alive keep the old pool.
+        if (!pool || pool->ReservedBytes() > pool->MaxBytes() / 4 * 3)
+            pool = std::make_shared<Wmi::StringPool>(maxPoolBytes);
+        return pool;
+    }
+
+    void WmiPollScheduler::record(uint64_t id, Windows::Foundation::Collections::IVectorView<WinMgmt::WmiClassObject> const& results)
+    {
+        std::wstring identityProperty;
+        {
+            std::lock_guard lk(m_mutex);
+            auto it = m_recorded.find(id);
+            if (it == m_recorded.end())
+                return;
+            identityProperty = it->second;
+        }
+
+        if (results.Size() == 0)
+            return;
+
+        auto now = toMicroseconds(winrt::clock::now());
+        try
+        {
+            m_history.Append(now, *winrt::get_self<WmiClassObject>(results.GetAt(0))->Table(), identityProperty);
+        }
+        catch (std::invalid_argument const&)
+        {
+            // The query does not select the identity property; there is nothing to key the samples by.
+        }
+    }
+}
@@ -0,0 +1,81 @@
+﻿#pragma once
+
+#include "WmiPollScheduler.g.h"
+#include "Core/PollScheduler.h"
+#include "Core/StringPool.h"
+#include "Core/TimeSeriesStore.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace winrt::WinMgmt::implementation
+{
+    struct WmiPollScheduler : WmiPollSchedulerT<WmiPollScheduler>
+    {
+        WmiPollScheduler(hstring const& server, uint32_t maxConcurrentPerNamespace);
+        ~WmiPollScheduler();
+
+        uint64_t Register(hstring const& ns, hstring const& query, Windows::Foundation::TimeSpan const& interval, Windows::Foundation::TimeSpan const& jitter, WinMgmt::WmiOverlapPolicy overlap);
+
+        bool Unregister(uint64_t id);
+
+        Windows::Foundation::TimeSpan Timeout() const noexcept;
+
+        void Timeout(Windows::Foundation::TimeSpan const& value) noexcept;
+
+        void RecordHistory(uint64_t id, hstring const& identityProperty);
+
+        Windows::Foundation::Collections::IVectorView<WinMgmt::WmiHistorySample> History(hstring const& identity, hstring const& property, Windows::Foundation::DateTime const& from, Windows::Foundation::DateTime const& to);
+
+        winrt::event_token ResultsReady(Windows::Foundation::TypedEventHandler<WinMgmt::WmiPollScheduler, WinMgmt::WmiPollResult> const& handler);
+
+        void ResultsReady(winrt::event_token const& token) noexcept;
+
+        void Close();
+
+    private:
+        // Turns the wheel every resolution until Close.
+        void drive();
+
+        winrt::fire_and_forget execute(Wmi::PollRun run);
+
+        // The string pool for runs in ns, started over once it is mostly full.
+        std::shared_ptr<Wmi::StringPool> strings(std::wstring const& ns);
+
+        // Adds a completed run of id to the history if it is recorded.
+        void record(uint64_t id, Windows::Foundation::Collections::IVectorView<WinMgmt::WmiClassObject> const& results);
+
+    private:
+        hstring m_server;
+
+        // Ticks of the per-run deadline; read by runs on background threads.
+        std::atomic<Windows::Foundation::TimeSpan::rep> m_timeout{ std::chrono::duration_cast<Windows::Foundation::TimeSpan>(std::chrono::seconds{ 30 }).count() };
+        Wmi::PollScheduler m_scheduler;
+        winrt::event<Windows::Foundation::TypedEventHandler<WinMgmt::WmiPollScheduler, WinMgmt::WmiPollResult>> m_resultsReady;
+
+        std::mutex m_mutex;
+        std::condition_variable m_stop;
+        bool m_closed = false;
+        std::thread m_driver;
+
+        // One pool per namespace, so values repeated across runs are stored once;
+        // guarded by m_mutex. Results already delivered keep the pool they were built with.
+        std::unordered_map<std::wstring, std::shared_ptr<Wmi::StringPool>> m_strings;
+
+        // Identity property per recorded registration, guarded by m_mutex.
+        std::unordered_map<uint64_t, std::wstring> m_recorded;
+        Wmi::TimeSeriesStore m_history;
+    };
+}
+
+namespace winrt::WinMgmt::factory_implementation
+{
+    struct WmiPollScheduler : WmiPollSchedulerT<WmiPollScheduler, implementation::WmiPollScheduler>
+    {
+    };
+}
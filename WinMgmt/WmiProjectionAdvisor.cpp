@@ -0,0 +1,19 @@
+#include "pch.h"
+#include "WmiProjectionAdvisor.h"
+
+[[nodiscard]] Wmi::ProjectionAdvisor& WmiProjectionAdvisor::Instance() noexcept
+{
+    static Wmi::ProjectionAdvisor advisor;
+    return advisor;
+}
+
+[[nodiscard]] std::wstring WmiProjectionAdvisor::Key(winrt::hstring const& ns, Wmi::Wql::QueryPlan const& plan)
+{
+    std::wstring key;
+    key.reserve(ns.size() + plan.normalized.size() + 1);
+    for (auto c : ns)
+        key.push_back(Wmi::Wql::ToUpperAscii(c));
+    key.push_back(L'\n');
+    key.append(plan.normalized);
+    return key;
+}
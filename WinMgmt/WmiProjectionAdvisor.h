@@ -0,0 +1,11 @@
+#pragma once
+#include "Core/Projection.h"
+#include "Core/WqlPlanCache.h"
+
+struct WmiProjectionAdvisor
+{
+	// Shapes are shared by every data context in the process, keyed by namespace and normalized query.
+	static std::wstring Key(winrt::hstring const& ns, Wmi::Wql::QueryPlan const& plan);
+
+	static Wmi::ProjectionAdvisor& Instance() noexcept;
+};
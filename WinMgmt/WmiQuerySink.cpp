@@ -1,9 +1,28 @@
 #include "pch.h"
 #include "WmiQuerySink.h"
+#include "WmiConnectionPool.h"
+#include "WmiRowCollection.h"
 
-[[nodiscard]] winrt::Windows::Foundation::Collections::IVectorView<winrt::WinMgmt::WmiClassObject> WmiQuerySink::Results() noexcept
+WmiQuerySink::WmiQuerySink(WmiSchemaScope schemas, Wmi::AccessRecorderPtr recorder)
+    : m_schemas(std::move(schemas)), m_recorder(std::move(recorder))
 {
-    return m_results.GetView();
+}
+
+[[nodiscard]] winrt::Windows::Foundation::Collections::IVectorView<winrt::WinMgmt::WmiClassObject> WmiQuerySink::Results()
+{
+    auto rows = std::make_shared<Wmi::RowArena<winrt::com_ptr<IWbemClassObject>>>();
+    m_queue.CloseInto(*rows);
+    return Rows(std::move(rows), m_schemas, m_recorder);
+}
+
+[[nodiscard]] winrt::Windows::Foundation::Collections::IVectorView<winrt::WinMgmt::WmiClassObject> WmiQuerySink::Rows(std::shared_ptr<const Wmi::RowArena<winrt::com_ptr<IWbemClassObject>>> rows, WmiSchemaScope const& schemas, Wmi::AccessRecorderPtr const& recorder)
+{
+    const auto size = rows->Size();
+    return winrt::make<WmiRowCollection>(size, [rows = std::move(rows), schemas, recorder](std::size_t row) {
+        auto const& object = (*rows)[row];
+        auto schema = schemas.Resolve(object.get());
+        return winrt::make<winrt::WinMgmt::implementation::WmiClassObject>(object.get(), std::move(schema), recorder);
+    });
 }
 
 HRESULT STDMETHODCALLTYPE WmiQuerySink::Indicate(LONG lObjectCount, IWbemClassObject** apObjArray) noexcept
@@ -11,22 +30,65 @@ HRESULT STDMETHODCALLTYPE WmiQuerySink::Indicate(LONG lObjectCount, IWbemClassOb
     if (!apObjArray) [[unlikely]]
         return E_POINTER;
 
-    for (LONG i = 0; i < lObjectCount; i++) [[likely]]
+    try
     {
-        m_results.Append(winrt::make<winrt::WinMgmt::implementation::WmiClassObject>(apObjArray[i]));
+        std::vector<winrt::com_ptr<IWbemClassObject>> objects(lObjectCount);
+        for (LONG i = 0; i < lObjectCount; i++) [[likely]]
+        {
+            objects[i].copy_from(apObjArray[i]);
+        }
+
+        // Refused once the caller has given up; tells winmgmt to stop delivering.
+        if (!m_queue.Push(std::move(objects)))
+            return WBEM_E_CALL_CANCELLED;
+    }
+    catch (...)
+    {
+        return winrt::to_hresult();
     }
     return WBEM_S_NO_ERROR;
 }
 
 HRESULT STDMETHODCALLTYPE WmiQuerySink::SetStatus(LONG lFlags, HRESULT hResult, BSTR strParam, IWbemClassObject* pObjParam) noexcept
 {
-    return ::SetEvent(m_event.get()) ? WBEM_S_NO_ERROR : WBEM_E_FAILED;
+    if (lFlags == WBEM_STATUS_COMPLETE)
+        m_call.Complete(hResult);
+
+    return WBEM_S_NO_ERROR;
 }
 
-winrt::Windows::Foundation::IAsyncAction WmiQuerySink::WaitAsync()
+void WmiQuerySink::Started(winrt::com_ptr<IWbemServices> services)
+{
+    m_call.OnCancel([services = AgileServices{ services }, this] { WmiConnectionPool::CancelAsyncCall(services, this); });
+}
+
+winrt::Windows::Foundation::IAsyncAction WmiQuerySink::WaitAsync(winrt::Windows::Foundation::TimeSpan timeout)
 {
     if (!m_event) [[unlikely]]
         throw winrt::hresult_error(E_POINTER, L"Event not initialized");
 
-    co_await winrt::resume_on_signal(m_event.get());
+    // A zero timeout waits indefinitely.
+    auto strong = get_strong();
+    if (!co_await winrt::resume_on_signal(m_event.get(), timeout))
+        m_call.Cancel(WBEM_E_TIMED_OUT);
+
+    winrt::check_hresult(m_call.Status());
+}
+
+[[nodiscard]] WmiQuerySink::call_type& WmiQuerySink::Call() noexcept
+{
+    return m_call;
+}
+
+[[nodiscard]] WmiQuerySink::queue_type& WmiQuerySink::Queue() noexcept
+{
+    return m_queue;
+}
+
+void WmiQuerySink::finished()
+{
+    if (m_call.IsCancelled())
+        (void)m_queue.Close();
+
+    ::SetEvent(m_event.get());
 }
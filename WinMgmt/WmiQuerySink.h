@@ -1,17 +1,52 @@
 #pragma once
 #include "WmiClassObject.h"
+#include "Core/MpscBatchQueue.h"
+#include "Core/PendingCall.h"
+#include "Core/RowArena.h"
+
+#include <memory>
+#include <variant>
 
 struct WmiQuerySink : winrt::implements<WmiQuerySink, IWbemObjectSink>
 {
-	winrt::Windows::Foundation::Collections::IVectorView<winrt::WinMgmt::WmiClassObject> Results() noexcept;
+	// Indicate may run on several RPC threads at once; each delivery is pushed as one
+	// batch of plain object references. WmiClassObjects are made only when read.
+	using queue_type = Wmi::MpscBatchQueue<winrt::com_ptr<IWbemClassObject>>;
+
+	// Status and cancellation only; the objects travel through the queue.
+	using call_type = Wmi::PendingCall<std::monostate>;
+
+	explicit WmiQuerySink(WmiSchemaScope schemas, Wmi::AccessRecorderPtr recorder = nullptr);
+
+	// Hands over the objects as one lazily projected collection; call once, after
+	// WaitAsync succeeded.
+	winrt::Windows::Foundation::Collections::IVectorView<winrt::WinMgmt::WmiClassObject> Results();
+
+	// Live objects over delivered rows, whichever call delivered them, each made on first touch.
+	static winrt::Windows::Foundation::Collections::IVectorView<winrt::WinMgmt::WmiClassObject> Rows(std::shared_ptr<const Wmi::RowArena<winrt::com_ptr<IWbemClassObject>>> rows, WmiSchemaScope const& schemas, Wmi::AccessRecorderPtr const& recorder = nullptr);
 
 	HRESULT STDMETHODCALLTYPE Indicate(LONG lObjectCount, IWbemClassObject** apObjArray) noexcept override;
 
-	HRESULT STDMETHODCALLTYPE SetStatus([[maybe_unused]] LONG lFlags, [[maybe_unused]] HRESULT hResult, [[maybe_unused]] BSTR strParam, [[maybe_unused]] IWbemClassObject* pObjParam) noexcept override;
+	HRESULT STDMETHODCALLTYPE SetStatus(LONG lFlags, HRESULT hResult, [[maybe_unused]] BSTR strParam, [[maybe_unused]] IWbemClassObject* pObjParam) noexcept override;
 
-	winrt::Windows::Foundation::IAsyncAction WaitAsync();
+	// Lets Call().Cancel() stop the call on the connection it was started on.
+	void Started(winrt::com_ptr<IWbemServices> services);
+
+	// Completes when the call ends and throws its failure status. A non-zero timeout
+	// cancels the call with WBEM_E_TIMED_OUT once it elapses.
+	winrt::Windows::Foundation::IAsyncAction WaitAsync(winrt::Windows::Foundation::TimeSpan timeout = {});
+
+	call_type& Call() noexcept;
+
+	queue_type& Queue() noexcept;
 
 private:
+	// Frees what was delivered when the call was given up, then wakes WaitAsync.
+	void finished();
+
+	WmiSchemaScope m_schemas;
+	Wmi::AccessRecorderPtr m_recorder;
 	winrt::handle m_event{ ::CreateEventW(NULL, TRUE, FALSE, NULL) };
-	winrt::Windows::Foundation::Collections::IVector<winrt::WinMgmt::WmiClassObject> m_results = winrt::single_threaded_vector<winrt::WinMgmt::WmiClassObject>();
+	queue_type m_queue;
+	call_type m_call{ [this] { finished(); } };
 };
\ No newline at end of file
@@ -0,0 +1,102 @@
+﻿#include "pch.h"
+#include "WmiQueryStream.h"
+#if __has_include("WmiQueryStream.g.cpp")
+#include "WmiQueryStream.g.cpp"
+#endif
+
+#include "WmiSchemaCache.h"
+
+namespace winrt::WinMgmt::implementation
+{
+    WmiQueryStream::WmiQueryStream(winrt::com_ptr<IWbemServices> services, winrt::com_ptr<WmiStreamSink> sink)
+        : m_services(services), m_sink(std::move(sink))
+    {
+    }
+
+    WmiQueryStream::WmiQueryStream(std::unique_ptr<WmiPullEnumerator> enumerator, WmiSchemaScope schemas, Wmi::AccessRecorderPtr recorder, Windows::Foundation::TimeSpan timeout)
+        : m_enumerator(std::move(enumerator)), m_schemas(std::move(schemas)), m_recorder(std::move(recorder)), m_timeout(timeout)
+    {
+    }
+
+    WmiQueryStream::~WmiQueryStream()
+    {
+        Close();
+    }
+
+    [[nodiscard]] Windows::Foundation::IAsyncOperation<Windows::Foundation::Collections::IVectorView<WinMgmt::WmiClassObject>> WmiQueryStream::NextBatchAsync()
+    {
+        auto strong = get_strong();
+        auto cancellation = co_await winrt::get_cancellation_token();
+        co_await winrt::resume_background();
+
+        if (!m_sink)
+            co_return pullBatch([this, cancellation] { return m_closing.load(std::memory_order_relaxed) || cancellation(); });
+
+        auto batch = m_sink->Channel().Pop();
+        if (!batch)
+        {
+            winrt::check_hresult(m_sink->Channel().Status());
+            co_return single_threaded_vector<WinMgmt::WmiClassObject>().GetView();
+        }
+
+        co_return single_threaded_vector<WinMgmt::WmiClassObject>(std::move(*batch)).GetView();
+    }
+
+    Windows::Foundation::Collections::IVectorView<WinMgmt::WmiClassObject> WmiQueryStream::pullBatch(std::function<bool()> cancelled)
+    {
+        std::lock_guard lk(m_mutex);
+        if (!m_enumerator)
+            throw winrt::hresult_error(RO_E_CLOSED, L"stream is closed");
+
+        m_enumerator->GetSource().Limit(WmiEnumSource::DeadlineAfter(m_timeout), std::move(cancelled));
+        auto batch = m_enumerator->NextBatch();
+        winrt::check_hresult(m_enumerator->Status());
+
+        std::vector<WinMgmt::WmiClassObject> objects;
+        objects.reserve(batch.size());
+        for (auto const& object : batch)
+        {
+            auto schema = m_schemas->Resolve(object.get());
+            objects.push_back(winrt::make<WmiClassObject>(object.get(), std::move(schema), m_recorder));
+        }
+        return single_threaded_vector<WinMgmt::WmiClassObject>(std::move(objects)).GetView();
+    }
+
+    [[nodiscard]] bool WmiQueryStream::IsCompleted() const
+    {
+        if (!m_sink)
+        {
+            std::lock_guard lk(m_mutex);
+            return !m_enumerator || m_enumerator->IsCompleted();
+        }
+        return m_sink->Channel().IsCompleted();
+    }
+
+    [[nodiscard]] uint32_t WmiQueryStream::BatchSize() const
+    {
+        if (!m_sink)
+        {
+            std::lock_guard lk(m_mutex);
+            return m_enumerator ? m_enumerator->Policy().Size() : 0;
+        }
+        return static_cast<uint32_t>(m_sink->Channel().BatchSize());
+    }
+
+    void WmiQueryStream::Close()
+    {
+        if (!m_sink)
+        {
+            // Releasing a forward-only enumerator ends the enumeration on the server.
+            m_closing.store(true, std::memory_order_relaxed);
+            std::lock_guard lk(m_mutex);
+            m_enumerator.reset();
+            return;
+        }
+
+        if (!m_sink->Channel().IsCompleted())
+        {
+            m_sink->Channel().Cancel(WBEM_E_CALL_CANCELLED);
+            WmiConnectionPool::CancelAsyncCall(m_services, m_sink.get());
+        }
+    }
+}
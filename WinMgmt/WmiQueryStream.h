@@ -0,0 +1,49 @@
+﻿#pragma once
+
+#include "WmiQueryStream.g.h"
+#include "WmiStreamSink.h"
+#include "WmiEnumSource.h"
+#include "WmiConnectionPool.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+namespace winrt::WinMgmt::implementation
+{
+    struct WmiQueryStream : WmiQueryStreamT<WmiQueryStream>
+    {
+        WmiQueryStream(winrt::com_ptr<IWbemServices> services, winrt::com_ptr<WmiStreamSink> sink);
+        // Each NextBatchAsync waits at most timeout for its batch; zero waits indefinitely.
+        WmiQueryStream(std::unique_ptr<WmiPullEnumerator> enumerator, WmiSchemaScope schemas, Wmi::AccessRecorderPtr recorder, Windows::Foundation::TimeSpan timeout);
+        ~WmiQueryStream();
+
+        Windows::Foundation::IAsyncOperation<Windows::Foundation::Collections::IVectorView<WinMgmt::WmiClassObject>> NextBatchAsync();
+
+        bool IsCompleted() const;
+
+        uint32_t BatchSize() const;
+
+        void Close();
+
+    private:
+        Windows::Foundation::Collections::IVectorView<WinMgmt::WmiClassObject> pullBatch(std::function<bool()> cancelled);
+
+    private:
+        // Asynchronous mode: the sink pushes batches into its channel.
+        AgileServices m_services{ nullptr };
+        winrt::com_ptr<WmiStreamSink> m_sink{ nullptr };
+
+        // Semisynchronous mode: each NextBatchAsync pulls from the enumerator.
+        mutable std::mutex m_mutex;
+        std::unique_ptr<WmiPullEnumerator> m_enumerator;
+        std::optional<WmiSchemaScope> m_schemas;
+        Wmi::AccessRecorderPtr m_recorder;
+        Windows::Foundation::TimeSpan m_timeout{};
+
+        // Set by Close so a pull in progress gives up at its next wait slice.
+        std::atomic<bool> m_closing{ false };
+    };
+}
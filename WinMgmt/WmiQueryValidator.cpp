@@ -4,26 +4,33 @@
 #include "WmiQueryValidator.g.cpp"
 #endif
 
+#include "WmiPlanCache.h"
+
 namespace winrt::WinMgmt::implementation
 {
-	WmiQueryValidator::WmiQueryValidator()
+	// Parsed natively and cached by query shape; no IWbemQuery instance or COM apartment is needed.
+	bool WmiQueryValidator::Validate(winrt::hstring const& query)
 	{
-		initialize();
+		auto result = WmiPlanCache::Instance().Lookup(query);
+		if (result)
+		{
+			m_errorPosition = -1;
+			m_errorMessage = {};
+			return true;
+		}
+
+		m_errorPosition = static_cast<int32_t>(result.error.offset);
+		m_errorMessage = winrt::hstring{ result.error.message };
+		return false;
 	}
 
-	void WmiQueryValidator::initialize()
+	int32_t WmiQueryValidator::ErrorPosition() const noexcept
 	{
-		winrt::check_hresult(CoCreateInstance(
-			CLSID_WbemQuery,
-			NULL,
-			CLSCTX_INPROC_SERVER,
-			__uuidof(IWbemQuery),
-			m_query.put_void()
-		));
+		return m_errorPosition;
 	}
 
-	bool WmiQueryValidator::Validate(winrt::hstring const& query)
+	winrt::hstring WmiQueryValidator::ErrorMessage() const
 	{
-		return SUCCEEDED(m_query->Parse(L"WQL", query.c_str(), 0));
+		return m_errorMessage;
 	}
 }
@@ -6,16 +6,16 @@ namespace winrt::WinMgmt::implementation
 {
     struct WmiQueryValidator : WmiQueryValidatorT<WmiQueryValidator>
     {
-        WmiQueryValidator();
+        WmiQueryValidator() = default;
 
         bool Validate(winrt::hstring const& query);
 
-    private:
-
-        void initialize();
+        int32_t ErrorPosition() const noexcept;
+        winrt::hstring ErrorMessage() const;
 
     private:
-        winrt::com_ptr<IWbemQuery> m_query;
+        int32_t m_errorPosition{ -1 };
+        winrt::hstring m_errorMessage;
     };
 }
 
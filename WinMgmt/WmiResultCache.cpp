@@ -0,0 +1,36 @@
+#include "pch.h"
+#include "WmiResultCache.h"
+
+#include <atomic>
+
+[[nodiscard]] Wmi::ResultCache<WmiQueryResult>& WmiResultCache::Instance() noexcept
+{
+    static Wmi::ResultCache<WmiQueryResult> cache;
+    return cache;
+}
+
+[[nodiscard]] std::wstring WmiResultCache::Key(winrt::hstring const& server, uint64_t backend, winrt::hstring const& ns, winrt::hstring const& query, bool projected)
+{
+    auto id = std::to_wstring(backend);
+
+    std::wstring key;
+    key.reserve(server.size() + id.size() + ns.size() + query.size() + 4);
+    for (auto c : server)
+        key.push_back(Wmi::Wql::ToUpperAscii(c));
+    key.push_back(L'\n');
+    key.append(id);
+    if (projected)
+        key.push_back(L'*');
+    key.push_back(L'\n');
+    for (auto c : ns)
+        key.push_back(Wmi::Wql::ToUpperAscii(c));
+    key.push_back(L'\n');
+    key.append(query);
+    return key;
+}
+
+[[nodiscard]] uint64_t WmiResultCache::NewBackendId() noexcept
+{
+    static std::atomic<uint64_t> next{ 1 };
+    return next.fetch_add(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include "Core/ResultCache.h"
+#include "Core/WqlLexer.h"
+
+using WmiQueryResult = winrt::Windows::Foundation::Collections::IVectorView<winrt::WinMgmt::WmiClassObject>;
+
+struct WmiResultCache
+{
+	// Results are shared by every data context in the process that queries the same
+	// source: server (empty for the local machine), backend (0 for winmgmt, otherwise
+	// one from NewBackendId) and namespace, then the query text. Projected results
+	// carry only the columns that were read before, so they are kept apart from
+	// complete ones.
+	static std::wstring Key(winrt::hstring const& server, uint64_t backend, winrt::hstring const& ns, winrt::hstring const& query, bool projected);
+
+	// Distinct for every non-live backend, so replayed results never answer live queries
+	// or another replay.
+	static uint64_t NewBackendId() noexcept;
+
+	static Wmi::ResultCache<WmiQueryResult>& Instance() noexcept;
+};
@@ -0,0 +1,92 @@
+#include "pch.h"
+#include "WmiRowCollection.h"
+
+struct WmiRowCollection::Iterator : winrt::implements<Iterator, winrt::Windows::Foundation::Collections::IIterator<winrt::WinMgmt::WmiClassObject>>
+{
+    explicit Iterator(winrt::com_ptr<WmiRowCollection> owner)
+        : m_owner(std::move(owner))
+    {
+    }
+
+    winrt::WinMgmt::WmiClassObject Current()
+    {
+        return m_owner->GetAt(m_index);
+    }
+
+    bool HasCurrent() const noexcept
+    {
+        return m_index < m_owner->Size();
+    }
+
+    bool MoveNext() noexcept
+    {
+        if (m_index < m_owner->Size())
+            ++m_index;
+
+        return HasCurrent();
+    }
+
+    uint32_t GetMany(winrt::array_view<winrt::WinMgmt::WmiClassObject> items)
+    {
+        const auto taken = m_owner->GetMany(m_index, items);
+        m_index += taken;
+        return taken;
+    }
+
+private:
+    winrt::com_ptr<WmiRowCollection> m_owner;
+    uint32_t m_index = 0;
+};
+
+WmiRowCollection::WmiRowCollection(std::size_t size, factory make)
+    : m_make(std::move(make)), m_rows(size)
+{
+}
+
+[[nodiscard]] winrt::WinMgmt::WmiClassObject WmiRowCollection::GetAt(uint32_t index)
+{
+    if (index >= m_rows.Size()) [[unlikely]]
+        throw winrt::hresult_out_of_bounds();
+
+    return m_rows.Get(index, m_make);
+}
+
+[[nodiscard]] uint32_t WmiRowCollection::Size() const noexcept
+{
+    return static_cast<uint32_t>(m_rows.Size());
+}
+
+bool WmiRowCollection::IndexOf(winrt::WinMgmt::WmiClassObject const& value, uint32_t& index)
+{
+    // An object from this collection was made by GetAt, so only made rows can match.
+    if (auto found = m_rows.Find(value))
+    {
+        index = static_cast<uint32_t>(*found);
+        return true;
+    }
+
+    index = 0;
+    return false;
+}
+
+uint32_t WmiRowCollection::GetMany(uint32_t startIndex, winrt::array_view<winrt::WinMgmt::WmiClassObject> items)
+{
+    if (startIndex >= Size())
+        return 0;
+
+    const auto count = (std::min)(items.size(), Size() - startIndex);
+    for (uint32_t i = 0; i < count; ++i)
+        items[i] = m_rows.Get(startIndex + i, m_make);
+
+    return count;
+}
+
+[[nodiscard]] winrt::Windows::Foundation::Collections::IIterator<winrt::WinMgmt::WmiClassObject> WmiRowCollection::First()
+{
+    return winrt::make<Iterator>(get_strong());
+}
+
+[[nodiscard]] std::size_t WmiRowCollection::Materialized() const
+{
+    return m_rows.Materialized();
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include "WmiClassObject.h"
+#include "Core/RowArena.h"
+
+#include <functional>
+
+// The one collection object handed out for a result set. Its rows stay in the
+// query's own storage; the WmiClassObject for a row is made the first time GetAt
+// or an iterator reaches it and is returned again on later touches.
+struct WmiRowCollection : winrt::implements<WmiRowCollection,
+	winrt::Windows::Foundation::Collections::IVectorView<winrt::WinMgmt::WmiClassObject>,
+	winrt::Windows::Foundation::Collections::IIterable<winrt::WinMgmt::WmiClassObject>>
+{
+	// Makes the object for a row; the closure keeps the rows alive.
+	using factory = std::function<winrt::WinMgmt::WmiClassObject(std::size_t)>;
+
+	WmiRowCollection(std::size_t size, factory make);
+
+	winrt::WinMgmt::WmiClassObject GetAt(uint32_t index);
+
+	uint32_t Size() const noexcept;
+
+	bool IndexOf(winrt::WinMgmt::WmiClassObject const& value, uint32_t& index);
+
+	uint32_t GetMany(uint32_t startIndex, winrt::array_view<winrt::WinMgmt::WmiClassObject> items);
+
+	winrt::Windows::Foundation::Collections::IIterator<winrt::WinMgmt::WmiClassObject> First();
+
+	// Rows that have a WmiClassObject so far.
+	std::size_t Materialized() const;
+
+private:
+	struct Iterator;
+
+	factory m_make;
+	Wmi::LazyProjection<winrt::WinMgmt::WmiClassObject> m_rows;
+};
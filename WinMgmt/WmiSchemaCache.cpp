@@ -0,0 +1,54 @@
+#include "pch.h"
+#include "WmiSchemaCache.h"
+#include "WmiPlanCache.h"
+
+[[nodiscard]] Wmi::BasicSchemaCache<winrt::hstring>& WmiSchemaCache::Instance() noexcept
+{
+    static Wmi::BasicSchemaCache<winrt::hstring> cache;
+    return cache;
+}
+
+WmiSchemaScope::WmiSchemaScope(winrt::hstring ns, winrt::hstring const& query)
+    : m_namespace(std::move(ns))
+{
+    // A projected query ("SELECT Name FROM ...") returns objects of the same __CLASS
+    // with only the selected properties, so the select list is part of the key.
+    auto lookup = WmiPlanCache::Resolve(query);
+    auto const& plan = lookup.plan->query;
+    if (plan.kind != Wmi::Wql::QueryKind::Select || plan.selectAll)
+        return;
+
+    for (auto property : plan.properties)
+    {
+        m_shape.push_back(L'\n');
+        for (auto c : property)
+            m_shape.push_back(Wmi::Wql::ToUpperAscii(c));
+    }
+}
+
+[[nodiscard]] WmiClassSchemaPtr WmiSchemaScope::Resolve(IWbemClassObject* object) const
+{
+    _variant_t className;
+    winrt::check_hresult(object->Get(L"__CLASS", 0, &className, nullptr, nullptr));
+
+    if (className.vt != VT_BSTR) [[unlikely]]
+        throw winrt::hresult_error(WBEM_E_INVALID_CLASS, L"object has no class name");
+
+    std::wstring key{ className.bstrVal, ::SysStringLen(className.bstrVal) };
+    key.append(m_shape);
+
+    return WmiSchemaCache::Instance().GetOrAdd(m_namespace, key, [object](auto&& add)
+    {
+        winrt::check_hresult(object->BeginEnumeration(WBEM_FLAG_NONSYSTEM_ONLY));
+
+        auto guard = wil::scope_exit([&] { object->EndEnumeration(); });
+
+        _bstr_t name;
+        CIMTYPE cimType{};
+        while (object->Next(0, name.GetAddress(), nullptr, &cimType, nullptr) == WBEM_S_NO_ERROR)
+        {
+            auto type = static_cast<std::uint32_t>(cimType);
+            add({ { static_cast<const wchar_t*>(name), name.length() }, Wmi::PropertyTypeFromCimType(type), Wmi::ElementTypeFromCimType(type) });
+        }
+    });
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include "Core/SchemaCache.h"
+
+using WmiClassSchema = Wmi::BasicClassSchema<winrt::hstring>;
+using WmiClassSchemaPtr = std::shared_ptr<const WmiClassSchema>;
+
+struct WmiSchemaCache
+{
+	static Wmi::BasicSchemaCache<winrt::hstring>& Instance() noexcept;
+};
+
+// Resolves the schemas of the objects one query returns. Every object of a class
+// that a query returns carries the properties its select list names, so the key
+// is worked out once from the query text and each object costs one __CLASS read.
+class WmiSchemaScope
+{
+public:
+	WmiSchemaScope(winrt::hstring ns, winrt::hstring const& query);
+
+	WmiClassSchemaPtr Resolve(IWbemClassObject* object) const;
+
+private:
+	winrt::hstring m_namespace;
+	std::wstring m_shape;
+};
@@ -0,0 +1,78 @@
+﻿#include "pch.h"
+#include "WmiSnapshotDiff.h"
+#if __has_include("WmiSnapshotDiff.g.cpp")
+#include "WmiSnapshotDiff.g.cpp"
+#endif
+
+namespace winrt::WinMgmt::implementation
+{
+    WmiSnapshotDiff::WmiSnapshotDiff(Windows::Foundation::Collections::IVectorView<WinMgmt::WmiClassObject> const& before,
+                                     Windows::Foundation::Collections::IVectorView<WinMgmt::WmiClassObject> const& after,
+                                     Wmi::SnapshotDiff const& diff)
+        : m_unchanged(static_cast<uint32_t>(diff.Unchanged()))
+    {
+        std::vector<WinMgmt::WmiClassObject> added;
+        added.reserve(diff.Added().size());
+        for (auto row : diff.Added())
+            added.push_back(after.GetAt(row));
+
+        std::vector<WinMgmt::WmiClassObject> removed;
+        removed.reserve(diff.Removed().size());
+        for (auto row : diff.Removed())
+            removed.push_back(before.GetAt(row));
+
+        std::vector<WinMgmt::WmiClassObject> changed;
+        changed.reserve(diff.Changed().size());
+        m_previous.reserve(diff.Changed().size());
+        m_changedProperties.reserve(diff.Changed().size());
+        for (auto const& change : diff.Changed())
+        {
+            changed.push_back(after.GetAt(change.after));
+            m_previous.push_back(before.GetAt(change.before));
+
+            std::vector<hstring> names;
+            names.reserve(change.propertyCount);
+            for (auto property : diff.ChangedProperties(change))
+                names.emplace_back(diff.PropertyName(property));
+            m_changedProperties.push_back(single_threaded_vector<hstring>(std::move(names)).GetView());
+        }
+
+        m_added = single_threaded_vector<WinMgmt::WmiClassObject>(std::move(added)).GetView();
+        m_removed = single_threaded_vector<WinMgmt::WmiClassObject>(std::move(removed)).GetView();
+        m_changed = single_threaded_vector<WinMgmt::WmiClassObject>(std::move(changed)).GetView();
+    }
+
+    [[nodiscard]] Windows::Foundation::Collections::IVectorView<WinMgmt::WmiClassObject> WmiSnapshotDiff::Added() const noexcept
+    {
+        return m_added;
+    }
+
+    [[nodiscard]] Windows::Foundation::Collections::IVectorView<WinMgmt::WmiClassObject> WmiSnapshotDiff::Removed() const noexcept
+    {
+        return m_removed;
+    }
+
+    [[nodiscard]] Windows::Foundation::Collections::IVectorView<WinMgmt::WmiClassObject> WmiSnapshotDiff::Changed() const noexcept
+    {
+        return m_changed;
+    }
+
+    [[nodiscard]] WinMgmt::WmiClassObject WmiSnapshotDiff::Previous(uint32_t index) const
+    {
+        if (index >= m_previous.size()) [[unlikely]]
+            throw winrt::hresult_out_of_bounds();
+        return m_previous[index];
+    }
+
+    [[nodiscard]] Windows::Foundation::Collections::IVectorView<hstring> WmiSnapshotDiff::ChangedProperties(uint32_t index) const
+    {
+        if (index >= m_changedProperties.size()) [[unlikely]]
+            throw winrt::hresult_out_of_bounds();
+        return m_changedProperties[index];
+    }
+
+    [[nodiscard]] uint32_t WmiSnapshotDiff::UnchangedCount() const noexcept
+    {
+        return m_unchanged;
+    }
+}
@@ -0,0 +1,37 @@
+﻿#pragma once
+
+#include "WmiSnapshotDiff.g.h"
+#include "Core/SnapshotDiff.h"
+
+#include <vector>
+
+namespace winrt::WinMgmt::implementation
+{
+    struct WmiSnapshotDiff : WmiSnapshotDiffT<WmiSnapshotDiff>
+    {
+        // Picks the objects named by diff out of the two results it was computed from.
+        WmiSnapshotDiff(Windows::Foundation::Collections::IVectorView<WinMgmt::WmiClassObject> const& before,
+                        Windows::Foundation::Collections::IVectorView<WinMgmt::WmiClassObject> const& after,
+                        Wmi::SnapshotDiff const& diff);
+
+        Windows::Foundation::Collections::IVectorView<WinMgmt::WmiClassObject> Added() const noexcept;
+
+        Windows::Foundation::Collections::IVectorView<WinMgmt::WmiClassObject> Removed() const noexcept;
+
+        Windows::Foundation::Collections::IVectorView<WinMgmt::WmiClassObject> Changed() const noexcept;
+
+        WinMgmt::WmiClassObject Previous(uint32_t index) const;
+
+        Windows::Foundation::Collections::IVectorView<hstring> ChangedProperties(uint32_t index) const;
+
+        uint32_t UnchangedCount() const noexcept;
+
+    private:
+        Windows::Foundation::Collections::IVectorView<WinMgmt::WmiClassObject> m_added;
+        Windows::Foundation::Collections::IVectorView<WinMgmt::WmiClassObject> m_removed;
+        Windows::Foundation::Collections::IVectorView<WinMgmt::WmiClassObject> m_changed;
+        std::vector<WinMgmt::WmiClassObject> m_previous;
+        std::vector<Windows::Foundation::Collections::IVectorView<hstring>> m_changedProperties;
+        uint32_t m_unchanged = 0;
+    };
+}
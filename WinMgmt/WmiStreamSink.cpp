@@ -0,0 +1,42 @@
+#include "pch.h"
+#include "WmiStreamSink.h"
+
+WmiStreamSink::WmiStreamSink(WmiSchemaScope schemas, Wmi::AccessRecorderPtr recorder, std::size_t batchSize, std::size_t maxPendingBatches)
+    : m_schemas(std::move(schemas)), m_recorder(std::move(recorder)), m_channel(batchSize, maxPendingBatches)
+{
+}
+
+HRESULT STDMETHODCALLTYPE WmiStreamSink::Indicate(LONG lObjectCount, IWbemClassObject** apObjArray) noexcept
+{
+    if (!apObjArray) [[unlikely]]
+        return E_POINTER;
+
+    try
+    {
+        // Push blocks once the consumer falls behind, which in turn holds back the provider.
+        for (LONG i = 0; i < lObjectCount; i++) [[likely]]
+        {
+            auto schema = m_schemas.Resolve(apObjArray[i]);
+            if (!m_channel.Push(winrt::make<winrt::WinMgmt::implementation::WmiClassObject>(apObjArray[i], std::move(schema), m_recorder))) [[unlikely]]
+                return WBEM_E_CALL_CANCELLED;
+        }
+    }
+    catch (...)
+    {
+        return winrt::to_hresult();
+    }
+    return WBEM_S_NO_ERROR;
+}
+
+HRESULT STDMETHODCALLTYPE WmiStreamSink::SetStatus(LONG lFlags, HRESULT hResult, BSTR strParam, IWbemClassObject* pObjParam) noexcept
+{
+    if (lFlags == WBEM_STATUS_COMPLETE)
+        m_channel.Complete(hResult);
+
+    return WBEM_S_NO_ERROR;
+}
+
+[[nodiscard]] WmiStreamSink::channel_type& WmiStreamSink::Channel() noexcept
+{
+    return m_channel;
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include "WmiClassObject.h"
+#include "Core/BatchChannel.h"
+
+struct WmiStreamSink : winrt::implements<WmiStreamSink, IWbemObjectSink>
+{
+	using channel_type = Wmi::BatchChannel<winrt::WinMgmt::WmiClassObject>;
+
+	WmiStreamSink(WmiSchemaScope schemas, Wmi::AccessRecorderPtr recorder, std::size_t batchSize, std::size_t maxPendingBatches);
+
+	HRESULT STDMETHODCALLTYPE Indicate(LONG lObjectCount, IWbemClassObject** apObjArray) noexcept override;
+
+	HRESULT STDMETHODCALLTYPE SetStatus(LONG lFlags, HRESULT hResult, [[maybe_unused]] BSTR strParam, [[maybe_unused]] IWbemClassObject* pObjParam) noexcept override;
+
+	channel_type& Channel() noexcept;
+
+private:
+	WmiSchemaScope m_schemas;
+	Wmi::AccessRecorderPtr m_recorder;
+	channel_type m_channel;
+};
@@ -0,0 +1,86 @@
+#include "pch.h"
+#include "WmiTableSink.h"
+#include "WmiConnectionPool.h"
+#include "WmiRowCollection.h"
+#include "PropertyParser.h"
+
+WmiTableSink::WmiTableSink(WmiSchemaScope schemas, std::shared_ptr<Wmi::StringPool> strings)
+    : m_schemas(std::move(schemas))
+{
+    if (strings)
+        m_call.Produce([&](Wmi::ResultTable& table) { table.UseStringPool(std::move(strings)); });
+}
+
+[[nodiscard]] std::shared_ptr<const Wmi::ResultTable> WmiTableSink::TakeTable()
+{
+    return std::make_shared<const Wmi::ResultTable>(m_call.Take());
+}
+
+[[nodiscard]] winrt::Windows::Foundation::Collections::IVectorView<winrt::WinMgmt::WmiClassObject> WmiTableSink::Results()
+{
+    return Rows(TakeTable());
+}
+
+[[nodiscard]] winrt::Windows::Foundation::Collections::IVectorView<winrt::WinMgmt::WmiClassObject> WmiTableSink::Rows(std::shared_ptr<const Wmi::ResultTable> const& table, Wmi::AccessRecorderPtr const& recorder)
+{
+    return winrt::make<WmiRowCollection>(table->RowCount(), [table, recorder](std::size_t row) {
+        return winrt::make<winrt::WinMgmt::implementation::WmiClassObject>(table, row, recorder);
+    });
+}
+
+HRESULT STDMETHODCALLTYPE WmiTableSink::Indicate(LONG lObjectCount, IWbemClassObject** apObjArray) noexcept
+{
+    if (!apObjArray) [[unlikely]]
+        return E_POINTER;
+
+    try
+    {
+        // Refused once the caller has given up; tells winmgmt to stop delivering.
+        const bool accepted = m_call.Produce([&](Wmi::ResultTable& table) {
+            for (LONG i = 0; i < lObjectCount; i++) [[likely]]
+            {
+                auto schema = m_schemas.Resolve(apObjArray[i]);
+                PropertyParser::AppendRow(table, apObjArray[i], *schema);
+            }
+        });
+
+        if (!accepted)
+            return WBEM_E_CALL_CANCELLED;
+    }
+    catch (...)
+    {
+        return winrt::to_hresult();
+    }
+    return WBEM_S_NO_ERROR;
+}
+
+HRESULT STDMETHODCALLTYPE WmiTableSink::SetStatus(LONG lFlags, HRESULT hResult, BSTR strParam, IWbemClassObject* pObjParam) noexcept
+{
+    if (lFlags == WBEM_STATUS_COMPLETE)
+        m_call.Complete(hResult);
+
+    return WBEM_S_NO_ERROR;
+}
+
+void WmiTableSink::Started(winrt::com_ptr<IWbemServices> services)
+{
+    m_call.OnCancel([services = AgileServices{ services }, this] { WmiConnectionPool::CancelAsyncCall(services, this); });
+}
+
+winrt::Windows::Foundation::IAsyncAction WmiTableSink::WaitAsync(winrt::Windows::Foundation::TimeSpan timeout)
+{
+    if (!m_event) [[unlikely]]
+        throw winrt::hresult_error(E_POINTER, L"Event not initialized");
+
+    // A zero timeout waits indefinitely.
+    auto strong = get_strong();
+    if (!co_await winrt::resume_on_signal(m_event.get(), timeout))
+        m_call.Cancel(WBEM_E_TIMED_OUT);
+
+    winrt::check_hresult(m_call.Status());
+}
+
+[[nodiscard]] WmiTableSink::call_type& WmiTableSink::Call() noexcept
+{
+    return m_call;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "WmiClassObject.h"
+#include "Core/PendingCall.h"
+#include "Core/ResultTable.h"
+
+#include <memory>
+
+struct WmiTableSink : winrt::implements<WmiTableSink, IWbemObjectSink>
+{
+	using call_type = Wmi::PendingCall<Wmi::ResultTable>;
+
+	// With a pool, repeated string values are kept once per pool rather than per row.
+	explicit WmiTableSink(WmiSchemaScope schemas, std::shared_ptr<Wmi::StringPool> strings = nullptr);
+
+	// Hands over the table; call once, after the call completed successfully.
+	std::shared_ptr<const Wmi::ResultTable> TakeTable();
+
+	winrt::Windows::Foundation::Collections::IVectorView<winrt::WinMgmt::WmiClassObject> Results();
+
+	// Row-view objects over a finished table, whichever backend produced it, each made
+	// on first touch.
+	static winrt::Windows::Foundation::Collections::IVectorView<winrt::WinMgmt::WmiClassObject> Rows(std::shared_ptr<const Wmi::ResultTable> const& table, Wmi::AccessRecorderPtr const& recorder = nullptr);
+
+	HRESULT STDMETHODCALLTYPE Indicate(LONG lObjectCount, IWbemClassObject** apObjArray) noexcept override;
+
+	HRESULT STDMETHODCALLTYPE SetStatus(LONG lFlags, HRESULT hResult, [[maybe_unused]] BSTR strParam, [[maybe_unused]] IWbemClassObject* pObjParam) noexcept override;
+
+	// Lets Call().Cancel() stop the call on the connection it was started on.
+	void Started(winrt::com_ptr<IWbemServices> services);
+
+	// Completes when the call ends and throws its failure status. A non-zero timeout
+	// cancels the call with WBEM_E_TIMED_OUT once it elapses.
+	winrt::Windows::Foundation::IAsyncAction WaitAsync(winrt::Windows::Foundation::TimeSpan timeout = {});
+
+	call_type& Call() noexcept;
+
+private:
+	WmiSchemaScope m_schemas;
+	winrt::handle m_event{ ::CreateEventW(NULL, TRUE, FALSE, NULL) };
+	call_type m_call{ [this] { ::SetEvent(m_event.get()); } };
+};
@@ -0,0 +1,86 @@
+#include "pch.h"
+#include "WmiWbemBackend.h"
+#include "WmiTableSink.h"
+
+WmiWbemBackend::WmiWbemBackend(std::wstring server, winrt::Windows::Foundation::TimeSpan timeout, std::shared_ptr<Wmi::StringPool> strings)
+    : m_server(std::move(server)), m_timeout(timeout), m_strings(std::move(strings))
+{
+}
+
+Wmi::ResultTablePtr WmiWbemBackend::Execute(std::wstring_view ns, std::wstring_view query)
+{
+    winrt::hstring queryText{ query };
+
+    auto sink = winrt::make_self<WmiTableSink>(WmiSchemaScope{ winrt::hstring{ ns }, queryText }, m_strings);
+    sink->Started(Start({ m_server, std::wstring{ ns }, {} }, queryText, sink.get()));
+
+    // Callers of Execute are already on a thread of their own, so wait on it directly.
+    auto& call = sink->Call();
+    winrt::check_hresult(m_timeout.count() > 0 ? call.WaitFor(m_timeout) : call.Wait());
+    return sink->TakeTable();
+}
+
+WmiServices WmiWbemBackend::Start(Wmi::ConnectionKey const& key, winrt::hstring const& query, IWbemObjectSink* sink)
+{
+    auto services = WmiConnectionPool::Instance().Acquire(key);
+
+    HRESULT hr = services->ExecQueryAsync(
+        _bstr_t(L"WQL"),
+        _bstr_t(query.c_str()),
+        0,
+        NULL,
+        sink
+    );
+
+    if (WmiConnectionPool::IsTransportError(hr)) [[unlikely]]
+        WmiConnectionPool::Instance().Invalidate(key);
+
+    winrt::check_hresult(hr);
+    WmiConnectionPool::Instance().Confirm(key);
+    return services;
+}
+
+WmiServices WmiWbemBackend::StartNotification(Wmi::ConnectionKey const& key, winrt::hstring const& query, IWbemObjectSink* sink)
+{
+    auto services = WmiConnectionPool::Instance().Acquire(key);
+
+    HRESULT hr = services->ExecNotificationQueryAsync(
+        _bstr_t(L"WQL"),
+        _bstr_t(query.c_str()),
+        0,
+        NULL,
+        sink
+    );
+
+    if (WmiConnectionPool::IsTransportError(hr)) [[unlikely]]
+        WmiConnectionPool::Instance().Invalidate(key);
+
+    winrt::check_hresult(hr);
+    WmiConnectionPool::Instance().Confirm(key);
+    return services;
+}
+
+winrt::com_ptr<IEnumWbemClassObject> WmiWbemBackend::StartForwardOnly(Wmi::ConnectionKey const& key, winrt::hstring const& query)
+{
+    auto services = WmiConnectionPool::Instance().Acquire(key);
+
+    winrt::com_ptr<IEnumWbemClassObject> enumerator;
+    HRESULT hr = services->ExecQuery(
+        _bstr_t(L"WQL"),
+        _bstr_t(query.c_str()),
+        WBEM_FLAG_RETURN_IMMEDIATELY | WBEM_FLAG_FORWARD_ONLY,
+        NULL,
+        enumerator.put()
+    );
+
+    if (WmiConnectionPool::IsTransportError(hr)) [[unlikely]]
+        WmiConnectionPool::Instance().Invalidate(key);
+
+    winrt::check_hresult(hr);
+    WmiConnectionPool::Instance().Confirm(key);
+
+    // The enumerator is a separate proxy and does not inherit the services' blanket.
+    WmiConnectionPool::SetProxyBlanket(enumerator.get());
+
+    return enumerator;
+}
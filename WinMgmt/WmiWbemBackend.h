@@ -0,0 +1,31 @@
+#pragma once
+#include "Core/QueryBackend.h"
+#include "WmiConnectionPool.h"
+
+// Live backend: runs queries through winmgmt on a pooled connection.
+struct WmiWbemBackend : Wmi::IQueryBackend
+{
+	// A non-zero timeout bounds every provider call; a call still running then is
+	// cancelled and Execute throws WBEM_E_TIMED_OUT. Given a strings pool, values
+	// repeated in the tables are stored once per pool.
+	explicit WmiWbemBackend(std::wstring server, winrt::Windows::Foundation::TimeSpan timeout = {}, std::shared_ptr<Wmi::StringPool> strings = nullptr);
+
+	Wmi::ResultTablePtr Execute(std::wstring_view ns, std::wstring_view query) override;
+
+	// Starts query asynchronously on the pooled connection for key and returns that
+	// connection; transport failures evict it from the pool before rethrowing.
+	static WmiServices Start(Wmi::ConnectionKey const& key, winrt::hstring const& query, IWbemObjectSink* sink);
+
+	// Starts query semisynchronously (WBEM_FLAG_RETURN_IMMEDIATELY | WBEM_FLAG_FORWARD_ONLY)
+	// and returns the enumerator to pull results from.
+	static winrt::com_ptr<IEnumWbemClassObject> StartForwardOnly(Wmi::ConnectionKey const& key, winrt::hstring const& query);
+
+	// Subscribes sink to an event query (ExecNotificationQueryAsync) and returns the
+	// connection the subscription lives on; cancel it there with CancelAsyncCall.
+	static WmiServices StartNotification(Wmi::ConnectionKey const& key, winrt::hstring const& query, IWbemObjectSink* sink);
+
+private:
+	std::wstring m_server;
+	winrt::Windows::Foundation::TimeSpan m_timeout;
+	std::shared_ptr<Wmi::StringPool> m_strings;
+};